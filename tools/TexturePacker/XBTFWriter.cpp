@@ -82,7 +82,9 @@ void CXBTFWriter::Cleanup()
 
 bool CXBTFWriter::AppendContent(unsigned char const* data, size_t length)
 {
-  unsigned char *new_data = (unsigned char *)realloc(m_data, m_size + length);
+  // pad so that each frame starts on an aligned offset (see UpdateHeader)
+  size_t padding = Align(m_size) - m_size;
+  unsigned char *new_data = (unsigned char *)realloc(m_data, m_size + padding + length);
 
   if (new_data == NULL)
   { // OOM - cleanup and fail
@@ -92,12 +94,19 @@ bool CXBTFWriter::AppendContent(unsigned char const* data, size_t length)
 
   m_data = new_data;
 
+  memset(m_data + m_size, 0, padding);
+  m_size += padding;
   memcpy(m_data + m_size, data, length);
   m_size += length;
 
   return true;
 }
 
+uint64_t CXBTFWriter::Align(uint64_t offset)
+{
+  return (offset + XBTF_FRAME_ALIGNMENT - 1) & ~(uint64_t)(XBTF_FRAME_ALIGNMENT - 1);
+}
+
 bool CXBTFWriter::UpdateHeader(const std::vector<unsigned int>& dupes)
 {
   if (m_file == NULL)
@@ -105,7 +114,10 @@ bool CXBTFWriter::UpdateHeader(const std::vector<unsigned int>& dupes)
     return false;
   }
 
-  uint64_t offset = m_xbtf.GetHeaderSize();
+  // frame data starts after the header, padded to our alignment
+  uint64_t headerSize = m_xbtf.GetHeaderSize();
+  uint64_t contentStart = Align(headerSize);
+  uint64_t offset = 0;
 
   WRITE_STR(XBTF_MAGIC, 4, m_file);
   WRITE_STR(XBTF_VERSION, 1, m_file);
@@ -136,7 +148,8 @@ bool CXBTFWriter::UpdateHeader(const std::vector<unsigned int>& dupes)
         frame.SetOffset(files[dupes[i]].GetFrames()[j].GetOffset());
       else
       {
-        frame.SetOffset(offset);
+        offset = Align(offset);
+        frame.SetOffset(contentStart + offset);
         offset += frame.GetPackedSize();
       }
 
@@ -152,11 +165,15 @@ bool CXBTFWriter::UpdateHeader(const std::vector<unsigned int>& dupes)
 
   // Sanity check
   int64_t pos = ftell(m_file);
-  if (pos != (int64_t)m_xbtf.GetHeaderSize())
+  if (pos != (int64_t)headerSize)
   {
-    printf("Expected header size (%" PRId64 ") != actual size (%" PRId64 ")\n", m_xbtf.GetHeaderSize(), pos);
+    printf("Expected header size (%" PRId64 ") != actual size (%" PRId64 ")\n", headerSize, pos);
     return false;
   }
 
+  // pad out to the start of the frame data
+  static const unsigned char padding[XBTF_FRAME_ALIGNMENT] = { 0 };
+  fwrite(padding, 1, (size_t)(contentStart - headerSize), m_file);
+
   return true;
 }
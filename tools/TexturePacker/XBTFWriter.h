@@ -25,6 +25,7 @@
 #include <vector>
 #include <string>
 #include <stdio.h>
+#include <stdint.h>
 
 class CXBTF;
 
@@ -39,6 +40,7 @@ public:
 
 private:
   void Cleanup();
+  static uint64_t Align(uint64_t offset);
 
   CXBTF& m_xbtf;
   std::string m_outputFile;
@@ -28,8 +28,10 @@
 #include "LangInfo.h"
 #include "Util.h"
 #include "URL.h"
+#include "network/DNSNameCache.h"
 #include "guilib/TextureManager.h"
 #include "cores/dvdplayer/DVDFileInfo.h"
+#include "cores/dvdplayer/DVDDemuxers/DVDDemuxProbeCache.h"
 #include "cores/AudioEngine/AEFactory.h"
 #include "cores/AudioEngine/Utils/AEUtil.h"
 #include "PlayListPlayer.h"
@@ -76,6 +78,7 @@
 #include "GUIUserMessages.h"
 #include "filesystem/DirectoryCache.h"
 #include "filesystem/StackDirectory.h"
+#include "filesystem/MultiPathDirectory.h"
 #include "filesystem/SpecialProtocol.h"
 #include "filesystem/DllLibCurl.h"
 #include "filesystem/MythSession.h"
@@ -180,6 +183,7 @@
 
 // Windows includes
 #include "guilib/GUIWindowManager.h"
+#include "guilib/GUIWindowXMLCache.h"
 #include "windows/GUIWindowHome.h"
 #include "guilib/GUIStandardWindow.h"
 #include "settings/GUIWindowSettings.h"
@@ -304,6 +308,7 @@
 #include "utils/JobManager.h"
 #include "utils/SaveFileStateJob.h"
 #include "utils/AlarmClock.h"
+#include "utils/Housekeeper.h"
 #include "utils/StringUtils.h"
 #include "DatabaseManager.h"
 
@@ -405,6 +410,11 @@ CApplication::CApplication(void)
 
   m_frameCount = 0;
 
+  m_idle = false;
+  memset(m_wakeCount, 0, sizeof(m_wakeCount));
+  m_idleTime = 0;
+  m_idleStatsStart = XbmcThreads::SystemClockMillis();
+
   m_bPresentFrame = false;
   m_bPlatformDirectories = true;
 
@@ -1356,6 +1366,7 @@ bool CApplication::Initialize()
   }
 
   m_slowTimer.StartZero();
+  StartHousekeeping();
 
 #if defined(HAVE_LIBCRYSTALHD)
   CCrystalHD::GetInstance();
@@ -1788,6 +1799,27 @@ void CApplication::DimLCDOnPlayback(bool dim)
 #endif
 }
 
+// only network filesystems have a host name to resolve - plugin://, special:// and friends
+// keep other things in that part of the url
+static void PrefetchSourceHost(const CStdString &path)
+{
+  if (URIUtils::IsMultiPath(path))
+  {
+    vector<CStdString> paths;
+    CMultiPathDirectory::GetPaths(path, paths);
+    for (unsigned int i = 0; i < paths.size(); i++)
+      PrefetchSourceHost(paths[i]);
+    return;
+  }
+
+  CURL url(path);
+  CStdString protocol = url.GetProtocol();
+  if (protocol.Equals("smb")  || protocol.Equals("nfs")   || protocol.Equals("afp")  ||
+      protocol.Equals("ftp")  || protocol.Equals("ftps")  || protocol.Equals("sftp") ||
+      protocol.Equals("http") || protocol.Equals("https") || protocol.Equals("dav")  || protocol.Equals("davs"))
+    CDNSNameCache::Prefetch(url.GetHostName());
+}
+
 void CApplication::StartServices()
 {
 #if !defined(_WIN32) && defined(HAS_DVD_DRIVE)
@@ -1796,6 +1828,18 @@ void CApplication::StartServices()
   m_DetectDVDType.Create(false, THREAD_MINSTACKSIZE);
 #endif
 
+  // warm the dns cache with the hosts our sources live on, so the first browse doesn't wait on the resolver
+  VECSOURCES *sources[] = { &g_settings.m_videoSources, &g_settings.m_musicSources, &g_settings.m_pictureSources,
+                            &g_settings.m_fileSources, &g_settings.m_programSources };
+  for (unsigned int i = 0; i < sizeof(sources) / sizeof(sources[0]); i++)
+  {
+    for (IVECSOURCES it = sources[i]->begin(); it != sources[i]->end(); ++it)
+    {
+      for (unsigned int j = 0; j < it->vecPaths.size(); j++)
+        PrefetchSourceHost(it->vecPaths[j]);
+    }
+  }
+
   CLog::Log(LOGNOTICE, "initializing playlistplayer");
   g_playlistPlayer.SetRepeat(PLAYLIST_MUSIC, g_settings.m_bMyMusicPlaylistRepeat ? PLAYLIST::REPEAT_ALL : PLAYLIST::REPEAT_NONE);
   g_playlistPlayer.SetShuffle(PLAYLIST_MUSIC, g_settings.m_bMyMusicPlaylistShuffle);
@@ -1816,6 +1860,7 @@ void CApplication::StartServices()
 void CApplication::StopServices()
 {
   m_network.NetworkMessage(CNetwork::SERVICES_DOWN, 0);
+  CDNSNameCache::Deinitialize();
 
 #if !defined(_WIN32) && defined(HAS_DVD_DRIVE)
   CLog::Log(LOGNOTICE, "stop dvd detect media");
@@ -1914,6 +1959,9 @@ void CApplication::LoadSkin(const SkinPtr& skin)
   g_SkinInfo = skin;
   g_SkinInfo->Start();
 
+  // parse the windows we're about to show while fonts and includes load
+  g_windowManager.PreloadWindows(currentWindow != WINDOW_INVALID ? currentWindow : g_SkinInfo->GetStartWindow());
+
   CLog::Log(LOGINFO, "  load fonts for skin...");
   g_graphicsContext.SetMediaDir(skin->Path());
   g_directoryCache.ClearSubPaths(skin->Path());
@@ -2012,6 +2060,7 @@ void CApplication::UnloadSkin(bool forReload /* = false */)
 
   g_windowManager.DeInitialize();
   CTextureCache::Get().Deinitialize();
+  g_windowXMLCache.Clear();
 
   // remove the skin-dependent window
   g_windowManager.Delete(WINDOW_DIALOG_FULLSCREEN_INFO);
@@ -2203,6 +2252,52 @@ void CApplication::NewFrame()
   }
 
   m_frameCond.notifyAll();
+  WakeUp(WAKE_PLAYER);
+}
+
+void CApplication::WakeUp(WakeReason reason)
+{
+  CSingleLock lock(m_wakeSection);
+  if (m_idle)
+  {
+    m_wakeCount[reason]++;
+    m_idle = false;
+  }
+  m_wakeEvent.Set();
+}
+
+void CApplication::OnThreadMessage()
+{
+  WakeUp(WAKE_MESSAGE);
+}
+
+void CApplication::WaitForWakeUp(unsigned int timeout)
+{
+  {
+    CSingleLock lock(m_wakeSection);
+    m_idle = true;
+  }
+
+  // a wake up that came in while we were busy returns straight away, uncounted
+  unsigned int start = XbmcThreads::SystemClockMillis();
+  bool woken = m_wakeEvent.WaitMSec(timeout);
+  unsigned int now = XbmcThreads::SystemClockMillis();
+
+  CSingleLock lock(m_wakeSection);
+  if (m_idle && !woken)
+    m_wakeCount[WAKE_TIMEOUT]++;
+  m_idle = false;
+  m_idleTime += now - start;
+
+  if (now - m_idleStatsStart >= 300000)
+  {
+    CLog::Log(LOGDEBUG, "%s - idle %u%% of the last %u s, woken by: timeout %u, message %u, input %u, player %u", __FUNCTION__,
+              (unsigned int)((uint64_t)m_idleTime * 100 / (now - m_idleStatsStart)), (now - m_idleStatsStart) / 1000,
+              m_wakeCount[WAKE_TIMEOUT], m_wakeCount[WAKE_MESSAGE], m_wakeCount[WAKE_INPUT], m_wakeCount[WAKE_PLAYER]);
+    memset(m_wakeCount, 0, sizeof(m_wakeCount));
+    m_idleTime = 0;
+    m_idleStatsStart = now;
+  }
 }
 
 void CApplication::Render()
@@ -2313,11 +2408,15 @@ void CApplication::Render()
   //fps limiter, make sure each frame lasts at least singleFrameTime milliseconds
   if (limitFrames || !flip)
   {
-    if (!limitFrames)
-      singleFrameTime = 40; //if not flipping, loop at 25 fps
-
     unsigned int frameTime = now - m_lastFrameTime;
-    if (frameTime < singleFrameTime)
+    if (!limitFrames)
+    {
+      // nothing on screen is changing, so wait for something to do rather than looping at the frame rate
+      singleFrameTime = g_advancedSettings.m_guiIdleWakeInterval;
+      if (frameTime < singleFrameTime)
+        WaitForWakeUp(singleFrameTime - frameTime);
+    }
+    else if (frameTime < singleFrameTime)
       Sleep(singleFrameTime - frameTime);
   }
   m_lastFrameTime = XbmcThreads::SystemClockMillis();
@@ -3539,6 +3638,7 @@ void CApplication::Stop(int exitCode)
     CJobManager::GetInstance().CancelJobs();
 
     g_alarmClock.StopThread();
+    g_housekeeper.Stop();
 
 #ifdef HAS_HTTPAPI
     if (m_pXbmcHttp)
@@ -3604,6 +3704,7 @@ void CApplication::Stop(int exitCode)
       delete m_pPlayer;
       m_pPlayer = NULL;
     }
+    CDVDDemuxProbeCache::Get().Flush();
 
 #if HAS_FILESYTEM_DAAP
     CLog::Log(LOGNOTICE, "stop daap clients");
@@ -5146,7 +5247,87 @@ void CApplication::Process()
   g_cpuInfo.getUsedPercentage(); // must call it to recalculate pct values
 }
 
-// We get called every 500ms
+// The housekeeping tasks below are run every 500ms by g_housekeeper, as they were by
+// ProcessSlow() - the idle checks count their timeouts in these ticks.
+#define HOUSEKEEPING_INTERVAL 500
+
+static void UnloadDelayedSections()
+{
+  //  check if we can unload any unreferenced dlls or sections
+  if (!g_application.IsPlayingVideo())
+    CSectionLoader::UnloadDelayed();
+}
+
+static void CheckIdleCurl()
+{
+  g_curlInterface.CheckIdle();
+}
+
+#ifdef HAS_FILESYSTEM_HTSP
+static void CheckIdleHTSP()
+{
+  HTSP::CHTSPDirectorySession::CheckIdle();
+}
+#endif
+
+#if defined(_LINUX) && defined(HAS_FILESYSTEM_SMB)
+static void CheckIdleSMB()
+{
+  smb.CheckIfIdle();
+}
+#endif
+
+#ifdef HAS_FILESYSTEM_NFS
+static void CheckIdleNFS()
+{
+  gNfsConnection.CheckIfIdle();
+}
+#endif
+
+#ifdef HAS_FILESYSTEM_AFP
+static void CheckIdleAFP()
+{
+  gAfpConnection.CheckIfIdle();
+}
+#endif
+
+static void ProcessMediaEvents()
+{
+  g_mediaManager.ProcessEvents();
+}
+
+static void UpdateAddonRepos()
+{
+  if (!g_application.IsPlayingVideo())
+    CAddonInstaller::Get().UpdateRepos();
+}
+
+void CApplication::StartHousekeeping()
+{
+  // checks that don't need the GUI thread, and would cost it a frame whenever they block
+  g_housekeeper.AddTask("sections", UnloadDelayedSections, HOUSEKEEPING_INTERVAL, 500);
+  g_housekeeper.AddTask("curl", CheckIdleCurl, HOUSEKEEPING_INTERVAL, 100);
+  g_housekeeper.AddTask("myth", CMythSession::CheckIdle, HOUSEKEEPING_INTERVAL, 100);
+#ifdef HAS_FILESYSTEM_HTSP
+  g_housekeeper.AddTask("htsp", CheckIdleHTSP, HOUSEKEEPING_INTERVAL, 100);
+#endif
+#if defined(_LINUX) && defined(HAS_FILESYSTEM_SMB)
+  g_housekeeper.AddTask("smb", CheckIdleSMB, HOUSEKEEPING_INTERVAL, 100);
+#endif
+#ifdef HAS_FILESYSTEM_NFS
+  g_housekeeper.AddTask("nfs", CheckIdleNFS, HOUSEKEEPING_INTERVAL, 100);
+#endif
+#ifdef HAS_FILESYSTEM_AFP
+  g_housekeeper.AddTask("afp", CheckIdleAFP, HOUSEKEEPING_INTERVAL, 100);
+#endif
+#ifdef HAS_FILESYSTEM_SFTP
+  g_housekeeper.AddTask("sftp", CSFTPSessionManager::ClearOutIdleSessions, HOUSEKEEPING_INTERVAL, 100);
+#endif
+  g_housekeeper.AddTask("media", ProcessMediaEvents, HOUSEKEEPING_INTERVAL, 200);
+  g_housekeeper.AddTask("repos", UpdateAddonRepos, HOUSEKEEPING_INTERVAL, 500);
+  g_housekeeper.Start();
+}
+
 void CApplication::ProcessSlow()
 {
   g_powerManager.ProcessEvents();
@@ -5186,21 +5367,6 @@ void CApplication::ProcessSlow()
   // check if we should restart the player
   CheckDelayedPlayerRestart();
 
-  //  check if we can unload any unreferenced dlls or sections
-  if (!IsPlayingVideo())
-    CSectionLoader::UnloadDelayed();
-
-  // check for any idle curl connections
-  g_curlInterface.CheckIdle();
-
-  // check for any idle myth sessions
-  CMythSession::CheckIdle();
-
-#ifdef HAS_FILESYSTEM_HTSP
-  // check for any idle htsp sessions
-  HTSP::CHTSPDirectorySession::CheckIdle();
-#endif
-
 #ifdef HAS_KARAOKE
   if ( m_pKaraokeMgr )
     m_pKaraokeMgr->ProcessSlow();
@@ -5231,24 +5397,6 @@ void CApplication::ProcessSlow()
   //Check to see if current playing Title has changed and whether we should broadcast the fact
   CheckForTitleChange();
 
-#if defined(_LINUX) && defined(HAS_FILESYSTEM_SMB)
-  smb.CheckIfIdle();
-#endif
-
-#ifdef HAS_FILESYSTEM_NFS
-  gNfsConnection.CheckIfIdle();
-#endif
-
-#ifdef HAS_FILESYSTEM_AFP
-  gAfpConnection.CheckIfIdle();
-#endif
-
-#ifdef HAS_FILESYSTEM_SFTP
-  CSFTPSessionManager::ClearOutIdleSessions();
-#endif
-
-  g_mediaManager.ProcessEvents();
-
 #ifdef HAS_LIRC
   if (g_RemoteControl.IsInUse() && !g_RemoteControl.IsInitialized())
     g_RemoteControl.Initialize();
@@ -5266,9 +5414,6 @@ void CApplication::ProcessSlow()
   }
 #endif
 
-  if (!IsPlayingVideo())
-    CAddonInstaller::Get().UpdateRepos();
-
   CAEFactory::GarbageCollect();
 }
 
@@ -27,6 +27,7 @@
 #include "guilib/IMsgTargetCallback.h"
 #include "guilib/Key.h"
 #include "threads/Condition.h"
+#include "threads/Event.h"
 
 #include <map>
 
@@ -205,6 +206,7 @@ public:
 
   virtual void Process();
   void ProcessSlow();
+  void StartHousekeeping();
   void ResetScreenSaver();
   int GetVolume() const;
   void SetVolume(float iValue, bool isPercentage = true);
@@ -318,6 +320,23 @@ public:
   void NewFrame();
   bool WaitFrame(unsigned int timeout);
 
+  /*! \brief What woke the render loop while nothing on screen was changing */
+  enum WakeReason
+  {
+    WAKE_TIMEOUT = 0, ///< gui.idlewakeinterval passed
+    WAKE_MESSAGE,     ///< a message for the application or the GUI was queued
+    WAKE_INPUT,       ///< input arrived from a background thread
+    WAKE_PLAYER,      ///< the player has a new frame to show
+    WAKE_REASONS
+  };
+
+  /*! \brief Wake the render loop if it's waiting for something to change on screen
+   Safe to call from any thread.
+   \param reason what there is to do
+   */
+  void WakeUp(WakeReason reason);
+  virtual void OnThreadMessage();
+
   void EnablePlatformDirectories(bool enable=true)
   {
     m_bPlatformDirectories = enable;
@@ -426,6 +445,15 @@ protected:
   unsigned int m_lastFrameTime;
   unsigned int m_lastRenderTime;
 
+  void WaitForWakeUp(unsigned int timeout);
+
+  CCriticalSection m_wakeSection;
+  CEvent       m_wakeEvent;
+  bool         m_idle;                     ///< the render loop is waiting in WaitForWakeUp()
+  unsigned int m_wakeCount[WAKE_REASONS];
+  unsigned int m_idleTime;                 ///< ms spent waiting since m_idleStatsStart
+  unsigned int m_idleStatsStart;
+
   bool m_bStandalone;
   bool m_bEnableLegacyRes;
   bool m_bTestMode;
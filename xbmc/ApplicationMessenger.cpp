@@ -181,6 +181,8 @@ void CApplicationMessenger::SendMessage(ThreadMessage& message, bool wait)
                  //   of the message itself after this point consittutes
                  //   a race condition (yarc - "yet another race condition")
                  //
+  g_application.WakeUp(CApplication::WAKE_MESSAGE);
+
   if (waitEvent) // ... it just so happens we have a spare reference to the
                  //  waitEvent ... just for such contingencies :)
   { 
@@ -22,6 +22,7 @@
 #include "DynamicDll.h"
 #include "SectionLoader.h"
 #include "filesystem/File.h"
+#include "threads/SingleLock.h"
 #include "utils/log.h"
 
 using namespace XFILE;
@@ -49,7 +50,7 @@ bool DllDynamic::Load()
   if (m_dll)
     return true;
 
-  if (!(m_dll=CSectionLoader::LoadDLL(m_strDllName, m_DelayUnload, LoadSymbols())))
+  if (!(m_dll=CSectionLoader::LoadDLL(m_strDllName, m_DelayUnload, LoadSymbols(), &m_exports)))
     return false;
 
   if (!ResolveExports())
@@ -67,6 +68,27 @@ void DllDynamic::Unload()
   if(m_dll)
     CSectionLoader::UnloadDLL(m_strDllName);
   m_dll=NULL;
+  m_exports.reset();
+}
+
+int DllDynamic::ResolveExport(const char* symbol, void** ptr)
+{
+  if (!m_exports)
+    return m_dll->ResolveExport(symbol, ptr);
+
+  CSingleLock lock(m_exports->m_critSection);
+  std::map<std::string, void*>::const_iterator it = m_exports->m_exports.find(symbol);
+  if (it != m_exports->m_exports.end())
+  {
+    *ptr = it->second;
+    return 1;
+  }
+
+  if (!m_dll->ResolveExport(symbol, ptr))
+    return 0;
+
+  m_exports->m_exports.insert(std::make_pair(std::string(symbol), *ptr));
+  return 1;
 }
 
 bool DllDynamic::CanLoad()
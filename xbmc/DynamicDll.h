@@ -21,10 +21,15 @@
  *
  */
 
+#include <boost/shared_ptr.hpp>
+
 #include "cores/DllLoader/LibraryLoader.h"
 #include "utils/StdString.h"
 #include "DllPaths.h"
 
+class CDllExportTable;
+typedef boost::shared_ptr<CDllExportTable> DllExportTablePtr;
+
 ///////////////////////////////////////////////////////////
 //
 //  DECLARE_DLL_WRAPPER
@@ -375,10 +380,10 @@ public: \
 //          or DEFINE_METHOD_LINKAGE
 //
 #define RESOLVE_METHOD(method) \
-  m_dll->ResolveExport( #method , & m_##method##_ptr ) &&
+  ResolveExport( #method , & m_##method##_ptr ) &&
 
 #define RESOLVE_METHOD_FP(method) \
-  m_dll->ResolveExport( #method , & method##_ptr ) &&
+  ResolveExport( #method , & method##_ptr ) &&
 
 ///////////////////////////////////////////////////////////
 //
@@ -391,10 +396,10 @@ public: \
 //          or DEFINE_METHOD_LINKAGE
 //
 #define RESOLVE_METHOD_RENAME(dllmethod, method) \
-  m_dll->ResolveExport( #dllmethod , & m_##method##_ptr ) &&
+  ResolveExport( #dllmethod , & m_##method##_ptr ) &&
 
 #define RESOLVE_METHOD_RENAME_FP(dllmethod, method) \
-  m_dll->ResolveExport( #dllmethod , & method##_ptr ) &&
+  ResolveExport( #dllmethod , & method##_ptr ) &&
 
 
 ////////////////////////////////////////////////////////////////////
@@ -471,9 +476,9 @@ public: \
 //    virtual bool ResolveExports()
 //    {
 //      return (
-//              m_dll->ResolveExport( "foo", (void**)& m_foo ) &&
-//              m_dll->ResolveExport( "_bar@8", (void**)& m_bar ) &&
-//              m_dll->ResolveExport( "foobar" , (void**)& foobar ) &&
+//              ResolveExport( "foo", (void**)& m_foo ) &&
+//              ResolveExport( "_bar@8", (void**)& m_bar ) &&
+//              ResolveExport( "foobar" , (void**)& foobar ) &&
 //             1
 //             );
 //    }
@@ -511,7 +516,12 @@ public:
 protected:
   virtual bool ResolveExports()=0;
   virtual bool LoadSymbols() { return false; }
+  /*! \brief Resolve an export through the export table shared by all wrappers of the dll
+   Only looks the export up in the dll the first time it's resolved after the dll was loaded.
+   */
+  int ResolveExport(const char* symbol, void** ptr);
   bool  m_DelayUnload;
   LibraryLoader* m_dll;
   CStdString m_strDllName;
+  DllExportTablePtr m_exports;
 };
@@ -54,6 +54,9 @@
 #include "music/karaoke/karaokelyricsfactory.h"
 #include "utils/Mime.h"
 
+#define FILEITEMLIST_CACHE_MAGIC   0x4c464258 // "XBFL"
+#define FILEITEMLIST_CACHE_VERSION 1
+
 using namespace std;
 using namespace XFILE;
 using namespace PLAYLIST;
@@ -1667,34 +1670,11 @@ void CFileItemList::Archive(CArchive& ar)
   CSingleLock lock(m_lock);
   if (ar.IsStoring())
   {
-    CFileItem::Archive(ar);
-
     int i = 0;
     if (m_items.size() > 0 && m_items[0]->IsParentFolder())
       i = 1;
 
-    ar << (int)(m_items.size() - i);
-
-    ar << m_fastLookup;
-
-    ar << (int)m_sortMethod;
-    ar << (int)m_sortOrder;
-    ar << m_sortIgnoreFolders;
-    ar << (int)m_cacheToDisc;
-
-    ar << (int)m_sortDetails.size();
-    for (unsigned int j = 0; j < m_sortDetails.size(); ++j)
-    {
-      const SORT_METHOD_DETAILS &details = m_sortDetails[j];
-      ar << (int)details.m_sortMethod;
-      ar << details.m_buttonLabel;
-      ar << details.m_labelMasks.m_strLabelFile;
-      ar << details.m_labelMasks.m_strLabelFolder;
-      ar << details.m_labelMasks.m_strLabel2File;
-      ar << details.m_labelMasks.m_strLabel2Folder;
-    }
-
-    ar << m_content;
+    StoreHeader(ar, (int)m_items.size() - i);
 
     for (; i < (int)m_items.size(); ++i)
     {
@@ -1704,71 +1684,107 @@ void CFileItemList::Archive(CArchive& ar)
   }
   else
   {
-    CFileItemPtr pParent;
-    if (!IsEmpty())
+    bool fastLookup = false;
+    int iSize = LoadHeader(ar, fastLookup);
+    if (iSize <= 0)
+      return ;
+
+    for (int i = 0; i < iSize; ++i)
     {
-      CFileItemPtr pItem=m_items[0];
-      if (pItem->IsParentFolder())
-        pParent.reset(new CFileItem(*pItem));
+      CFileItemPtr pItem(new CFileItem);
+      ar >> *pItem;
+      Add(pItem);
     }
 
-    SetFastLookup(false);
-    Clear();
+    SetFastLookup(fastLookup);
+  }
+}
 
+void CFileItemList::StoreHeader(CArchive& ar, int count)
+{
+  CFileItem::Archive(ar);
 
-    CFileItem::Archive(ar);
+  ar << count;
 
-    int iSize = 0;
-    ar >> iSize;
-    if (iSize <= 0)
-      return ;
+  ar << m_fastLookup;
 
-    if (pParent)
-    {
-      m_items.reserve(iSize + 1);
-      m_items.push_back(pParent);
-    }
-    else
-      m_items.reserve(iSize);
+  ar << (int)m_sortMethod;
+  ar << (int)m_sortOrder;
+  ar << m_sortIgnoreFolders;
+  ar << (int)m_cacheToDisc;
 
-    bool fastLookup=false;
-    ar >> fastLookup;
+  ar << (int)m_sortDetails.size();
+  for (unsigned int j = 0; j < m_sortDetails.size(); ++j)
+  {
+    const SORT_METHOD_DETAILS &details = m_sortDetails[j];
+    ar << (int)details.m_sortMethod;
+    ar << details.m_buttonLabel;
+    ar << details.m_labelMasks.m_strLabelFile;
+    ar << details.m_labelMasks.m_strLabelFolder;
+    ar << details.m_labelMasks.m_strLabel2File;
+    ar << details.m_labelMasks.m_strLabel2Folder;
+  }
 
-    int tempint;
-    ar >> (int&)tempint;
-    m_sortMethod = SORT_METHOD(tempint);
-    ar >> (int&)tempint;
-    m_sortOrder = SortOrder(tempint);
-    ar >> m_sortIgnoreFolders;
-    ar >> (int&)tempint;
-    m_cacheToDisc = CACHE_TYPE(tempint);
+  ar << m_content;
+}
 
-    unsigned int detailSize = 0;
-    ar >> detailSize;
-    for (unsigned int j = 0; j < detailSize; ++j)
-    {
-      SORT_METHOD_DETAILS details;
-      ar >> (int&)tempint;
-      details.m_sortMethod = SORT_METHOD(tempint);
-      ar >> details.m_buttonLabel;
-      ar >> details.m_labelMasks.m_strLabelFile;
-      ar >> details.m_labelMasks.m_strLabelFolder;
-      ar >> details.m_labelMasks.m_strLabel2File;
-      ar >> details.m_labelMasks.m_strLabel2Folder;
-      m_sortDetails.push_back(details);
-    }
+int CFileItemList::LoadHeader(CArchive& ar, bool &fastLookup)
+{
+  CFileItemPtr pParent;
+  if (!IsEmpty())
+  {
+    CFileItemPtr pItem=m_items[0];
+    if (pItem->IsParentFolder())
+      pParent.reset(new CFileItem(*pItem));
+  }
 
-    ar >> m_content;
+  SetFastLookup(false);
+  Clear();
 
-    for (int i = 0; i < iSize; ++i)
-    {
-      CFileItemPtr pItem(new CFileItem);
-      ar >> *pItem;
-      Add(pItem);
-    }
 
-    SetFastLookup(fastLookup);
+  CFileItem::Archive(ar);
+
+  int iSize = 0;
+  ar >> iSize;
+  if (iSize <= 0)
+    return 0;
+
+  if (pParent)
+  {
+    m_items.reserve(iSize + 1);
+    m_items.push_back(pParent);
   }
+  else
+    m_items.reserve(iSize);
+
+  ar >> fastLookup;
+
+  int tempint;
+  ar >> (int&)tempint;
+  m_sortMethod = SORT_METHOD(tempint);
+  ar >> (int&)tempint;
+  m_sortOrder = SortOrder(tempint);
+  ar >> m_sortIgnoreFolders;
+  ar >> (int&)tempint;
+  m_cacheToDisc = CACHE_TYPE(tempint);
+
+  unsigned int detailSize = 0;
+  ar >> detailSize;
+  for (unsigned int j = 0; j < detailSize; ++j)
+  {
+    SORT_METHOD_DETAILS details;
+    ar >> (int&)tempint;
+    details.m_sortMethod = SORT_METHOD(tempint);
+    ar >> details.m_buttonLabel;
+    ar >> details.m_labelMasks.m_strLabelFile;
+    ar >> details.m_labelMasks.m_strLabelFolder;
+    ar >> details.m_labelMasks.m_strLabel2File;
+    ar >> details.m_labelMasks.m_strLabel2Folder;
+    m_sortDetails.push_back(details);
+  }
+
+  ar >> m_content;
+  return iSize;
 }
 
 void CFileItemList::FillInDefaultIcons()
@@ -2306,11 +2322,33 @@ bool CFileItemList::Load(int windowID)
   if (file.Open(GetDiscFileCache(windowID)))
   {
     CLog::Log(LOGDEBUG,"Loading fileitems [%s]",GetPath().c_str());
-    CArchive ar(&file, CArchive::load);
-    ar >> *this;
-    CLog::Log(LOGDEBUG,"  -- items: %i, directory: %s sort method: %i, ascending: %s",Size(),GetPath().c_str(), m_sortMethod, m_sortOrder ? "true" : "false");
-    ar.Close();
+
+    // read the whole cache in one go and decode it from memory
+    std::vector<uint8_t> data;
+    int64_t length = file.GetLength();
+    if (length > 0 && length < INT_MAX)
+    {
+      data.resize((size_t)length);
+      unsigned int read = 0;
+      while (read < data.size())
+      {
+        unsigned int chunk = file.Read(&data[read], data.size() - read);
+        if (chunk == 0 || chunk > data.size() - read)
+          break;
+        read += chunk;
+      }
+      data.resize(read);
+    }
     file.Close();
+
+    if (!LoadFromCache(data))
+    {
+      CLog::Log(LOGDEBUG,"  -- discarding outdated or damaged cache for %s", GetPath().c_str());
+      Clear();
+      RemoveDiscCache(windowID);
+      return false;
+    }
+    CLog::Log(LOGDEBUG,"  -- items: %i, directory: %s sort method: %i, ascending: %s",Size(),GetPath().c_str(), m_sortMethod, m_sortOrder ? "true" : "false");
     return true;
   }
 
@@ -2328,8 +2366,34 @@ bool CFileItemList::Save(int windowID)
   CFile file;
   if (file.OpenForWrite(GetDiscFileCache(windowID), true)) // overwrite always
   {
+    CSingleLock lock(m_lock);
     CArchive ar(&file, CArchive::store);
-    ar << *this;
+    ar << (unsigned int)FILEITEMLIST_CACHE_MAGIC;
+    ar << (int)FILEITEMLIST_CACHE_VERSION;
+
+    int first = (m_items.size() > 0 && m_items[0]->IsParentFolder()) ? 1 : 0;
+    int count = (int)m_items.size() - first;
+    StoreHeader(ar, count);
+
+    // each item is followed by the next, so the offset table also gives their lengths
+    std::vector<int64_t> offsets;
+    offsets.reserve(count + 1);
+    for (int i = first; i < (int)m_items.size(); ++i)
+    {
+      offsets.push_back(ar.GetPosition());
+      ar << *m_items[i];
+    }
+    offsets.push_back(ar.GetPosition());
+
+    int64_t table = ar.GetPosition();
+    ar << count;
+    for (unsigned int i = 0; i < offsets.size(); ++i)
+      ar << offsets[i];
+
+    // the trailer is written last, so a cache that wasn't finished is never loaded
+    ar << table;
+    ar << (unsigned int)FILEITEMLIST_CACHE_MAGIC;
+
     CLog::Log(LOGDEBUG,"  -- items: %i, sort method: %i, ascending: %s",iSize,m_sortMethod, m_sortOrder ? "true" : "false");
     ar.Close();
     file.Close();
@@ -2339,6 +2403,62 @@ bool CFileItemList::Save(int windowID)
   return false;
 }
 
+bool CFileItemList::LoadFromCache(const std::vector<uint8_t> &data)
+{
+  static const unsigned int trailerSize = sizeof(int64_t) + sizeof(unsigned int);
+  static const unsigned int headerSize = sizeof(unsigned int) + sizeof(int);
+  if (data.size() < headerSize + trailerSize)
+    return false;
+
+  unsigned int magic = 0;
+  int version = 0;
+  CArchive header(&data[0], data.size());
+  header >> magic;
+  header >> version;
+  if (magic != FILEITEMLIST_CACHE_MAGIC || version != FILEITEMLIST_CACHE_VERSION)
+    return false;
+
+  int64_t table = 0;
+  CArchive trailer(&data[data.size() - trailerSize], trailerSize);
+  trailer >> table;
+  trailer >> magic;
+  if (magic != FILEITEMLIST_CACHE_MAGIC || table < headerSize || table > (int64_t)(data.size() - trailerSize))
+    return false;
+
+  // the offset table, with the end of the last item as its final entry
+  int count = 0;
+  CArchive tableAr(&data[(size_t)table], data.size() - trailerSize - (size_t)table);
+  tableAr >> count;
+  if (count < 0 || ((int64_t)count + 1) * sizeof(int64_t) + sizeof(int) != data.size() - trailerSize - table)
+    return false;
+  std::vector<int64_t> offsets(count + 1);
+  for (int i = 0; i <= count; ++i)
+  {
+    tableAr >> offsets[i];
+    if (offsets[i] > table || (i > 0 && offsets[i] < offsets[i - 1]))
+      return false;
+  }
+
+  CSingleLock lock(m_lock);
+  bool fastLookup = false;
+  if (LoadHeader(header, fastLookup) != count || header.GetPosition() != offsets[0])
+    return false;
+
+  for (int i = 0; i < count; ++i)
+  {
+    unsigned int length = (unsigned int)(offsets[i + 1] - offsets[i]);
+    CArchive ar(&data[(size_t)offsets[i]], length);
+    CFileItemPtr pItem(new CFileItem);
+    ar >> *pItem;
+    if (ar.GetPosition() != length)
+      return false;
+    Add(pItem);
+  }
+
+  SetFastLookup(fastLookup);
+  return true;
+}
+
 void CFileItemList::RemoveDiscCache(int windowID) const
 {
   CStdString cacheFile(GetDiscFileCache(windowID));
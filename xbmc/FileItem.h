@@ -465,6 +465,9 @@ private:
   void Sort(FILEITEMLISTCOMPARISONFUNC func);
   void FillSortFields(FILEITEMFILLFUNC func);
   CStdString GetDiscFileCache(int windowID) const;
+  void StoreHeader(CArchive& ar, int count);
+  int LoadHeader(CArchive& ar, bool &fastLookup);
+  bool LoadFromCache(const std::vector<uint8_t> &data);
 
   /*!
    \brief stack files in a CFileItemList
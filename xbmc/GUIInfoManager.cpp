@@ -26,6 +26,7 @@
 #include "Application.h"
 #include "Util.h"
 #include "network/libscrobbler/lastfmscrobbler.h"
+#include "network/DNSNameCache.h"
 #include "utils/URIUtils.h"
 #include "utils/Weather.h"
 #include "PartyModeManager.h"
@@ -286,7 +287,8 @@ const infomap network_labels[] = {{ "isdhcp",            NETWORK_IS_DHCP },
                                   { "gatewayaddress",    NETWORK_GATEWAY_ADDRESS },
                                   { "dns1address",       NETWORK_DNS1_ADDRESS },
                                   { "dns2address",       NETWORK_DNS2_ADDRESS },
-                                  { "dhcpaddress",       NETWORK_DHCP_ADDRESS }};
+                                  { "dhcpaddress",       NETWORK_DHCP_ADDRESS },
+                                  { "dnscache",          NETWORK_DNS_CACHE }};
 
 const infomap musicpartymode[] = {{ "enabled",           MUSICPM_ENABLED },
                                   { "songsplayed",       MUSICPM_SONGSPLAYED },
@@ -1603,6 +1605,13 @@ CStdString CGUIInfoManager::GetLabel(int info, int contextWindow, CStdString *fa
       return dhcpserver;
     }
     break;
+  case NETWORK_DNS_CACHE:
+    {
+      unsigned int hits, misses, negativeHits;
+      CDNSNameCache::GetStats(hits, misses, negativeHits);
+      strLabel.Format("%u / %u / %u", hits, misses, negativeHits);
+    }
+    break;
   case NETWORK_LINK_STATE:
     {
       CStdString linkStatus = g_localizeStrings.Get(151);
@@ -188,6 +188,7 @@ namespace INFO
 #define NETWORK_DNS1_ADDRESS        196
 #define NETWORK_DNS2_ADDRESS        197
 #define NETWORK_DHCP_ADDRESS        198
+#define NETWORK_DNS_CACHE           199
 
 #define MUSICPLAYER_TITLE           200
 #define MUSICPLAYER_ALBUM           201
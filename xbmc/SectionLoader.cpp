@@ -34,6 +34,11 @@ using namespace std;
 //  delay for unloading dll's
 #define UNLOAD_DELAY 30*1000 // 30 sec.
 
+//  dll's loaded again within this time after unloading them
+//  are kept loaded twice as long, up to MAX_UNLOAD_DELAY
+#define HOT_RELOAD_WINDOW 5*60*1000 // 5 min.
+#define MAX_UNLOAD_DELAY 10*60*1000 // 10 min.
+
 //Define this to get loggin on all calls to load/unload sections/dlls
 //#define LOGALL
 
@@ -45,11 +50,21 @@ CSectionLoader::~CSectionLoader(void)
   UnloadAll();
 }
 
-LibraryLoader *CSectionLoader::LoadDLL(const CStdString &dllname, bool bDelayUnload /*=true*/, bool bLoadSymbols /*=false*/)
+CSectionLoader::CDllStats &CSectionLoader::GetStatsLocked(const CStdString &dllname)
+{
+  CStdString key(dllname);
+  key.ToLower();
+  return g_sectionLoader.m_stats[key];
+}
+
+LibraryLoader *CSectionLoader::LoadDLL(const CStdString &dllname, bool bDelayUnload /*=true*/, bool bLoadSymbols /*=false*/, DllExportTablePtr *exports /*=NULL*/)
 {
   CSingleLock lock(g_sectionLoader.m_critSection);
 
   if (!dllname) return NULL;
+  CDllStats &stats = GetStatsLocked(dllname);
+  stats.m_references++;
+
   // check if it's already loaded, and increase the reference count if so
   for (int i = 0; i < (int)g_sectionLoader.m_vecLoadedDLLs.size(); ++i)
   {
@@ -57,23 +72,41 @@ LibraryLoader *CSectionLoader::LoadDLL(const CStdString &dllname, bool bDelayUnl
     if (dll.m_strDllName.Equals(dllname))
     {
       dll.m_lReferenceCount++;
+      if (exports)
+        *exports = dll.m_exports;
       return dll.m_pDll;
     }
   }
 
   // ok, now load the dll
-  CLog::Log(LOGDEBUG, "SECTION:LoadDLL(%s)\n", dllname.c_str());
+  unsigned int start = XbmcThreads::SystemClockMillis();
   LibraryLoader* pDll = DllLoaderContainer::LoadModule(dllname.c_str(), NULL, bLoadSymbols);
   if (!pDll)
     return NULL;
 
+  unsigned int loadTime = XbmcThreads::SystemClockMillis() - start;
+  stats.m_loads++;
+  stats.m_loadTime += loadTime;
+
+  // a dll that's loaded again soon after it was unloaded is in use, keep it loaded longer
+  if (stats.m_loads > 1 && start - stats.m_unloadTick < HOT_RELOAD_WINDOW)
+    stats.m_unloadDelay = std::min(stats.m_unloadDelay * 2, (unsigned int)MAX_UNLOAD_DELAY);
+  else
+    stats.m_unloadDelay = UNLOAD_DELAY;
+
+  CLog::Log(LOGDEBUG, "SECTION:LoadDLL(%s) took %u ms, loaded %u times in %u ms, unload delay %u s\n",
+            dllname.c_str(), loadTime, stats.m_loads, stats.m_loadTime, stats.m_unloadDelay / 1000);
+
   CDll newDLL;
   newDLL.m_strDllName = dllname;
   newDLL.m_lReferenceCount = 1;
   newDLL.m_bDelayUnload=bDelayUnload;
   newDLL.m_pDll=pDll;
+  newDLL.m_exports.reset(new CDllExportTable);
   g_sectionLoader.m_vecLoadedDLLs.push_back(newDLL);
 
+  if (exports)
+    *exports = newDLL.m_exports;
   return newDLL.m_pDll;
 }
 
@@ -98,6 +131,7 @@ void CSectionLoader::UnloadDLL(const CStdString &dllname)
           CLog::Log(LOGDEBUG,"SECTION:UnloadDll(%s)", dllname.c_str());
           if (dll.m_pDll)
             DllLoaderContainer::ReleaseModule(dll.m_pDll);
+          GetStatsLocked(dll.m_strDllName).m_unloadTick = XbmcThreads::SystemClockMillis();
           g_sectionLoader.m_vecLoadedDLLs.erase(g_sectionLoader.m_vecLoadedDLLs.begin() + i);
         }
 
@@ -112,15 +146,21 @@ void CSectionLoader::UnloadDelayed()
   CSingleLock lock(g_sectionLoader.m_critSection);
 
   // check if we can unload any unreferenced dlls
+  unsigned int now = XbmcThreads::SystemClockMillis();
   for (int i = 0; i < (int)g_sectionLoader.m_vecLoadedDLLs.size(); ++i)
   {
     CDll& dll = g_sectionLoader.m_vecLoadedDLLs[i];
-    if (dll.m_lReferenceCount == 0 && XbmcThreads::SystemClockMillis() - dll.m_unloadDelayStartTick > UNLOAD_DELAY)
+    if (dll.m_lReferenceCount != 0)
+      continue;
+
+    CDllStats &stats = GetStatsLocked(dll.m_strDllName);
+    if (now - dll.m_unloadDelayStartTick > stats.m_unloadDelay)
     {
       CLog::Log(LOGDEBUG,"SECTION:UnloadDelayed(DLL: %s)", dll.m_strDllName.c_str());
 
       if (dll.m_pDll)
         DllLoaderContainer::ReleaseModule(dll.m_pDll);
+      stats.m_unloadTick = now;
       g_sectionLoader.m_vecLoadedDLLs.erase(g_sectionLoader.m_vecLoadedDLLs.begin() + i);
       return;
     }
@@ -140,4 +180,20 @@ void CSectionLoader::UnloadAll()
       DllLoaderContainer::ReleaseModule(dll.m_pDll);
     it = g_sectionLoader.m_vecLoadedDLLs.erase(it);
   }
+
+  for (map<string, CDllStats>::const_iterator stats = g_sectionLoader.m_stats.begin(); stats != g_sectionLoader.m_stats.end(); ++stats)
+    CLog::Log(LOGDEBUG, "SECTION:UnloadAll(DLL: %s) loaded %u times in %u ms, referenced %u times",
+              stats->first.c_str(), stats->second.m_loads, stats->second.m_loadTime, stats->second.m_references);
+}
+
+bool CSectionLoader::GetStats(const CStdString &dllname, CDllStats &stats)
+{
+  CSingleLock lock(g_sectionLoader.m_critSection);
+  CStdString key(dllname);
+  key.ToLower();
+  map<string, CDllStats>::const_iterator it = g_sectionLoader.m_stats.find(key);
+  if (it == g_sectionLoader.m_stats.end())
+    return false;
+  stats = it->second;
+  return true;
 }
@@ -20,6 +20,11 @@
  *
  */
 
+#include <map>
+#include <string>
+#include <vector>
+#include <boost/shared_ptr.hpp>
+
 #include "utils/StdString.h"
 #include "threads/CriticalSection.h"
 #include "utils/GlobalsHandling.h"
@@ -27,6 +32,18 @@
 //  forward
 class LibraryLoader;
 
+/*! \brief Exports of a loaded dll resolved so far, shared by all DllDynamic wrappers of the dll
+ Lives as long as the dll stays loaded, so the exports are only looked up in the dll once per load.
+ */
+class CDllExportTable
+{
+public:
+  CCriticalSection m_critSection;
+  std::map<std::string, void*> m_exports;
+};
+
+typedef boost::shared_ptr<CDllExportTable> DllExportTablePtr;
+
 class CSectionLoader
 {
 public:
@@ -38,17 +55,49 @@ public:
     LibraryLoader *m_pDll;
     unsigned int m_unloadDelayStartTick;
     bool m_bDelayUnload;
+    DllExportTablePtr m_exports;
   };
+
+  /*! \brief Usage of a dll over the lifetime of the process */
+  class CDllStats
+  {
+  public:
+    CDllStats() : m_loads(0), m_references(0), m_loadTime(0), m_unloadTick(0), m_unloadDelay(0) {};
+
+    unsigned int m_loads;       ///< times the dll was loaded from disk
+    unsigned int m_references;  ///< times the dll was asked for, loaded or not
+    unsigned int m_loadTime;    ///< ms spent loading the dll
+    unsigned int m_unloadTick;  ///< when the dll was last unloaded
+    unsigned int m_unloadDelay; ///< ms an unreferenced dll is kept loaded, grows while the dll is reloaded soon after unloading
+  };
+
   CSectionLoader(void);
   virtual ~CSectionLoader(void);
 
-  static LibraryLoader* LoadDLL(const CStdString& strSection, bool bDelayUnload=true, bool bLoadSymbols=false);
+  /*! \brief Load a dll, or reference it if it's already loaded
+   \param strSection path of the dll
+   \param bDelayUnload keep the dll loaded for a while once it's no longer referenced
+   \param bLoadSymbols load debug symbols of the dll
+   \param exports [out] if not NULL, the export table shared by the users of the dll
+   \return the loaded dll, NULL on failure
+   */
+  static LibraryLoader* LoadDLL(const CStdString& strSection, bool bDelayUnload=true, bool bLoadSymbols=false, DllExportTablePtr *exports=NULL);
   static void UnloadDLL(const CStdString& strSection);
   static void UnloadDelayed();
   void UnloadAll();
 
+  /*! \brief Get the usage of a dll
+   \param strSection path of the dll
+   \param stats [out] usage of the dll
+   \return true if the dll was ever asked for, false otherwise
+   */
+  static bool GetStats(const CStdString& strSection, CDllStats &stats);
+
 protected:
+  static CDllStats &GetStatsLocked(const CStdString& strSection);
+
   std::vector<CDll> m_vecLoadedDLLs;
+  std::map<std::string, CDllStats> m_stats; ///< usage per dll, keyed by lowercased path
   CCriticalSection m_critSection;
 
 };
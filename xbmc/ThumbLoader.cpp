@@ -26,6 +26,7 @@
 #include "filesystem/File.h"
 #include "filesystem/DirectoryCache.h"
 #include "FileItem.h"
+#include "settings/AdvancedSettings.h"
 #include "settings/GUISettings.h"
 #include "GUIUserMessages.h"
 #include "guilib/GUIWindowManager.h"
@@ -142,7 +143,7 @@ bool CThumbExtractor::DoWork()
 }
 
 CVideoThumbLoader::CVideoThumbLoader() :
-  CThumbLoader(1), CJobQueue(true), m_pStreamDetailsObs(NULL)
+  CThumbLoader(1), CJobQueue(true, g_advancedSettings.m_videoExtractionJobs), m_pStreamDetailsObs(NULL)
 {
   m_database = new CVideoDatabase();
 }
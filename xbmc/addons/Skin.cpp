@@ -180,9 +180,9 @@ void CSkinInfo::LoadIncludes()
   m_includes.LoadIncludes(includesPath);
 }
 
-void CSkinInfo::ResolveIncludes(TiXmlElement *node)
+void CSkinInfo::ResolveIncludes(TiXmlElement *node, bool *conditional /* = NULL */)
 {
-  m_includes.ResolveIncludes(node);
+  m_includes.ResolveIncludes(node, conditional);
 }
 
 int CSkinInfo::GetStartWindow() const
@@ -92,7 +92,7 @@ public:
    */
   static bool TranslateResolution(const CStdString &name, RESOLUTION_INFO &res);
 
-  void ResolveIncludes(TiXmlElement *node);
+  void ResolveIncludes(TiXmlElement *node, bool *conditional = NULL);
 
   float GetEffectsSlowdown() const { return m_effectsSlowDown; };
 
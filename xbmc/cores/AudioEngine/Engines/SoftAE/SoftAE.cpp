@@ -58,7 +58,9 @@ CSoftAE::CSoftAE():
   m_convertedSize      (0           ),
   m_masterStream       (NULL        ),
   m_outputStageFn      (NULL        ),
-  m_streamStageFn      (NULL        )
+  m_streamStageFn      (NULL        ),
+  m_mixTime            (0           ),
+  m_mixFrames          (0           )
 {
   CAESinkFactory::EnumerateEx(m_sinkInfoList);
   for (AESinkInfoList::iterator itt = m_sinkInfoList.begin(); itt != m_sinkInfoList.end(); ++itt)
@@ -876,17 +878,31 @@ void CSoftAE::Run()
     if ((this->*m_outputStageFn)(hasAudio) > 0)
       hasAudio = false; /* taken some audio - reset our silence flag */
 
-    /* if we have enough room in the buffer */
-    if (m_buffer.Free() >= m_frameSize)
+    /* fill whatever room there is in the buffer, up to a whole sink period */
+    unsigned int frames = m_buffer.Free() / m_frameSize;
+    if (frames > 0)
     {
       /* take some data for our use from the buffer */
-      uint8_t *out = (uint8_t*)m_buffer.Take(m_frameSize);
-      memset(out, 0, m_frameSize);
+      uint8_t *out = (uint8_t*)m_buffer.Take(frames * m_frameSize);
+      memset(out, 0, frames * m_frameSize);
 
       /* run the stream stage */
       CSoftAEStream *oldMaster = m_masterStream;
-      if ((this->*m_streamStageFn)(m_chLayout.Count(), out, restart) > 0)
+      int64_t start = CurrentHostCounter();
+      if ((this->*m_streamStageFn)(m_chLayout.Count(), out, frames, restart) > 0)
         hasAudio = true; /* have some audio */
+      m_mixTime   += CurrentHostCounter() - start;
+      m_mixFrames += frames;
+
+      /* report the cost of mixing every minute of audio */
+      if (m_mixFrames >= m_sinkFormat.m_sampleRate * 60)
+      {
+        CLog::Log(LOGDEBUG, "CSoftAE::Run - stream stage used %.3f ms of CPU per second of audio (%u streams)",
+                  (double)m_mixTime * 1000.0 / (double)CurrentHostFrequency() * (double)m_sinkFormat.m_sampleRate / (double)m_mixFrames,
+                  (unsigned int)m_playingStreams.size());
+        m_mixTime   = 0;
+        m_mixFrames = 0;
+      }
 
       /* if in audiophile mode and the master stream has changed, flag for restart */
       if (m_audiophile && oldMaster != m_masterStream)
@@ -953,8 +969,9 @@ unsigned int CSoftAE::MixSounds(float *buffer, unsigned int samples)
       CAEUtil::SSEMulAddArray(buffer, ss->samples, volume, mixSamples);
     #else
       float *sample_buffer = ss->samples;
+      float *out_buffer    = buffer;
       for (unsigned int i = 0; i < mixSamples; ++i)
-        *buffer++ = *sample_buffer++ * volume;
+        *out_buffer++ += *sample_buffer++ * volume;
     #endif
 
     ss->sampleCount -= mixSamples;
@@ -1142,7 +1159,7 @@ int CSoftAE::RunTranscodeStage(bool hasAudio)
   return encodedFrames;
 }
 
-unsigned int CSoftAE::RunRawStreamStage(unsigned int channelCount, void *out, bool &restart)
+unsigned int CSoftAE::RunRawStreamStage(unsigned int channelCount, void *out, unsigned int frames, bool &restart)
 {
   StreamList resumeStreams;
   static StreamList::iterator itt;
@@ -1156,10 +1173,18 @@ unsigned int CSoftAE::RunRawStreamStage(unsigned int channelCount, void *out, bo
       continue;
 
     /* consume data from streams even though we cant use it */
-    uint8_t *frame = sitt->GetFrame();
+    unsigned int consumed = 0;
+    while (consumed < frames)
+    {
+      unsigned int count = frames - consumed;
+      float volStart, volEnd;
+      if (!sitt->GetFrames(count, volStart, volEnd) || !count)
+        break;
+      consumed += count;
+    }
 
     /* flag the stream's slave to be resumed if it has drained */
-    if (!frame && sitt->IsDrained() && sitt->m_slave && sitt->m_slave->IsPaused())
+    if (consumed < frames && sitt->IsDrained() && sitt->m_slave && sitt->m_slave->IsPaused())
       resumeStreams.push_back(sitt);
   }
 
@@ -1167,33 +1192,35 @@ unsigned int CSoftAE::RunRawStreamStage(unsigned int channelCount, void *out, bo
   if (!m_masterStream)
     return 0;
 
-  /* get the frame and append it to the output */
-  uint8_t *frame = m_masterStream->GetFrame();
-  unsigned int mixed;
-  if (frame)
-  {
-    mixed = 1;
-    memcpy(out, frame, m_sinkFormat.m_frameSize);
-  }
-  else
+  /* get the frames and append them to the output */
+  uint8_t *dst = (uint8_t*)out;
+  unsigned int copied = 0;
+  while (copied < frames)
   {
-    mixed = 0;
-    if (m_masterStream->IsDrained() && m_masterStream->m_slave && m_masterStream->m_slave->IsPaused())
-      resumeStreams.push_back(m_masterStream);
+    unsigned int count = frames - copied;
+    float volStart, volEnd;
+    uint8_t *frame = m_masterStream->GetFrames(count, volStart, volEnd);
+    if (!frame || !count)
+      break;
+    memcpy(dst, frame, count * m_sinkFormat.m_frameSize);
+    dst    += count * m_sinkFormat.m_frameSize;
+    copied += count;
   }
 
+  if (copied < frames && m_masterStream->IsDrained() && m_masterStream->m_slave && m_masterStream->m_slave->IsPaused())
+    resumeStreams.push_back(m_masterStream);
+
   ResumeSlaveStreams(resumeStreams);
-  return mixed;
+  return copied > 0 ? 1 : 0;
 }
 
-unsigned int CSoftAE::RunStreamStage(unsigned int channelCount, void *out, bool &restart)
+unsigned int CSoftAE::RunStreamStage(unsigned int channelCount, void *out, unsigned int frames, bool &restart)
 {
   // no point doing anything if we have no streams,
   // we do not have to take a lock just to check empty
   if (m_playingStreams.empty())
     return 0;
 
-  float *dst = (float*)out;
   unsigned int mixed = 0;
 
   /* identify the master stream */
@@ -1204,26 +1231,56 @@ unsigned int CSoftAE::RunStreamStage(unsigned int channelCount, void *out, bool
   for (StreamList::iterator itt = m_playingStreams.begin(); itt != m_playingStreams.end(); ++itt)
   {
     CSoftAEStream *stream = *itt;
+    float *dst = (float*)out;
+    float gain = stream->GetReplayGain();
 
-    float *frame = (float*)stream->GetFrame();
-    if (!frame && stream->IsDrained() && stream->m_slave && stream->m_slave->IsPaused())
-      resumeStreams.push_back(stream);
+    /* a stream hands back contiguous runs of frames, one per packet, so keep
+     * pulling until the block is full or the stream runs dry */
+    unsigned int done = 0;
+    while (done < frames)
+    {
+      unsigned int count = frames - done;
+      float volStart, volEnd;
+      float *frame = (float*)stream->GetFrames(count, volStart, volEnd);
+      if (!frame || !count)
+        break;
 
-    if (!frame)
-      continue;
+      const unsigned int samples = count * channelCount;
+      if (volStart == volEnd)
+      {
+        float volume = volStart * gain;
+        #ifdef __SSE__
+        if (samples > 1)
+          CAEUtil::SSEMulAddArray(dst, frame, volume, samples);
+        else
+        #endif
+        {
+          for (unsigned int i = 0; i < samples; ++i)
+            dst[i] += frame[i] * volume;
+        }
+      }
+      else
+      {
+        /* fading, ramp the volume across the run */
+        float volume = volStart * gain;
+        const float step = (volEnd - volStart) * gain / count;
+        for (unsigned int f = 0; f < count; ++f)
+        {
+          volume += step;
+          for (unsigned int i = 0; i < channelCount; ++i)
+            dst[f * channelCount + i] += frame[f * channelCount + i] * volume;
+        }
+      }
 
-    float volume = stream->GetVolume() * stream->GetReplayGain();
-    #ifdef __SSE__
-    if (channelCount > 1)
-      CAEUtil::SSEMulAddArray(dst, frame, volume, channelCount);
-    else
-    #endif
-    {
-      for (unsigned int i = 0; i < channelCount; ++i)
-        *dst++ += *frame++ * volume;
+      dst  += samples;
+      done += count;
     }
 
-    ++mixed;
+    if (done < frames && stream->IsDrained() && stream->m_slave && stream->m_slave->IsPaused())
+      resumeStreams.push_back(stream);
+
+    if (done > 0)
+      ++mixed;
   }
 
   ResumeSlaveStreams(resumeStreams);
@@ -221,13 +221,26 @@ private:
   int          RunRawOutputStage(bool hasAudio);
   int          RunTranscodeStage(bool hasAudio);
 
-  unsigned int (CSoftAE::*m_streamStageFn)(unsigned int channelCount, void *out, bool &restart);
-  unsigned int RunRawStreamStage (unsigned int channelCount, void *out, bool &restart);
-  unsigned int RunStreamStage    (unsigned int channelCount, void *out, bool &restart);
+  /*! \brief Run the stream stage on the audio.
+   Pulls a block of frames from every playing stream and mixes them into out,
+   taking the stream lock once for the whole block.
+   \param channelCount the number of channels in the output.
+   \param out the (zeroed) output block.
+   \param frames the number of frames in the output block.
+   \param restart set to true if the sink needs to be restarted.
+   \return the number of streams that contributed audio.
+   */
+  unsigned int (CSoftAE::*m_streamStageFn)(unsigned int channelCount, void *out, unsigned int frames, bool &restart);
+  unsigned int RunRawStreamStage (unsigned int channelCount, void *out, unsigned int frames, bool &restart);
+  unsigned int RunStreamStage    (unsigned int channelCount, void *out, unsigned int frames, bool &restart);
 
   void         ResumeSlaveStreams(const StreamList &streams);
   void         RunNormalizeStage (unsigned int channelCount, void *out, unsigned int mixed);
 
   void         RemoveStream(StreamList &streams, CSoftAEStream *stream);
+
+  /* stream stage cost, logged periodically */
+  int64_t        m_mixTime;
+  unsigned int   m_mixFrames;
 };
 
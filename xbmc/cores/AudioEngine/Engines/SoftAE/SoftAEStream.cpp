@@ -402,33 +402,50 @@ unsigned int CSoftAEStream::ProcessFrameBuffer()
   return consumed;
 }
 
-uint8_t* CSoftAEStream::GetFrame()
+void CSoftAEStream::AdvanceFade(unsigned int frames)
 {
-  CExclusiveLock lock(m_lock);
+  if (!m_fadeRunning)
+    return;
 
-  /* if we are fading, this runs even if we have underrun as it is time based */
-  if (m_fadeRunning)
+  m_volume += m_fadeStep * frames;
+  m_volume = std::min(1.0f, std::max(0.0f, m_volume));
+  if (m_fadeDirUp)
   {
-    m_volume += m_fadeStep;
-    m_volume = std::min(1.0f, std::max(0.0f, m_volume));
-    if (m_fadeDirUp)
+    if (m_volume >= m_fadeTarget)
     {
-      if (m_volume >= m_fadeTarget)
-        m_fadeRunning = false;
+      m_volume = m_fadeTarget;
+      m_fadeRunning = false;
     }
-    else
+  }
+  else
+  {
+    if (m_volume <= m_fadeTarget)
     {
-      if (m_volume <= m_fadeTarget)
-        m_fadeRunning = false;
+      m_volume = m_fadeTarget;
+      m_fadeRunning = false;
     }
   }
+}
+
+uint8_t* CSoftAEStream::GetFrames(unsigned int &frames, float &volStart, float &volEnd)
+{
+  CExclusiveLock lock(m_lock);
+
+  const unsigned int wanted = frames;
+  frames   = 0;
+  volStart = m_volume;
 
   /* if we have been deleted or are refilling but not draining */
   if (!m_valid || m_delete || (m_refillBuffer && !m_draining))
+  {
+    /* if we are fading, this runs even if we have underrun as it is time based */
+    AdvanceFade(wanted);
+    volEnd = m_volume;
     return NULL;
+  }
 
-  /* if the packet is empty, advance to the next one */
-  if (!m_packet || m_packet->data.CursorEnd())
+  /* if the packet is empty or only holds a partial frame, advance to the next one */
+  if (!m_packet || m_packet->data.CursorRemaining() < m_aeBytesPerFrame)
   {
     delete m_packet;
     m_packet = NULL;
@@ -436,16 +453,17 @@ uint8_t* CSoftAEStream::GetFrame()
     /* no more packets, return null */
     if (m_outBuffer.empty())
     {
-      if (m_draining)
-        return NULL;
-      else
+      AdvanceFade(wanted);
+      volEnd = m_volume;
+
+      if (!m_draining)
       {
         /* underrun, we need to refill our buffers */
-        CLog::Log(LOGDEBUG, "CSoftAEStream::GetFrame - Underrun");
+        CLog::Log(LOGDEBUG, "CSoftAEStream::GetFrames - Underrun");
         ASSERT(m_waterLevel > m_framesBuffered);
         m_refillBuffer = m_waterLevel - m_framesBuffered;
-        return NULL;
       }
+      return NULL;
     }
 
     /* get the next packet */
@@ -453,23 +471,33 @@ uint8_t* CSoftAEStream::GetFrame()
     m_outBuffer.pop_front();
   }
 
-  /* fetch one frame of data */
-  uint8_t *ret = (uint8_t*)m_packet->data.CursorRead(m_aeBytesPerFrame);
+  /* fetch as many frames as the current packet holds, up to what was asked for */
+  frames = std::min(wanted, (unsigned int)(m_packet->data.CursorRemaining() / m_aeBytesPerFrame));
+  uint8_t *ret = (uint8_t*)m_packet->data.CursorRead(frames * m_aeBytesPerFrame);
 
-  /* we have a frame, if we have a viz we need to hand the data to it */
-  if (m_audioCallback && !m_packet->vizData.CursorEnd())
+  /* we have frames, if we have a viz we need to hand the data to it */
+  if (m_audioCallback)
   {
-    float *vizData = (float*)m_packet->vizData.CursorRead(2 * sizeof(float));
-    memcpy(m_vizBuffer + m_vizBufferSamples, vizData, 2 * sizeof(float));
-    m_vizBufferSamples += 2;
-    if (m_vizBufferSamples == 512)
+    unsigned int vizSamples = std::min(frames * 2, (unsigned int)(m_packet->vizData.CursorRemaining() / sizeof(float)));
+    while (vizSamples > 0)
     {
-      m_audioCallback->OnAudioData(m_vizBuffer, 512);
-      m_vizBufferSamples = 0;
+      unsigned int copy = std::min(vizSamples, 512 - m_vizBufferSamples);
+      float *vizData = (float*)m_packet->vizData.CursorRead(copy * sizeof(float));
+      memcpy(m_vizBuffer + m_vizBufferSamples, vizData, copy * sizeof(float));
+      m_vizBufferSamples += copy;
+      vizSamples         -= copy;
+      if (m_vizBufferSamples == 512)
+      {
+        m_audioCallback->OnAudioData(m_vizBuffer, 512);
+        m_vizBufferSamples = 0;
+      }
     }
   }
 
-  --m_framesBuffered;
+  AdvanceFade(frames);
+  volEnd = m_volume;
+
+  m_framesBuffered -= frames;
   return ret;
 }
 
@@ -42,7 +42,13 @@ protected:
   void Initialize();
   void InitializeRemap();
   void Destroy();
-  uint8_t* GetFrame();
+  /*! \brief Fetch a run of contiguous frames from the stream
+   \param frames in: the most frames wanted, out: the number of frames returned
+   \param volStart the stream volume at the start of the run
+   \param volEnd the stream volume at the end of the run, differs from volStart while fading
+   \return a pointer to the frames, or NULL if there is no data available
+   */
+  uint8_t* GetFrames(unsigned int &frames, float &volStart, float &volEnd);
 
   bool IsPaused   () { return m_paused; }
   bool IsDestroyed() { return m_delete; }
@@ -85,6 +91,7 @@ public:
   virtual void              RegisterSlave(IAEStream *stream);
 private:
   void InternalFlush();
+  void AdvanceFade(unsigned int frames);
   void CheckResampleBuffers();
 
   CSharedSection    m_lock;
@@ -155,6 +155,11 @@ public:
     return m_cursorPos == m_bufferPos;
   }
 
+  inline size_t CursorRemaining()
+  {
+    return m_bufferPos - m_cursorPos;
+  }
+
   inline void CursorSeek (const size_t pos )
   {
   #ifdef _DEBUG
@@ -0,0 +1,180 @@
+/*
+ *      Copyright (C) 2005-2008 Team XBMC
+ *      http://www.xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, write to
+ *  the Free Software Foundation, 675 Mass Ave, Cambridge, MA 02139, USA.
+ *  http://www.gnu.org/copyleft/gpl.html
+ *
+ */
+
+#include <algorithm>
+#include "SliceScaler.h"
+#include "DllSwScale.h"
+
+// slices start on a multiple of this many rows, which keeps subsampled chroma rows aligned
+#define SLICE_ALIGN 16
+
+CSliceScaler::CWorker::CWorker(CSliceScaler *scaler)
+ : CThread("CSliceScaler")
+ , m_scaler(scaler)
+ , m_slice(NULL)
+{
+}
+
+void CSliceScaler::CWorker::Start(CSlice *slice)
+{
+  m_slice = slice;
+  m_start.Set();
+}
+
+void CSliceScaler::CWorker::WaitDone()
+{
+  m_done.Wait();
+}
+
+void CSliceScaler::CWorker::Process()
+{
+  while (!m_bStop)
+  {
+    if (AbortableWait(m_start) != WAIT_SIGNALED)
+      break;
+
+    m_scaler->ConvertSlice(*m_slice);
+    m_done.Set();
+  }
+}
+
+CSliceScaler::CSliceScaler(DllSwScaleInterface *dll)
+{
+  m_dll     = dll;
+  m_threads = 1;
+}
+
+CSliceScaler::~CSliceScaler()
+{
+  Free();
+}
+
+void CSliceScaler::SetThreads(unsigned int threads)
+{
+  if (threads < 1)
+    threads = 1;
+
+  if (threads != m_threads)
+  {
+    Free();
+    m_threads = threads;
+  }
+}
+
+void CSliceScaler::Free()
+{
+  StopWorkers();
+
+  for (unsigned int i = 0; i < m_slices.size(); i++)
+  {
+    if (m_slices[i].context)
+      m_dll->sws_freeContext(m_slices[i].context);
+  }
+  m_slices.clear();
+}
+
+void CSliceScaler::StopWorkers()
+{
+  for (unsigned int i = 0; i < m_workers.size(); i++)
+  {
+    m_workers[i]->StopThread();
+    delete m_workers[i];
+  }
+  m_workers.clear();
+}
+
+int CSliceScaler::ChromaShift(int format)
+{
+  switch (format)
+  {
+    case PIX_FMT_YUV420P:
+    case PIX_FMT_YUVJ420P:
+    case PIX_FMT_NV12:
+    case PIX_FMT_NV21:
+      return 1;
+    default:
+      return 0;
+  }
+}
+
+void CSliceScaler::ConvertSlice(CSlice &slice)
+{
+  slice.context = m_dll->sws_getCachedContext(slice.context,
+                                              slice.width, slice.height, slice.srcFormat,
+                                              slice.width, slice.height, slice.dstFormat,
+                                              slice.flags, NULL, NULL, NULL);
+  if (slice.context)
+    m_dll->sws_scale(slice.context, slice.src, slice.srcStride, 0, slice.height, slice.dst, slice.dstStride);
+}
+
+void CSliceScaler::Convert(uint8_t* src[], int srcStride[], int srcFormat, int width, int height,
+                           uint8_t* dst, int dstStride, int dstFormat, int flags)
+{
+  // split into equal slices, aligned so that chroma rows aren't shared between slices
+  unsigned int sliceHeight = (height + m_threads - 1) / m_threads;
+  sliceHeight = (sliceHeight + SLICE_ALIGN - 1) & ~(SLICE_ALIGN - 1);
+  unsigned int slices = (height + sliceHeight - 1) / sliceHeight;
+
+  if (m_slices.size() != slices)
+  {
+    Free();
+    m_slices.resize(slices);
+  }
+
+  int shift = ChromaShift(srcFormat);
+  for (unsigned int i = 0; i < slices; i++)
+  {
+    CSlice &slice = m_slices[i];
+    int y = i * sliceHeight;
+
+    for (int p = 0; p < 4; p++)
+    {
+      int planeY = p ? y >> shift : y;
+      slice.src[p]       = src[p] ? src[p] + planeY * srcStride[p] : NULL;
+      slice.srcStride[p] = srcStride[p];
+      slice.dst[p]       = NULL;
+      slice.dstStride[p] = 0;
+    }
+    slice.dst[0]       = dst + y * dstStride;
+    slice.dstStride[0] = dstStride;
+    slice.srcFormat    = srcFormat;
+    slice.dstFormat    = dstFormat;
+    slice.width        = width;
+    slice.height       = std::min((int)sliceHeight, height - y);
+    slice.flags        = flags;
+  }
+
+  // start our workers on all but the first slice
+  while (m_workers.size() < slices - 1)
+  {
+    CWorker *worker = new CWorker(this);
+    worker->Create();
+    m_workers.push_back(worker);
+  }
+
+  for (unsigned int i = 1; i < slices; i++)
+    m_workers[i - 1]->Start(&m_slices[i]);
+
+  ConvertSlice(m_slices[0]);
+
+  for (unsigned int i = 1; i < slices; i++)
+    m_workers[i - 1]->WaitDone();
+}
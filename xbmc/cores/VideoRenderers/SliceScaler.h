@@ -0,0 +1,117 @@
+#pragma once
+
+/*
+ *      Copyright (C) 2005-2008 Team XBMC
+ *      http://www.xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, write to
+ *  the Free Software Foundation, 675 Mass Ave, Cambridge, MA 02139, USA.
+ *  http://www.gnu.org/copyleft/gpl.html
+ *
+ */
+
+#include <vector>
+#include <stdint.h>
+#include "threads/Thread.h"
+#include "threads/Event.h"
+
+// upper limit on the number of threads a renderer should use for conversion
+#define MAX_SLICE_THREADS 8
+
+class DllSwScaleInterface;
+struct SwsContext;
+
+/*!
+ \brief Converts frames between pixel formats by splitting them into horizontal slices
+ that are converted in parallel.
+
+ Each slice is converted as an independent image with its own SwsContext, so the source
+ and destination must be the same size.  Slices after the first are handed to a pool of
+ persistent worker threads, while the calling thread converts the first slice itself.
+ The destination must be a single packed plane (eg. BGRA), and is written to directly.
+ */
+class CSliceScaler
+{
+public:
+  CSliceScaler(DllSwScaleInterface *dll);
+  ~CSliceScaler();
+
+  /*!
+   \brief Set the number of threads used for conversion, including the calling thread.
+   \param threads number of threads, 1 converts on the calling thread only.
+   */
+  void SetThreads(unsigned int threads);
+
+  /*!
+   \brief Convert an image, returning once all slices have been converted.
+   \param src source planes.
+   \param srcStride source plane strides.
+   \param srcFormat source pixel format (PIX_FMT_*).
+   \param width width of the image.
+   \param height height of the image.
+   \param dst destination plane.
+   \param dstStride destination stride.
+   \param dstFormat destination pixel format (PIX_FMT_*).
+   \param flags SWS_* flags.
+   */
+  void Convert(uint8_t* src[], int srcStride[], int srcFormat, int width, int height,
+               uint8_t* dst, int dstStride, int dstFormat, int flags);
+
+  /*!
+   \brief Stop the worker threads and free all conversion contexts.
+   */
+  void Free();
+
+private:
+  class CSlice
+  {
+  public:
+    CSlice() : context(NULL), srcFormat(-1), dstFormat(-1), width(0), height(0), flags(0) {};
+
+    struct SwsContext *context;
+    uint8_t* src[4];
+    int      srcStride[4];
+    uint8_t* dst[4];
+    int      dstStride[4];
+    int      srcFormat;
+    int      dstFormat;
+    int      width;
+    int      height;
+    int      flags;
+  };
+
+  class CWorker : public CThread
+  {
+  public:
+    CWorker(CSliceScaler *scaler);
+    void Start(CSlice *slice);
+    void WaitDone();
+  protected:
+    virtual void Process();
+  private:
+    CSliceScaler *m_scaler;
+    CSlice       *m_slice;
+    CEvent        m_start;
+    CEvent        m_done;
+  };
+
+  void ConvertSlice(CSlice &slice);
+  void StopWorkers();
+  static int ChromaShift(int format);
+
+  DllSwScaleInterface   *m_dll;
+  unsigned int           m_threads;
+  std::vector<CSlice>    m_slices;
+  std::vector<CWorker*>  m_workers;
+};
@@ -0,0 +1,126 @@
+/*
+ *      Copyright (C) 2005-2011 Team XBMC
+ *      http://www.xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, write to
+ *  the Free Software Foundation, 675 Mass Ave, Cambridge, MA 02139, USA.
+ *  http://www.gnu.org/copyleft/gpl.html
+ *
+ */
+
+/*
+ * Measures the throughput of software YUV420P->BGRA conversion as done by the
+ * GL/GLES renderers in RENDER_SW mode, with a single thread and with slices
+ * spread over all available cores.
+ *
+ * usage: benchSliceScaler [threads]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "../SliceScaler.h"
+#include "DllSwScale.h"
+#include "threads/Thread.h"
+#include "threads/SystemClock.h"
+#include "commons/ilog.h"
+
+class NullLogger : public XbmcCommons::ILogger
+{
+public:
+  void log(int loglevel, const char* message) {}
+};
+
+// calls straight into libswscale rather than going through DllSwScale
+class CSwScaleDirect : public DllSwScaleInterface
+{
+public:
+  virtual struct SwsContext *sws_getCachedContext(struct SwsContext *context,
+                                                  int srcW, int srcH, int srcFormat, int dstW, int dstH, int dstFormat, int flags,
+                                                  SwsFilter *srcFilter, SwsFilter *dstFilter, double *param)
+    { return ::sws_getCachedContext(context, srcW, srcH, (enum PixelFormat)srcFormat, dstW, dstH, (enum PixelFormat)dstFormat, flags, srcFilter, dstFilter, param); }
+  virtual struct SwsContext *sws_getContext(int srcW, int srcH, int srcFormat, int dstW, int dstH, int dstFormat, int flags,
+                                            SwsFilter *srcFilter, SwsFilter *dstFilter, double *param)
+    { return ::sws_getContext(srcW, srcH, (enum PixelFormat)srcFormat, dstW, dstH, (enum PixelFormat)dstFormat, flags, srcFilter, dstFilter, param); }
+  virtual int sws_scale(struct SwsContext *context, uint8_t* src[], int srcStride[], int srcSliceY,
+                        int srcSliceH, uint8_t* dst[], int dstStride[])
+    { return ::sws_scale(context, src, srcStride, srcSliceY, srcSliceH, dst, dstStride); }
+  virtual void sws_freeContext(struct SwsContext *context) { ::sws_freeContext(context); }
+};
+
+static double RunBenchmark(DllSwScaleInterface *dll, unsigned int threads, int width, int height)
+{
+  int      stride[4] = { width, width / 2, width / 2, 0 };
+  uint8_t *planes[4] = { new uint8_t[width * height], new uint8_t[width * height / 4], new uint8_t[width * height / 4], NULL };
+  uint8_t *rgb       = new uint8_t[width * height * 4];
+
+  for (int i = 0; i < width * height; i++)
+    planes[0][i] = i & 0xff;
+  memset(planes[1], 0x40, width * height / 4);
+  memset(planes[2], 0xc0, width * height / 4);
+
+  CSliceScaler scaler(dll);
+  scaler.SetThreads(threads);
+
+  // warm up (creates contexts and worker threads)
+  scaler.Convert(planes, stride, PIX_FMT_YUV420P, width, height, rgb, width * 4, PIX_FMT_BGRA, SWS_FAST_BILINEAR);
+
+  unsigned int frames = 0;
+  unsigned int start  = XbmcThreads::SystemClockMillis();
+  unsigned int elapsed;
+  do
+  {
+    scaler.Convert(planes, stride, PIX_FMT_YUV420P, width, height, rgb, width * 4, PIX_FMT_BGRA, SWS_FAST_BILINEAR);
+    frames++;
+    elapsed = XbmcThreads::SystemClockMillis() - start;
+  } while (elapsed < 2000);
+
+  scaler.Free();
+  for (int i = 0; i < 3; i++)
+    delete[] planes[i];
+  delete[] rgb;
+
+  return frames * 1000.0 / elapsed;
+}
+
+int main(int argc, char *argv[])
+{
+  NullLogger nullLogger;
+  CThread::SetLogger(&nullLogger);
+
+  unsigned int threads = argc > 1 ? atoi(argv[1]) : sysconf(_SC_NPROCESSORS_ONLN);
+  if (threads > MAX_SLICE_THREADS)
+    threads = MAX_SLICE_THREADS;
+
+  static const struct { const char *name; int width; int height; } sizes[] =
+  {
+    { "720p",  1280,  720 },
+    { "1080p", 1920, 1080 },
+    { "2160p", 3840, 2160 },
+  };
+
+  CSwScaleDirect dll;
+  printf("%-8s %12s %12s\n", "size", "1 thread", "threads");
+  for (unsigned int i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++)
+  {
+    double single = RunBenchmark(&dll, 1, sizes[i].width, sizes[i].height);
+    double sliced = RunBenchmark(&dll, threads, sizes[i].width, sizes[i].height);
+    printf("%-8s %8.1f fps %8.1f fps (%u threads)\n", sizes[i].name, single, sliced, threads);
+  }
+
+  CThread::SetLogger(NULL);
+  return 0;
+}
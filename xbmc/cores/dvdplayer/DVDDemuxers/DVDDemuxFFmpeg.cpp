@@ -250,6 +250,9 @@ bool CDVDDemuxFFmpeg::Open(CDVDInputStream* pInput)
   strFile = m_pInput->GetFileName();
 
   bool streaminfo = true; /* set to true if we want to look for streams before playback*/
+  bool useProbeCache = false;
+  CDVDDemuxProbeCache::CProbeInfo probeInfo;
+  unsigned int openStart = XbmcThreads::SystemClockMillis();
 
   if( m_pInput->GetContent().length() > 0 )
   {
@@ -304,6 +307,19 @@ bool CDVDDemuxFFmpeg::Open(CDVDInputStream* pInput)
     if(m_pInput->Seek(0, SEEK_POSSIBLE) == 0)
       m_ioContext->seekable = 0;
 
+    /* plain files that we've seen before don't need probing again */
+    if (iformat == NULL && g_advancedSettings.m_videoProbeCache && m_ioContext->seekable
+    &&  m_pInput->IsStreamType(DVDSTREAM_TYPE_FILE) && m_pInput->GetContent() != "audio/x-spdif-compressed")
+    {
+      useProbeCache = true;
+      if (CDVDDemuxProbeCache::Get().Lookup(strFile, probeInfo))
+      {
+        iformat = m_dllAvFormat.av_find_input_format(probeInfo.format.c_str());
+        if (iformat)
+          CLog::Log(LOGDEBUG, "%s - using cached format [%s]", __FUNCTION__, iformat->name);
+      }
+    }
+
     if( iformat == NULL )
     {
       // let ffmpeg decide which demuxer we have to open
@@ -430,6 +446,18 @@ bool CDVDDemuxFFmpeg::Open(CDVDInputStream* pInput)
   m_bMatroska = strncmp(m_pFormatContext->iformat->name, "matroska", 8) == 0;	// for "matroska.webm"
   m_bAVI = strcmp(m_pFormatContext->iformat->name, "avi") == 0;
 
+  if (streaminfo && useProbeCache && !probeInfo.format.empty())
+  {
+    if (ApplyProbeInfo(probeInfo))
+    {
+      CLog::Log(LOGDEBUG, "%s - using cached stream info", __FUNCTION__);
+      streaminfo = false;
+      useProbeCache = false;
+    }
+    else
+      CLog::Log(LOGDEBUG, "%s - cached stream info doesn't match, probing", __FUNCTION__);
+  }
+
   if (streaminfo)
   {
     /* too speed up dvd switches, only analyse very short */
@@ -453,6 +481,12 @@ bool CDVDDemuxFFmpeg::Open(CDVDInputStream* pInput)
       }
     }
     CLog::Log(LOGDEBUG, "%s - av_find_stream_info finished", __FUNCTION__);
+
+    if (iErr >= 0 && useProbeCache)
+    {
+      GetProbeInfo(probeInfo);
+      CDVDDemuxProbeCache::Get().Store(strFile, probeInfo);
+    }
   }
   // reset any timeout
   m_timeout.SetInfinite();
@@ -491,9 +525,140 @@ bool CDVDDemuxFFmpeg::Open(CDVDInputStream* pInput)
       AddStream(i);
   }
 
+  CLog::Log(LOGDEBUG, "%s - opened %s in %u ms", __FUNCTION__, strFile.c_str(), XbmcThreads::SystemClockMillis() - openStart);
   return true;
 }
 
+bool CDVDDemuxFFmpeg::ApplyProbeInfo(const CDVDDemuxProbeCache::CProbeInfo &info)
+{
+  if (info.streams.size() != m_pFormatContext->nb_streams)
+    return false;
+
+  // only fill in the gaps if the container reports the same streams as last time
+  for (unsigned int i = 0; i < m_pFormatContext->nb_streams; i++)
+  {
+    const AVCodecContext *codec = m_pFormatContext->streams[i]->codec;
+    const CDVDDemuxProbeCache::CStreamInfo &s = info.streams[i];
+    if (codec->codec_type != s.type)
+      return false;
+    if (codec->codec_id != CODEC_ID_NONE && codec->codec_id != s.codecId)
+      return false;
+  }
+
+  for (unsigned int i = 0; i < m_pFormatContext->nb_streams; i++)
+  {
+    AVStream *st = m_pFormatContext->streams[i];
+    AVCodecContext *codec = st->codec;
+    const CDVDDemuxProbeCache::CStreamInfo &s = info.streams[i];
+
+    codec->codec_id = (CodecID)s.codecId;
+    if (!codec->codec_tag)             codec->codec_tag = s.codecTag;
+    if (codec->profile == FF_PROFILE_UNKNOWN) codec->profile = s.profile;
+    if (codec->level == FF_LEVEL_UNKNOWN)     codec->level = s.level;
+    if (!codec->bit_rate)              codec->bit_rate = s.bitRate;
+    if (!codec->width)                 codec->width = s.width;
+    if (!codec->height)                codec->height = s.height;
+    if (!codec->sample_aspect_ratio.num)
+    {
+      codec->sample_aspect_ratio.num = s.aspectNum;
+      codec->sample_aspect_ratio.den = s.aspectDen;
+    }
+    if (codec->pix_fmt == PIX_FMT_NONE) codec->pix_fmt = (PixelFormat)s.pixFmt;
+    if (!st->r_frame_rate.num)
+    {
+      st->r_frame_rate.num = s.frameRateNum;
+      st->r_frame_rate.den = s.frameRateDen;
+    }
+    if (!st->avg_frame_rate.num)
+    {
+      st->avg_frame_rate.num = s.avgFrameRateNum;
+      st->avg_frame_rate.den = s.avgFrameRateDen;
+    }
+    if (!codec->sample_rate)           codec->sample_rate = s.sampleRate;
+    if (!codec->channels)              codec->channels = s.channels;
+    if (!codec->channel_layout)        codec->channel_layout = s.channelLayout;
+    if (codec->sample_fmt == AV_SAMPLE_FMT_NONE) codec->sample_fmt = (AVSampleFormat)s.sampleFmt;
+    if (!codec->bits_per_coded_sample) codec->bits_per_coded_sample = s.bitsPerCodedSample;
+    if (!codec->block_align)           codec->block_align = s.blockAlign;
+    if (!codec->has_b_frames)          codec->has_b_frames = s.hasBFrames;
+    if (!codec->time_base.num)
+    {
+      codec->time_base.num = s.timeBaseNum;
+      codec->time_base.den = s.timeBaseDen;
+    }
+    if (st->duration == (int64_t)AV_NOPTS_VALUE)
+      st->duration = s.duration;
+    if (st->start_time == (int64_t)AV_NOPTS_VALUE)
+      st->start_time = s.startTime;
+
+    if (!codec->extradata && !s.extraData.empty())
+    {
+      codec->extradata = (uint8_t*)m_dllAvUtil.av_mallocz(s.extraData.size() + FF_INPUT_BUFFER_PADDING_SIZE);
+      if (codec->extradata)
+      {
+        memcpy(codec->extradata, s.extraData.data(), s.extraData.size());
+        codec->extradata_size = s.extraData.size();
+      }
+    }
+  }
+
+  if (m_pFormatContext->duration == (int64_t)AV_NOPTS_VALUE)
+    m_pFormatContext->duration = info.duration;
+  if (m_pFormatContext->start_time == (int64_t)AV_NOPTS_VALUE)
+    m_pFormatContext->start_time = info.startTime;
+  if (!m_pFormatContext->bit_rate)
+    m_pFormatContext->bit_rate = info.bitRate;
+
+  return true;
+}
+
+void CDVDDemuxFFmpeg::GetProbeInfo(CDVDDemuxProbeCache::CProbeInfo &info)
+{
+  info.format    = m_pFormatContext->iformat->name;
+  info.duration  = m_pFormatContext->duration;
+  info.startTime = m_pFormatContext->start_time;
+  info.bitRate   = m_pFormatContext->bit_rate;
+  info.streams.resize(m_pFormatContext->nb_streams);
+
+  for (unsigned int i = 0; i < m_pFormatContext->nb_streams; i++)
+  {
+    const AVStream *st = m_pFormatContext->streams[i];
+    const AVCodecContext *codec = st->codec;
+    CDVDDemuxProbeCache::CStreamInfo &s = info.streams[i];
+
+    s.type               = codec->codec_type;
+    s.codecId            = codec->codec_id;
+    s.codecTag           = codec->codec_tag;
+    s.profile            = codec->profile;
+    s.level              = codec->level;
+    s.bitRate            = codec->bit_rate;
+    s.width              = codec->width;
+    s.height             = codec->height;
+    s.aspectNum          = codec->sample_aspect_ratio.num;
+    s.aspectDen          = codec->sample_aspect_ratio.den;
+    s.pixFmt             = codec->pix_fmt;
+    s.frameRateNum       = st->r_frame_rate.num;
+    s.frameRateDen       = st->r_frame_rate.den;
+    s.avgFrameRateNum    = st->avg_frame_rate.num;
+    s.avgFrameRateDen    = st->avg_frame_rate.den;
+    s.sampleRate         = codec->sample_rate;
+    s.channels           = codec->channels;
+    s.channelLayout      = codec->channel_layout;
+    s.sampleFmt          = codec->sample_fmt;
+    s.bitsPerCodedSample = codec->bits_per_coded_sample;
+    s.blockAlign         = codec->block_align;
+    s.duration           = st->duration;
+    s.startTime          = st->start_time;
+    s.timeBaseNum        = codec->time_base.num;
+    s.timeBaseDen        = codec->time_base.den;
+    s.hasBFrames         = codec->has_b_frames;
+    if (codec->extradata && codec->extradata_size > 0)
+      s.extraData.assign((const char*)codec->extradata, codec->extradata_size);
+    else
+      s.extraData.clear();
+  }
+}
+
 void CDVDDemuxFFmpeg::Dispose()
 {
   g_demuxer.set(this);
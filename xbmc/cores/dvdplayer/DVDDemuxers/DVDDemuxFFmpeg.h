@@ -25,6 +25,7 @@
 #include "DllAvFormat.h"
 #include "DllAvCodec.h"
 #include "DllAvUtil.h"
+#include "DVDDemuxProbeCache.h"
 
 #include "threads/CriticalSection.h"
 #include "threads/SystemClock.h"
@@ -121,6 +122,9 @@ protected:
   int ReadFrame(AVPacket *packet);
   void AddStream(int iId);
 
+  bool ApplyProbeInfo(const CDVDDemuxProbeCache::CProbeInfo &info);
+  void GetProbeInfo(CDVDDemuxProbeCache::CProbeInfo &info);
+
   double ConvertTimestamp(int64_t pts, int den, int num);
   void UpdateCurrentPTS();
 
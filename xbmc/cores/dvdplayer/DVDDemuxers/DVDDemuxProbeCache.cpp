@@ -0,0 +1,261 @@
+/*
+ *      Copyright (C) 2005-2012 Team XBMC
+ *      http://www.xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, write to
+ *  the Free Software Foundation, 675 Mass Ave, Cambridge, MA 02139, USA.
+ *  http://www.gnu.org/copyleft/gpl.html
+ *
+ */
+
+#include "DVDDemuxProbeCache.h"
+#include "filesystem/File.h"
+#include "threads/SingleLock.h"
+#include "utils/Archive.h"
+#include "utils/Job.h"
+#include "utils/JobManager.h"
+#include "utils/log.h"
+
+#define PROBE_CACHE_FILE    "special://temp/probecache.dat"
+#define PROBE_CACHE_VERSION 2
+#define PROBE_CACHE_ENTRIES 500
+// new entries collected before the cache is written out in the background
+#define PROBE_CACHE_SAVE_BATCH 16
+
+using namespace XFILE;
+
+static CStdString ToHex(const std::string &data)
+{
+  static const char digits[] = "0123456789abcdef";
+  CStdString hex;
+  hex.reserve(data.size() * 2);
+  for (unsigned int i = 0; i < data.size(); i++)
+  {
+    hex += digits[(unsigned char)data[i] >> 4];
+    hex += digits[(unsigned char)data[i] & 0xf];
+  }
+  return hex;
+}
+
+static std::string FromHex(const CStdString &hex)
+{
+  std::string data;
+  data.reserve(hex.size() / 2);
+  for (unsigned int i = 0; i + 1 < hex.size(); i += 2)
+  {
+    char digit[3] = { hex[i], hex[i + 1], 0 };
+    data += (char)strtol(digit, NULL, 16);
+  }
+  return data;
+}
+
+class CProbeCacheSaveJob : public CJob
+{
+public:
+  virtual const char *GetType() const { return "probecachesave"; }
+  virtual bool DoWork()
+  {
+    CDVDDemuxProbeCache::Get().Flush();
+    return true;
+  }
+};
+
+CDVDDemuxProbeCache::CStreamInfo::CStreamInfo()
+{
+  type = codecId = profile = level = bitRate = 0;
+  codecTag = 0;
+  width = height = aspectNum = aspectDen = pixFmt = 0;
+  frameRateNum = frameRateDen = avgFrameRateNum = avgFrameRateDen = 0;
+  sampleRate = channels = sampleFmt = bitsPerCodedSample = blockAlign = 0;
+  channelLayout = 0;
+  duration = startTime = 0;
+  timeBaseNum = timeBaseDen = hasBFrames = 0;
+}
+
+CDVDDemuxProbeCache::CDVDDemuxProbeCache()
+{
+  m_loaded = false;
+  m_unsaved = 0;
+  m_saveQueued = false;
+}
+
+CDVDDemuxProbeCache &CDVDDemuxProbeCache::Get()
+{
+  static CDVDDemuxProbeCache cache;
+  return cache;
+}
+
+std::string CDVDDemuxProbeCache::GetKey(const CStdString &path)
+{
+  struct __stat64 st;
+  if (CFile::Stat(path, &st) != 0 || st.st_size <= 0)
+    return "";
+
+  CStdString key;
+  key.Format("%s|%"PRId64"|%"PRId64, path.c_str(), (int64_t)st.st_size, (int64_t)st.st_mtime);
+  return key;
+}
+
+bool CDVDDemuxProbeCache::Lookup(const CStdString &path, CProbeInfo &info)
+{
+  std::string key = GetKey(path);
+  if (key.empty())
+    return false;
+
+  CSingleLock lock(m_section);
+  if (!m_loaded)
+    Load();
+
+  ProbeIndex::const_iterator it = m_entries.find(key);
+  if (it == m_entries.end())
+    return false;
+
+  info = it->second;
+  return true;
+}
+
+void CDVDDemuxProbeCache::Store(const CStdString &path, const CProbeInfo &info)
+{
+  std::string key = GetKey(path);
+  if (key.empty())
+    return;
+
+  CSingleLock lock(m_section);
+  if (!m_loaded)
+    Load();
+
+  if (m_entries.find(key) == m_entries.end())
+  {
+    m_order.push_back(key);
+    while (m_order.size() > PROBE_CACHE_ENTRIES)
+    {
+      m_entries.erase(m_order.front());
+      m_order.pop_front();
+    }
+  }
+  m_entries[key] = info;
+
+  if (++m_unsaved >= PROBE_CACHE_SAVE_BATCH && !m_saveQueued)
+  {
+    m_saveQueued = true;
+    CJobManager::GetInstance().AddJob(new CProbeCacheSaveJob(), NULL);
+  }
+}
+
+void CDVDDemuxProbeCache::Flush()
+{
+  CSingleLock saveLock(m_saveSection);
+
+  // write a snapshot, so opening files doesn't wait for the disk
+  std::vector<std::pair<std::string, CProbeInfo> > entries;
+  {
+    CSingleLock lock(m_section);
+    m_saveQueued = false;
+    if (!m_unsaved)
+      return;
+    m_unsaved = 0;
+    entries.reserve(m_order.size());
+    for (std::deque<std::string>::const_iterator it = m_order.begin(); it != m_order.end(); ++it)
+      entries.push_back(std::make_pair(*it, m_entries[*it]));
+  }
+  Save(entries);
+}
+
+void CDVDDemuxProbeCache::Load()
+{
+  m_loaded = true;
+
+  CFile file;
+  if (!file.Open(PROBE_CACHE_FILE))
+    return;
+
+  CArchive ar(&file, CArchive::load);
+  int version = 0;
+  unsigned int count = 0;
+  ar >> version;
+  if (version == PROBE_CACHE_VERSION)
+  {
+    ar >> count;
+    for (unsigned int i = 0; i < count && i < PROBE_CACHE_ENTRIES; i++)
+    {
+      CStdString key, format;
+      CProbeInfo info;
+      unsigned int streams = 0;
+      ar >> key;
+      ar >> format;
+      ar >> info.duration;
+      ar >> info.startTime;
+      ar >> info.bitRate;
+      ar >> streams;
+      info.format = format;
+      info.streams.resize(streams);
+      for (unsigned int j = 0; j < streams; j++)
+      {
+        CStreamInfo &s = info.streams[j];
+        CStdString extraData;
+        ar >> s.type >> s.codecId >> s.codecTag >> s.profile >> s.level >> s.bitRate;
+        ar >> s.width >> s.height >> s.aspectNum >> s.aspectDen >> s.pixFmt;
+        ar >> s.frameRateNum >> s.frameRateDen >> s.avgFrameRateNum >> s.avgFrameRateDen;
+        ar >> s.sampleRate >> s.channels >> s.channelLayout >> s.sampleFmt;
+        ar >> s.bitsPerCodedSample >> s.blockAlign;
+        ar >> s.duration >> s.startTime >> s.timeBaseNum >> s.timeBaseDen >> s.hasBFrames;
+        ar >> extraData;
+        s.extraData = FromHex(extraData);
+      }
+      m_entries[key] = info;
+      m_order.push_back(key);
+    }
+  }
+  ar.Close();
+  file.Close();
+
+  CLog::Log(LOGDEBUG, "%s - loaded %u entries", __FUNCTION__, (unsigned int)m_entries.size());
+}
+
+void CDVDDemuxProbeCache::Save(const std::vector<std::pair<std::string, CProbeInfo> > &entries)
+{
+  CFile file;
+  if (!file.OpenForWrite(PROBE_CACHE_FILE, true))
+  {
+    CLog::Log(LOGWARNING, "%s - unable to write %s", __FUNCTION__, PROBE_CACHE_FILE);
+    return;
+  }
+
+  CArchive ar(&file, CArchive::store);
+  ar << (int)PROBE_CACHE_VERSION;
+  ar << (unsigned int)entries.size();
+  for (unsigned int i = 0; i < entries.size(); i++)
+  {
+    const CProbeInfo &info = entries[i].second;
+    ar << CStdString(entries[i].first);
+    ar << CStdString(info.format);
+    ar << info.duration;
+    ar << info.startTime;
+    ar << info.bitRate;
+    ar << (unsigned int)info.streams.size();
+    for (unsigned int j = 0; j < info.streams.size(); j++)
+    {
+      const CStreamInfo &s = info.streams[j];
+      ar << s.type << s.codecId << s.codecTag << s.profile << s.level << s.bitRate;
+      ar << s.width << s.height << s.aspectNum << s.aspectDen << s.pixFmt;
+      ar << s.frameRateNum << s.frameRateDen << s.avgFrameRateNum << s.avgFrameRateDen;
+      ar << s.sampleRate << s.channels << s.channelLayout << s.sampleFmt;
+      ar << s.bitsPerCodedSample << s.blockAlign;
+      ar << s.duration << s.startTime << s.timeBaseNum << s.timeBaseDen << s.hasBFrames;
+      ar << ToHex(s.extraData);
+    }
+  }
+  ar.Close();
+  file.Close();
+}
@@ -0,0 +1,123 @@
+#pragma once
+
+/*
+ *      Copyright (C) 2005-2012 Team XBMC
+ *      http://www.xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, write to
+ *  the Free Software Foundation, 675 Mass Ave, Cambridge, MA 02139, USA.
+ *  http://www.gnu.org/copyleft/gpl.html
+ *
+ */
+
+#include "utils/StdString.h"
+#include "threads/CriticalSection.h"
+
+#include <deque>
+#include <string>
+#include <vector>
+#include <stdint.h>
+#include <boost/unordered_map.hpp>
+
+/*!
+ \brief Persistent cache of what avformat found out about a file.
+
+ Probing a big MKV or TS over the network reads several MB before playback
+ can start, and the same file gets probed again on resume, for every stack
+ part and when stream details are extracted. Entries are keyed on path, size
+ and modification time so a changed file is simply probed again.
+ */
+class CDVDDemuxProbeCache
+{
+public:
+  class CStreamInfo
+  {
+  public:
+    CStreamInfo();
+    int          type;
+    int          codecId;
+    unsigned int codecTag;
+    int          profile;
+    int          level;
+    int          bitRate;
+    int          width;
+    int          height;
+    int          aspectNum;
+    int          aspectDen;
+    int          pixFmt;
+    int          frameRateNum;
+    int          frameRateDen;
+    int          avgFrameRateNum;
+    int          avgFrameRateDen;
+    int          sampleRate;
+    int          channels;
+    uint64_t     channelLayout;
+    int          sampleFmt;
+    int          bitsPerCodedSample;
+    int          blockAlign;
+    int64_t      duration;     ///< in time base units of the stream
+    int64_t      startTime;    ///< in time base units of the stream
+    int          timeBaseNum;  ///< time base of the codec
+    int          timeBaseDen;
+    int          hasBFrames;
+    std::string  extraData;
+  };
+
+  class CProbeInfo
+  {
+  public:
+    CProbeInfo() : duration(0), startTime(0), bitRate(0) {};
+    std::string              format;
+    int64_t                  duration;
+    int64_t                  startTime;
+    int                      bitRate;
+    std::vector<CStreamInfo> streams;
+  };
+
+  static CDVDDemuxProbeCache &Get();
+
+  /*! \brief Find the probe results for a file
+   \param path the file being opened
+   \param info [out] the cached results
+   \return true if there is an entry matching the file's current size and mtime
+   */
+  bool Lookup(const CStdString &path, CProbeInfo &info);
+
+  /*! \brief Remember the probe results for a file
+   The cache is written out in the background once enough entries were added,
+   and on Flush().
+   */
+  void Store(const CStdString &path, const CProbeInfo &info);
+
+  /*! \brief Write the cache out if it has unsaved entries
+   */
+  void Flush();
+
+private:
+  typedef boost::unordered_map<std::string, CProbeInfo> ProbeIndex;
+
+  CDVDDemuxProbeCache();
+
+  static std::string GetKey(const CStdString &path);
+  void Load();
+  static void Save(const std::vector<std::pair<std::string, CProbeInfo> > &entries);
+
+  ProbeIndex              m_entries;
+  std::deque<std::string> m_order;
+  bool                    m_loaded;
+  unsigned int            m_unsaved;    ///< entries stored since the last save
+  bool                    m_saveQueued;
+  CCriticalSection        m_section;
+  CCriticalSection        m_saveSection; ///< serialises writers of the cache file
+};
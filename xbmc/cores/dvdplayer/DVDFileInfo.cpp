@@ -163,16 +163,16 @@ bool CDVDFileInfo::ExtractThumb(const CStdString &strPath, CTextureDetails &deta
     CDVDStreamInfo hint(*pDemuxer->GetStream(nVideoStream), true);
     hint.software = true;
 
-    if (hint.codec == CODEC_ID_MPEG2VIDEO || hint.codec == CODEC_ID_MPEG1VIDEO)
-    {
-      // libmpeg2 is not thread safe so use ffmepg for mpeg2/mpeg1 thumb extraction
-      CDVDCodecOptions dvdOptions;
-      pVideoCodec = CDVDFactoryCodec::OpenCodec(new CDVDVideoCodecFFmpeg(), hint, dvdOptions);
-    }
-    else
-    {
+    // the seek lands on a key frame, so decode nothing else - thumbs are extracted
+    // several at a time, and frames in between only cost time
+    CDVDCodecOptions dvdOptions;
+    dvdOptions.m_keys.push_back(CDVDCodecOption("skip_frame", "nokey"));
+    dvdOptions.m_formats.push_back(RENDER_FMT_YUV420P);
+    pVideoCodec = CDVDFactoryCodec::OpenCodec(new CDVDVideoCodecFFmpeg(), hint, dvdOptions);
+
+    // libmpeg2 is not thread safe so only ever use ffmpeg for mpeg2/mpeg1 thumb extraction
+    if (!pVideoCodec && hint.codec != CODEC_ID_MPEG2VIDEO && hint.codec != CODEC_ID_MPEG1VIDEO)
       pVideoCodec = CDVDFactoryCodec::CreateVideoCodec( hint );
-    }
 
     if (pVideoCodec)
     {
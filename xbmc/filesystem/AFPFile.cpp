@@ -359,7 +359,7 @@ int CAfpConnection::stat(const CURL &url, struct stat *statbuff)
 }
 
 
-/* This is called from CApplication::ProcessSlow() and is used to tell if afp have been idle for too long */
+/* This is called every 500ms by the housekeeper (see CApplication::StartHousekeeping()) and is used to tell if afp have been idle for too long */
 void CAfpConnection::CheckIfIdle()
 {
   /* We check if there are open connections. This is done without a lock to not halt the mainthread. It should be thread safe as
@@ -79,6 +79,10 @@ public:
   virtual int nfs_pread(struct nfs_context *nfs,     struct nfsfh *nfsfh,  uint64_t offset, uint64_t count, char *buf)=0;
   virtual int nfs_pwrite(struct nfs_context *nfs,    struct nfsfh *nfsfh,  uint64_t offset, uint64_t count, char *buf)=0;
   virtual int nfs_lseek(struct nfs_context *nfs,     struct nfsfh *nfsfh,  uint64_t offset, int whence,   uint64_t *current_offset)=0;
+  virtual int nfs_pread_async(struct nfs_context *nfs, struct nfsfh *nfsfh, uint64_t offset, uint64_t count, nfs_cb cb, void *private_data)=0;
+  virtual int nfs_service(struct nfs_context *nfs,   int revents)=0;
+  virtual int nfs_get_fd(struct nfs_context *nfs)=0;
+  virtual int nfs_which_events(struct nfs_context *nfs)=0;
 };
 
 class DllLibNfs : public DllDynamic, DllLibNfsInterface
@@ -93,6 +97,8 @@ class DllLibNfs : public DllDynamic, DllLibNfsInterface
   DEFINE_METHOD1(uint64_t,  nfs_get_readmax,                  (struct nfs_context *p1))
   DEFINE_METHOD1(uint64_t,  nfs_get_writemax,                 (struct nfs_context *p1)) 
   DEFINE_METHOD1(char *,  nfs_get_error,                    (struct nfs_context *p1))    
+  DEFINE_METHOD1(int,     nfs_get_fd,                       (struct nfs_context *p1))
+  DEFINE_METHOD1(int,     nfs_which_events,                 (struct nfs_context *p1))
   DEFINE_METHOD2(struct nfsdirent *, nfs_readdir,           (struct nfs_context *p1, struct nfsdir *p2))
   DEFINE_METHOD2(int, nfs_fsync,     (struct nfs_context *p1, struct nfsfh *p2))
   DEFINE_METHOD2(int, nfs_mkdir,     (struct nfs_context *p1, const char *p2))
@@ -100,6 +106,7 @@ class DllLibNfs : public DllDynamic, DllLibNfsInterface
   DEFINE_METHOD2(int, nfs_unlink,    (struct nfs_context *p1, const char *p2))
   DEFINE_METHOD2(void,nfs_closedir,  (struct nfs_context *p1, struct nfsdir *p2))        
   DEFINE_METHOD2(int, nfs_close,     (struct nfs_context *p1, struct nfsfh *p2)) 
+  DEFINE_METHOD2(int, nfs_service,   (struct nfs_context *p1, int p2))
   DEFINE_METHOD3(int, nfs_mount,     (struct nfs_context *p1, const char *p2,    const char *p3))
   DEFINE_METHOD3(int, nfs_stat,      (struct nfs_context *p1, const char *p2,    struct stat *p3))
   DEFINE_METHOD3(int, nfs_fstat,     (struct nfs_context *p1, struct nfsfh *p2,  struct stat *p3))
@@ -125,6 +132,7 @@ class DllLibNfs : public DllDynamic, DllLibNfsInterface
   DEFINE_METHOD5(int, nfs_pread,     (struct nfs_context *p1, struct nfsfh *p2,  uint64_t p3,   uint64_t p4,  char *p5))
   DEFINE_METHOD5(int, nfs_pwrite,    (struct nfs_context *p1, struct nfsfh *p2,  uint64_t p3,   uint64_t p4,  char *p5))
   DEFINE_METHOD5(int, nfs_lseek,     (struct nfs_context *p1, struct nfsfh *p2,  uint64_t p3,   int p4,     uint64_t *p5))
+  DEFINE_METHOD6(int, nfs_pread_async, (struct nfs_context *p1, struct nfsfh *p2, uint64_t p3, uint64_t p4, nfs_cb p5, void *p6))
 
 
 
@@ -146,6 +154,10 @@ class DllLibNfs : public DllDynamic, DllLibNfsInterface
     RESOLVE_METHOD_RENAME(nfs_open,      nfs_open)
     RESOLVE_METHOD_RENAME(nfs_close,     nfs_close)
     RESOLVE_METHOD_RENAME(nfs_pread,     nfs_pread)
+    RESOLVE_METHOD_RENAME(nfs_pread_async, nfs_pread_async)
+    RESOLVE_METHOD_RENAME(nfs_service,   nfs_service)
+    RESOLVE_METHOD_RENAME(nfs_get_fd,    nfs_get_fd)
+    RESOLVE_METHOD_RENAME(nfs_which_events, nfs_which_events)
     RESOLVE_METHOD_RENAME(nfs_read,      nfs_read)
     RESOLVE_METHOD_RENAME(nfs_pwrite,    nfs_pwrite)
     RESOLVE_METHOD_RENAME(nfs_write,     nfs_write)
@@ -31,13 +31,18 @@
 #include "utils/log.h"
 #include "utils/URIUtils.h"
 #include "network/DNSNameCache.h"
+#include "settings/AdvancedSettings.h"
 #include "threads/SystemClock.h"
+#include "utils/TimeUtils.h"
 
 #include <nfsc/libnfs-raw-mount.h>
 
 #ifdef TARGET_WINDOWS
 #include <fcntl.h>
 #include <sys\stat.h>
+#define poll WSAPoll
+#else
+#include <poll.h>
 #endif
 
 //KEEP_ALIVE_TIMEOUT is decremented every half a second
@@ -49,6 +54,9 @@
 //4 mins cached context timeout
 #define CONTEXT_TIMEOUT 240000
 
+//a stream gives up when no reply arrived for 30s
+#define REPLY_TIMEOUT 30000
+
 //return codes for getContextForExport
 #define CONTEXT_INVALID  0    //getcontext failed
 #define CONTEXT_NEW      1    //new context created
@@ -67,6 +75,10 @@ CNfsConnection::CNfsConnection()
 , m_IdleTimeout(0)
 , m_lastAccessedTime(0)
 , m_pLibNfs(new DllLibNfs())
+, m_statsBytes(0)
+, m_statsRpcs(0)
+, m_statsRpcTicks(0)
+, m_statsReadTicks(0)
 {
 }
 
@@ -136,6 +148,15 @@ void CNfsConnection::destroyOpenContexts()
     m_pLibNfs->nfs_destroy_context(it->second.pContext);
   }
   m_openContextMap.clear();
+
+  for(tStreamContextMap::iterator it = m_streamContexts.begin();it!=m_streamContexts.end();it++)
+  {
+    for(std::list<struct contextTimeout>::iterator context = it->second.begin();context!=it->second.end();context++)
+    {
+      m_pLibNfs->nfs_destroy_context(context->pContext);
+    }
+  }
+  m_streamContexts.clear();
 }
 
 struct nfs_context *CNfsConnection::getContextFromMap(const CStdString &exportname)
@@ -301,6 +322,84 @@ bool CNfsConnection::Connect(const CURL& url, CStdString &relativePath)
   return ret; 
 }
 
+struct nfs_context *CNfsConnection::AcquireStreamContext(const CURL &url, CStdString &relativePath, CStdString &key)
+{
+  CStdString exportPath;
+  CStdString resolvedHost;
+
+  {
+    CSingleLock lock(*this);
+
+    //connecting the shared context resolves the host and keeps the export list current
+    if(!Connect(url, relativePath))
+      return NULL;
+
+    exportPath = m_exportPath;
+    resolvedHost = m_resolvedHostName;
+    key = url.GetHostName() + exportPath;
+
+    //reuse the most recently given back context that hasn't timed out
+    std::list<struct contextTimeout> &idleContexts = m_streamContexts[key];
+    uint64_t now = XbmcThreads::SystemClockMillis();
+    while(!idleContexts.empty())
+    {
+      struct contextTimeout tmp = idleContexts.back();
+      idleContexts.pop_back();
+      if((now - tmp.lastAccessedTime) < CONTEXT_TIMEOUT)
+      {
+        return tmp.pContext;
+      }
+      m_pLibNfs->nfs_destroy_context(tmp.pContext);
+    }
+  }
+
+  //mount without holding the connection lock - the lib can't be unloaded
+  //meanwhile as the calling file counts as an open connection
+  struct nfs_context *pContext = m_pLibNfs->nfs_init_context();
+  if(!pContext)
+  {
+    CLog::Log(LOGERROR,"NFS: Error initcontext in AcquireStreamContext.");
+    return NULL;
+  }
+
+  if(m_pLibNfs->nfs_mount(pContext, resolvedHost.c_str(), exportPath.c_str()) != 0)
+  {
+    CLog::Log(LOGERROR,"NFS: Failed to mount nfs share for streaming: %s (%s)\n", exportPath.c_str(), m_pLibNfs->nfs_get_error(pContext));
+    m_pLibNfs->nfs_destroy_context(pContext);
+    return NULL;
+  }
+  CLog::Log(LOGDEBUG,"NFS: Mounted stream context for server %s and export %s\n", url.GetHostName().c_str(), exportPath.c_str());
+  return pContext;
+}
+
+void CNfsConnection::ReleaseStreamContext(const CStdString &key, struct nfs_context *pContext)
+{
+  CSingleLock lock(*this);
+  struct contextTimeout tmp;
+  tmp.pContext = pContext;
+  tmp.lastAccessedTime = XbmcThreads::SystemClockMillis();
+  m_streamContexts[key].push_back(tmp);
+}
+
+void CNfsConnection::AddReadStats(uint64_t bytes, uint64_t rpcs, int64_t rpcTicks, int64_t readTicks)
+{
+  CSingleLock lock(m_statsLock);
+  m_statsBytes += bytes;
+  m_statsRpcs += rpcs;
+  m_statsRpcTicks += rpcTicks;
+  m_statsReadTicks += readTicks;
+}
+
+void CNfsConnection::GetReadStats(uint64_t &bytes, uint64_t &rpcs, float &averageRpcMs, float &throughputKBs)
+{
+  CSingleLock lock(m_statsLock);
+  float frequency = (float)CurrentHostFrequency();
+  bytes = m_statsBytes;
+  rpcs = m_statsRpcs;
+  averageRpcMs = m_statsRpcs ? m_statsRpcTicks * 1000.0f / frequency / m_statsRpcs : 0.0f;
+  throughputKBs = m_statsReadTicks ? m_statsBytes / 1024.0f / (m_statsReadTicks / frequency) : 0.0f;
+}
+
 void CNfsConnection::Deinit()
 {
   if(m_pNfsContext && m_pLibNfs->IsLoaded())
@@ -312,7 +411,7 @@ void CNfsConnection::Deinit()
   clearMembers();
 }
 
-/* This is called from CApplication::ProcessSlow() and is used to tell if nfs have been idle for too long */
+/* This is called every 500ms by the housekeeper (see CApplication::StartHousekeeping()) and is used to tell if nfs have been idle for too long */
 void CNfsConnection::CheckIfIdle()
 {
   /* We check if there are open connections. This is done without a lock to not halt the mainthread. It should be thread safe as
@@ -336,20 +435,20 @@ void CNfsConnection::CheckIfIdle()
   
   if( m_pNfsContext != NULL )
   {
-    //handle keep alive on opened files
+    //handle keep alive on opened files - the lock keeps the files
+    //from being closed while their keep alive is sent
+    CSingleLock lock(keepAliveLock);
     for( tFileKeepAliveMap::iterator it = m_KeepAliveTimeouts.begin();it!=m_KeepAliveTimeouts.end();it++)
     {
-      CSingleLock lock(keepAliveLock);
-      if(it->second > 0)
+      if(it->second.refreshCounter > 0)
       {
-        it->second--;
+        it->second.refreshCounter--;
       }
       else
       {
-        lock.Leave();
-        keepAlive(it->first);
+        keepAlive(it->first, it->second);
         //reset timeout
-        resetKeepAlive(it->first);
+        it->second.refreshCounter = KEEP_ALIVE_TIMEOUT;
       }
     }
   }
@@ -363,25 +462,25 @@ void CNfsConnection::removeFromKeepAliveList(struct nfsfh  *_pFileHandle)
 }
 
 //reset timeouts on read
-void CNfsConnection::resetKeepAlive(struct nfsfh  *_pFileHandle)
+void CNfsConnection::resetKeepAlive(struct nfs_context *_pContext, CCriticalSection &section, struct nfsfh  *_pFileHandle)
 {
   CSingleLock lock(keepAliveLock);
   //adds new keys - refreshs existing ones  
-  m_KeepAliveTimeouts[_pFileHandle] = KEEP_ALIVE_TIMEOUT;
+  struct keepAliveTimeout &entry = m_KeepAliveTimeouts[_pFileHandle];
+  entry.pContext = _pContext;
+  entry.pSection = &section;
+  entry.refreshCounter = KEEP_ALIVE_TIMEOUT;
 }
 
 //keep alive the filehandles nfs connection
-//by blindly doing a read 32bytes - seek back to where
-//we were before
-void CNfsConnection::keepAlive(struct nfsfh  *_pFileHandle)
+//by blindly doing a read of 32bytes - pread leaves
+//the position of the filehandle untouched
+void CNfsConnection::keepAlive(struct nfsfh  *_pFileHandle, const struct keepAliveTimeout &entry)
 {
-  uint64_t offset = 0;
   char buffer[32];
   CLog::Log(LOGNOTICE, "NFS: sending keep alive after %i s.",KEEP_ALIVE_TIMEOUT/2);
-  CSingleLock lock(*this);
-  m_pLibNfs->nfs_lseek(m_pNfsContext, _pFileHandle, 0, SEEK_CUR, &offset);
-  m_pLibNfs->nfs_read(m_pNfsContext, _pFileHandle, 32, buffer);
-  m_pLibNfs->nfs_lseek(m_pNfsContext, _pFileHandle, offset, SEEK_SET, &offset);
+  CSingleLock lock(*entry.pSection);
+  m_pLibNfs->nfs_pread(entry.pContext, _pFileHandle, 0, 32, buffer);
 }
 
 int CNfsConnection::stat(const CURL &url, struct stat *statbuff)
@@ -448,6 +547,14 @@ CNFSFile::CNFSFile()
 : m_fileSize(0)
 , m_pFileHandle(NULL)
 , m_pNfsContext(NULL)
+, m_bStream(false)
+, m_position(0)
+, m_chunkSize(0)
+, m_inFlight(0)
+, m_bytesRead(0)
+, m_rpcs(0)
+, m_rpcTicks(0)
+, m_readTicks(0)
 {
   gNfsConnection.AddActiveConnection();
 }
@@ -462,6 +569,9 @@ int64_t CNFSFile::GetPosition()
 {
   int ret = 0;
   uint64_t offset = 0;
+
+  if (m_bStream) return m_position;
+
   CSingleLock lock(gNfsConnection);
   
   if (gNfsConnection.GetNfsContext() == NULL || m_pFileHandle == NULL) return 0;
@@ -495,34 +605,42 @@ bool CNFSFile::Open(const CURL& url)
   
   CStdString filename = "";
    
-  CSingleLock lock(gNfsConnection);
-  
-  if(!gNfsConnection.Connect(url, filename))
+  //read on a context of our own, so the stream neither waits for nor holds
+  //up other files and directory listings on the shared context
+  m_pNfsContext = gNfsConnection.AcquireStreamContext(url, filename, m_streamKey);
+  if(!m_pNfsContext)
     return false;
   
-  m_pNfsContext = gNfsConnection.GetNfsContext(); 
-  
   ret = gNfsConnection.GetImpl()->nfs_open(m_pNfsContext, filename.c_str(), O_RDONLY, &m_pFileHandle);
   
   if (ret != 0) 
   {
     CLog::Log(LOGINFO, "CNFSFile::Open: Unable to open file : '%s'  error : '%s'", url.GetFileName().c_str(), gNfsConnection.GetImpl()->nfs_get_error(m_pNfsContext));
+    gNfsConnection.ReleaseStreamContext(m_streamKey, m_pNfsContext);
+    m_pNfsContext = NULL;
+    m_pFileHandle = NULL;
     return false;
   } 
   
   CLog::Log(LOGDEBUG,"CNFSFile::Open - opened %s",url.GetFileName().c_str());
   m_url=url;
+  m_bStream = true;
   
-  struct __stat64 tmpBuffer;
+  struct stat tmpBuffer = {0};
 
-  if( Stat(&tmpBuffer) )
+  if( gNfsConnection.GetImpl()->nfs_fstat(m_pNfsContext, m_pFileHandle, &tmpBuffer) != 0 )
   {
+    CLog::Log(LOGERROR, "NFS: Failed to fstat(%s) %s\n", url.GetFileName().c_str(), gNfsConnection.GetImpl()->nfs_get_error(m_pNfsContext));
     m_url.Reset();
     Close();
     return false;
   }
   
   m_fileSize = tmpBuffer.st_size;//cache the size of this file
+  m_position = 0;
+  m_chunkSize = gNfsConnection.GetImpl()->nfs_get_readmax(m_pNfsContext);
+  if (m_chunkSize == 0)
+    m_chunkSize = 32768;
   // We've successfully opened the file!
   return true;
 }
@@ -583,6 +701,19 @@ int CNFSFile::Stat(const CURL& url, struct __stat64* buffer)
 unsigned int CNFSFile::Read(void *lpBuf, int64_t uiBufSize)
 {
   int numberOfBytesRead = 0;
+
+  if (m_bStream)
+  {
+    {
+      CSingleLock lock(m_streamLock);
+      int64_t start = CurrentHostCounter();
+      numberOfBytesRead = ReadStream((char *)lpBuf, uiBufSize);
+      m_readTicks += CurrentHostCounter() - start;
+    }
+    gNfsConnection.resetKeepAlive(m_pNfsContext, m_streamLock, m_pFileHandle);//triggers keep alive timer reset for this filehandle
+    return numberOfBytesRead < 0 ? 0 : (unsigned int)numberOfBytesRead;
+  }
+
   CSingleLock lock(gNfsConnection);
   
   if (m_pFileHandle == NULL || m_pNfsContext == NULL ) return 0;
@@ -591,7 +722,7 @@ unsigned int CNFSFile::Read(void *lpBuf, int64_t uiBufSize)
 
   lock.Leave();//no need to keep the connection lock after that
   
-  gNfsConnection.resetKeepAlive(m_pFileHandle);//triggers keep alive timer reset for this filehandle
+  gNfsConnection.resetKeepAlive(m_pNfsContext, gNfsConnection, m_pFileHandle);//triggers keep alive timer reset for this filehandle
   
   //something went wrong ...
   if (numberOfBytesRead < 0) 
@@ -607,6 +738,32 @@ int64_t CNFSFile::Seek(int64_t iFilePosition, int iWhence)
   int ret = 0;
   uint64_t offset = 0;
 
+  if (m_bStream)
+  {
+    CSingleLock lock(m_streamLock);
+    int64_t position = -1;
+    if (iWhence == SEEK_SET)
+      position = iFilePosition;
+    else if (iWhence == SEEK_CUR)
+      position = m_position + iFilePosition;
+    else if (iWhence == SEEK_END)
+    {
+      //the file might still be growing
+      struct stat tmpBuffer = {0};
+      if (gNfsConnection.GetImpl()->nfs_fstat(m_pNfsContext, m_pFileHandle, &tmpBuffer) == 0)
+        m_fileSize = tmpBuffer.st_size;
+      position = m_fileSize + iFilePosition;
+    }
+    if (position < 0)
+    {
+      CLog::Log(LOGERROR, "%s - Error( seekpos: %"PRId64", whence: %i, fsize: %"PRId64")", __FUNCTION__, iFilePosition, iWhence, m_fileSize);
+      return -1;
+    }
+    //the read ahead window follows on the next Read()
+    m_position = position;
+    return m_position;
+  }
+
   CSingleLock lock(gNfsConnection);  
   if (m_pFileHandle == NULL || m_pNfsContext == NULL) return -1;
   
@@ -622,6 +779,15 @@ int64_t CNFSFile::Seek(int64_t iFilePosition, int iWhence)
 
 void CNFSFile::Close()
 {
+  if (m_bStream)
+  {
+    CloseStream();
+    return;
+  }
+
+  //before taking the connection lock - keep alives are sent holding the keep alive lock
+  gNfsConnection.removeFromKeepAliveList(m_pFileHandle);
+
   CSingleLock lock(gNfsConnection);
   
   if (m_pFileHandle != NULL && m_pNfsContext != NULL)
@@ -629,7 +795,6 @@ void CNFSFile::Close()
     int ret = 0;
     CLog::Log(LOGDEBUG,"CNFSFile::Close closing file %s", m_url.GetFileName().c_str());
     ret = gNfsConnection.GetImpl()->nfs_close(m_pNfsContext, m_pFileHandle);
-    gNfsConnection.removeFromKeepAliveList(m_pFileHandle);
         
 	  if (ret < 0) 
     {
@@ -654,7 +819,7 @@ int CNFSFile::Write(const void* lpBuf, int64_t uiBufSize)
   
   CSingleLock lock(gNfsConnection);
   
-  if (m_pFileHandle == NULL || m_pNfsContext == NULL) return -1;
+  if (m_pFileHandle == NULL || m_pNfsContext == NULL || m_bStream) return -1;
   
   //write as long as some bytes are left to be written
   while( leftBytes )
@@ -786,6 +951,215 @@ bool CNFSFile::OpenForWrite(const CURL& url, bool bOverWrite)
   return true;
 }
 
+void CNFSFile::ReadCallback(int err, struct nfs_context *nfs, void *data, void *private_data)
+{
+  readRequest *request = (readRequest *)private_data;
+  CNFSFile *file = request->pFile;
+
+  file->m_inFlight--;
+  file->m_rpcTicks += CurrentHostCounter() - request->issuedAt;
+
+  if (request->discarded)
+  {
+    delete request;
+    return;
+  }
+
+  request->done = true;
+  request->result = err;
+  if (err > 0)
+  {
+    request->data.assign((char *)data, (char *)data + err);
+    file->m_bytesRead += err;
+  }
+}
+
+bool CNFSFile::IssueRead(int64_t offset)
+{
+  readRequest *request = new readRequest;
+  request->pFile = this;
+  request->offset = offset;
+  request->issuedAt = CurrentHostCounter();
+  request->done = false;
+  request->discarded = false;
+  request->result = 0;
+
+  if (gNfsConnection.GetImpl()->nfs_pread_async(m_pNfsContext, m_pFileHandle, offset, m_chunkSize, ReadCallback, request) != 0)
+  {
+    CLog::Log(LOGERROR, "NFS: Failed to send read(%s) %s\n", m_url.GetFileName().c_str(), gNfsConnection.GetImpl()->nfs_get_error(m_pNfsContext));
+    delete request;
+    return false;
+  }
+  m_inFlight++;
+  m_rpcs++;
+  m_readAhead.push_back(request);
+  return true;
+}
+
+bool CNFSFile::WaitForReply()
+{
+  struct pollfd pfd;
+  pfd.fd = gNfsConnection.GetImpl()->nfs_get_fd(m_pNfsContext);
+  pfd.events = gNfsConnection.GetImpl()->nfs_which_events(m_pNfsContext);
+  pfd.revents = 0;
+
+  int ret = poll(&pfd, 1, REPLY_TIMEOUT);
+  if (ret < 0)
+  {
+    if (errno == EINTR)
+      return true;
+    CLog::Log(LOGERROR, "NFS: Failed to poll(%s) - %s", m_url.GetFileName().c_str(), strerror(errno));
+    return false;
+  }
+  if (ret == 0)
+  {
+    CLog::Log(LOGERROR, "NFS: No reply for %s within %i s", m_url.GetFileName().c_str(), REPLY_TIMEOUT / 1000);
+    return false;
+  }
+
+  //calls ReadCallback for the replies that arrived
+  if (gNfsConnection.GetImpl()->nfs_service(m_pNfsContext, pfd.revents) < 0)
+  {
+    CLog::Log(LOGERROR, "NFS: Failed to service(%s) %s", m_url.GetFileName().c_str(), gNfsConnection.GetImpl()->nfs_get_error(m_pNfsContext));
+    return false;
+  }
+  return true;
+}
+
+void CNFSFile::DiscardRead(readRequest *request)
+{
+  if (request->done)
+    delete request;
+  else
+    request->discarded = true;
+}
+
+int CNFSFile::ReadStream(char *buffer, int64_t size)
+{
+  size_t window = (size_t)g_advancedSettings.m_nfsReadAhead;
+  int64_t copied = 0;
+
+  while (copied < size)
+  {
+    //drop the requests the position moved past - or the whole window if it moved back
+    while (!m_readAhead.empty() && (m_readAhead.front()->offset > m_position ||
+           m_readAhead.front()->offset + (int64_t)m_chunkSize <= m_position))
+    {
+      if (m_readAhead.front()->offset > m_position)
+      {
+        for (std::deque<readRequest *>::iterator it = m_readAhead.begin(); it != m_readAhead.end(); ++it)
+          DiscardRead(*it);
+        m_readAhead.clear();
+      }
+      else
+      {
+        DiscardRead(m_readAhead.front());
+        m_readAhead.pop_front();
+      }
+    }
+
+    if (m_readAhead.empty() && !IssueRead(m_position))
+      break;
+
+    //keep the window full - nothing past the size of the file is read ahead
+    int64_t next = m_readAhead.back()->offset + m_chunkSize;
+    while (m_readAhead.size() < window && next < m_fileSize && IssueRead(next))
+      next += m_chunkSize;
+
+    readRequest *head = m_readAhead.front();
+    if (!head->done && copied > 0)
+      break;//return what we have rather than waiting
+
+    bool ok = true;
+    while (!head->done && ok)
+      ok = WaitForReply();
+
+    if (!ok || head->result < 0)
+    {
+      if (ok)
+        CLog::Log(LOGERROR, "%s - Error( %d, %s )", __FUNCTION__, head->result, gNfsConnection.GetImpl()->nfs_get_error(m_pNfsContext));
+      for (std::deque<readRequest *>::iterator it = m_readAhead.begin(); it != m_readAhead.end(); ++it)
+        DiscardRead(*it);
+      m_readAhead.clear();
+      return copied > 0 ? (int)copied : -1;
+    }
+
+    int64_t available = head->offset + head->result - m_position;
+    if (available <= 0)
+    {
+      //a short read - at the end of the file, unless the server
+      //returned less than asked for, then read on from the position
+      bool eof = head->offset == m_position || m_position >= m_fileSize;
+      for (std::deque<readRequest *>::iterator it = m_readAhead.begin(); it != m_readAhead.end(); ++it)
+        DiscardRead(*it);
+      m_readAhead.clear();
+      if (eof)
+        break;
+      continue;
+    }
+
+    int64_t count = std::min(available, size - copied);
+    memcpy(buffer + copied, &head->data[m_position - head->offset], (size_t)count);
+    copied += count;
+    m_position += count;
+  }
+  return (int)copied;
+}
+
+void CNFSFile::CloseStream()
+{
+  //before taking the stream lock - keep alives are sent holding the keep alive lock
+  gNfsConnection.removeFromKeepAliveList(m_pFileHandle);
+
+  CSingleLock lock(m_streamLock);
+
+  for (std::deque<readRequest *>::iterator it = m_readAhead.begin(); it != m_readAhead.end(); ++it)
+    DiscardRead(*it);
+  m_readAhead.clear();
+
+  //replies still on their way would call back into this file
+  while (m_inFlight > 0 && WaitForReply());
+
+  if (m_pFileHandle != NULL)
+  {
+    CLog::Log(LOGDEBUG,"CNFSFile::Close closing file %s", m_url.GetFileName().c_str());
+    if (gNfsConnection.GetImpl()->nfs_close(m_pNfsContext, m_pFileHandle) < 0)
+    {
+      CLog::Log(LOGERROR, "Failed to close(%s) - %s\n", m_url.GetFileName().c_str(), gNfsConnection.GetImpl()->nfs_get_error(m_pNfsContext));
+    }
+  }
+
+  if (m_rpcs > 0)
+  {
+    float frequency = (float)CurrentHostFrequency();
+    CLog::Log(LOGDEBUG, "NFS: read %"PRIu64" bytes of %s in %"PRIu64" rpcs, %.2f ms per rpc, %.0f kB/s",
+              m_bytesRead, m_url.GetFileName().c_str(), m_rpcs, m_rpcTicks * 1000.0f / frequency / m_rpcs,
+              m_readTicks ? m_bytesRead / 1024.0f / (m_readTicks / frequency) : 0.0f);
+    gNfsConnection.AddReadStats(m_bytesRead, m_rpcs, m_rpcTicks, m_readTicks);
+  }
+
+  if (m_inFlight == 0)
+  {
+    gNfsConnection.ReleaseStreamContext(m_streamKey, m_pNfsContext);
+  }
+  else
+  {
+    //the context is broken - destroying it cancels the rpcs left
+    gNfsConnection.GetImpl()->nfs_destroy_context(m_pNfsContext);
+  }
+
+  m_bStream = false;
+  m_pFileHandle = NULL;
+  m_pNfsContext = NULL;
+  m_fileSize = 0;
+  m_position = 0;
+  m_inFlight = 0;
+  m_bytesRead = 0;
+  m_rpcs = 0;
+  m_rpcTicks = 0;
+  m_readTicks = 0;
+}
+
 bool CNFSFile::IsValidFile(const CStdString& strFileName)
 {
   if (strFileName.Find('/') == -1 || /* doesn't have sharename */
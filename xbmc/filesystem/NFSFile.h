@@ -29,6 +29,8 @@
 #include <list>
 #include "SectionLoader.h"
 #include <map>
+#include <deque>
+#include <vector>
 
 #ifdef TARGET_WINDOWS
 #define S_IRGRP 0
@@ -51,7 +53,14 @@ class DllLibNfs;
 class CNfsConnection : public CCriticalSection
 {     
 public:
-  typedef std::map<struct nfsfh  *, unsigned int> tFileKeepAliveMap;  
+  struct keepAliveTimeout
+  {
+    struct nfs_context *pContext;//context the filehandle belongs to
+    CCriticalSection *pSection;//lock held while the context is used
+    unsigned int refreshCounter;
+  };
+
+  typedef std::map<struct nfsfh  *, struct keepAliveTimeout> tFileKeepAliveMap;
 
   struct contextTimeout
   {
@@ -60,6 +69,7 @@ public:
   };
 
   typedef std::map<std::string, struct contextTimeout> tOpenContextMap;    
+  typedef std::map<std::string, std::list<struct contextTimeout> > tStreamContextMap;
   
   CNfsConnection();
   ~CNfsConnection();
@@ -82,9 +92,23 @@ public:
   void CheckIfIdle();
   void Deinit();
   bool HandleDyLoad();//loads the lib if needed
+  //get a mounted context of its own for reading a file - either an idle one
+  //of the export or a newly mounted one. key is set to the export the
+  //context has to be given back to with ReleaseStreamContext.
+  struct nfs_context *AcquireStreamContext(const CURL &url, CStdString &relativePath, CStdString &key);
+  void ReleaseStreamContext(const CStdString &key, struct nfs_context *pContext);
+
+  //account a closed read stream - bytes read, number of READ rpcs, summed up
+  //rpc round trips and time spent in Read() (host ticks)
+  void AddReadStats(uint64_t bytes, uint64_t rpcs, int64_t rpcTicks, int64_t readTicks);
+  //bytes and READ rpcs of all closed read streams, their average rpc round trip
+  //and the throughput Read() achieved
+  void GetReadStats(uint64_t &bytes, uint64_t &rpcs, float &averageRpcMs, float &throughputKBs);
+
   //adds the filehandle to the keep alive list or resets
-  //the timeout for this filehandle if already in list
-  void resetKeepAlive(struct nfsfh  *_pFileHandle);
+  //the timeout for this filehandle if already in list.
+  //section must not be held by the caller.
+  void resetKeepAlive(struct nfs_context *_pContext, CCriticalSection &section, struct nfsfh  *_pFileHandle);
   //removes file handle from keep alive list
   void removeFromKeepAliveList(struct nfsfh  *_pFileHandle);  
   
@@ -102,17 +126,23 @@ private:
   unsigned int m_IdleTimeout;//timeout for idle connection close and dyunload
   tFileKeepAliveMap m_KeepAliveTimeouts;//mapping filehandles to its idle timeout
   tOpenContextMap m_openContextMap;//unique map for tracking all open contexts
+  tStreamContextMap m_streamContexts;//idle mounted contexts for read streams per export
   uint64_t m_lastAccessedTime;//last access time for m_pNfsContext
   DllLibNfs *m_pLibNfs;//the lib
   std::list<CStdString> m_exportList;//list of exported pathes of current connected servers
   CCriticalSection keepAliveLock;
+  CCriticalSection m_statsLock;
+  uint64_t m_statsBytes;
+  uint64_t m_statsRpcs;
+  int64_t m_statsRpcTicks;
+  int64_t m_statsReadTicks;
  
   void clearMembers();
   struct nfs_context *getContextFromMap(const CStdString &exportname);
   int  getContextForExport(const CStdString &exportname);//get context for given export and add to open contexts map - sets m_pNfsContext (my return a already mounted cached context)
   void destroyOpenContexts();
   void resolveHost(const CURL &url);//resolve hostname by dnslookup
-  void keepAlive(struct nfsfh  *_pFileHandle);
+  void keepAlive(struct nfsfh  *_pFileHandle, const struct keepAliveTimeout &entry);
 };
 
 extern CNfsConnection gNfsConnection;
@@ -143,11 +173,44 @@ namespace XFILE
     virtual bool Delete(const CURL& url);
     virtual bool Rename(const CURL& url, const CURL& urlnew);    
   protected:
+    //a READ of the read ahead window of a stream
+    struct readRequest
+    {
+      CNFSFile *pFile;
+      int64_t offset;
+      int64_t issuedAt;//host counter when the rpc was sent
+      bool done;
+      bool discarded;//dropped by a seek while in flight - freed by the callback
+      int result;//bytes read or a negative error
+      std::vector<char> data;
+    };
+
+    static void ReadCallback(int err, struct nfs_context *nfs, void *data, void *private_data);
+    bool IssueRead(int64_t offset);
+    bool WaitForReply();
+    void DiscardRead(readRequest *request);
+    int ReadStream(char *buffer, int64_t size);
+    void CloseStream();
+
     CURL m_url;
     bool IsValidFile(const CStdString& strFileName);
     int64_t m_fileSize;
     struct nfsfh  *m_pFileHandle;
     struct nfs_context *m_pNfsContext;//current nfs context    
+
+    //files opened for reading are streams on a context of their own,
+    //read with a window of asynchronous READs in flight
+    bool m_bStream;
+    CStdString m_streamKey;//export the stream context is given back to
+    CCriticalSection m_streamLock;//held while m_pNfsContext of a stream is used
+    std::deque<readRequest *> m_readAhead;//requests in file order
+    int64_t m_position;//position of the stream
+    uint64_t m_chunkSize;//size of a READ
+    unsigned int m_inFlight;//requests sent but not answered - including discarded ones
+    uint64_t m_bytesRead;
+    uint64_t m_rpcs;
+    int64_t m_rpcTicks;
+    int64_t m_readTicks;//time spent in Read()
   };
 }
 #endif // FILENFS_H_
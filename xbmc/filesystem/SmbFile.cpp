@@ -38,6 +38,22 @@
 
 using namespace XFILE;
 
+#ifdef DEPRECATED_SMBC_INTERFACE
+#define SMBC_OPEN(context)  smbc_getFunctionOpen(context)
+#define SMBC_READ(context)  smbc_getFunctionRead(context)
+#define SMBC_LSEEK(context) smbc_getFunctionLseek(context)
+#define SMBC_STAT(context)  smbc_getFunctionStat(context)
+#define SMBC_FSTAT(context) smbc_getFunctionFstat(context)
+#define SMBC_CLOSE(context) smbc_getFunctionClose(context)
+#else
+#define SMBC_OPEN(context)  (context)->open
+#define SMBC_READ(context)  (context)->read
+#define SMBC_LSEEK(context) (context)->lseek
+#define SMBC_STAT(context)  (context)->stat
+#define SMBC_FSTAT(context) (context)->fstat
+#define SMBC_CLOSE(context) (context)->close_fn
+#endif
+
 void xb_smbc_log(const char* msg)
 {
   CLog::Log(LOGINFO, "%s%s", "smb: ", msg);
@@ -56,12 +72,53 @@ SMBCSRV* xb_smbc_cache(SMBCCTX* c, const char* server, const char* share, const
   return orig_cache(c, server, share, workgroup, username);
 }
 
+/*! \brief Get the lock a call on a pooled context has to hold
+ Without its thread support libsmbclient isn't safe to call from several threads at once,
+ not even on separate contexts, so then every call is serialised by the CSMB lock.
+ */
+static CCriticalSection &GetCallSection(CSMBContext *context)
+{
+#ifdef HAVE_SMBC_THREAD_POSIX
+  return context->m_section;
+#else
+  return smb;
+#endif
+}
+
+/*! \brief Holds the lock of a pooled context for the duration of a call, and records how long
+ the call waited for the lock and how long it took once it had it.
+ */
+class CSMBCall
+{
+public:
+  CSMBCall(CSMBContext *context)
+    : m_start(CurrentHostCounter()), m_lock(GetCallSection(context)), m_locked(CurrentHostCounter())
+  {
+  }
+
+  ~CSMBCall()
+  {
+    smb.AddCallTimes(m_locked - m_start, CurrentHostCounter() - m_locked);
+  }
+
+private:
+  int64_t     m_start;
+  CSingleLock m_lock;
+  int64_t     m_locked;
+};
+
 CSMB::CSMB()
 {
 #ifdef TARGET_POSIX
   m_IdleTimeout = 0;
 #endif
   m_context = NULL;
+  m_calls = 0;
+  m_waitTicks = 0;
+  m_maxWaitTicks = 0;
+  m_callTicks = 0;
+  m_statsTicks = 0;
+  m_reportedCalls = 0;
 }
 
 CSMB::~CSMB()
@@ -73,6 +130,42 @@ void CSMB::Deinit()
 {
   CSingleLock lock(*this);
 
+  if (!m_pool.empty())
+    LogPoolStats();
+
+  // contexts still leased by open files are kept, they go once a later Deinit finds them idle
+  for (ContextPool::iterator it = m_pool.begin(); it != m_pool.end();)
+  {
+    std::vector<CSMBContext*> leased;
+    for (std::vector<CSMBContext*>::iterator context = it->second.begin(); context != it->second.end(); ++context)
+    {
+      if ((*context)->m_users > 0)
+      {
+        leased.push_back(*context);
+        continue;
+      }
+      try
+      {
+        smbc_free_context((*context)->m_context, 1);
+      }
+      XBMCCOMMONS_HANDLE_UNCHECKED
+      catch(...)
+      {
+        CLog::Log(LOGERROR,"exception on CSMB::Deinit. errno: %d", errno);
+      }
+      delete *context;
+    }
+
+    if (leased.empty())
+      m_pool.erase(it++);
+    else
+    {
+      CLog::Log(LOGDEBUG, "%s - keeping %u contexts that are still in use", __FUNCTION__, (unsigned int)leased.size());
+      it->second.swap(leased);
+      ++it;
+    }
+  }
+
   /* samba goes loco if deinited while it has some files opened */
   if (m_context)
   {
@@ -142,6 +235,17 @@ void CSMB::Init()
     }
 #endif
 
+#ifdef HAVE_SMBC_THREAD_POSIX
+    // the pooled contexts are used from several threads at once, which libsmbclient
+    // only allows once its thread support is set up, before any context is created
+    static bool threadsInitialized = false;
+    if (!threadsInitialized)
+    {
+      smbc_thread_posix();
+      threadsInitialized = true;
+    }
+#endif
+
     // reads smb.conf so this MUST be after we create smb.conf
     // multiple smbc_init calls are ignored by libsmbclient.
     smbc_init(xb_smbc_auth, 0);
@@ -152,29 +256,8 @@ void CSMB::Init()
 #endif
 
     // setup our context
-    m_context = smbc_new_context();
-#ifdef DEPRECATED_SMBC_INTERFACE
-    smbc_setDebug(m_context, g_advancedSettings.m_logLevel == LOG_LEVEL_DEBUG_SAMBA ? 10 : 0);
-    smbc_setFunctionAuthData(m_context, xb_smbc_auth);
-    orig_cache = smbc_getFunctionGetCachedServer(m_context);
-    smbc_setFunctionGetCachedServer(m_context, xb_smbc_cache);
-    smbc_setOptionOneSharePerServer(m_context, false);
-    smbc_setOptionBrowseMaxLmbCount(m_context, 0);
-    smbc_setTimeout(m_context, g_advancedSettings.m_sambaclienttimeout * 1000);
-    smbc_setUser(m_context, strdup("guest"));
-#else
-    m_context->debug = g_advancedSettings.m_logLevel == LOG_LEVEL_DEBUG_SAMBA ? 10 : 0;
-    m_context->callbacks.auth_fn = xb_smbc_auth;
-    orig_cache = m_context->callbacks.get_cached_srv_fn;
-    m_context->callbacks.get_cached_srv_fn = xb_smbc_cache;
-    m_context->options.one_share_per_server = false;
-    m_context->options.browse_max_lmb_count = 0;
-    m_context->timeout = g_advancedSettings.m_sambaclienttimeout * 1000;
-    m_context->user = strdup("guest");
-#endif
-
-    // initialize samba and do some hacking into the settings
-    if (smbc_init_context(m_context))
+    m_context = CreateContext();
+    if (m_context)
     {
       /* setup old interface to use this context */
       smbc_set_context(m_context);
@@ -195,17 +278,133 @@ void CSMB::Init()
         lp_do_parameter( -1, "dos charset", "CP850");
 #endif
     }
-    else
-    {
-      smbc_free_context(m_context, 1);
-      m_context = NULL;
-    }
   }
 #ifdef TARGET_POSIX
   m_IdleTimeout = 180;
 #endif
 }
 
+SMBCCTX *CSMB::CreateContext()
+{
+  SMBCCTX *context = smbc_new_context();
+  if (!context)
+    return NULL;
+
+#ifdef DEPRECATED_SMBC_INTERFACE
+  smbc_setDebug(context, g_advancedSettings.m_logLevel == LOG_LEVEL_DEBUG_SAMBA ? 10 : 0);
+  smbc_setFunctionAuthData(context, xb_smbc_auth);
+  orig_cache = smbc_getFunctionGetCachedServer(context);
+  smbc_setFunctionGetCachedServer(context, xb_smbc_cache);
+  smbc_setOptionOneSharePerServer(context, false);
+  smbc_setOptionBrowseMaxLmbCount(context, 0);
+  smbc_setTimeout(context, g_advancedSettings.m_sambaclienttimeout * 1000);
+  smbc_setUser(context, strdup("guest"));
+#else
+  context->debug = g_advancedSettings.m_logLevel == LOG_LEVEL_DEBUG_SAMBA ? 10 : 0;
+  context->callbacks.auth_fn = xb_smbc_auth;
+  orig_cache = context->callbacks.get_cached_srv_fn;
+  context->callbacks.get_cached_srv_fn = xb_smbc_cache;
+  context->options.one_share_per_server = false;
+  context->options.browse_max_lmb_count = 0;
+  context->timeout = g_advancedSettings.m_sambaclienttimeout * 1000;
+  context->user = strdup("guest");
+#endif
+
+  // initialize samba and do some hacking into the settings
+  if (!smbc_init_context(context))
+  {
+    smbc_free_context(context, 1);
+    return NULL;
+  }
+  return context;
+}
+
+CSMBContext *CSMB::AcquireContext(const CURL &url)
+{
+  Init();
+
+  CSingleLock lock(*this);
+  if (!m_context)
+    return NULL;
+
+#ifdef HAVE_SMBC_THREAD_POSIX
+  // sessions are per server and credentials
+  std::string key = url.GetHostName() + "|" + url.GetDomain() + "|" + url.GetUserName() + "|" + url.GetPassWord();
+  size_t maxContexts = (size_t)g_advancedSettings.m_sambaContextsPerServer;
+#else
+  // calls are serialised by our lock anyway (see GetCallSection), so share a single context
+  std::string key;
+  size_t maxContexts = 1;
+#endif
+  std::vector<CSMBContext*> &contexts = m_pool[key];
+
+  CSMBContext *context = NULL;
+  for (std::vector<CSMBContext*>::iterator it = contexts.begin(); it != contexts.end(); ++it)
+  {
+    if (!context || (*it)->m_users < context->m_users)
+      context = *it;
+  }
+
+  if ((!context || context->m_users > 0) && contexts.size() < maxContexts)
+  {
+    SMBCCTX *created = CreateContext();
+    if (created)
+    {
+      context = new CSMBContext(created);
+      contexts.push_back(context);
+      CLog::Log(LOGDEBUG, "%s - %u contexts for %s", __FUNCTION__, (unsigned int)contexts.size(), url.GetHostName().c_str());
+    }
+  }
+
+  if (context)
+    context->m_users++;
+  return context;
+}
+
+void CSMB::ReleaseContext(CSMBContext *context)
+{
+  CSingleLock lock(*this);
+  if (context && context->m_users > 0)
+    context->m_users--;
+}
+
+void CSMB::AddCallTimes(int64_t wait, int64_t call)
+{
+  CSingleLock lock(m_statsSection);
+  m_calls++;
+  m_waitTicks += wait;
+  m_callTicks += call;
+  if (wait > m_maxWaitTicks)
+    m_maxWaitTicks = wait;
+}
+
+void CSMB::GetPoolStats(unsigned int &contexts, uint64_t &calls, float &averageWaitMs, float &maxWaitMs, float &averageCallMs)
+{
+  {
+    CSingleLock lock(*this);
+    contexts = 0;
+    for (ContextPool::const_iterator it = m_pool.begin(); it != m_pool.end(); ++it)
+      contexts += it->second.size();
+  }
+
+  CSingleLock lock(m_statsSection);
+  float ticksPerMs = CurrentHostFrequency() / 1000.0f;
+  calls = m_calls;
+  averageWaitMs = m_calls ? m_waitTicks / ticksPerMs / m_calls : 0.0f;
+  maxWaitMs = m_maxWaitTicks / ticksPerMs;
+  averageCallMs = m_calls ? m_callTicks / ticksPerMs / m_calls : 0.0f;
+}
+
+void CSMB::LogPoolStats()
+{
+  unsigned int contexts;
+  uint64_t calls;
+  float averageWait, maxWait, averageCall;
+  GetPoolStats(contexts, calls, averageWait, maxWait, averageCall);
+  CLog::Log(LOGDEBUG, "CSMB - %u pooled contexts, %"PRIu64" calls, waited %.2f ms on average (at most %.2f ms), calls took %.2f ms on average",
+            contexts, calls, averageWait, maxWait, averageCall);
+}
+
 void CSMB::Purge()
 {
 #ifdef TARGET_WINDOWS
@@ -296,9 +495,25 @@ DWORD CSMB::ConvertUnixToNT(int error)
 #endif
 
 #ifdef TARGET_POSIX
-/* This is called from CApplication::ProcessSlow() and is used to tell if smbclient have been idle for too long */
+/* This is called every 500ms by the housekeeper (see CApplication::StartHousekeeping()) and is used to tell if smbclient have been idle for too long */
 void CSMB::CheckIfIdle()
 {
+  /* Report the pool once a minute while it is in use */
+  if (++m_statsTicks >= 120)
+  {
+    m_statsTicks = 0;
+    uint64_t calls;
+    {
+      CSingleLock lock(m_statsSection);
+      calls = m_calls;
+    }
+    if (calls != m_reportedCalls)
+    {
+      m_reportedCalls = calls;
+      LogPoolStats();
+    }
+  }
+
 /* We check if there are open connections. This is done without a lock to not halt the mainthread. It should be thread safe as
    worst case scenario is that m_OpenConnections could read 0 and then changed to 1 if this happens it will enter the if wich will lead to another check, wich is locked.  */
   if (m_OpenConnections == 0)
@@ -321,7 +536,7 @@ void CSMB::CheckIfIdle()
 
 void CSMB::SetActivityTime()
 {
-  /* Since we get called every 500ms from ProcessSlow we limit the tick count to 180 */
+  /* Since we get called every 500ms by the housekeeper we limit the tick count to 180 */
   /* That means we have 2 ticks per second which equals 180/2 == 90 seconds */
   m_IdleTimeout = 180;
 }
@@ -349,6 +564,8 @@ CSmbFile::CSmbFile()
 {
   smb.Init();
   m_fd = -1;
+  m_context = NULL;
+  m_file = NULL;
 #ifdef TARGET_POSIX
   smb.AddActiveConnection();
 #endif
@@ -364,10 +581,9 @@ CSmbFile::~CSmbFile()
 
 int64_t CSmbFile::GetPosition()
 {
-  if (m_fd == -1) return 0;
+  if (m_fd == -1 && !m_file) return 0;
   smb.Init();
-  CSingleLock lock(smb);
-  int64_t pos = smbc_lseek(m_fd, 0, SEEK_CUR);
+  int64_t pos = SeekHandle(0, SEEK_CUR);
   if ( pos < 0 )
     return 0;
   return pos;
@@ -375,7 +591,7 @@ int64_t CSmbFile::GetPosition()
 
 int64_t CSmbFile::GetLength()
 {
-  if (m_fd == -1) return 0;
+  if (m_fd == -1 && !m_file) return 0;
   return m_fileSize;
 }
 
@@ -397,10 +613,10 @@ bool CSmbFile::Open(const CURL& url)
   // listed, which will create lot's of open sessions.
 
   CStdString strFileName;
-  m_fd = OpenFile(url, strFileName);
+  bool opened = OpenFile(url, strFileName);
 
-  CLog::Log(LOGDEBUG,"CSmbFile::Open - opened %s, fd=%d",url.GetFileName().c_str(), m_fd);
-  if (m_fd == -1)
+  CLog::Log(LOGDEBUG,"CSmbFile::Open - opened %s, handle=%p",url.GetFileName().c_str(), (void*)m_file);
+  if (!opened)
   {
     // write error to logfile
 #ifdef TARGET_WINDOWS
@@ -412,28 +628,26 @@ bool CSmbFile::Open(const CURL& url)
     return false;
   }
 
-  CSingleLock lock(smb);
 #ifdef TARGET_WINDOWS
   struct __stat64 tmpBuffer = {0};
 #else
   struct stat tmpBuffer;
 #endif
-  if (smbc_stat(strFileName, &tmpBuffer) < 0)
+  bool ok;
   {
-    smbc_close(m_fd);
-    m_fd = -1;
+    CSMBCall call(m_context);
+    SMBCCTX *context = m_context->m_context;
+    ok = SMBC_STAT(context)(context, strFileName.c_str(), &tmpBuffer) >= 0 &&
+         SMBC_LSEEK(context)(context, m_file, 0, SEEK_SET) >= 0;
+  }
+  if (!ok)
+  {
+    Close();
     return false;
   }
 
   m_fileSize = tmpBuffer.st_size;
 
-  int64_t ret = smbc_lseek(m_fd, 0, SEEK_SET);
-  if ( ret < 0 )
-  {
-    smbc_close(m_fd);
-    m_fd = -1;
-    return false;
-  }
   // We've successfully opened the file!
   return true;
 }
@@ -464,23 +678,30 @@ int CSmbFile::OpenFile(CStdString& strAuth)
 }
 */
 
-int CSmbFile::OpenFile(const CURL &url, CStdString& strAuth)
+bool CSmbFile::OpenFile(const CURL &url, CStdString& strAuth)
 {
-  int fd = -1;
-  smb.Init();
+  CURL authURL = GetAuthenticatedURL(url);
+  strAuth = smb.URLEncode(authURL);
 
-  strAuth = GetAuthenticatedPath(url);
-  CStdString strPath = strAuth;
+  // files are read on a context of the pool, so that reads from
+  // different files don't queue up behind each other
+  m_context = smb.AcquireContext(authURL);
+  if (!m_context)
+    return false;
 
   {
-    CSingleLock lock(smb);
-    fd = smbc_open(strPath.c_str(), O_RDONLY, 0);
+    CSMBCall call(m_context);
+    SMBCCTX *context = m_context->m_context;
+    m_file = SMBC_OPEN(context)(context, strAuth.c_str(), O_RDONLY, 0);
   }
 
-  if (fd >= 0)
-    strAuth = strPath;
-
-  return fd;
+  if (!m_file)
+  {
+    smb.ReleaseContext(m_context);
+    m_context = NULL;
+    return false;
+  }
+  return true;
 }
 
 bool CSmbFile::Exists(const CURL& url)
@@ -489,8 +710,8 @@ bool CSmbFile::Exists(const CURL& url)
   // if a file matches the if below return false, it can't exist on a samba share.
   if (!IsValidFile(url.GetFileName())) return false;
 
-  smb.Init();
-  CStdString strFileName = GetAuthenticatedPath(url);
+  CURL authURL = GetAuthenticatedURL(url);
+  CStdString strFileName = smb.URLEncode(authURL);
 
 #ifdef TARGET_WINDOWS
   struct __stat64 info;
@@ -498,8 +719,15 @@ bool CSmbFile::Exists(const CURL& url)
   struct stat info;
 #endif
 
-  CSingleLock lock(smb);
-  int iResult = smbc_stat(strFileName, &info);
+  CSMBContext *context = smb.AcquireContext(authURL);
+  if (!context) return false;
+
+  int iResult;
+  {
+    CSMBCall call(context);
+    iResult = SMBC_STAT(context->m_context)(context->m_context, strFileName.c_str(), &info);
+  }
+  smb.ReleaseContext(context);
 
   if (iResult < 0) return false;
   return true;
@@ -507,7 +735,7 @@ bool CSmbFile::Exists(const CURL& url)
 
 int CSmbFile::Stat(struct __stat64* buffer)
 {
-  if (m_fd == -1)
+  if (m_fd == -1 && !m_file)
     return -1;
 
 #ifdef TARGET_WINDOWS
@@ -516,8 +744,17 @@ int CSmbFile::Stat(struct __stat64* buffer)
   struct stat tmpBuffer = {0};
 #endif
 
-  CSingleLock lock(smb);
-  int iResult = smbc_fstat(m_fd, &tmpBuffer);
+  int iResult;
+  if (m_file)
+  {
+    CSMBCall call(m_context);
+    iResult = SMBC_FSTAT(m_context->m_context)(m_context->m_context, m_file, &tmpBuffer);
+  }
+  else
+  {
+    CSingleLock lock(smb);
+    iResult = smbc_fstat(m_fd, &tmpBuffer);
+  }
 
   memset(buffer, 0, sizeof(struct __stat64));
   buffer->st_dev = tmpBuffer.st_dev;
@@ -537,16 +774,24 @@ int CSmbFile::Stat(struct __stat64* buffer)
 
 int CSmbFile::Stat(const CURL& url, struct __stat64* buffer)
 {
-  smb.Init();
-  CStdString strFileName = GetAuthenticatedPath(url);
-  CSingleLock lock(smb);
+  CURL authURL = GetAuthenticatedURL(url);
+  CStdString strFileName = smb.URLEncode(authURL);
 
 #ifdef TARGET_WINDOWS
   struct __stat64 tmpBuffer = {0};
 #else
   struct stat tmpBuffer = {0};
 #endif
-  int iResult = smbc_stat(strFileName, &tmpBuffer);
+  int iResult = -1;
+  CSMBContext *context = smb.AcquireContext(authURL);
+  if (context)
+  {
+    {
+      CSMBCall call(context);
+      iResult = SMBC_STAT(context->m_context)(context->m_context, strFileName.c_str(), &tmpBuffer);
+    }
+    smb.ReleaseContext(context);
+  }
 
   memset(buffer, 0, sizeof(struct __stat64));
   buffer->st_dev = tmpBuffer.st_dev;
@@ -566,8 +811,8 @@ int CSmbFile::Stat(const CURL& url, struct __stat64* buffer)
 
 unsigned int CSmbFile::Read(void *lpBuf, int64_t uiBufSize)
 {
-  if (m_fd == -1) return 0;
-  CSingleLock lock(smb); // Init not called since it has to be "inited" by now
+  if (m_fd == -1 && !m_file) return 0;
+  // Init not called since it has to be "inited" by now
 #ifdef TARGET_POSIX
   smb.SetActivityTime();
 #endif
@@ -581,12 +826,12 @@ unsigned int CSmbFile::Read(void *lpBuf, int64_t uiBufSize)
   if( uiBufSize >= 64*1024-2 )
     uiBufSize = 64*1024-2;
 
-  int bytesRead = smbc_read(m_fd, lpBuf, (int)uiBufSize);
+  int bytesRead = ReadHandle(lpBuf, (int)uiBufSize);
 
   if ( bytesRead < 0 && errno == EINVAL )
   {
     CLog::Log(LOGERROR, "%s - Error( %d, %d, %s ) - Retrying", __FUNCTION__, bytesRead, errno, strerror(errno));
-    bytesRead = smbc_read(m_fd, lpBuf, (int)uiBufSize);
+    bytesRead = ReadHandle(lpBuf, (int)uiBufSize);
   }
 
   if ( bytesRead < 0 )
@@ -604,13 +849,13 @@ unsigned int CSmbFile::Read(void *lpBuf, int64_t uiBufSize)
 
 int64_t CSmbFile::Seek(int64_t iFilePosition, int iWhence)
 {
-  if (m_fd == -1) return -1;
+  if (m_fd == -1 && !m_file) return -1;
 
-  CSingleLock lock(smb); // Init not called since it has to be "inited" by now
+  // Init not called since it has to be "inited" by now
 #ifdef TARGET_POSIX
   smb.SetActivityTime();
 #endif
-  int64_t pos = smbc_lseek(m_fd, iFilePosition, iWhence);
+  int64_t pos = SeekHandle(iFilePosition, iWhence);
 
   if ( pos < 0 )
   {
@@ -625,8 +870,41 @@ int64_t CSmbFile::Seek(int64_t iFilePosition, int iWhence)
   return (int64_t)pos;
 }
 
+int CSmbFile::ReadHandle(void *lpBuf, int uiBufSize)
+{
+  if (m_file)
+  {
+    CSMBCall call(m_context);
+    return SMBC_READ(m_context->m_context)(m_context->m_context, m_file, lpBuf, uiBufSize);
+  }
+  CSingleLock lock(smb);
+  return smbc_read(m_fd, lpBuf, uiBufSize);
+}
+
+int64_t CSmbFile::SeekHandle(int64_t iFilePosition, int iWhence)
+{
+  if (m_file)
+  {
+    CSMBCall call(m_context);
+    return SMBC_LSEEK(m_context->m_context)(m_context->m_context, m_file, iFilePosition, iWhence);
+  }
+  CSingleLock lock(smb);
+  return smbc_lseek(m_fd, iFilePosition, iWhence);
+}
+
 void CSmbFile::Close()
 {
+  if (m_file)
+  {
+    CLog::Log(LOGDEBUG,"CSmbFile::Close closing handle %p", (void*)m_file);
+    {
+      CSMBCall call(m_context);
+      SMBC_CLOSE(m_context->m_context)(m_context->m_context, m_file);
+    }
+    smb.ReleaseContext(m_context);
+    m_file = NULL;
+    m_context = NULL;
+  }
   if (m_fd != -1)
   {
     CLog::Log(LOGDEBUG,"CSmbFile::Close closing fd %d", m_fd);
@@ -735,9 +1013,14 @@ bool CSmbFile::IsValidFile(const CStdString& strFileName)
   return true;
 }
 
-CStdString CSmbFile::GetAuthenticatedPath(const CURL &url)
+CURL CSmbFile::GetAuthenticatedURL(const CURL &url)
 {
   CURL authURL(url);
   CPasswordManager::GetInstance().AuthenticateURL(authURL);
-  return smb.URLEncode(authURL);
+  return authURL;
+}
+
+CStdString CSmbFile::GetAuthenticatedPath(const CURL &url)
+{
+  return smb.URLEncode(GetAuthenticatedURL(url));
 }
@@ -38,6 +38,10 @@
 
 #endif // _MSC_VER > 1000
 
+#include <map>
+#include <string>
+#include <vector>
+
 #include "IFile.h"
 #include "URL.h"
 #include "threads/CriticalSection.h"
@@ -52,6 +56,23 @@
 
 struct _SMBCCTX;
 typedef _SMBCCTX SMBCCTX;
+struct _SMBCFILE;
+typedef _SMBCFILE SMBCFILE;
+
+/*! \brief A libsmbclient context of the CSMB pool
+ Each context has its own session with the server, so calls on different contexts run in
+ parallel while calls on the same context are serialised by its lock. Where libsmbclient
+ lacks smbc_thread_posix() all calls share a single context under the CSMB lock instead.
+ */
+class CSMBContext
+{
+public:
+  CSMBContext(SMBCCTX *context) : m_context(context), m_users(0) {};
+
+  SMBCCTX         *m_context;
+  CCriticalSection m_section; ///< held for the duration of each call on m_context
+  unsigned int     m_users;   ///< file handles leasing the context, guarded by the CSMB lock
+};
 
 class CSMB : public CCriticalSection
 {
@@ -72,8 +93,43 @@ public:
   CStdString URLEncode(const CURL &url);
 
   DWORD ConvertUnixToNT(int error);
+
+  /*! \brief Lease a pooled context for a server and set of credentials
+   Prefers an idle context, creates another one while there are fewer than
+   samba.contextsperserver for the server and credentials, and otherwise shares the least
+   used one. Without smbc_thread_posix() there is only ever one context.
+   \param url the authenticated url of the file
+   \return the context, or NULL if samba failed to initialize. Give it back with ReleaseContext().
+   */
+  CSMBContext *AcquireContext(const CURL &url);
+  void ReleaseContext(CSMBContext *context);
+
+  /*! \brief Record the time a call waited for its context and the time the call took, in host ticks */
+  void AddCallTimes(int64_t wait, int64_t call);
+
+  /*! \brief Get statistics of the context pool
+   \param contexts [out] number of pooled contexts
+   \param calls [out] number of calls made on pooled contexts
+   \param averageWaitMs [out] average time a call waited for its context
+   \param maxWaitMs [out] longest time a call waited for its context
+   \param averageCallMs [out] average time a call took once it had its context
+   */
+  void GetPoolStats(unsigned int &contexts, uint64_t &calls, float &averageWaitMs, float &maxWaitMs, float &averageCallMs);
 private:
+  static SMBCCTX *CreateContext();
+  void LogPoolStats();
+
+  typedef std::map<std::string, std::vector<CSMBContext*> > ContextPool;
+
   SMBCCTX *m_context;
+  ContextPool m_pool;       ///< pooled contexts keyed by server and credentials
+  CCriticalSection m_statsSection;
+  uint64_t m_calls;
+  int64_t m_waitTicks;
+  int64_t m_maxWaitTicks;
+  int64_t m_callTicks;
+  unsigned int m_statsTicks;    ///< housekeeper ticks since the pool was last reported
+  uint64_t m_reportedCalls;     ///< calls at the last report
   CStdString m_strLastHost;
   CStdString m_strLastShare;
 #ifdef _LINUX
@@ -90,7 +146,7 @@ class CSmbFile : public IFile
 {
 public:
   CSmbFile();
-  int OpenFile(const CURL &url, CStdString& strAuth);
+  bool OpenFile(const CURL &url, CStdString& strAuth);
   virtual ~CSmbFile();
   virtual void Close();
   virtual int64_t Seek(int64_t iFilePosition, int iWhence = SEEK_SET);
@@ -111,9 +167,14 @@ public:
 protected:
   CURL m_url;
   bool IsValidFile(const CStdString& strFileName);
+  CURL GetAuthenticatedURL(const CURL &url);
   CStdString GetAuthenticatedPath(const CURL &url);
+  int ReadHandle(void* lpBuf, int uiBufSize);
+  int64_t SeekHandle(int64_t iFilePosition, int iWhence);
   int64_t m_fileSize;
   int m_fd;
+  CSMBContext *m_context; ///< pooled context of a file opened for reading
+  SMBCFILE *m_file;       ///< handle on m_context of a file opened for reading
 };
 }
 
@@ -40,8 +40,14 @@ using namespace std;
 #define SCROLLING_GAP   200U
 #define SCROLLING_THRESHOLD 300U
 
+// upper bound of layouts kept around for reuse per container
+#define MAX_RECYCLED_LAYOUTS         48
+#define MAX_RECYCLED_FOCUSED_LAYOUTS 4
+
 CGUIBaseContainer::CGUIBaseContainer(int parentID, int controlID, float posX, float posY, float width, float height, ORIENTATION orientation, const CScroller& scroller, int preloadItems)
     : CGUIControl(parentID, controlID, posX, posY, width, height)
+    , m_layoutPool(MAX_RECYCLED_LAYOUTS)
+    , m_focusedLayoutPool(MAX_RECYCLED_FOCUSED_LAYOUTS)
     , m_scroller(scroller)
 {
   m_cursor = 0;
@@ -60,6 +66,12 @@ CGUIBaseContainer::CGUIBaseContainer(int parentID, int controlID, float posX, fl
   m_focusedLayout = NULL;
   m_cacheItems = preloadItems;
   m_scrollItemsPerFrame = 0.0f;
+  m_bindFrames = 0;
+  m_bindCount = 0;
+  m_frameBindCount = 0;
+  m_bindTime = 0;
+  m_frameBindTime = 0;
+  m_maxFrameBindTime = 0;
 }
 
 CGUIBaseContainer::~CGUIBaseContainer(void)
@@ -128,6 +140,7 @@ void CGUIBaseContainer::Process(unsigned int currentTime, CDirtyRegionList &dirt
     current++;
   }
 
+  UpdateLayoutStats();
   UpdatePageControl(offset);
 
   CGUIControl::Process(currentTime, dirtyregions);
@@ -142,12 +155,15 @@ void CGUIBaseContainer::ProcessItem(float posX, float posY, CGUIListItemPtr& ite
 
   if (m_bInvalidated)
     item->SetInvalid();
+
+  // time taken to hand out layouts and fill them with the item's info
+  int64_t bindStart = 0;
   if (focused)
   {
     if (!item->GetFocusedLayout())
     {
-      CGUIListItemLayout *layout = new CGUIListItemLayout(*m_focusedLayout);
-      item->SetFocusedLayout(layout);
+      bindStart = CurrentHostCounter();
+      item->SetFocusedLayout(m_focusedLayoutPool.Acquire(m_focusedLayout));
     }
     if (item->GetFocusedLayout())
     {
@@ -173,8 +189,8 @@ void CGUIBaseContainer::ProcessItem(float posX, float posY, CGUIListItemPtr& ite
       item->GetFocusedLayout()->SetFocusedItem(0);  // focus is not set
     if (!item->GetLayout())
     {
-      CGUIListItemLayout *layout = new CGUIListItemLayout(*m_layout);
-      item->SetLayout(layout);
+      bindStart = CurrentHostCounter();
+      item->SetLayout(m_layoutPool.Acquire(m_layout));
     }
     if (item->GetFocusedLayout())
       item->GetFocusedLayout()->Process(item.get(), m_parentID, currentTime, dirtyregions);
@@ -182,6 +198,12 @@ void CGUIBaseContainer::ProcessItem(float posX, float posY, CGUIListItemPtr& ite
       item->GetLayout()->Process(item.get(), m_parentID, currentTime, dirtyregions);
   }
 
+  if (bindStart)
+  {
+    m_frameBindCount++;
+    m_frameBindTime += CurrentHostCounter() - bindStart;
+  }
+
   g_graphicsContext.RestoreOrigin();
 }
 
@@ -790,6 +812,8 @@ void CGUIBaseContainer::FreeResources(bool immediately)
   { // free any static content
     Reset();
   }
+  m_layoutPool.Clear();
+  m_focusedLayoutPool.Clear();
   m_scroller.Stop();
 }
 
@@ -1068,17 +1092,55 @@ void CGUIBaseContainer::FreeMemory(int keepStart, int keepEnd)
   if (keepStart < keepEnd)
   { // remove before keepStart and after keepEnd
     for (int i = 0; i < keepStart && i < (int)m_items.size(); ++i)
-      m_items[i]->FreeMemory();
+      RecycleLayouts(m_items[i]);
     for (int i = std::max(keepEnd + 1, 0); i < (int)m_items.size(); ++i)
-      m_items[i]->FreeMemory();
+      RecycleLayouts(m_items[i]);
   }
   else
   { // wrapping
     for (int i = std::max(keepEnd + 1, 0); i < keepStart && i < (int)m_items.size(); ++i)
-      m_items[i]->FreeMemory();
+      RecycleLayouts(m_items[i]);
   }
 }
 
+void CGUIBaseContainer::RecycleLayouts(const CGUIListItemPtr &item)
+{
+  CGUIListItemLayout *layout, *focusedLayout;
+  item->DetachLayouts(layout, focusedLayout);
+  m_layoutPool.Release(layout);
+  m_focusedLayoutPool.Release(focusedLayout);
+}
+
+void CGUIBaseContainer::UpdateLayoutStats()
+{
+  if (m_frameBindCount)
+  {
+    m_bindFrames++;
+    m_bindCount += m_frameBindCount;
+    m_bindTime += m_frameBindTime;
+    m_maxFrameBindTime = std::max(m_maxFrameBindTime, m_frameBindTime);
+    m_frameBindCount = 0;
+    m_frameBindTime = 0;
+    return;
+  }
+
+  if (!m_bindFrames)
+    return;
+
+  // the list came to rest, so report what it took to get here
+  double msPerTick = 1000.0 / CurrentHostFrequency();
+  CLog::Log(LOGDEBUG, "%s - container %i bound %u layouts over %u frames (%u allocated, %u recycled in total), %.2f ms/frame, worst %.2f ms",
+            __FUNCTION__, GetID(), m_bindCount, m_bindFrames,
+            m_layoutPool.GetAllocations() + m_focusedLayoutPool.GetAllocations(),
+            m_layoutPool.GetReuses() + m_focusedLayoutPool.GetReuses(),
+            m_bindTime * msPerTick / m_bindFrames, m_maxFrameBindTime * msPerTick);
+
+  m_bindFrames = 0;
+  m_bindCount = 0;
+  m_bindTime = 0;
+  m_maxFrameBindTime = 0;
+}
+
 bool CGUIBaseContainer::InsideLayout(const CGUIListItemLayout *layout, const CPoint &point) const
 {
   if (!layout) return false;
@@ -130,6 +130,8 @@ protected:
   inline float Size() const;
   void MoveToRow(int row);
   void FreeMemory(int keepStart, int keepEnd);
+  void RecycleLayouts(const CGUIListItemPtr &item);
+  void UpdateLayoutStats();
   void GetCurrentLayouts();
   CGUIListItemLayout *GetFocusedLayout() const;
 
@@ -153,6 +155,17 @@ protected:
   CGUIListItemLayout *m_layout;
   CGUIListItemLayout *m_focusedLayout;
 
+  CGUIListItemLayoutPool m_layoutPool;
+  CGUIListItemLayoutPool m_focusedLayoutPool;
+
+  // layout binding stats, accumulated while the list is scrolling
+  unsigned int m_bindFrames;
+  unsigned int m_bindCount;
+  unsigned int m_frameBindCount;
+  int64_t m_bindTime;
+  int64_t m_frameBindTime;
+  int64_t m_maxFrameBindTime;
+
   void ScrollToOffset(int offset);
   void SetContainerMoving(int direction);
   void UpdateScrollOffset(unsigned int currentTime);
@@ -47,12 +47,14 @@ public:
    Replaces any instances of <include file="foo">bar</include> with the value of the include
    "bar" from the include file "foo".
    \param node an XML Element - all child elements are traversed.
+   \param conditional [out] set to true if an include with a condition was met, and so the result
+                      may differ next time. May be NULL.
    */
-  void ResolveIncludes(TiXmlElement *node);
+  void ResolveIncludes(TiXmlElement *node, bool *conditional = NULL);
   const INFO::CSkinVariableString* CreateSkinVariable(const CStdString& name, int context);
 
 private:
-  void ResolveIncludesForNode(TiXmlElement *node);
+  void ResolveIncludesForNode(TiXmlElement *node, bool *conditional);
   CStdString ResolveConstant(const CStdString &constant) const;
   bool HasIncludeFile(const CStdString &includeFile) const;
   std::map<CStdString, TiXmlElement> m_includes;
@@ -24,11 +24,17 @@
 #include "utils/Archive.h"
 #include "utils/CharsetConverter.h"
 #include "utils/Variant.h"
+#include "threads/Atomics.h"
+#include "threads/SharedSection.h"
+
+#include <ctype.h>
 
 using namespace std;
 
 CGUIListItem::CGUIListItem(const CGUIListItem& item)
 {
+  m_sortLabelIsLabel = false;
+  m_sortLabelLock = 0;
   m_layout = NULL;
   m_focusedLayout = NULL;
   *this = item;
@@ -40,6 +46,8 @@ CGUIListItem::CGUIListItem(void)
   m_bIsFolder = false;
   m_strLabel2 = "";
   m_strLabel = "";
+  m_sortLabelIsLabel = false;
+  m_sortLabelLock = 0;
   m_bSelected = false;
   m_strIcon = "";
   m_strThumbnailImage = "";
@@ -53,7 +61,8 @@ CGUIListItem::CGUIListItem(const CStdString& strLabel)
   m_bIsFolder = false;
   m_strLabel2 = "";
   m_strLabel = strLabel;
-  SetSortLabel(strLabel);
+  m_sortLabelIsLabel = true;
+  m_sortLabelLock = 0;
   m_bSelected = false;
   m_strIcon = "";
   m_strThumbnailImage = "";
@@ -71,9 +80,14 @@ void CGUIListItem::SetLabel(const CStdString& strLabel)
 {
   if (m_strLabel == strLabel)
     return;
+  if (m_sortLabelIsLabel)
+  { // the sort label sticks to the first label, so convert it before that goes away
+    g_charsetConverter.utf8ToW(m_strLabel, m_sortLabel, false);
+    m_sortLabelIsLabel = false;
+  }
   m_strLabel = strLabel;
   if (m_sortLabel.IsEmpty())
-    SetSortLabel(strLabel);
+    m_sortLabelIsLabel = true; // converted to UTF16 on first use, most labels never are
   SetInvalid();
 }
 
@@ -99,16 +113,26 @@ const CStdString& CGUIListItem::GetLabel2() const
 void CGUIListItem::SetSortLabel(const CStdString &label)
 {
   g_charsetConverter.utf8ToW(label, m_sortLabel, false);
+  m_sortLabelIsLabel = false;
   // no need to invalidate - this is never shown in the UI
 }
 
 void CGUIListItem::SetSortLabel(const CStdStringW &label)
 {
   m_sortLabel = label;
+  m_sortLabelIsLabel = false;
 }
 
 const CStdStringW& CGUIListItem::GetSortLabel() const
 {
+  // lists are sorted and searched from several threads at once, so only one of them
+  // may do the conversion. Once done the label is left alone until the item changes.
+  CAtomicSpinLock lock(m_sortLabelLock);
+  if (m_sortLabelIsLabel)
+  {
+    g_charsetConverter.utf8ToW(m_strLabel, m_sortLabel, false);
+    m_sortLabelIsLabel = false;
+  }
   return m_sortLabel;
 }
 
@@ -222,7 +246,11 @@ const CGUIListItem& CGUIListItem::operator =(const CGUIListItem& item)
   if (&item == this) return * this;
   m_strLabel2 = item.m_strLabel2;
   m_strLabel = item.m_strLabel;
-  m_sortLabel = item.m_sortLabel;
+  {
+    CAtomicSpinLock lock(item.m_sortLabelLock);
+    m_sortLabel = item.m_sortLabel;
+    m_sortLabelIsLabel = item.m_sortLabelIsLabel;
+  }
   FreeMemory();
   m_bSelected = item.m_bSelected;
   m_strIcon = item.m_strIcon;
@@ -241,7 +269,7 @@ void CGUIListItem::Archive(CArchive &ar)
     ar << m_bIsFolder;
     ar << m_strLabel;
     ar << m_strLabel2;
-    ar << m_sortLabel;
+    ar << GetSortLabel();
     ar << m_strThumbnailImage;
     ar << m_strIcon;
     ar << m_bSelected;
@@ -249,7 +277,7 @@ void CGUIListItem::Archive(CArchive &ar)
     ar << (int)m_mapProperties.size();
     for (PropertyMap::const_iterator it = m_mapProperties.begin(); it != m_mapProperties.end(); it++)
     {
-      ar << it->first;
+      ar << it->first->name;
       ar << it->second;
     }
   }
@@ -259,6 +287,7 @@ void CGUIListItem::Archive(CArchive &ar)
     ar >> m_strLabel;
     ar >> m_strLabel2;
     ar >> m_sortLabel;
+    m_sortLabelIsLabel = false;
     ar >> m_strThumbnailImage;
     ar >> m_strIcon;
     ar >> m_bSelected;
@@ -269,6 +298,7 @@ void CGUIListItem::Archive(CArchive &ar)
 
     int mapSize;
     ar >> mapSize;
+    m_mapProperties.reserve(m_mapProperties.size() + mapSize);
     for (int i = 0; i < mapSize; i++)
     {
       CStdString key;
@@ -284,14 +314,14 @@ void CGUIListItem::Serialize(CVariant &value)
   value["isFolder"] = m_bIsFolder;
   value["strLabel"] = m_strLabel;
   value["strLabel2"] = m_strLabel2;
-  value["sortLabel"] = CStdString(m_sortLabel);
+  value["sortLabel"] = CStdString(GetSortLabel());
   value["strThumbnailImage"] = m_strThumbnailImage;
   value["strIcon"] = m_strIcon;
   value["selected"] = m_bSelected;
 
   for (PropertyMap::const_iterator it = m_mapProperties.begin(); it != m_mapProperties.end(); it++)
   {
-    value["properties"][it->first] = it->second;
+    value["properties"][it->first->name] = it->second;
   }
 }
 
@@ -341,20 +371,82 @@ CGUIListItemLayout *CGUIListItem::GetFocusedLayout()
   return m_focusedLayout;
 }
 
+void CGUIListItem::DetachLayouts(CGUIListItemLayout *&layout, CGUIListItemLayout *&focusedLayout)
+{
+  layout = m_layout;
+  focusedLayout = m_focusedLayout;
+  m_layout = NULL;
+  m_focusedLayout = NULL;
+}
+
 void CGUIListItem::SetInvalid()
 {
   if (m_layout) m_layout->SetInvalid();
   if (m_focusedLayout) m_focusedLayout->SetInvalid();
 }
 
+unsigned int CGUIListItem::HashPropertyKey(const CStdString &key)
+{
+  unsigned int hash = 2166136261u; // FNV-1a over the lower cased key
+  for (const char *c = key.c_str(); *c; ++c)
+    hash = (hash ^ (unsigned char)tolower((unsigned char)*c)) * 16777619u;
+  return hash;
+}
+
+const CGUIListItem::PropertyKey *CGUIListItem::InternPropertyKey(const CStdString &key, unsigned int hash)
+{
+  // keys by exact name. Entries are never removed as items hold on to them, but
+  // there are only a few hundred distinct keys.
+  static CSharedSection section;
+  static map<CStdString, PropertyKey *> keys;
+
+  { // nearly every key has been seen before
+    CSharedLock lock(section);
+    map<CStdString, PropertyKey *>::const_iterator it = keys.find(key);
+    if (it != keys.end())
+      return it->second;
+  }
+
+  CExclusiveLock lock(section);
+  PropertyKey *&interned = keys[key];
+  if (!interned)
+  {
+    interned = new PropertyKey;
+    interned->name = key;
+    interned->hash = hash;
+  }
+  return interned;
+}
+
+CGUIListItem::PropertyMap::iterator CGUIListItem::FindProperty(const CStdString &key, unsigned int hash)
+{
+  PropertyMap::iterator it = m_mapProperties.begin();
+  while (it != m_mapProperties.end() && (it->first->hash != hash || it->first->name.CompareNoCase(key) != 0))
+    ++it;
+  return it;
+}
+
+CGUIListItem::PropertyMap::const_iterator CGUIListItem::FindProperty(const CStdString &key, unsigned int hash) const
+{
+  PropertyMap::const_iterator it = m_mapProperties.begin();
+  while (it != m_mapProperties.end() && (it->first->hash != hash || it->first->name.CompareNoCase(key) != 0))
+    ++it;
+  return it;
+}
+
 void CGUIListItem::SetProperty(const CStdString &strKey, const CVariant &value)
 {
-  m_mapProperties[strKey] = value;
+  unsigned int hash = HashPropertyKey(strKey);
+  PropertyMap::iterator iter = FindProperty(strKey, hash);
+  if (iter != m_mapProperties.end())
+    iter->second = value;
+  else
+    m_mapProperties.push_back(make_pair(InternPropertyKey(strKey, hash), value));
 }
 
 CVariant CGUIListItem::GetProperty(const CStdString &strKey) const
 {
-  PropertyMap::const_iterator iter = m_mapProperties.find(strKey);
+  PropertyMap::const_iterator iter = FindProperty(strKey, HashPropertyKey(strKey));
   if (iter == m_mapProperties.end())
     return CVariant(CVariant::VariantTypeNull);
 
@@ -363,16 +455,17 @@ CVariant CGUIListItem::GetProperty(const CStdString &strKey) const
 
 bool CGUIListItem::HasProperty(const CStdString &strKey) const
 {
-  PropertyMap::const_iterator iter = m_mapProperties.find(strKey);
-  if (iter == m_mapProperties.end())
-    return false;
+  return FindProperty(strKey, HashPropertyKey(strKey)) != m_mapProperties.end();
+}
 
-  return true;
+bool CGUIListItem::HasProperties() const
+{
+  return !m_mapProperties.empty();
 }
 
 void CGUIListItem::ClearProperty(const CStdString &strKey)
 {
-  PropertyMap::iterator iter = m_mapProperties.find(strKey);
+  PropertyMap::iterator iter = FindProperty(strKey, HashPropertyKey(strKey));
   if (iter != m_mapProperties.end())
     m_mapProperties.erase(iter);
 }
@@ -399,5 +492,11 @@ void CGUIListItem::IncrementProperty(const CStdString &strKey, double dVal)
 void CGUIListItem::AppendProperties(const CGUIListItem &item)
 {
   for (PropertyMap::const_iterator i = item.m_mapProperties.begin(); i != item.m_mapProperties.end(); ++i)
-    SetProperty(i->first, i->second);
+  {
+    PropertyMap::iterator iter = FindProperty(i->first->name, i->first->hash);
+    if (iter != m_mapProperties.end())
+      iter->second = i->second;
+    else
+      m_mapProperties.push_back(*i);
+  }
 }
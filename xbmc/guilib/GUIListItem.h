@@ -33,6 +33,7 @@
 
 #include <map>
 #include <string>
+#include <vector>
 
 //  Forward
 class CGUIListItemLayout;
@@ -111,6 +112,12 @@ public:
   void SetFocusedLayout(CGUIListItemLayout *layout);
   CGUIListItemLayout *GetFocusedLayout();
 
+  /*! \brief Hand the layouts over to the caller without freeing them
+   \param layout [out] the normal layout, or NULL
+   \param focusedLayout [out] the focused layout, or NULL
+   */
+  void DetachLayouts(CGUIListItemLayout *&layout, CGUIListItemLayout *&focusedLayout);
+
   void FreeIcons();
   void FreeMemory(bool immediately = false);
   void SetInvalid();
@@ -135,7 +142,7 @@ public:
   void Serialize(CVariant& value);
 
   bool       HasProperty(const CStdString &strKey) const;
-  bool       HasProperties() const { return m_mapProperties.size() > 0; };
+  bool       HasProperties() const;
   void       ClearProperty(const CStdString &strKey);
 
   CVariant   GetProperty(const CStdString &strKey) const;
@@ -150,18 +157,31 @@ protected:
   CGUIListItemLayout *m_focusedLayout;
   bool m_bSelected;     // item is selected or not
 
-  struct icompare
+  /*! \brief A property key shared by all items that use it.
+   Keys are interned once and never change or go away afterwards, so items can
+   hold and read them without locking.
+   */
+  struct PropertyKey
   {
-    bool operator()(const CStdString &s1, const CStdString &s2) const
-    {
-      return s1.CompareNoCase(s2) < 0;
-    }
+    CStdString   name;
+    unsigned int hash;  // case insensitive hash of name
   };
 
-  typedef std::map<CStdString, CVariant, icompare> PropertyMap;
+  /*! \brief Properties keyed case insensitively by interned key.
+   Items rarely carry more than a handful of properties, so a flat vector searched
+   linearly is both smaller and faster than a map.
+   */
+  typedef std::vector< std::pair<const PropertyKey *, CVariant> > PropertyMap;
   PropertyMap m_mapProperties;
+
+  static unsigned int HashPropertyKey(const CStdString &key);
+  static const PropertyKey *InternPropertyKey(const CStdString &key, unsigned int hash);
+  PropertyMap::iterator FindProperty(const CStdString &key, unsigned int hash);
+  PropertyMap::const_iterator FindProperty(const CStdString &key, unsigned int hash) const;
 private:
-  CStdStringW m_sortLabel;    // text for sorting. Need to be UTF16 for proper sorting
+  mutable CStdStringW m_sortLabel;    // text for sorting. Need to be UTF16 for proper sorting
+  mutable bool m_sortLabelIsLabel;    // sort label is m_strLabel and is converted on first use
+  mutable long m_sortLabelLock;       // guards the conversion in GetSortLabel()
   CStdString m_strLabel;      // text of column1
 };
 #endif
@@ -37,6 +37,7 @@ CGUIListItemLayout::CGUIListItemLayout()
   m_condition = 0;
   m_focused = false;
   m_invalidated = true;
+  m_source = NULL;
   m_group.SetPushUpdates(true);
 }
 
@@ -48,6 +49,7 @@ CGUIListItemLayout::CGUIListItemLayout(const CGUIListItemLayout &from)
   m_focused = from.m_focused;
   m_condition = from.m_condition;
   m_invalidated = true;
+  m_source = &from;
 }
 
 CGUIListItemLayout::~CGUIListItemLayout()
@@ -206,6 +208,90 @@ void CGUIListItemLayout::FreeResources(bool immediately)
   m_group.FreeResources(immediately);
 }
 
+void CGUIListItemLayout::Unbind(bool immediately)
+{
+  m_group.FreeResources(immediately);
+  m_group.ResetAnimations();
+  m_group.SetFocusedItem(0);
+  m_invalidated = true;
+}
+
+CGUIListItemLayoutPool::CGUIListItemLayoutPool(unsigned int maxSize)
+{
+  m_template = NULL;
+  m_maxSize = maxSize;
+  m_allocations = 0;
+  m_reuses = 0;
+}
+
+CGUIListItemLayoutPool::CGUIListItemLayoutPool(const CGUIListItemLayoutPool &from)
+{
+  // the free list belongs to the source, so copies start out empty
+  m_template = NULL;
+  m_maxSize = from.m_maxSize;
+  m_allocations = 0;
+  m_reuses = 0;
+}
+
+CGUIListItemLayoutPool &CGUIListItemLayoutPool::operator=(const CGUIListItemLayoutPool &from)
+{
+  if (this != &from)
+  {
+    Clear();
+    m_maxSize = from.m_maxSize;
+  }
+  return *this;
+}
+
+CGUIListItemLayoutPool::~CGUIListItemLayoutPool()
+{
+  Clear();
+}
+
+CGUIListItemLayout *CGUIListItemLayoutPool::Acquire(const CGUIListItemLayout *layoutTemplate)
+{
+  if (layoutTemplate != m_template)
+  {
+    Clear();
+    m_template = layoutTemplate;
+  }
+
+  if (!m_free.empty())
+  {
+    CGUIListItemLayout *layout = m_free.back();
+    m_free.pop_back();
+    m_reuses++;
+    return layout;
+  }
+
+  m_allocations++;
+  return new CGUIListItemLayout(*layoutTemplate);
+}
+
+void CGUIListItemLayoutPool::Release(CGUIListItemLayout *layout, bool immediately)
+{
+  if (!layout)
+    return;
+
+  if (!m_template || layout->GetSource() != m_template || m_free.size() >= m_maxSize)
+  {
+    layout->FreeResources(immediately);
+    delete layout;
+    return;
+  }
+
+  layout->Unbind(immediately);
+  m_free.push_back(layout);
+}
+
+void CGUIListItemLayoutPool::Clear()
+{
+  for (std::vector<CGUIListItemLayout *>::iterator it = m_free.begin(); it != m_free.end(); ++it)
+    delete *it;
+  m_free.clear();
+  m_template = NULL;
+}
+
 #ifdef _DEBUG
 void CGUIListItemLayout::DumpTextureUse()
 {
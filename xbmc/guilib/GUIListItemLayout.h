@@ -46,6 +46,15 @@ public:
   void SetInvalid() { m_invalidated = true; };
   void FreeResources(bool immediately = false);
 
+  /*! \brief Drop resources and per-item state so the layout can be bound to another item
+   \param immediately whether textures should be released immediately
+   */
+  void Unbind(bool immediately = false);
+
+  /*! \brief The layout this one was copied from, or NULL if it was loaded from the skin
+   */
+  const CGUIListItemLayout *GetSource() const { return m_source; };
+
 //#ifdef PRE_SKIN_VERSION_9_10_COMPATIBILITY
   void CreateListControlLayouts(float width, float height, bool focused, const CLabelInfo &labelInfo, const CLabelInfo &labelInfo2, const CTextureInfo &texture, const CTextureInfo &textureFocus, float texHeight, float iconWidth, float iconHeight, const CStdString &nofocusCondition, const CStdString &focusCondition);
 //#endif
@@ -71,5 +80,46 @@ protected:
 
   unsigned int m_condition;
   CGUIInfoBool m_isPlaying;
+
+  const CGUIListItemLayout *m_source;
+};
+
+/*!
+ \ingroup controls
+ \brief Bounded free list of item layouts copied from a single template layout.
+
+ Containers give the layouts of items that have left the cache window back to the
+ pool, and rebind them to items scrolling into view instead of deep copying the
+ template's control tree again. Layouts copied from another template are freed.
+ */
+class CGUIListItemLayoutPool
+{
+public:
+  CGUIListItemLayoutPool(unsigned int maxSize);
+  CGUIListItemLayoutPool(const CGUIListItemLayoutPool &from);
+  CGUIListItemLayoutPool &operator=(const CGUIListItemLayoutPool &from);
+  ~CGUIListItemLayoutPool();
+
+  /*! \brief Get a layout for the given template, reusing a released one if possible
+   \param layoutTemplate the skin layout to copy. Switching templates flushes the pool.
+   \return the layout, owned by the caller until it is released again
+   */
+  CGUIListItemLayout *Acquire(const CGUIListItemLayout *layoutTemplate);
+
+  /*! \brief Give a layout back to the pool, deleting it if it can't be reused
+   */
+  void Release(CGUIListItemLayout *layout, bool immediately = false);
+
+  void Clear();
+
+  unsigned int GetAllocations() const { return m_allocations; };
+  unsigned int GetReuses() const { return m_reuses; };
+
+private:
+  const CGUIListItemLayout *m_template;
+  std::vector<CGUIListItemLayout *> m_free;
+  unsigned int m_maxSize;
+  unsigned int m_allocations;
+  unsigned int m_reuses;
 };
 
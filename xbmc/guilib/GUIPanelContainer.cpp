@@ -90,6 +90,7 @@ void CGUIPanelContainer::Process(unsigned int currentTime, CDirtyRegionList &dir
     current++;
   }
 
+  UpdateLayoutStats();
   UpdatePageControl(offset);
 
   CGUIControl::Process(currentTime, dirtyregions);
@@ -130,7 +130,7 @@ bool CGUITextureBase::AllocateOnDemand()
 {
   if (m_visible)
   { // visible, so make sure we're allocated
-    if (!IsAllocated() || (m_isAllocated == LARGE && !m_texture.size()))
+    if (!IsAllocated() || (m_isAllocated == LARGE && !m_texture.size()) || m_isAllocated == NORMAL_PENDING)
       return AllocResources();
   }
   else
@@ -330,9 +330,14 @@ bool CGUITextureBase::AllocResources()
         m_isAllocated = LARGE_FAILED;
     }
   }
-  else if (!IsAllocated())
+  else if (!IsAllocated() || m_isAllocated == NORMAL_PENDING)
   {
-    int images = g_TextureManager.Load(m_info.filename);
+    int images = g_TextureManager.LoadAsync(m_info.filename, !IsAllocated());
+    if (images < 0)
+    { // still being decoded in the background - we'll check again next frame
+      m_isAllocated = NORMAL_PENDING;
+      return false;
+    }
 
     // set allocated to true even if we couldn't load the image to save
     // us hitting the disk every frame
@@ -462,6 +467,8 @@ void CGUITextureBase::FreeResources(bool immediately /* = false */)
     g_largeTextureManager.ReleaseImage(m_info.filename, immediately || (m_isAllocated == LARGE_FAILED));
   else if (m_isAllocated == NORMAL && m_texture.size())
     g_TextureManager.ReleaseTexture(m_info.filename);
+  else if (m_isAllocated == NORMAL_PENDING)
+    g_TextureManager.CancelLoad(m_info.filename);
 
   if (m_diffuse.size())
     g_TextureManager.ReleaseTexture(m_info.diffuse);
@@ -22,6 +22,7 @@
 #include "system.h"
 #include "GUIWindow.h"
 #include "GUIWindowManager.h"
+#include "GUIWindowXMLCache.h"
 #include "Key.h"
 #include "LocalizeStrings.h"
 #include "GUIControlFactory.h"
@@ -40,6 +41,7 @@
 #include "input/ButtonTranslator.h"
 #include "utils/XMLUtils.h"
 #include "GUIAudioManager.h"
+#include "TextureManager.h"
 #include "Application.h"
 #include "ApplicationMessenger.h"
 #include "utils/Variant.h"
@@ -116,17 +118,17 @@ bool CGUIWindow::Load(const CStdString& strFileName, bool bContainsPath)
 bool CGUIWindow::LoadXML(const CStdString &strPath, const CStdString &strLowerPath)
 {
   CXBMCTinyXML xmlDoc;
-  if ( !xmlDoc.LoadFile(strPath) && !xmlDoc.LoadFile(CStdString(strPath).ToLower()) && !xmlDoc.LoadFile(strLowerPath))
+  if ( !g_windowXMLCache.Get(strPath, xmlDoc) && !g_windowXMLCache.Get(CStdString(strPath).ToLower(), xmlDoc) && !g_windowXMLCache.Get(strLowerPath, xmlDoc))
   {
     CLog::Log(LOGERROR, "unable to load:%s, Line %d\n%s", strPath.c_str(), xmlDoc.ErrorRow(), xmlDoc.ErrorDesc());
     SetID(WINDOW_INVALID);
     return false;
   }
 
-  return Load(xmlDoc);
+  return Load(xmlDoc, true);
 }
 
-bool CGUIWindow::Load(CXBMCTinyXML &xmlDoc)
+bool CGUIWindow::Load(CXBMCTinyXML &xmlDoc, bool includesResolved /* = false */)
 {
   TiXmlElement* pRootElement = xmlDoc.RootElement();
   if (strcmpi(pRootElement->Value(), "window"))
@@ -140,7 +142,8 @@ bool CGUIWindow::Load(CXBMCTinyXML &xmlDoc)
   g_graphicsContext.SetScalingResolution(m_coordsRes, m_needsScaling);
 
   // Resolve any includes that may be present
-  g_SkinInfo->ResolveIncludes(pRootElement);
+  if (!includesResolved)
+    g_SkinInfo->ResolveIncludes(pRootElement);
   // now load in the skin file
   SetDefaults();
 
@@ -674,10 +677,11 @@ void CGUIWindow::AllocResources(bool forceLoad /*= FALSE */)
 {
   CSingleLock lock(g_graphicsContext);
 
-#ifdef _DEBUG
   int64_t start;
   start = CurrentHostCounter();
-#endif
+  unsigned int texturesLoaded, texturesQueued;
+  g_TextureManager.GetLoadStats(texturesLoaded, texturesQueued);
+
   // load skin xml fil
   CStdString xmlFile = GetProperty("xmlfile").asString();
   bool bHasPath=false;
@@ -692,12 +696,14 @@ void CGUIWindow::AllocResources(bool forceLoad /*= FALSE */)
   // and now allocate resources
   CGUIControlGroup::AllocResources();
 
-#ifdef _DEBUG
   int64_t end, freq;
   end = CurrentHostCounter();
   freq = CurrentHostFrequency();
-  CLog::Log(LOGDEBUG,"Alloc resources: %.2fms (%.2f ms skin load)", 1000.f * (end - start) / freq, 1000.f * (slend - start) / freq);
-#endif
+  unsigned int loadedAfter, queuedAfter;
+  g_TextureManager.GetLoadStats(loadedAfter, queuedAfter);
+  CLog::Log(LOGDEBUG,"Alloc resources (%s): %.2fms (%.2f ms skin load, %u textures loaded, %u textures queued)",
+            xmlFile.c_str(), 1000.f * (end - start) / freq, 1000.f * (slend - start) / freq,
+            loadedAfter - texturesLoaded, queuedAfter - texturesQueued);
   m_bAllocated = true;
 }
 
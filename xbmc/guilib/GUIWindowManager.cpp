@@ -26,6 +26,7 @@
 #include "ApplicationMessenger.h"
 #include "GUIPassword.h"
 #include "GUIInfoManager.h"
+#include "GUIWindowXMLCache.h"
 #include "threads/SingleLock.h"
 #include "utils/URIUtils.h"
 #include "settings/GUISettings.h"
@@ -753,6 +754,8 @@ void CGUIWindowManager::SendThreadMessage(CGUIMessage& message)
 
   CGUIMessage* msg = new CGUIMessage(message);
   m_vecThreadMessages.push_back( pair<CGUIMessage*,int>(msg,0) );
+  if (m_pCallback)
+    m_pCallback->OnThreadMessage();
 }
 
 void CGUIWindowManager::SendThreadMessage(CGUIMessage& message, int window)
@@ -761,6 +764,8 @@ void CGUIWindowManager::SendThreadMessage(CGUIMessage& message, int window)
 
   CGUIMessage* msg = new CGUIMessage(message);
   m_vecThreadMessages.push_back( pair<CGUIMessage*,int>(msg,window) );
+  if (m_pCallback)
+    m_pCallback->OnThreadMessage();
 }
 
 void CGUIWindowManager::DispatchThreadMessages()
@@ -850,6 +855,29 @@ bool CGUIWindowManager::IsWindowVisible(const CStdString &xmlFile) const
   return IsWindowActive(xmlFile, false);
 }
 
+void CGUIWindowManager::PreloadWindows(int startWindow)
+{
+  vector<CStdString> paths;
+  CSingleLock lock(g_graphicsContext);
+  for (WindowMap::iterator it = m_mapWindows.begin(); it != m_mapWindows.end(); it++)
+  {
+    CGUIWindow *pWindow = (*it).second;
+    if (pWindow->GetLoadOnDemand() && pWindow->GetID() != startWindow)
+      continue;
+    CStdString xmlFile = pWindow->GetProperty("xmlfile").asString();
+    if (xmlFile.IsEmpty())
+      continue;
+    if (xmlFile.Find("\\") > -1 || xmlFile.Find("/") > -1)
+      paths.push_back(xmlFile);
+    else
+    {
+      RESOLUTION_INFO res;
+      paths.push_back(g_SkinInfo->GetSkinPath(xmlFile, &res));
+    }
+  }
+  g_windowXMLCache.Preload(paths);
+}
+
 void CGUIWindowManager::LoadNotOnDemandWindows()
 {
   CSingleLock lock(g_graphicsContext);
@@ -51,6 +51,10 @@ public:
   bool SendMessage(int message, int senderID, int destID, int param1 = 0, int param2 = 0);
   bool SendMessage(CGUIMessage& message, int window);
   void Initialize();
+  /*! \brief Parse the files of the windows loaded with the skin in the background
+   \param startWindow id of the window that will be shown first
+   */
+  void PreloadWindows(int startWindow);
   void Add(CGUIWindow* pWindow);
   void AddUniqueInstance(CGUIWindow *window);
   void AddCustomWindow(CGUIWindow* pWindow);
@@ -0,0 +1,543 @@
+/*
+ *      Copyright (C) 2005-2012 Team XBMC
+ *      http://www.xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, write to
+ *  the Free Software Foundation, 675 Mass Ave, Cambridge, MA 02139, USA.
+ *  http://www.gnu.org/copyleft/gpl.html
+ *
+ */
+
+
+#include "GUIWindowXMLCache.h"
+#include "addons/Skin.h"
+#include "filesystem/File.h"
+#include "settings/AdvancedSettings.h"
+#include "threads/SingleLock.h"
+#include "utils/Archive.h"
+#include "utils/CPUInfo.h"
+#include "utils/XBMCTinyXML.h"
+#include "utils/log.h"
+
+using namespace std;
+using namespace XFILE;
+
+#define WINDOWXML_CACHE_MAGIC   0x4c4d5857 // "WXML"
+#define WINDOWXML_CACHE_VERSION 1
+
+// nodes nested deeper than this in the binary cache are taken as corruption
+#define WINDOWXML_CACHE_MAX_DEPTH 256
+
+CGUIWindowXMLCache g_windowXMLCache;
+
+namespace
+{
+  /*! \brief A window in the table at the end of the binary cache */
+  class CTableEntry
+  {
+  public:
+    CStdString m_path;
+    int64_t    m_mtime;
+    int64_t    m_size;
+    bool       m_resolved;
+    int64_t    m_start;
+    int64_t    m_end;
+  };
+}
+
+/*
+ * The binary form of a window is its root element with the elements and text below it.
+ * Comments and declarations are dropped, nothing in the GUI looks at them.
+ *
+ *   element: name, attribute count, (name, value) per attribute, child count, children
+ *   child:   'e' followed by an element, or 't' followed by the text and its CDATA flag
+ */
+static void WriteElement(CArchive &ar, const TiXmlElement *element)
+{
+  ar << CStdString(element->Value());
+
+  int count = 0;
+  for (const TiXmlAttribute *attribute = element->FirstAttribute(); attribute; attribute = attribute->Next())
+    count++;
+  ar << count;
+  for (const TiXmlAttribute *attribute = element->FirstAttribute(); attribute; attribute = attribute->Next())
+  {
+    ar << CStdString(attribute->Name());
+    ar << CStdString(attribute->Value());
+  }
+
+  count = 0;
+  for (const TiXmlNode *child = element->FirstChild(); child; child = child->NextSibling())
+  {
+    if (child->ToElement() || child->ToText())
+      count++;
+  }
+  ar << count;
+  for (const TiXmlNode *child = element->FirstChild(); child; child = child->NextSibling())
+  {
+    if (child->ToElement())
+    {
+      ar << 'e';
+      WriteElement(ar, child->ToElement());
+    }
+    else if (child->ToText())
+    {
+      ar << 't';
+      ar << CStdString(child->Value());
+      ar << child->ToText()->CDATA();
+    }
+  }
+}
+
+static bool ReadElement(CArchive &ar, int64_t size, TiXmlElement *element, int depth)
+{
+  if (depth > WINDOWXML_CACHE_MAX_DEPTH)
+    return false;
+
+  CStdString name, value;
+  ar >> name;
+  element->SetValue(name);
+
+  // every attribute and child takes at least a few bytes, so larger counts can't be right
+  int count = 0;
+  ar >> count;
+  if (count < 0 || count > size - ar.GetPosition())
+    return false;
+  for (int i = 0; i < count; i++)
+  {
+    ar >> name;
+    ar >> value;
+    element->SetAttribute(name.c_str(), value.c_str());
+  }
+
+  ar >> count;
+  if (count < 0 || count > size - ar.GetPosition())
+    return false;
+  for (int i = 0; i < count; i++)
+  {
+    char type = 0;
+    ar >> type;
+    if (type == 'e')
+    {
+      TiXmlElement *child = new TiXmlElement("");
+      element->LinkEndChild(child);
+      if (!ReadElement(ar, size, child, depth + 1))
+        return false;
+    }
+    else if (type == 't')
+    {
+      bool cdata = false;
+      ar >> value;
+      ar >> cdata;
+      TiXmlText *text = new TiXmlText(value.c_str());
+      text->SetCDATA(cdata);
+      element->LinkEndChild(text);
+    }
+    else
+      return false;
+  }
+  return ar.GetPosition() <= size;
+}
+
+static bool ReadDocument(const vector<uint8_t> &data, CXBMCTinyXML &doc)
+{
+  if (data.empty())
+    return false;
+
+  CArchive ar(&data[0], data.size());
+  TiXmlElement *root = new TiXmlElement("");
+  doc.Clear();
+  doc.LinkEndChild(root);
+  if (!ReadElement(ar, data.size(), root, 0) || ar.GetPosition() != (int64_t)data.size())
+  {
+    doc.Clear();
+    return false;
+  }
+  return true;
+}
+
+bool CGUIWindowXMLCache::CStamp::Read(const CStdString &path)
+{
+  struct __stat64 buffer;
+  memset(&buffer, 0, sizeof(buffer));
+  if (CFile::Stat(path, &buffer) != 0)
+    return false;
+  m_mtime = buffer.st_mtime;
+  m_size = buffer.st_size;
+  return true;
+}
+
+class CGUIWindowXMLCache::CParseJob : public CJob
+{
+public:
+  CParseJob(const CStdString &path, const CDiskEntry *disk)
+    : m_path(path), m_hasDisk(disk != NULL), m_document(NULL), m_resolved(false), m_stored(false)
+  {
+    if (disk)
+      m_disk = *disk;
+  }
+
+  virtual ~CParseJob()
+  {
+    delete m_document;
+  }
+
+  virtual const char *GetType() const { return "windowxml"; };
+
+  virtual bool DoWork()
+  {
+    m_document = new CXBMCTinyXML;
+    if (!Load(m_path, m_hasDisk ? &m_disk : NULL, *m_document, m_resolved, m_stamp, m_stored))
+    { // leave it for Get() to report
+      delete m_document;
+      m_document = NULL;
+    }
+    return true;
+  }
+
+  CStdString    m_path;
+  CDiskEntry    m_disk;     ///< a copy, the cache may be cleared while the job runs
+  bool          m_hasDisk;
+  CXBMCTinyXML *m_document;
+  bool          m_resolved;
+  CStamp        m_stamp;
+  bool          m_stored;
+};
+
+CGUIWindowXMLCache::CGUIWindowXMLCache()
+  : m_queue(NULL), m_diskLoaded(false), m_sequence(0), m_hits(0), m_misses(0)
+{
+}
+
+CGUIWindowXMLCache::~CGUIWindowXMLCache()
+{
+  // the skin may be gone by now, so don't try to write the binary cache
+  delete m_queue;
+  for (map<CStdString, CEntry>::iterator it = m_entries.begin(); it != m_entries.end(); ++it)
+    delete it->second.m_document;
+}
+
+bool CGUIWindowXMLCache::Load(const CStdString &path, const CDiskEntry *disk, CXBMCTinyXML &doc, bool &resolved, CStamp &stamp, bool &stored)
+{
+  stamp = CStamp();
+  stored = false;
+  resolved = false;
+  if (stamp.Read(path) && disk && disk->m_stamp == stamp && ReadDocument(disk->m_data, doc))
+  {
+    resolved = disk->m_resolved;
+    stored = true;
+    return true;
+  }
+  return doc.LoadFile(path);
+}
+
+void CGUIWindowXMLCache::Preload(const vector<CStdString> &paths)
+{
+  CSingleLock lock(m_section);
+  LoadDiskCache();
+  if (!m_queue)
+    m_queue = new COwnedJobQueue(this, false, max(1, g_cpuInfo.getCPUCount()), CJob::PRIORITY_HIGH);
+
+  for (vector<CStdString>::const_iterator path = paths.begin(); path != paths.end(); ++path)
+  {
+    if (m_pending.find(*path) != m_pending.end() || m_entries.find(*path) != m_entries.end())
+      continue;
+    m_pending.insert(*path);
+    map<CStdString, CDiskEntry>::const_iterator disk = m_disk.find(*path);
+    m_queue->AddJob(new CParseJob(*path, disk != m_disk.end() ? &disk->second : NULL));
+  }
+}
+
+bool CGUIWindowXMLCache::Get(const CStdString &path, CXBMCTinyXML &doc)
+{
+  bool resolved = false;
+  CStamp stamp;
+  {
+    CSingleLock lock(m_section);
+    while (m_pending.find(path) != m_pending.end())
+    {
+      CSingleExit exit(m_section);
+      m_parsedEvent.WaitMSec(100);
+    }
+
+    map<CStdString, CEntry>::iterator it = m_entries.find(path);
+    if (it != m_entries.end())
+    {
+      it->second.m_lastUsed = m_sequence++;
+      doc = *it->second.m_document;
+      resolved = it->second.m_resolved;
+      stamp = it->second.m_stamp;
+      m_hits++;
+      if (resolved)
+        return true;
+    }
+    else
+    {
+      m_misses++;
+      LoadDiskCache();
+      CDiskEntry disk;
+      map<CStdString, CDiskEntry>::const_iterator cached = m_disk.find(path);
+      bool hasDisk = cached != m_disk.end();
+      if (hasDisk)
+        disk = cached->second;
+      lock.Leave();
+
+      bool stored;
+      if (!Load(path, hasDisk ? &disk : NULL, doc, resolved, stamp, stored))
+        return false;
+      Store(path, doc, resolved, stamp, stored);
+      if (resolved)
+        return true;
+    }
+  }
+
+  bool conditional = false;
+  if (g_SkinInfo)
+    g_SkinInfo->ResolveIncludes(doc.RootElement(), &conditional);
+  if (!conditional)
+    Store(path, doc, true, stamp, false);
+  return true;
+}
+
+void CGUIWindowXMLCache::Clear()
+{
+  CSingleLock lock(m_section);
+  // jobs that are already running may still complete, OnParsed() drops them as they're no longer pending
+  if (m_queue)
+    m_queue->CancelJobs();
+
+  SaveDiskCache();
+
+  for (map<CStdString, CEntry>::iterator it = m_entries.begin(); it != m_entries.end(); ++it)
+    delete it->second.m_document;
+  m_entries.clear();
+  m_pending.clear();
+  m_disk.clear();
+  m_diskLoaded = false;
+
+  if (m_hits + m_misses > 0)
+    CLog::Log(LOGDEBUG, "%s - %u of %u window loads were cached", __FUNCTION__, m_hits, m_hits + m_misses);
+  m_hits = 0;
+  m_misses = 0;
+}
+
+void CGUIWindowXMLCache::OnJobComplete(unsigned int jobID, bool success, CJob *job)
+{
+  CParseJob *parseJob = (CParseJob *)job;
+  OnParsed(parseJob->m_path, parseJob->m_document, parseJob->m_resolved, parseJob->m_stamp, parseJob->m_stored);
+  parseJob->m_document = NULL;
+}
+
+void CGUIWindowXMLCache::OnParsed(const CStdString &path, CXBMCTinyXML *document, bool resolved, const CStamp &stamp, bool stored)
+{
+  CSingleLock lock(m_section);
+  if (m_pending.erase(path) && document)
+  {
+    map<CStdString, CEntry>::iterator it = m_entries.find(path);
+    if (it != m_entries.end())
+      delete it->second.m_document;
+    CEntry &entry = m_entries[path];
+    entry.m_document = document;
+    entry.m_resolved = resolved;
+    entry.m_stamp = stamp;
+    entry.m_stored = stored;
+    entry.m_lastUsed = m_sequence++;
+  }
+  else
+    delete document;
+  m_parsedEvent.Set();
+}
+
+void CGUIWindowXMLCache::Store(const CStdString &path, const CXBMCTinyXML &doc, bool resolved, const CStamp &stamp, bool stored)
+{
+  CSingleLock lock(m_section);
+  map<CStdString, CEntry>::iterator it = m_entries.find(path);
+  if (it == m_entries.end())
+  {
+    // make room for it, dropping the least recently used windows
+    while (!m_entries.empty() && m_entries.size() >= (size_t)g_advancedSettings.m_guiWindowXMLCache)
+    {
+      map<CStdString, CEntry>::iterator oldest = m_entries.begin();
+      for (map<CStdString, CEntry>::iterator i = m_entries.begin(); i != m_entries.end(); ++i)
+      {
+        if (i->second.m_lastUsed < oldest->second.m_lastUsed)
+          oldest = i;
+      }
+      delete oldest->second.m_document;
+      m_entries.erase(oldest);
+    }
+    if (g_advancedSettings.m_guiWindowXMLCache <= 0)
+      return;
+    it = m_entries.insert(make_pair(path, CEntry())).first;
+    it->second.m_document = new CXBMCTinyXML;
+  }
+  *it->second.m_document = doc;
+  it->second.m_resolved = resolved;
+  it->second.m_stamp = stamp;
+  it->second.m_stored = stored;
+  it->second.m_lastUsed = m_sequence++;
+}
+
+CStdString CGUIWindowXMLCache::GetDiskCachePath() const
+{
+  return "special://temp/windowxml-" + g_SkinInfo->ID() + ".cache";
+}
+
+CStdString CGUIWindowXMLCache::GetSkinStamp() const
+{
+  // resolved windows hold the includes, so they're only current as long as those are
+  CStamp includes;
+  includes.Read(g_SkinInfo->GetSkinPath("includes.xml"));
+  CStdString stamp;
+  stamp.Format("%s|%s|%"PRId64"|%"PRId64, g_SkinInfo->ID().c_str(), g_SkinInfo->Version().c_str(), includes.m_mtime, includes.m_size);
+  return stamp;
+}
+
+void CGUIWindowXMLCache::LoadDiskCache()
+{
+  if (m_diskLoaded || !g_SkinInfo || g_advancedSettings.m_guiWindowXMLCache <= 0)
+    return;
+  m_diskLoaded = true;
+
+  CFile file;
+  if (!file.Open(GetDiskCachePath()))
+    return;
+  int64_t length = file.GetLength();
+  if (length <= 0 || length > 64 * 1024 * 1024)
+    return;
+  vector<uint8_t> data((size_t)length);
+  if (file.Read(&data[0], data.size()) != data.size())
+    return;
+  file.Close();
+
+  // same layout as the CFileItemList disc cache: documents, then a table of them and a trailer pointing at it
+  static const unsigned int trailerSize = sizeof(int64_t) + sizeof(unsigned int);
+  if (data.size() < trailerSize)
+    return;
+  unsigned int magic = 0;
+  int version = 0;
+  CStdString skin;
+  CArchive header(&data[0], data.size());
+  header >> magic;
+  header >> version;
+  header >> skin;
+  if (magic != WINDOWXML_CACHE_MAGIC || version != WINDOWXML_CACHE_VERSION || skin != GetSkinStamp())
+    return;
+
+  int64_t table = 0;
+  CArchive trailer(&data[data.size() - trailerSize], trailerSize);
+  trailer >> table;
+  trailer >> magic;
+  if (magic != WINDOWXML_CACHE_MAGIC || table < header.GetPosition() || table > (int64_t)(data.size() - trailerSize))
+    return;
+
+  int64_t tableSize = data.size() - trailerSize - table;
+  CArchive tableAr(&data[(size_t)table], (unsigned int)tableSize);
+  int count = 0;
+  tableAr >> count;
+  if (count < 0 || count > tableSize)
+    return;
+  for (int i = 0; i < count; i++)
+  {
+    CTableEntry entry;
+    tableAr >> entry.m_path;
+    tableAr >> entry.m_mtime;
+    tableAr >> entry.m_size;
+    tableAr >> entry.m_resolved;
+    tableAr >> entry.m_start;
+    tableAr >> entry.m_end;
+    if (tableAr.GetPosition() > tableSize || entry.m_start < header.GetPosition() || entry.m_end < entry.m_start || entry.m_end > table)
+    {
+      m_disk.clear();
+      return;
+    }
+    CDiskEntry &disk = m_disk[entry.m_path];
+    disk.m_stamp.m_mtime = entry.m_mtime;
+    disk.m_stamp.m_size = entry.m_size;
+    disk.m_resolved = entry.m_resolved;
+    disk.m_data.assign(data.begin() + (size_t)entry.m_start, data.begin() + (size_t)entry.m_end);
+  }
+  CLog::Log(LOGDEBUG, "%s - %u windows in the cache of %s", __FUNCTION__, (unsigned int)m_disk.size(), g_SkinInfo->ID().c_str());
+}
+
+void CGUIWindowXMLCache::SaveDiskCache()
+{
+  // nothing to do unless windows were loaded from their files since the cache was read
+  bool changed = false;
+  for (map<CStdString, CEntry>::const_iterator it = m_entries.begin(); it != m_entries.end() && !changed; ++it)
+    changed = !it->second.m_stored && it->second.m_stamp.m_mtime != 0;
+  if (!changed || !g_SkinInfo || g_advancedSettings.m_guiWindowXMLCache <= 0)
+    return;
+
+  CFile file;
+  if (!file.OpenForWrite(GetDiskCachePath(), true))
+    return;
+
+  CArchive ar(&file, CArchive::store);
+  ar << (unsigned int)WINDOWXML_CACHE_MAGIC;
+  ar << (int)WINDOWXML_CACHE_VERSION;
+  ar << GetSkinStamp();
+
+  // windows loaded in this session, and those of the old cache that weren't
+  vector<CTableEntry> table;
+  for (map<CStdString, CEntry>::const_iterator it = m_entries.begin(); it != m_entries.end(); ++it)
+  {
+    const CXBMCTinyXML &doc = *it->second.m_document;
+    if (it->second.m_stamp.m_mtime == 0 || !doc.RootElement())
+      continue;
+    CTableEntry entry;
+    entry.m_path = it->first;
+    entry.m_mtime = it->second.m_stamp.m_mtime;
+    entry.m_size = it->second.m_stamp.m_size;
+    entry.m_resolved = it->second.m_resolved;
+    entry.m_start = ar.GetPosition();
+    WriteElement(ar, doc.RootElement());
+    entry.m_end = ar.GetPosition();
+    table.push_back(entry);
+  }
+  for (map<CStdString, CDiskEntry>::const_iterator it = m_disk.begin(); it != m_disk.end(); ++it)
+  {
+    if (m_entries.find(it->first) != m_entries.end() || it->second.m_data.empty())
+      continue;
+    CTableEntry entry;
+    entry.m_path = it->first;
+    entry.m_mtime = it->second.m_stamp.m_mtime;
+    entry.m_size = it->second.m_stamp.m_size;
+    entry.m_resolved = it->second.m_resolved;
+    entry.m_start = ar.GetPosition();
+    for (vector<uint8_t>::const_iterator c = it->second.m_data.begin(); c != it->second.m_data.end(); ++c)
+      ar << (char)*c;
+    entry.m_end = ar.GetPosition();
+    table.push_back(entry);
+  }
+
+  int64_t tablePosition = ar.GetPosition();
+  ar << (int)table.size();
+  for (vector<CTableEntry>::const_iterator it = table.begin(); it != table.end(); ++it)
+  {
+    ar << it->m_path;
+    ar << it->m_mtime;
+    ar << it->m_size;
+    ar << it->m_resolved;
+    ar << it->m_start;
+    ar << it->m_end;
+  }
+
+  // the trailer is written last, so a cache that wasn't finished is never loaded
+  ar << tablePosition;
+  ar << (unsigned int)WINDOWXML_CACHE_MAGIC;
+  ar.Close();
+  file.Close();
+  CLog::Log(LOGDEBUG, "%s - wrote %u windows to the cache of %s", __FUNCTION__, (unsigned int)table.size(), g_SkinInfo->ID().c_str());
+}
@@ -0,0 +1,135 @@
+#pragma once
+/*
+ *      Copyright (C) 2005-2012 Team XBMC
+ *      http://www.xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, write to
+ *  the Free Software Foundation, 675 Mass Ave, Cambridge, MA 02139, USA.
+ *  http://www.gnu.org/copyleft/gpl.html
+ *
+ */
+
+
+#include <map>
+#include <set>
+#include <vector>
+
+#include "threads/CriticalSection.h"
+#include "threads/Event.h"
+#include "utils/JobManager.h"
+#include "utils/StdString.h"
+
+class CXBMCTinyXML;
+
+/*! \brief Keeps the XML of recently loaded windows of the current skin
+ Window files can be parsed ahead of time, several at once, so that the ones loaded at startup
+ are ready when the GUI thread gets to them. Windows are kept with their includes resolved,
+ unless resolving them met a conditional include, in which case they are kept as parsed and
+ resolved again on each load. At most gui.windowxmlcache windows are kept, the least recently
+ used being dropped first.
+
+ The windows are also written to a binary cache in special://temp when the skin is unloaded,
+ keyed by the skin's version and includes and by each window file's modification time, so
+ later boots don't parse the XML at all.
+ */
+class CGUIWindowXMLCache : public IJobCallback
+{
+public:
+  CGUIWindowXMLCache();
+  ~CGUIWindowXMLCache();
+
+  /*! \brief Parse window files in the background
+   \param paths paths to the window files
+   */
+  void Preload(const std::vector<CStdString> &paths);
+
+  /*! \brief Get a window file with its includes resolved, waiting for it if it's being preloaded
+   Must be called from the GUI thread, as resolving includes may evaluate conditions.
+   \param path path to the window file
+   \param doc [out] the window, or the parse error if it couldn't be loaded
+   \return true if the window was loaded, false otherwise
+   */
+  bool Get(const CStdString &path, CXBMCTinyXML &doc);
+
+  /*! \brief Cancel any preloads, write the binary cache and drop all windows, e.g. on changing skin */
+  void Clear();
+
+  virtual void OnJobComplete(unsigned int jobID, bool success, CJob *job);
+
+private:
+  class CParseJob;
+
+  /*! \brief Modification time and size of a window file */
+  class CStamp
+  {
+  public:
+    CStamp() : m_mtime(0), m_size(0) {};
+    bool operator==(const CStamp &stamp) const { return m_mtime == stamp.m_mtime && m_size == stamp.m_size; };
+    bool operator!=(const CStamp &stamp) const { return !(*this == stamp); };
+    bool Read(const CStdString &path);
+    int64_t m_mtime;
+    int64_t m_size;
+  };
+
+  class CEntry
+  {
+  public:
+    CXBMCTinyXML *m_document;
+    bool          m_resolved; ///< includes have been resolved in m_document
+    CStamp        m_stamp;    ///< of the window file m_document was loaded from
+    bool          m_stored;   ///< m_document is as it is in the binary cache
+    unsigned int  m_lastUsed;
+  };
+
+  /*! \brief A window in the binary cache */
+  class CDiskEntry
+  {
+  public:
+    CStamp              m_stamp;
+    bool                m_resolved;
+    std::vector<uint8_t> m_data;     ///< the serialized document
+  };
+
+  /*! \brief Load a window from its serialized document if that is current, or from its file
+   \param path path to the window file
+   \param disk the window in the binary cache, or NULL if it isn't in there
+   \param doc [out] the window
+   \param resolved [out] whether doc has its includes resolved
+   \param stamp [out] stamp of the window file
+   \param stored [out] whether doc came from the binary cache
+   \return true if the window was loaded, false otherwise
+   */
+  static bool Load(const CStdString &path, const CDiskEntry *disk, CXBMCTinyXML &doc, bool &resolved, CStamp &stamp, bool &stored);
+
+  void OnParsed(const CStdString &path, CXBMCTinyXML *document, bool resolved, const CStamp &stamp, bool stored);
+  void Store(const CStdString &path, const CXBMCTinyXML &doc, bool resolved, const CStamp &stamp, bool stored);
+
+  CStdString GetDiskCachePath() const;
+  CStdString GetSkinStamp() const;
+  void LoadDiskCache();
+  void SaveDiskCache();
+
+  CCriticalSection                    m_section;
+  CEvent                              m_parsedEvent;
+  COwnedJobQueue                     *m_queue;   ///< created on first use, lives as long as the cache
+  std::set<CStdString>                m_pending; ///< windows queued or being parsed
+  std::map<CStdString, CEntry>        m_entries;
+  std::map<CStdString, CDiskEntry>    m_disk;    ///< windows of the binary cache of the current skin
+  bool                                m_diskLoaded;
+  unsigned int                        m_sequence;
+  unsigned int                        m_hits;
+  unsigned int                        m_misses;
+};
+
+extern CGUIWindowXMLCache g_windowXMLCache;
@@ -39,4 +39,6 @@ public:
   virtual void FrameMove(bool processEvents, bool processGUI = true) = 0;
   virtual void Render() = 0;
   virtual void Process() = 0;
+  /*! \brief Called from any thread when a GUI message has been queued for the GUI thread */
+  virtual void OnThreadMessage() = 0;
 };
@@ -27,7 +27,22 @@
 #include "utils/XMLUtils.h"
 #include "utils/URIUtils.h"
 #include "utils/POUtils.h"
+#include "utils/Archive.h"
+#include "utils/Crc32.h"
 #include "filesystem/Directory.h"
+#include "filesystem/File.h"
+
+#define STRINGS_CACHE_MAGIC   0x53544258 // "XBTS"
+#define STRINGS_CACHE_VERSION 1
+
+static CStdString GetCompiledPath(const CStdString &filename)
+{
+  Crc32 crc;
+  crc.ComputeFromLowerCase(filename);
+  CStdString path;
+  path.Format("special://temp/str-%08x.bin", (unsigned __int32)crc);
+  return path;
+}
 
 CLocalizeStrings::CLocalizeStrings(void)
 {
@@ -70,6 +85,7 @@ bool CLocalizeStrings::LoadSkinStrings(const CStdString& path, const CStdString&
   if (!language.Equals(SOURCE_LANGUAGE))
     LoadStr2Mem(path, SOURCE_LANGUAGE, encoding);
 
+  ClearOriginals();
   return true;
 }
 
@@ -97,51 +113,69 @@ bool CLocalizeStrings::LoadStr2Mem(const CStdString &pathname_in, const CStdStri
 bool CLocalizeStrings::LoadPO(const CStdString &filename, CStdString &encoding,
                               uint32_t offset /* = 0 */, bool bSourceLanguage)
 {
-  CPODocument PODoc;
-  if (!PODoc.LoadFile(filename))
-    return false;
-
-  int counter = 0;
-
-  while ((PODoc.GetNextEntry()))
+  std::vector<LocEntry> entries;
+  CStdString poEncoding;
+  if (!LoadCompiled(filename, poEncoding, entries))
   {
-    uint32_t id;
-    if (PODoc.GetEntryType() == ID_FOUND)
-    {
-      bool bStrInMem = m_strings.find((id = PODoc.GetEntryID()) + offset) != m_strings.end();
-      PODoc.ParseEntry(bSourceLanguage);
+    CPODocument PODoc;
+    if (!PODoc.LoadFile(filename))
+      return false;
 
-      if (bSourceLanguage && !PODoc.GetMsgid().empty())
+    while ((PODoc.GetNextEntry()))
+    {
+      if (PODoc.GetEntryType() == ID_FOUND)
       {
-        if (bStrInMem && (m_strings[id + offset].strOriginal.IsEmpty() ||
-            PODoc.GetMsgid() == m_strings[id + offset].strOriginal))
-          continue;
-        else if (bStrInMem)
-          CLog::Log(LOGDEBUG,
-                    "POParser: id:%i was recently re-used in the English string file, which is not yet "
-                    "changed in the translated file. Using the English string instead", id);
-        m_strings[id + offset].strTranslated = PODoc.GetMsgid();
-        counter++;
+        // parse both strings, so the table serves the file whether or not it's the source language
+        LocEntry entry;
+        entry.id = PODoc.GetEntryID();
+        PODoc.ParseEntry(false);
+        entry.msgid = PODoc.GetMsgid();
+        entry.msgstr = PODoc.GetMsgstr();
+        entries.push_back(entry);
       }
-      else if (!bSourceLanguage && !bStrInMem && !PODoc.GetMsgstr().empty())
+      else if (PODoc.GetEntryType() == MSGID_FOUND)
       {
-        m_strings[id + offset].strTranslated = PODoc.GetMsgstr();
-        m_strings[id + offset].strOriginal = PODoc.GetMsgid();
-        counter++;
+        // TODO: implement reading of non-id based string entries from the PO files.
+        // These entries would go into a separate memory map, using hash codes for fast look-up.
+        // With this memory map we can implement using gettext(), ngettext(), pgettext() calls,
+        // so that we don't have to use new IDs for new strings. Even we can start converting
+        // the ID based calls to normal gettext calls.
+      }
+      else if (PODoc.GetEntryType() == MSGID_PLURAL_FOUND)
+      {
+        // TODO: implement reading of non-id based pluralized string entries from the PO files.
+        // We can store the pluralforms for each language, in the langinfo.xml files.
       }
     }
-    else if (PODoc.GetEntryType() == MSGID_FOUND)
+    SaveCompiled(filename, poEncoding, entries);
+  }
+
+  int counter = 0;
+
+  for (std::vector<LocEntry>::const_iterator it = entries.begin(); it != entries.end(); ++it)
+  {
+    uint32_t id = it->id + offset;
+    bool bStrInMem = m_strings.find(id) != m_strings.end();
+
+    if (bSourceLanguage && !it->msgid.empty())
     {
-      // TODO: implement reading of non-id based string entries from the PO files.
-      // These entries would go into a separate memory map, using hash codes for fast look-up.
-      // With this memory map we can implement using gettext(), ngettext(), pgettext() calls,
-      // so that we don't have to use new IDs for new strings. Even we can start converting
-      // the ID based calls to normal gettext calls.
+      if (bStrInMem)
+      {
+        ciStrings original = m_originals.find(id);
+        if (original == m_originals.end() || original->second.IsEmpty() || it->msgid == original->second)
+          continue;
+        CLog::Log(LOGDEBUG,
+                  "POParser: id:%i was recently re-used in the English string file, which is not yet "
+                  "changed in the translated file. Using the English string instead", it->id);
+      }
+      m_strings[id] = it->msgid;
+      counter++;
     }
-    else if (PODoc.GetEntryType() == MSGID_PLURAL_FOUND)
+    else if (!bSourceLanguage && !bStrInMem && !it->msgstr.empty())
     {
-      // TODO: implement reading of non-id based pluralized string entries from the PO files.
-      // We can store the pluralforms for each language, in the langinfo.xml files.
+      m_strings[id] = it->msgstr;
+      m_originals[id] = it->msgid;
+      counter++;
     }
   }
 
@@ -151,39 +185,150 @@ bool CLocalizeStrings::LoadPO(const CStdString &filename, CStdString &encoding,
 
 bool CLocalizeStrings::LoadXML(const CStdString &filename, CStdString &encoding, uint32_t offset /* = 0 */)
 {
-  CXBMCTinyXML xmlDoc;
-  if (!xmlDoc.LoadFile(filename))
+  std::vector<LocEntry> entries;
+  if (!LoadCompiled(filename, encoding, entries))
   {
-    CLog::Log(LOGDEBUG, "unable to load %s: %s at line %d", filename.c_str(), xmlDoc.ErrorDesc(), xmlDoc.ErrorRow());
-    return false;
-  }
+    CXBMCTinyXML xmlDoc;
+    if (!xmlDoc.LoadFile(filename))
+    {
+      CLog::Log(LOGDEBUG, "unable to load %s: %s at line %d", filename.c_str(), xmlDoc.ErrorDesc(), xmlDoc.ErrorRow());
+      return false;
+    }
 
-  XMLUtils::GetEncoding(&xmlDoc, encoding);
+    XMLUtils::GetEncoding(&xmlDoc, encoding);
+
+    TiXmlElement* pRootElement = xmlDoc.RootElement();
+    if (!pRootElement || pRootElement->NoChildren() ||
+         pRootElement->ValueStr()!=CStdString("strings"))
+    {
+      CLog::Log(LOGERROR, "%s Doesn't contain <strings>", filename.c_str());
+      return false;
+    }
 
-  TiXmlElement* pRootElement = xmlDoc.RootElement();
-  if (!pRootElement || pRootElement->NoChildren() ||
-       pRootElement->ValueStr()!=CStdString("strings"))
+    const TiXmlElement *pChild = pRootElement->FirstChildElement("string");
+    while (pChild)
+    {
+      // Load old style language file with id as attribute
+      const char* attrId=pChild->Attribute("id");
+      if (attrId && !pChild->NoChildren())
+      {
+        LocEntry entry;
+        entry.id = atoi(attrId);
+        entry.msgstr = ToUTF8(encoding, pChild->FirstChild()->Value());
+        entries.push_back(entry);
+      }
+      pChild = pChild->NextSiblingElement("string");
+    }
+    SaveCompiled(filename, encoding, entries);
+  }
+
+  for (std::vector<LocEntry>::const_iterator it = entries.begin(); it != entries.end(); ++it)
   {
-    CLog::Log(LOGERROR, "%s Doesn't contain <strings>", filename.c_str());
-    return false;
+    uint32_t id = it->id + offset;
+    if (m_strings.find(id) == m_strings.end())
+      m_strings[id] = it->msgstr;
   }
+  return true;
+}
+
+bool CLocalizeStrings::LoadCompiled(const CStdString &filename, CStdString &encoding, std::vector<LocEntry> &entries)
+{
+  struct __stat64 st;
+  if (XFILE::CFile::Stat(filename, &st) != 0)
+    return false;
 
-  const TiXmlElement *pChild = pRootElement->FirstChildElement("string");
-  while (pChild)
+  // read the whole table in one go and decode it from memory
+  XFILE::CFile file;
+  if (!file.Open(GetCompiledPath(filename)))
+    return false;
+  std::vector<uint8_t> data;
+  int64_t length = file.GetLength();
+  if (length > 0 && length < INT_MAX)
   {
-    // Load old style language file with id as attribute
-    const char* attrId=pChild->Attribute("id");
-    if (attrId && !pChild->NoChildren())
+    data.resize((size_t)length);
+    unsigned int read = 0;
+    while (read < data.size())
     {
-      int id = atoi(attrId) + offset;
-      if (m_strings.find(id) == m_strings.end())
-        m_strings[id].strTranslated = ToUTF8(encoding, pChild->FirstChild()->Value());
+      unsigned int chunk = file.Read(&data[read], data.size() - read);
+      if (chunk == 0 || chunk > data.size() - read)
+        break;
+      read += chunk;
     }
-    pChild = pChild->NextSiblingElement("string");
+    data.resize(read);
+  }
+  file.Close();
+
+  // the table ends with its magic, so a table cut short by a crash isn't used
+  static const unsigned int trailerSize = sizeof(unsigned int);
+  if (data.size() < 2 * sizeof(unsigned int) + trailerSize)
+    return false;
+  unsigned int magic = 0;
+  CArchive trailer(&data[data.size() - trailerSize], trailerSize);
+  trailer >> magic;
+  if (magic != STRINGS_CACHE_MAGIC)
+    return false;
+
+  int version = 0;
+  int64_t mtime = 0, size = 0;
+  CStdString source;
+  CArchive ar(&data[0], data.size() - trailerSize);
+  ar >> magic;
+  ar >> version;
+  if (magic != STRINGS_CACHE_MAGIC || version != STRINGS_CACHE_VERSION)
+    return false;
+  ar >> source;
+  ar >> mtime;
+  ar >> size;
+  if (source != filename || mtime != (int64_t)st.st_mtime || size != (int64_t)st.st_size)
+    return false;
+
+  unsigned int count = 0;
+  ar >> encoding;
+  ar >> count;
+  // each entry takes at least its id and the lengths of both strings, so a larger count is corrupt
+  static const unsigned int minEntrySize = sizeof(uint32_t) + 2 * sizeof(int);
+  int64_t remaining = (int64_t)(data.size() - trailerSize) - ar.GetPosition();
+  if (remaining < 0 || count > remaining / minEntrySize)
+    return false;
+  entries.resize(count);
+  for (unsigned int i = 0; i < count; i++)
+  {
+    ar >> entries[i].id;
+    ar >> entries[i].msgid;
+    ar >> entries[i].msgstr;
   }
   return true;
 }
 
+void CLocalizeStrings::SaveCompiled(const CStdString &filename, const CStdString &encoding, const std::vector<LocEntry> &entries)
+{
+  struct __stat64 st;
+  if (XFILE::CFile::Stat(filename, &st) != 0)
+    return;
+
+  XFILE::CFile file;
+  if (!file.OpenForWrite(GetCompiledPath(filename), true))
+    return;
+
+  CArchive ar(&file, CArchive::store);
+  ar << (unsigned int)STRINGS_CACHE_MAGIC;
+  ar << (int)STRINGS_CACHE_VERSION;
+  ar << filename;
+  ar << (int64_t)st.st_mtime;
+  ar << (int64_t)st.st_size;
+  ar << encoding;
+  ar << (unsigned int)entries.size();
+  for (std::vector<LocEntry>::const_iterator it = entries.begin(); it != entries.end(); ++it)
+  {
+    ar << (unsigned int)it->id;
+    ar << it->msgid;
+    ar << it->msgstr;
+  }
+  ar << (unsigned int)STRINGS_CACHE_MAGIC;
+  ar.Close();
+  file.Close();
+}
+
 bool CLocalizeStrings::Load(const CStdString& strPathName, const CStdString& strLanguage)
 {
   bool bLoadFallback = !strLanguage.Equals(SOURCE_LANGUAGE);
@@ -202,34 +347,35 @@ bool CLocalizeStrings::Load(const CStdString& strPathName, const CStdString& str
 
   if (bLoadFallback)
     LoadStr2Mem(strPathName, SOURCE_LANGUAGE, encoding);
+  ClearOriginals();
 
   CStdString encoding_thisfile = "ISO-8859-1";
   // we have ANSI encoding for LocalizeStrings.cpp therefore we need to use this encoding
   // when we add the degree strings
 
   // fill in the constant strings
-  m_strings[20022].strTranslated = "";
-  m_strings[20027].strTranslated = ToUTF8(encoding_thisfile, "F");
-  m_strings[20028].strTranslated = ToUTF8(encoding_thisfile, "K");
-  m_strings[20029].strTranslated = ToUTF8(encoding_thisfile, "C");
-  m_strings[20030].strTranslated = ToUTF8(encoding_thisfile, "R");
-  m_strings[20031].strTranslated = ToUTF8(encoding_thisfile, "Ra");
-  m_strings[20032].strTranslated = ToUTF8(encoding_thisfile, "R");
-  m_strings[20033].strTranslated = ToUTF8(encoding_thisfile, "De");
-  m_strings[20034].strTranslated = ToUTF8(encoding_thisfile, "N");
-
-  m_strings[20200].strTranslated = ToUTF8(encoding_thisfile, "km/h");
-  m_strings[20201].strTranslated = ToUTF8(encoding_thisfile, "m/min");
-  m_strings[20202].strTranslated = ToUTF8(encoding_thisfile, "m/s");
-  m_strings[20203].strTranslated = ToUTF8(encoding_thisfile, "ft/h");
-  m_strings[20204].strTranslated = ToUTF8(encoding_thisfile, "ft/min");
-  m_strings[20205].strTranslated = ToUTF8(encoding_thisfile, "ft/s");
-  m_strings[20206].strTranslated = ToUTF8(encoding_thisfile, "mph");
-  m_strings[20207].strTranslated = ToUTF8(encoding_thisfile, "kts");
-  m_strings[20208].strTranslated = ToUTF8(encoding_thisfile, "Beaufort");
-  m_strings[20209].strTranslated = ToUTF8(encoding_thisfile, "inch/s");
-  m_strings[20210].strTranslated = ToUTF8(encoding_thisfile, "yard/s");
-  m_strings[20211].strTranslated = ToUTF8(encoding_thisfile, "Furlong/Fortnight");
+  m_strings[20022] = "";
+  m_strings[20027] = ToUTF8(encoding_thisfile, "F");
+  m_strings[20028] = ToUTF8(encoding_thisfile, "K");
+  m_strings[20029] = ToUTF8(encoding_thisfile, "C");
+  m_strings[20030] = ToUTF8(encoding_thisfile, "R");
+  m_strings[20031] = ToUTF8(encoding_thisfile, "Ra");
+  m_strings[20032] = ToUTF8(encoding_thisfile, "R");
+  m_strings[20033] = ToUTF8(encoding_thisfile, "De");
+  m_strings[20034] = ToUTF8(encoding_thisfile, "N");
+
+  m_strings[20200] = ToUTF8(encoding_thisfile, "km/h");
+  m_strings[20201] = ToUTF8(encoding_thisfile, "m/min");
+  m_strings[20202] = ToUTF8(encoding_thisfile, "m/s");
+  m_strings[20203] = ToUTF8(encoding_thisfile, "ft/h");
+  m_strings[20204] = ToUTF8(encoding_thisfile, "ft/min");
+  m_strings[20205] = ToUTF8(encoding_thisfile, "ft/s");
+  m_strings[20206] = ToUTF8(encoding_thisfile, "mph");
+  m_strings[20207] = ToUTF8(encoding_thisfile, "kts");
+  m_strings[20208] = ToUTF8(encoding_thisfile, "Beaufort");
+  m_strings[20209] = ToUTF8(encoding_thisfile, "inch/s");
+  m_strings[20210] = ToUTF8(encoding_thisfile, "yard/s");
+  m_strings[20211] = ToUTF8(encoding_thisfile, "Furlong/Fortnight");
 
   return true;
 }
@@ -243,12 +389,19 @@ const CStdString& CLocalizeStrings::Get(uint32_t dwCode) const
   {
     return szEmptyString;
   }
-  return i->second.strTranslated;
+  return i->second;
 }
 
 void CLocalizeStrings::Clear()
 {
   m_strings.clear();
+  ClearOriginals();
+}
+
+void CLocalizeStrings::ClearOriginals()
+{
+  // swap rather than clear, to give back the buckets as well
+  StringMap().swap(m_originals);
 }
 
 void CLocalizeStrings::Clear(uint32_t start, uint32_t end)
@@ -285,6 +438,7 @@ uint32_t CLocalizeStrings::LoadBlock(const CStdString &id, const CStdString &pat
   // load the fallback
   if (!language.Equals(SOURCE_LANGUAGE))
     success |= LoadStr2Mem(path, SOURCE_LANGUAGE, encoding, offset);
+  ClearOriginals();
 
   return success ? offset : 0;
 }
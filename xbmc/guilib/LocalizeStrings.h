@@ -32,16 +32,18 @@
 #include "utils/StdString.h"
 
 #include <map>
+#include <vector>
+#include <boost/unordered_map.hpp>
 
 /*!
  \ingroup strings
- \brief
+ \brief A string as read from a strings.po or strings.xml file
  */
-
-struct LocStr
+struct LocEntry
 {
-CStdString strTranslated; // string to be used in xbmc GUI
-CStdString strOriginal;   // the original English string, the tranlsation is based on
+  uint32_t   id;
+  CStdString msgid;  // the original English string, empty for strings.xml
+  CStdString msgstr; // the translated string
 };
 
 // The default fallback language is fixed to be English
@@ -93,10 +95,30 @@ protected:
    */
   bool LoadXML(const CStdString &filename, CStdString &encoding, uint32_t offset = 0);
 
+  /*! \brief Reads the strings of a strings.po or strings.xml file from its compiled table
+   The table is a flat copy of the entries of the file in special://temp, and is only used while
+   the modification time and size of the file match those it was compiled from.
+   \param filename The strings file.
+   \param encoding [out] Encoding of the strings file.
+   \param entries [out] The strings in the file.
+   \return false if the file has no valid compiled table.
+   */
+  static bool LoadCompiled(const CStdString &filename, CStdString &encoding, std::vector<LocEntry> &entries);
+
+  /*! \brief Writes the compiled table of a strings file for LoadCompiled() */
+  static void SaveCompiled(const CStdString &filename, const CStdString &encoding, const std::vector<LocEntry> &entries);
+
+  void ClearOriginals();
+
   CStdString ToUTF8(const CStdString &encoding, const CStdString &str);
-  std::map<uint32_t, LocStr> m_strings;
-  typedef std::map<uint32_t, LocStr>::const_iterator ciStrings;
-  typedef std::map<uint32_t, LocStr>::iterator       iStrings;
+  typedef boost::unordered_map<uint32_t, CStdString> StringMap;
+  StringMap m_strings;
+  typedef StringMap::const_iterator ciStrings;
+  typedef StringMap::iterator       iStrings;
+
+  /*! \brief English strings the loaded translations were based on, only kept while loading the
+   fallback so that translations of reused ids can be replaced. */
+  StringMap m_originals;
 
   static const uint32_t block_start = 0xf000000;
   static const uint32_t block_size = 4096;
@@ -442,7 +442,7 @@ void CBaseTexture::LoadFromImage(ImageInfo &image, bool autoRotate)
   ClampToEdge();
 }
 
-bool CBaseTexture::LoadFromMemory(unsigned int width, unsigned int height, unsigned int pitch, unsigned int format, bool hasAlpha, unsigned char* pixels)
+bool CBaseTexture::LoadFromMemory(unsigned int width, unsigned int height, unsigned int pitch, unsigned int format, bool hasAlpha, const unsigned char* pixels)
 {
   m_imageWidth = width;
   m_imageHeight = height;
@@ -75,7 +75,7 @@ public:
 
   bool LoadFromFile(const CStdString& texturePath, unsigned int maxWidth, unsigned int maxHeight,
                     bool autoRotate, unsigned int *originalWidth, unsigned int *originalHeight);
-  bool LoadFromMemory(unsigned int width, unsigned int height, unsigned int pitch, unsigned int format, bool hasAlpha, unsigned char* pixels);
+  bool LoadFromMemory(unsigned int width, unsigned int height, unsigned int pitch, unsigned int format, bool hasAlpha, const unsigned char* pixels);
   bool LoadPaletted(unsigned int width, unsigned int height, unsigned int pitch, unsigned int format, const unsigned char *pixels, const COLOR *palette);
 
   bool HasAlpha() const;
@@ -21,6 +21,7 @@
 
 #include "system.h"
 #include "TextureBundle.h"
+#include "threads/SingleLock.h"
 
 CTextureBundle::CTextureBundle(void)
 {
@@ -79,6 +80,7 @@ bool CTextureBundle::LoadTexture(const CStdString& Filename, CBaseTexture** ppTe
   }
   else if (m_useXPR)
   {
+    CSingleLock lock(m_xprSection);
     return m_tbXPR.LoadTexture(Filename, ppTexture, width, height);
   }
   else
@@ -96,6 +98,7 @@ int CTextureBundle::LoadAnim(const CStdString& Filename, CBaseTexture*** ppTextu
   }
   else if (m_useXPR)
   {
+    CSingleLock lock(m_xprSection);
     return m_tbXPR.LoadAnim(Filename, ppTextures, width, height, nLoops, ppDelays);
   }
   else
@@ -24,6 +24,7 @@
 #include "utils/StdString.h"
 #include "TextureBundleXPR.h"
 #include "TextureBundleXBT.h"
+#include "threads/CriticalSection.h"
 
 class CTextureBundle
 {
@@ -48,6 +49,8 @@ private:
 
   bool m_useXPR;
   bool m_useXBT;
+
+  CCriticalSection m_xprSection; ///< XBT bundles may be loaded from concurrently, XPR bundles may not
 };
 
 
@@ -28,6 +28,8 @@
 #include "utils/log.h"
 #include "utils/URIUtils.h"
 #include "addons/Skin.h"
+#include "settings/AdvancedSettings.h"
+#include "utils/JobManager.h"
 #ifdef _DEBUG
 #include "utils/TimeUtils.h"
 #endif
@@ -209,6 +211,38 @@ void CTextureMap::Add(CBaseTexture* texture, int delay)
     m_memUsage += sizeof(CTexture) + (texture->GetTextureWidth() * texture->GetTextureHeight() * 4);
 }
 
+/*!
+ \ingroup textures,jobs
+ \brief Job used by the CGUITextureManager to decode skin textures off the GUI thread.
+ */
+class CTextureLoadJob : public CJob
+{
+public:
+  CTextureLoadJob(CGUITextureManager *manager, const CStdString &name, const CStdString &path, int bundle)
+  : m_manager(manager), m_name(name), m_path(path), m_bundle(bundle), m_map(NULL)
+  {
+  }
+
+  virtual ~CTextureLoadJob()
+  {
+    delete m_map;
+  }
+
+  virtual const char *GetType() const { return "textureload"; }
+
+  virtual bool DoWork()
+  {
+    m_map = m_manager->LoadTextureMap(m_name, m_path, m_bundle);
+    return m_map != NULL;
+  }
+
+  CGUITextureManager *m_manager;
+  CStdString m_name;  ///< name of the texture, as requested by the control
+  CStdString m_path;  ///< full path of the texture if it isn't bundled
+  int m_bundle;       ///< bundle the texture resides in, or -1 if not bundled
+  CTextureMap *m_map; ///< the decoded texture map
+};
+
 /************************************************************************/
 /*                                                                      */
 /************************************************************************/
@@ -216,6 +250,8 @@ CGUITextureManager::CGUITextureManager(void)
 {
   // we set the theme bundle to be the first bundle (thus prioritizing it)
   m_TexBundle[0].SetThemeBundle(true);
+  m_loadCount = 0;
+  m_queuedCount = 0;
 }
 
 CGUITextureManager::~CGUITextureManager(void)
@@ -223,18 +259,23 @@ CGUITextureManager::~CGUITextureManager(void)
   Cleanup();
 }
 
+CTextureMap* CGUITextureManager::FindTexture(const CStdString& strTextureName) const
+{
+  TextureIndex::const_iterator i = m_textures.find(strTextureName);
+  if (i != m_textures.end())
+    return i->second;
+  return NULL;
+}
+
 const CTextureArray& CGUITextureManager::GetTexture(const CStdString& strTextureName)
 {
   static CTextureArray emptyTexture;
   //  CLog::Log(LOGINFO, " refcount++ for  GetTexture(%s)\n", strTextureName.c_str());
-  for (int i = 0; i < (int)m_vecTextures.size(); ++i)
+  CTextureMap *pMap = FindTexture(strTextureName);
+  if (pMap)
   {
-    CTextureMap *pMap = m_vecTextures[i];
-    if (pMap->GetName() == strTextureName)
-    {
-      //CLog::Log(LOGDEBUG, "Total memusage %u", GetMemoryUsage());
-      return pMap->GetTexture();
-    }
+    //CLog::Log(LOGDEBUG, "Total memusage %u", GetMemoryUsage());
+    return pMap->GetTexture();
   }
   return emptyTexture;
 }
@@ -265,23 +306,22 @@ bool CGUITextureManager::HasTexture(const CStdString &textureName, CStdString *p
     return false;
 
   // Check our loaded and bundled textures - we store in bundles using \\.
-  CStdString bundledName = CTextureBundle::Normalize(textureName);
-  for (int i = 0; i < (int)m_vecTextures.size(); ++i)
+  if (FindTexture(textureName))
   {
-    CTextureMap *pMap = m_vecTextures[i];
-    if (pMap->GetName() == textureName)
-    {
-      if (size) *size = 1;
-      return true;
-    }
+    if (size) *size = 1;
+    return true;
   }
 
-  for (int i = 0; i < 2; i++)
+  CStdString bundledName = CTextureBundle::Normalize(textureName);
   {
-    if (m_TexBundle[i].HasFile(bundledName))
+    CExclusiveLock lock(m_bundleSection);
+    for (int i = 0; i < 2; i++)
     {
-      if (bundle) *bundle = i;
-      return true;
+      if (m_TexBundle[i].HasFile(bundledName))
+      {
+        if (bundle) *bundle = i;
+        return true;
+      }
     }
   }
 
@@ -309,25 +349,124 @@ int CGUITextureManager::Load(const CStdString& strTextureName, bool checkBundleO
   //Lock here, we will do stuff that could break rendering
   CSingleLock lock(g_graphicsContext);
 
+  CTextureMap* pMap = LoadTextureMap(strTextureName, strPath, bundle);
+  if (!pMap)
+    return 0;
+
+  m_textures.insert(make_pair(strTextureName, pMap));
+  m_loadCount++;
+  return 1;
+}
+
+int CGUITextureManager::LoadAsync(const CStdString& strTextureName, bool firstRequest)
+{
+  if (!g_advancedSettings.m_guiAsyncTextureLoad)
+    return Load(strTextureName);
+
+  if (FindTexture(strTextureName))
+    return 1;
+
+  { // check whether we have a decode in progress, or one that has completed
+    CSingleLock lock(m_pendingSection);
+    PendingIndex::iterator i = m_pending.find(strTextureName);
+    if (i != m_pending.end())
+    {
+      CPendingTexture &pending = i->second;
+      if (!pending.m_done)
+      {
+        if (firstRequest)
+          pending.m_refCount++;
+        return -1;
+      }
+
+      // decode has finished - transfer the texture to our list
+      CTextureMap *pMap = pending.m_map;
+      m_pending.erase(i);
+      if (!pMap)
+        return 0;
+
+      m_textures.insert(make_pair(strTextureName, pMap));
+      return 1;
+    }
+  }
+
+  CStdString strPath;
+  int bundle = -1;
+  int size = 0;
+  if (!HasTexture(strTextureName, &strPath, &bundle, &size))
+    return 0;
+
+  if (size) // we found the texture
+    return size;
+
+  CSingleLock lock(m_pendingSection);
+  unsigned int jobID = CJobManager::GetInstance().AddJob(new CTextureLoadJob(this, strTextureName, strPath, bundle), this, CJob::PRIORITY_HIGH);
+  m_pending.insert(make_pair(strTextureName, CPendingTexture(jobID)));
+  m_queuedCount++;
+  return -1;
+}
+
+void CGUITextureManager::CancelLoad(const CStdString& strTextureName)
+{
+  CSingleLock lock(m_pendingSection);
+  PendingIndex::iterator i = m_pending.find(strTextureName);
+  if (i == m_pending.end())
+    return;
+
+  CPendingTexture &pending = i->second;
+  if (--pending.m_refCount == 0)
+  {
+    if (pending.m_done)
+      delete pending.m_map;
+    else
+      CJobManager::GetInstance().CancelJob(pending.m_jobID);
+    m_pending.erase(i);
+  }
+}
+
+void CGUITextureManager::OnJobComplete(unsigned int jobID, bool success, CJob *job)
+{
+  CSingleLock lock(m_pendingSection);
+  CTextureLoadJob *loader = (CTextureLoadJob *)job;
+  PendingIndex::iterator i = m_pending.find(loader->m_name);
+  if (i != m_pending.end() && i->second.m_jobID == jobID)
+  {
+    i->second.m_done = true;
+    i->second.m_map = loader->m_map;
+    loader->m_map = NULL; // we keep the map - jobs are auto-deleted
+  }
+}
+
+void CGUITextureManager::GetLoadStats(unsigned int &loaded, unsigned int &queued) const
+{
+  loaded = m_loadCount;
+  queued = m_queuedCount;
+}
+
+CTextureMap* CGUITextureManager::LoadTextureMap(const CStdString& strTextureName, const CStdString& strPath, int bundle)
+{
 #ifdef _DEBUG
   int64_t start;
   start = CurrentHostCounter();
 #endif
 
+  CTextureMap* pMap = NULL;
   if (strPath.Right(4).ToLower() == ".gif")
   {
-    CTextureMap* pMap;
-
     if (bundle >= 0)
     {
       CBaseTexture **pTextures;
       int nLoops = 0, width = 0, height = 0;
       int* Delay;
-      int nImages = m_TexBundle[bundle].LoadAnim(strTextureName, &pTextures, width, height, nLoops, &Delay);
+      int nImages;
+      {
+        CSharedLock lock(m_bundleSection);
+        nImages = m_TexBundle[bundle].LoadAnim(strTextureName, &pTextures, width, height, nLoops, &Delay);
+      }
       if (!nImages)
       {
         CLog::Log(LOGERROR, "Texture manager unable to load bundled file: %s", strTextureName.c_str());
-        return 0;
+        return NULL;
       }
 
       pMap = new CTextureMap(strTextureName, width, height, nLoops);
@@ -348,7 +487,7 @@ int CGUITextureManager::Load(const CStdString& strTextureName, bool checkBundleO
         CStdString rootPath = strPath.Left(g_SkinInfo->Path().GetLength());
         if (0 == rootPath.CompareNoCase(g_SkinInfo->Path()))
           CLog::Log(LOGERROR, "Texture manager unable to load file: %s", strPath.c_str());
-        return 0;
+        return NULL;
       }
       int iWidth = AnimatedGifSet.FrameWidth;
       int iHeight = AnimatedGifSet.FrameHeight;
@@ -375,44 +514,38 @@ int CGUITextureManager::Load(const CStdString& strTextureName, bool checkBundleO
         }
       } // of for (int iImage=0; iImage < iImages; iImage++)
     }
-
-#ifdef _DEBUG
-    int64_t end, freq;
-    end = CurrentHostCounter();
-    freq = CurrentHostFrequency();
-    char temp[200];
-    sprintf(temp, "Load %s: %.1fms%s\n", strPath.c_str(), 1000.f * (end - start) / freq, (bundle >= 0) ? " (bundled)" : "");
-    OutputDebugString(temp);
-#endif
-
-    m_vecTextures.push_back(pMap);
-    return 1;
   } // of if (strPath.Right(4).ToLower()==".gif")
-
-  CBaseTexture *pTexture = NULL;
-  int width = 0, height = 0;
-  if (bundle >= 0)
+  else
   {
-    if (FAILED(m_TexBundle[bundle].LoadTexture(strTextureName, &pTexture, width, height)))
+    CBaseTexture *pTexture = NULL;
+    int width = 0, height = 0;
+    if (bundle >= 0)
     {
-      CLog::Log(LOGERROR, "Texture manager unable to load bundled file: %s", strTextureName.c_str());
-      return 0;
+      bool loaded;
+      {
+        CSharedLock lock(m_bundleSection);
+        loaded = m_TexBundle[bundle].LoadTexture(strTextureName, &pTexture, width, height);
+      }
+      if (!loaded)
+      {
+        CLog::Log(LOGERROR, "Texture manager unable to load bundled file: %s", strTextureName.c_str());
+        return NULL;
+      }
+    }
+    else
+    {
+      pTexture = CBaseTexture::LoadFromFile(strPath);
+      if (!pTexture)
+        return NULL;
+      width = pTexture->GetWidth();
+      height = pTexture->GetHeight();
     }
-  }
-  else
-  {
-    pTexture = CBaseTexture::LoadFromFile(strPath);
-    if (!pTexture)
-      return 0;
-    width = pTexture->GetWidth();
-    height = pTexture->GetHeight();
-  }
 
-  if (!pTexture) return 0;
+    if (!pTexture) return NULL;
 
-  CTextureMap* pMap = new CTextureMap(strTextureName, width, height, 0);
-  pMap->Add(pTexture, 100);
-  m_vecTextures.push_back(pMap);
+    pMap = new CTextureMap(strTextureName, width, height, 0);
+    pMap->Add(pTexture, 100);
+  }
 
 #ifdef _DEBUG_TEXTURES
   int64_t end, freq;
@@ -423,7 +556,7 @@ int CGUITextureManager::Load(const CStdString& strTextureName, bool checkBundleO
   OutputDebugString(temp);
 #endif
 
-  return 1;
+  return pMap;
 }
 
 
@@ -431,23 +564,18 @@ void CGUITextureManager::ReleaseTexture(const CStdString& strTextureName)
 {
   CSingleLock lock(g_graphicsContext);
 
-  ivecTextures i;
-  i = m_vecTextures.begin();
-  while (i != m_vecTextures.end())
+  TextureIndex::iterator i = m_textures.find(strTextureName);
+  if (i != m_textures.end())
   {
-    CTextureMap* pMap = *i;
-    if (pMap->GetName() == strTextureName)
+    CTextureMap* pMap = i->second;
+    if (pMap->Release())
     {
-      if (pMap->Release())
-      {
-        //CLog::Log(LOGINFO, "  cleanup:%s", strTextureName.c_str());
-        // add to our textures to free
-        m_unusedTextures.push_back(pMap);
-        i = m_vecTextures.erase(i);
-      }
-      return;
+      //CLog::Log(LOGINFO, "  cleanup:%s", strTextureName.c_str());
+      // add to our textures to free
+      m_unusedTextures.push_back(pMap);
+      m_textures.erase(i);
     }
-    ++i;
+    return;
   }
   CLog::Log(LOGWARNING, "%s: Unable to release texture %s", __FUNCTION__, strTextureName.c_str());
 }
@@ -464,29 +592,43 @@ void CGUITextureManager::Cleanup()
 {
   CSingleLock lock(g_graphicsContext);
 
-  ivecTextures i;
-  i = m_vecTextures.begin();
-  while (i != m_vecTextures.end())
+  { // cancel any outstanding decodes
+    CSingleLock pendingLock(m_pendingSection);
+    for (PendingIndex::iterator i = m_pending.begin(); i != m_pending.end(); ++i)
+    {
+      if (i->second.m_done)
+        delete i->second.m_map;
+      else
+        CJobManager::GetInstance().CancelJob(i->second.m_jobID);
+    }
+    m_pending.clear();
+  }
+
+  for (TextureIndex::iterator i = m_textures.begin(); i != m_textures.end(); ++i)
   {
-    CTextureMap* pMap = *i;
+    CTextureMap* pMap = i->second;
     CLog::Log(LOGWARNING, "%s: Having to cleanup texture %s", __FUNCTION__, pMap->GetName().c_str());
     delete pMap;
-    i = m_vecTextures.erase(i);
   }
-  for (int i = 0; i < 2; i++)
-    m_TexBundle[i].Cleanup();
+  m_textures.clear();
+
+  {
+    CExclusiveLock bundleLock(m_bundleSection);
+    for (int i = 0; i < 2; i++)
+      m_TexBundle[i].Cleanup();
+  }
   FreeUnusedTextures();
 }
 
 void CGUITextureManager::Dump() const
 {
   CStdString strLog;
-  strLog.Format("total texturemaps size:%i\n", m_vecTextures.size());
+  strLog.Format("total texturemaps size:%i\n", m_textures.size());
   OutputDebugString(strLog.c_str());
 
-  for (int i = 0; i < (int)m_vecTextures.size(); ++i)
+  for (TextureIndex::const_iterator i = m_textures.begin(); i != m_textures.end(); ++i)
   {
-    const CTextureMap* pMap = m_vecTextures[i];
+    const CTextureMap* pMap = i->second;
     if (!pMap->IsEmpty())
       pMap->Dump();
   }
@@ -496,16 +638,15 @@ void CGUITextureManager::Flush()
 {
   CSingleLock lock(g_graphicsContext);
 
-  ivecTextures i;
-  i = m_vecTextures.begin();
-  while (i != m_vecTextures.end())
+  TextureIndex::iterator i = m_textures.begin();
+  while (i != m_textures.end())
   {
-    CTextureMap* pMap = *i;
+    CTextureMap* pMap = i->second;
     pMap->Flush();
     if (pMap->IsEmpty() )
     {
       delete pMap;
-      i = m_vecTextures.erase(i);
+      i = m_textures.erase(i);
     }
     else
     {
@@ -517,9 +658,9 @@ void CGUITextureManager::Flush()
 unsigned int CGUITextureManager::GetMemoryUsage() const
 {
   unsigned int memUsage = 0;
-  for (int i = 0; i < (int)m_vecTextures.size(); ++i)
+  for (TextureIndex::const_iterator i = m_textures.begin(); i != m_textures.end(); ++i)
   {
-    memUsage += m_vecTextures[i]->GetMemoryUsage();
+    memUsage += i->second->GetMemoryUsage();
   }
   return memUsage;
 }
@@ -579,6 +720,7 @@ CStdString CGUITextureManager::GetTexturePath(const CStdString &textureName, boo
 
 void CGUITextureManager::GetBundledTexturesFromPath(const CStdString& texturePath, std::vector<CStdString> &items)
 {
+  CExclusiveLock lock(m_bundleSection);
   m_TexBundle[0].GetTexturesFromPath(texturePath, items);
   if (items.empty())
     m_TexBundle[1].GetTexturesFromPath(texturePath, items);
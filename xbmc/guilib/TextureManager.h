@@ -28,8 +28,11 @@
 #define GUILIB_TEXTUREMANAGER_H
 
 #include <vector>
+#include <boost/unordered_map.hpp>
 #include "TextureBundle.h"
 #include "threads/CriticalSection.h"
+#include "threads/SharedSection.h"
+#include "utils/Job.h"
 
 #pragma once
 
@@ -101,7 +104,7 @@ protected:
 /************************************************************************/
 /*                                                                      */
 /************************************************************************/
-class CGUITextureManager
+class CGUITextureManager : public IJobCallback
 {
 public:
   CGUITextureManager(void);
@@ -110,6 +113,35 @@ public:
   bool HasTexture(const CStdString &textureName, CStdString *path = NULL, int *bundle = NULL, int *size = NULL);
   bool CanLoad(const CStdString &texturePath) const; ///< Returns true if the texture manager can load this texture
   int Load(const CStdString& strTextureName, bool checkBundleOnly = false);
+
+  /*! \brief Load a texture, decoding it on a background thread if it isn't already loaded.
+
+   The texture is decoded by a CJob, and handed over to the texture list the next time it is requested
+   after the decode has finished.  Upload to the GPU happens on first render, as for Load().
+   Outstanding requests are reference counted, so each first request should be balanced by either
+   a call to GetTexture() once loaded, or a call to CancelLoad().
+
+   \param strTextureName the name of the texture to load.
+   \param firstRequest true if this is the first time the caller is requesting this texture.
+   \return the number of frames if loaded, 0 if the texture could not be loaded, -1 if it is still being decoded.
+   \sa Load, CancelLoad
+   */
+  int LoadAsync(const CStdString& strTextureName, bool firstRequest);
+
+  /*! \brief Cancel a pending LoadAsync() request.
+   The background decode is cancelled once all requests for the texture have been cancelled.
+   \param strTextureName the name of the texture that is no longer required.
+   */
+  void CancelLoad(const CStdString& strTextureName);
+
+  /*! \brief Retrieve running texture load counts, used to report per-window load times.
+   \param loaded number of textures decoded synchronously.
+   \param queued number of textures queued for background decoding.
+   */
+  void GetLoadStats(unsigned int &loaded, unsigned int &queued) const;
+
+  virtual void OnJobComplete(unsigned int jobID, bool success, CJob *job);
+
   const CTextureArray& GetTexture(const CStdString& strTextureName);
   void ReleaseTexture(const CStdString& strTextureName);
   void Cleanup();
@@ -124,12 +156,43 @@ public:
   void RemoveTexturePath(const CStdString &texturePath); ///< Remove a path from the paths to check when loading media
 
   void FreeUnusedTextures(); ///< Free textures (called from app thread only)
+
+  /*! \brief Decode a texture into a new texture map.
+   Safe to call from any thread - no GPU resources are touched.
+   \param strTextureName the name of the texture.
+   \param strPath the full path of the texture (as returned by HasTexture).
+   \param bundle the bundle the texture is in, or -1 if it is not bundled.
+   \return the texture map, or NULL if the texture failed to load.
+   */
+  CTextureMap* LoadTextureMap(const CStdString& strTextureName, const CStdString& strPath, int bundle);
 protected:
-  std::vector<CTextureMap*> m_vecTextures;
+  CTextureMap* FindTexture(const CStdString& strTextureName) const;
+
+  class CPendingTexture
+  {
+  public:
+    CPendingTexture(unsigned int jobID = 0) : m_jobID(jobID), m_refCount(1), m_done(false), m_map(NULL) {};
+    unsigned int m_jobID;
+    unsigned int m_refCount;
+    bool m_done;
+    CTextureMap *m_map;
+  };
+
+  typedef boost::unordered_map<std::string, CTextureMap*> TextureIndex;
+  typedef boost::unordered_map<std::string, CPendingTexture> PendingIndex;
+
+  TextureIndex m_textures;
   std::vector<CTextureMap*> m_unusedTextures;
   typedef std::vector<CTextureMap*>::iterator ivecTextures;
   // we have 2 texture bundles (one for the base textures, one for the theme)
   CTextureBundle m_TexBundle[2];
+  CSharedSection m_bundleSection; ///< shared for texture loads, exclusive when the bundles may be (re)opened
+
+  PendingIndex m_pending;
+  CCriticalSection m_pendingSection;
+
+  unsigned int m_loadCount;
+  unsigned int m_queuedCount;
 
   std::vector<CStdString> m_texturePaths;
   CCriticalSection m_section;
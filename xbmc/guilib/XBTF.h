@@ -28,6 +28,12 @@
 #define XBTF_MAGIC "XBTF"
 #define XBTF_VERSION "2"
 
+/*! \brief Alignment (in bytes) of frame data within the bundle.
+ Frames are written at aligned offsets so that the data can be used directly from a memory mapped bundle.
+ Older bundles without alignment remain readable, as frame offsets are absolute.
+ */
+#define XBTF_FRAME_ALIGNMENT 16
+
 #define XB_FMT_MASK   0xffff ///< mask for format info - other flags are outside this
 #define XB_FMT_DXT_MASK   15
 #define XB_FMT_UNKNOWN     0
@@ -79,6 +85,7 @@ public:
   CXBTFFile();
   CXBTFFile(const CXBTFFile& ref);
   char* GetPath();
+  const char* GetPath() const;
   void SetPath(const std::string& path);
   uint32_t GetLoop() const;
   void SetLoop(uint32_t loop);
@@ -20,151 +20,259 @@
  */
 
 #include <sys/stat.h>
+#include <algorithm>
 #include "XBTFReader.h"
 #include "utils/EndianSwap.h"
 #include "utils/CharsetConverter.h"
 #ifdef _WIN32
 #include "FileSystem/SpecialProtocol.h"
+#else
+#include <sys/mman.h>
+#include <fcntl.h>
 #endif
 
 #include <string.h>
 #include "PlatformDefs.h"
 
-#define READ_STR(str, size, file) \
-  if (!fread(str, size, 1, file)) \
-    return false;
+#define READ_STR(str, size, ptr, end) \
+  if (ptr + size > end) \
+    return false; \
+  memcpy(str, ptr, size); \
+  ptr += size;
 
-#define READ_U32(i, file) \
-  if (!fread(&i, 4, 1, file)) \
+#define READ_U32(i, ptr, end) \
+  if (ptr + 4 > end) \
     return false; \
+  memcpy(&i, ptr, 4); \
+  ptr += 4; \
   i = Endian_SwapLE32(i);
 
-#define READ_U64(i, file) \
-  if (!fread(&i, 8, 1, file)) \
+#define READ_U64(i, ptr, end) \
+  if (ptr + 8 > end) \
     return false; \
+  memcpy(&i, ptr, 8); \
+  ptr += 8; \
   i = Endian_SwapLE64(i);
 
+struct XBTFFileLess
+{
+  bool operator()(const CXBTFFile& lhs, const CXBTFFile& rhs) const
+  {
+    return strcmp(lhs.GetPath(), rhs.GetPath()) < 0;
+  }
+  bool operator()(const CXBTFFile& lhs, const char* rhs) const
+  {
+    return strcmp(lhs.GetPath(), rhs) < 0;
+  }
+};
+
 CXBTFReader::CXBTFReader()
 {
-  m_file = NULL;
+  m_data = NULL;
+  m_size = 0;
+#ifdef _WIN32
+  m_file = INVALID_HANDLE_VALUE;
+  m_mapping = NULL;
+#endif
 }
 
-bool CXBTFReader::IsOpen() const
+CXBTFReader::~CXBTFReader()
 {
-  return m_file != NULL;
+  Close();
 }
 
-bool CXBTFReader::Open(const CStdString& fileName)
+bool CXBTFReader::IsOpen() const
 {
-  m_fileName = fileName;
+  return m_data != NULL;
+}
 
+bool CXBTFReader::Map()
+{
 #ifdef _WIN32
   CStdStringW strPathW;
   g_charsetConverter.utf8ToW(CSpecialProtocol::TranslatePath(m_fileName), strPathW, false);
-  m_file = _wfopen(strPathW.c_str(), L"rb");
+  m_file = CreateFileW(strPathW.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+  if (m_file == INVALID_HANDLE_VALUE)
+    return false;
+
+  LARGE_INTEGER size;
+  if (!GetFileSizeEx(m_file, &size) || size.QuadPart == 0)
+    return false;
+  m_size = size.QuadPart;
+
+  m_mapping = CreateFileMapping(m_file, NULL, PAGE_READONLY, 0, 0, NULL);
+  if (m_mapping == NULL)
+    return false;
+
+  m_data = (unsigned char*)MapViewOfFile(m_mapping, FILE_MAP_READ, 0, 0, 0);
+  return m_data != NULL;
+#else
+  int fd = open(m_fileName.c_str(), O_RDONLY);
+  if (fd == -1)
+    return false;
+
+  struct stat fileStat;
+  if (fstat(fd, &fileStat) == -1 || fileStat.st_size == 0)
+  {
+    close(fd);
+    return false;
+  }
+  m_size = fileStat.st_size;
+
+  // the mapping stays valid after the descriptor is closed
+  void* data = mmap(NULL, (size_t)m_size, PROT_READ, MAP_SHARED, fd, 0);
+  close(fd);
+  if (data == MAP_FAILED)
+    return false;
+
+  m_data = (unsigned char*)data;
+  return true;
+#endif
+}
+
+void CXBTFReader::Unmap()
+{
+#ifdef _WIN32
+  if (m_data)
+    UnmapViewOfFile(m_data);
+  if (m_mapping)
+    CloseHandle(m_mapping);
+  if (m_file != INVALID_HANDLE_VALUE)
+    CloseHandle(m_file);
+  m_mapping = NULL;
+  m_file = INVALID_HANDLE_VALUE;
 #else
-  m_file = fopen(m_fileName.c_str(), "rb");
+  if (m_data)
+    munmap(m_data, (size_t)m_size);
 #endif
-  if (m_file == NULL)
+  m_data = NULL;
+  m_size = 0;
+}
+
+bool CXBTFReader::Open(const CStdString& fileName)
+{
+  Close();
+
+  m_fileName = fileName;
+
+  if (!Map())
   {
+    Close();
     return false;
   }
 
+  const unsigned char* ptr = m_data;
+  const unsigned char* end = m_data + m_size;
+
   char magic[4];
-  READ_STR(magic, 4, m_file);
+  READ_STR(magic, 4, ptr, end);
 
   if (strncmp(magic, XBTF_MAGIC, sizeof(magic)) != 0)
   {
+    Close();
     return false;
   }
 
   char version[1];
-  READ_STR(version, 1, m_file);
+  READ_STR(version, 1, ptr, end);
 
   if (strncmp(version, XBTF_VERSION, sizeof(version)) != 0)
   {
+    Close();
     return false;
   }
 
   unsigned int nofFiles;
-  READ_U32(nofFiles, m_file);
+  READ_U32(nofFiles, ptr, end);
+  std::vector<CXBTFFile>& files = m_xbtf.GetFiles();
+  files.reserve(nofFiles);
   for (unsigned int i = 0; i < nofFiles; i++)
   {
     CXBTFFile file;
     unsigned int u32;
     uint64_t u64;
 
-    READ_STR(file.GetPath(), 256, m_file);
-    READ_U32(u32, m_file);
+    READ_STR(file.GetPath(), 256, ptr, end);
+    file.GetPath()[255] = 0;
+    READ_U32(u32, ptr, end);
     file.SetLoop(u32);
 
     unsigned int nofFrames;
-    READ_U32(nofFrames, m_file);
+    READ_U32(nofFrames, ptr, end);
 
     for (unsigned int j = 0; j < nofFrames; j++)
     {
       CXBTFFrame frame;
 
-      READ_U32(u32, m_file);
+      READ_U32(u32, ptr, end);
       frame.SetWidth(u32);
-      READ_U32(u32, m_file);
+      READ_U32(u32, ptr, end);
       frame.SetHeight(u32);
-      READ_U32(u32, m_file);
+      READ_U32(u32, ptr, end);
       frame.SetFormat(u32);
-      READ_U64(u64, m_file);
+      READ_U64(u64, ptr, end);
       frame.SetPackedSize(u64);
-      READ_U64(u64, m_file);
+      READ_U64(u64, ptr, end);
       frame.SetUnpackedSize(u64);
-      READ_U32(u32, m_file);
+      READ_U32(u32, ptr, end);
       frame.SetDuration(u32);
-      READ_U64(u64, m_file);
+      READ_U64(u64, ptr, end);
       frame.SetOffset(u64);
 
       file.GetFrames().push_back(frame);
     }
 
-    m_xbtf.GetFiles().push_back(file);
-
-    m_filesMap[file.GetPath()] = file;
+    files.push_back(file);
   }
 
   // Sanity check
-  int64_t pos = ftell(m_file);
+  int64_t pos = ptr - m_data;
   if (pos != (int64_t)m_xbtf.GetHeaderSize())
   {
     printf("Expected header size (%"PRId64") != actual size (%"PRId64")\n", m_xbtf.GetHeaderSize(), pos);
+    Close();
     return false;
   }
 
+  // sort our file table so that lookups can be done with a binary search
+  std::sort(files.begin(), files.end(), XBTFFileLess());
+
   return true;
 }
 
 void CXBTFReader::Close()
 {
-  if (m_file)
-  {
-    fclose(m_file);
-    m_file = NULL;
-  }
-
+  Unmap();
   m_xbtf.GetFiles().clear();
-  m_filesMap.clear();
 }
 
 time_t CXBTFReader::GetLastModificationTimestamp()
 {
-  if (!m_file)
+  if (!m_data)
   {
     return 0;
   }
 
+#ifdef _WIN32
+  FILETIME writeTime;
+  if (!GetFileTime(m_file, NULL, NULL, &writeTime))
+  {
+    return 0;
+  }
+  ULARGE_INTEGER time;
+  time.LowPart = writeTime.dwLowDateTime;
+  time.HighPart = writeTime.dwHighDateTime;
+  // FILETIME is in 100ns intervals since 1601
+  return (time_t)((time.QuadPart - 116444736000000000ULL) / 10000000ULL);
+#else
   struct stat fileStat;
-  if (fstat(fileno(m_file), &fileStat) == -1)
+  if (stat(m_fileName.c_str(), &fileStat) == -1)
   {
     return 0;
   }
 
   return fileStat.st_mtime;
+#endif
 }
 
 bool CXBTFReader::Exists(const CStdString& name)
@@ -174,35 +282,40 @@ bool CXBTFReader::Exists(const CStdString& name)
 
 CXBTFFile* CXBTFReader::Find(const CStdString& name)
 {
-  std::map<CStdString, CXBTFFile>::iterator iter = m_filesMap.find(name);
-  if (iter == m_filesMap.end())
+  std::vector<CXBTFFile>& files = m_xbtf.GetFiles();
+  std::vector<CXBTFFile>::iterator iter = std::lower_bound(files.begin(), files.end(), name.c_str(), XBTFFileLess());
+  if (iter == files.end() || strcmp(iter->GetPath(), name.c_str()) != 0)
   {
     return NULL;
   }
 
-  return &(iter->second);
+  return &(*iter);
 }
 
-bool CXBTFReader::Load(const CXBTFFrame& frame, unsigned char* buffer)
+const unsigned char* CXBTFReader::GetFrameData(const CXBTFFrame& frame) const
 {
-  if (!m_file)
+  if (!m_data)
   {
-    return false;
+    return NULL;
   }
-#if defined(TARGET_DARWIN) || defined(__FreeBSD__) || defined(__ANDROID__)
-    if (fseeko(m_file, (off_t)frame.GetOffset(), SEEK_SET) == -1)
-#else
-    if (fseeko64(m_file, (off_t)frame.GetOffset(), SEEK_SET) == -1)
-#endif
+
+  if (frame.GetOffset() > m_size || frame.GetPackedSize() > m_size - frame.GetOffset())
   {
-    return false;
+    return NULL;
   }
 
-  if (fread(buffer, 1, (size_t)frame.GetPackedSize(), m_file) != frame.GetPackedSize())
+  return m_data + frame.GetOffset();
+}
+
+bool CXBTFReader::Load(const CXBTFFrame& frame, unsigned char* buffer) const
+{
+  const unsigned char* data = GetFrameData(frame);
+  if (!data)
   {
     return false;
   }
 
+  memcpy(buffer, data, (size_t)frame.GetPackedSize());
   return true;
 }
 
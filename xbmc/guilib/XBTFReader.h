@@ -23,28 +23,57 @@
 #define XBTFREADER_H_
 
 #include <vector>
-#include <map>
 #include "utils/StdString.h"
 #include "XBTF.h"
 
+/*!
+ \ingroup textures
+ \brief Reader for XBTF texture bundles.
+
+ The bundle is memory mapped, and the file table is kept as a single vector sorted by path,
+ so lookups are a binary search and frame data can be accessed in place.  Once opened, all
+ const member functions may be called concurrently from multiple threads.
+ */
 class CXBTFReader
 {
 public:
   CXBTFReader();
+  ~CXBTFReader();
   bool IsOpen() const;
   bool Open(const CStdString& fileName);
   void Close();
   time_t GetLastModificationTimestamp();
   bool Exists(const CStdString& name);
   CXBTFFile* Find(const CStdString& name);
-  bool Load(const CXBTFFrame& frame, unsigned char* buffer);
+
+  /*! \brief Copy the (possibly packed) data of a frame into a caller supplied buffer.
+   \param frame the frame to load.
+   \param buffer the buffer to copy into, at least frame.GetPackedSize() bytes.
+   \return true on success, false if the frame lies outside of the bundle.
+   */
+  bool Load(const CXBTFFrame& frame, unsigned char* buffer) const;
+
+  /*! \brief Retrieve the (possibly packed) data of a frame without copying.
+   The returned pointer points into the mapped bundle, and is valid until Close() is called.
+   \param frame the frame to retrieve.
+   \return pointer to frame.GetPackedSize() bytes of frame data, NULL if the frame lies outside of the bundle.
+   */
+  const unsigned char* GetFrameData(const CXBTFFrame& frame) const;
+
   std::vector<CXBTFFile>&  GetFiles();
 
 private:
+  bool Map();
+  void Unmap();
+
   CXBTF      m_xbtf;
   CStdString m_fileName;
-  FILE*      m_file;
-  std::map<CStdString, CXBTFFile> m_filesMap;
+  unsigned char* m_data;
+  uint64_t   m_size;
+#ifdef _WIN32
+  void*      m_file;    ///< file HANDLE
+  void*      m_mapping; ///< file mapping HANDLE
+#endif
 };
 
 #endif
@@ -0,0 +1,76 @@
+/*
+ *      Copyright (C) 2005-2012 Team XBMC
+ *      http://www.xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, write to
+ *  the Free Software Foundation, 675 Mass Ave, Cambridge, MA 02139, USA.
+ *  http://www.gnu.org/copyleft/gpl.html
+ *
+ */
+
+/*
+ * Builds a CFileItemList from a synthetic movie library the same way the video
+ * database does, and reports the heap used per item as well as the time taken
+ * to build, copy, sort label and destroy the listing.
+ *
+ * usage: benchFileItemList [items]   (built with "make benchFileItemList" from the top level)
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "FileItem.h"
+#include "utils/test/BenchmarkLibrary.h"
+#include "threads/SystemClock.h"
+
+using namespace BENCHMARK;
+
+int main(int argc, char *argv[])
+{
+  int count = argc > 1 ? atoi(argv[1]) : 50000;
+  if (count <= 0)
+    count = 50000;
+
+  size_t heapStart = HeapInUse();
+  unsigned int start = XbmcThreads::SystemClockMillis();
+
+  CFileItemList *items = new CFileItemList;
+  BuildLibrary(*items, count);
+
+  unsigned int built = XbmcThreads::SystemClockMillis();
+  size_t heapBuilt = HeapInUse();
+
+  // what the GUI does with a listing: copy it into the window and sort it by label
+  CFileItemList *copy = new CFileItemList;
+  copy->Copy(*items);
+  size_t sortChars = 0;
+  for (int i = 0; i < copy->Size(); i++)
+    sortChars += copy->Get(i)->GetSortLabel().size();
+
+  unsigned int copied = XbmcThreads::SystemClockMillis();
+  size_t heapCopied = HeapInUse();
+
+  delete copy;
+  delete items;
+  unsigned int destroyed = XbmcThreads::SystemClockMillis();
+
+  printf("%d items\n", count);
+  printf("  build:   %6u ms, %8.1f kB (%5.0f bytes/item)\n", built - start,
+         (heapBuilt - heapStart) / 1024.0, (double)(heapBuilt - heapStart) / count);
+  printf("  copy:    %6u ms, %8.1f kB (%5.0f bytes/item, %u sort label chars)\n", copied - built,
+         (heapCopied - heapBuilt) / 1024.0, (double)(heapCopied - heapBuilt) / count, (unsigned int)sortChars);
+  printf("  destroy: %6u ms\n", destroyed - copied);
+
+  return 0;
+}
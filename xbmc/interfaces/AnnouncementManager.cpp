@@ -21,7 +21,9 @@
 
 #include "AnnouncementManager.h"
 #include "threads/SingleLock.h"
+#include "threads/SystemClock.h"
 #include <stdio.h>
+#include <string.h>
 #include "utils/log.h"
 #include "utils/Variant.h"
 #include "utils/StringUtils.h"
@@ -32,19 +34,157 @@
 
 #define LOOKUP_PROPERTY "database-lookup"
 
+// announcements queued per announcer before the oldest ones get dropped
+#define MAX_QUEUED_ANNOUNCEMENTS 64
+// announcers taking longer than this to handle a single announcement get logged
+#define SLOW_ANNOUNCER_MS        500
+
 using namespace std;
 using namespace ANNOUNCEMENT;
 
 CCriticalSection CAnnouncementManager::m_critSection;
-vector<IAnnouncer *> CAnnouncementManager::m_announcers;
+vector<CAnnouncementManager::CDispatcher *> CAnnouncementManager::m_announcers;
+vector<CAnnouncementManager::CDispatcher *> CAnnouncementManager::m_retired;
+
+CAnnouncementManager::CDispatcher::CDispatcher(IAnnouncer *announcer, AnnouncerPolicy policy)
+  : CThread("CAnnouncementDispatcher"), m_announcer(announcer), m_policy(policy)
+{
+  m_retired = false;
+  m_dropped = 0;
+  m_delivered = 0;
+  m_totalTime = 0;
+  m_maxTime = 0;
+}
+
+CAnnouncementManager::CDispatcher::~CDispatcher()
+{
+  StopThread();
+  CLog::Log(LOGDEBUG, "CAnnouncementManager - announcer %p: %u delivered (avg %u ms, max %u ms), %u dropped",
+            m_announcer, m_delivered, m_delivered ? m_totalTime / m_delivered : 0, m_maxTime, m_dropped);
+}
+
+bool CAnnouncementManager::CDispatcher::Coalesce(const AnnouncementPtr &announcement)
+{
+  // high rate state changes only need their latest value delivered
+  const AnnouncementPtr &a = announcement;
+  if (!((a->m_flag == Player && (a->m_message == "OnSeek" || a->m_message == "OnSpeedChanged")) ||
+        (a->m_flag == Application && a->m_message == "OnVolumeChanged")))
+    return false;
+
+  // only an identical announcement at the tail is replaced, so the order of
+  // announcements from a sender is kept
+  if (m_queue.empty())
+    return false;
+
+  AnnouncementPtr &last = m_queue.back();
+  if (last->m_flag != a->m_flag || last->m_message != a->m_message || last->m_sender != a->m_sender)
+    return false;
+
+  last = announcement;
+  return true;
+}
+
+bool CAnnouncementManager::CDispatcher::Queue(const AnnouncementPtr &announcement)
+{
+  CSingleLock lock(m_queueSection);
+  if (m_retired || Coalesce(announcement))
+    return true;
+
+  if (m_queue.size() >= MAX_QUEUED_ANNOUNCEMENTS)
+  {
+    if (m_policy == Disconnect)
+    {
+      CLog::Log(LOGWARNING, "CAnnouncementManager - announcer %p can't keep up, disconnecting it", m_announcer);
+      return false;
+    }
+    if (m_dropped++ % 100 == 0)
+      CLog::Log(LOGWARNING, "CAnnouncementManager - announcer %p can't keep up, dropped %u announcements", m_announcer, m_dropped);
+    m_queue.pop_front();
+  }
+  m_queue.push_back(announcement);
+  m_queueEvent.Set();
+  return true;
+}
+
+void CAnnouncementManager::CDispatcher::Retire()
+{
+  {
+    CSingleLock lock(m_queueSection);
+    m_retired = true;
+    m_queue.clear();
+  }
+  StopThread(false);
+}
+
+void CAnnouncementManager::CDispatcher::Process()
+{
+  while (true)
+  {
+    AnnouncementPtr announcement;
+    {
+      CSingleLock lock(m_queueSection);
+      if (m_retired || m_bStop)
+        break;
+      if (!m_queue.empty())
+      {
+        announcement = m_queue.front();
+        m_queue.pop_front();
+      }
+    }
+
+    if (!announcement)
+    {
+      AbortableWait(m_queueEvent);
+      continue;
+    }
+
+    unsigned int start = XbmcThreads::SystemClockMillis();
+    m_announcer->Announce(announcement->m_flag, announcement->m_sender.c_str(), announcement->m_message.c_str(), announcement->m_data);
+    unsigned int elapsed = XbmcThreads::SystemClockMillis() - start;
+
+    m_delivered++;
+    m_totalTime += elapsed;
+    if (elapsed > m_maxTime)
+      m_maxTime = elapsed;
+    if (elapsed > SLOW_ANNOUNCER_MS)
+      CLog::Log(LOGWARNING, "CAnnouncementManager - announcer %p took %u ms to handle %s from %s",
+                m_announcer, elapsed, announcement->m_message.c_str(), announcement->m_sender.c_str());
+  }
+}
 
-void CAnnouncementManager::AddAnnouncer(IAnnouncer *listener)
+void CAnnouncementManager::ReapRetired()
+{
+  vector<CDispatcher *> finished;
+  {
+    CSingleLock lock (m_critSection);
+    for (vector<CDispatcher *>::iterator it = m_retired.begin(); it != m_retired.end(); )
+    {
+      if (!(*it)->IsRunning())
+      {
+        finished.push_back(*it);
+        it = m_retired.erase(it);
+      }
+      else
+        ++it;
+    }
+  }
+
+  for (unsigned int i = 0; i < finished.size(); i++)
+    delete finished[i];
+}
+
+void CAnnouncementManager::AddAnnouncer(IAnnouncer *listener, AnnouncerPolicy policy /* = DropOldest */)
 {
   if (!listener)
     return;
 
+  ReapRetired();
+
+  CDispatcher *dispatcher = new CDispatcher(listener, policy);
+  dispatcher->Create();
+
   CSingleLock lock (m_critSection);
-  m_announcers.push_back(listener);
+  m_announcers.push_back(dispatcher);
 }
 
 void CAnnouncementManager::RemoveAnnouncer(IAnnouncer *listener)
@@ -52,15 +192,51 @@ void CAnnouncementManager::RemoveAnnouncer(IAnnouncer *listener)
   if (!listener)
     return;
 
-  CSingleLock lock (m_critSection);
-  for (unsigned int i = 0; i < m_announcers.size(); i++)
+  CDispatcher *dispatcher = NULL;
   {
-    if (m_announcers[i] == listener)
+    CSingleLock lock (m_critSection);
+    for (unsigned int i = 0; i < m_announcers.size(); i++)
     {
-      m_announcers.erase(m_announcers.begin() + i);
+      if (m_announcers[i]->GetAnnouncer() == listener)
+      {
+        dispatcher = m_announcers[i];
+        m_announcers.erase(m_announcers.begin() + i);
+        break;
+      }
+    }
+
+    // a retired dispatcher (disconnected, or retired from within Announce())
+    // may still be delivering to the announcer, so it has to be waited for as well
+    for (unsigned int i = 0; !dispatcher && i < m_retired.size(); i++)
+    {
+      if (m_retired[i]->GetAnnouncer() == listener)
+      {
+        if (m_retired[i]->IsCurrentThread())
+          return;
+        dispatcher = m_retired[i];
+        m_retired.erase(m_retired.begin() + i);
+      }
+    }
+
+    // an announcer removing itself from within its own Announce() can't wait
+    // on its dispatcher, so just stop any further deliveries and clean up later
+    if (dispatcher && dispatcher->IsCurrentThread())
+    {
+      dispatcher->Retire();
+      m_retired.push_back(dispatcher);
       return;
     }
   }
+
+  // anything still queued is discarded, but we wait for a delivery in
+  // progress so the announcer can't be called once we return
+  if (dispatcher)
+  {
+    dispatcher->Retire();
+    delete dispatcher;
+  }
+
+  ReapRetired();
 }
 
 void CAnnouncementManager::Announce(AnnouncementFlag flag, const char *sender, const char *message)
@@ -72,9 +248,33 @@ void CAnnouncementManager::Announce(AnnouncementFlag flag, const char *sender, c
 void CAnnouncementManager::Announce(AnnouncementFlag flag, const char *sender, const char *message, CVariant &data)
 {
   CLog::Log(LOGDEBUG, "CAnnouncementManager - Announcement: %s from %s", message, sender);
-  CSingleLock lock (m_critSection);
-  for (unsigned int i = 0; i < m_announcers.size(); i++)
-    m_announcers[i]->Announce(flag, sender, message, data);
+
+  AnnouncementPtr announcement(new CAnnouncement(flag, sender, message, data));
+
+  bool retired;
+  {
+    CSingleLock lock (m_critSection);
+    for (unsigned int i = 0; i < m_announcers.size(); )
+    {
+      if (m_announcers[i]->Queue(announcement))
+      {
+        i++;
+        continue;
+      }
+
+      // disconnected announcers are retired like ones removing themselves,
+      // so a later RemoveAnnouncer() still waits for a delivery in progress
+      m_announcers[i]->Retire();
+      m_retired.push_back(m_announcers[i]);
+      m_announcers.erase(m_announcers.begin() + i);
+    }
+    retired = !m_retired.empty();
+  }
+
+  // retired dispatchers have finished by now or will
+  // be picked up by the next announcement
+  if (retired)
+    ReapRetired();
 }
 
 void CAnnouncementManager::Announce(AnnouncementFlag flag, const char *sender, const char *message, CFileItemPtr item)
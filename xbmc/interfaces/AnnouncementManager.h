@@ -23,21 +23,76 @@
 #include "IAnnouncer.h"
 #include "FileItem.h"
 #include "threads/CriticalSection.h"
+#include "threads/Event.h"
+#include "threads/Thread.h"
+#include "utils/Variant.h"
+#include <deque>
+#include <string>
 #include <vector>
+#include <boost/shared_ptr.hpp>
 
 namespace ANNOUNCEMENT
 {
   class CAnnouncementManager
   {
   public:
-    static void AddAnnouncer(IAnnouncer *listener);
+    static void AddAnnouncer(IAnnouncer *listener, AnnouncerPolicy policy = DropOldest);
     static void RemoveAnnouncer(IAnnouncer *listener);
     static void Announce(AnnouncementFlag flag, const char *sender, const char *message);
     static void Announce(AnnouncementFlag flag, const char *sender, const char *message, CVariant &data);
     static void Announce(AnnouncementFlag flag, const char *sender, const char *message, CFileItemPtr item);
     static void Announce(AnnouncementFlag flag, const char *sender, const char *message, CFileItemPtr item, CVariant &data);
   private:
-    static std::vector<IAnnouncer *> m_announcers;
+    class CAnnouncement
+    {
+    public:
+      CAnnouncement(AnnouncementFlag flag, const char *sender, const char *message, const CVariant &data)
+        : m_flag(flag), m_sender(sender), m_message(message), m_data(data) {};
+      AnnouncementFlag m_flag;
+      std::string      m_sender;
+      std::string      m_message;
+      CVariant         m_data;
+    };
+    typedef boost::shared_ptr<CAnnouncement> AnnouncementPtr;
+
+    /*!
+     \brief Delivers announcements to a single announcer on its own thread, so
+     a slow announcer only ever delays itself.
+     */
+    class CDispatcher : public CThread
+    {
+    public:
+      CDispatcher(IAnnouncer *announcer, AnnouncerPolicy policy);
+      virtual ~CDispatcher();
+
+      /*!
+       \brief Queue an announcement for delivery
+       \return false if the announcer fell too far behind and is to be disconnected
+       */
+      bool Queue(const AnnouncementPtr &announcement);
+      void Retire();
+      IAnnouncer *GetAnnouncer() const { return m_announcer; };
+    protected:
+      virtual void Process();
+    private:
+      bool Coalesce(const AnnouncementPtr &announcement);
+
+      IAnnouncer                 *m_announcer;
+      AnnouncerPolicy             m_policy;
+      CCriticalSection            m_queueSection;
+      std::deque<AnnouncementPtr> m_queue;
+      CEvent                      m_queueEvent;
+      bool                        m_retired;
+      unsigned int                m_dropped;
+      unsigned int                m_delivered;
+      unsigned int                m_totalTime;
+      unsigned int                m_maxTime;
+    };
+
+    static void ReapRetired();
+
+    static std::vector<CDispatcher *> m_announcers;
+    static std::vector<CDispatcher *> m_retired;
     static CCriticalSection m_critSection;
   };
 }
@@ -68,6 +68,15 @@ namespace ANNOUNCEMENT
     }
   }
 
+  /*!
+   \brief What to do with a consumer that can't keep up with its announcements
+   */
+  enum AnnouncerPolicy
+  {
+    DropOldest,   ///< discard the oldest queued announcement to make room
+    Disconnect    ///< stop delivering to the consumer altogether
+  };
+
   class IAnnouncer
   {
   public:
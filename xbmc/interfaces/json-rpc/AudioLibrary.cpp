@@ -198,6 +198,29 @@ JSONRPC_STATUS CAudioLibrary::GetSongs(const CStdString &method, ITransportLayer
   if (!ParseSorting(parameterObject, sorting.sortBy, sorting.sortOrder, sorting.sortAttributes))
     return InvalidParams;
 
+  std::set<std::string> properties;
+  for (CVariant::const_iterator_array itr = parameterObject["properties"].begin_array(); itr != parameterObject["properties"].end_array(); itr++)
+    properties.insert(itr->asString());
+
+  // plain library columns can go straight from the database into the result
+  if (CMusicDatabase::CanGetSongObjects(properties))
+  {
+    if (albumID > 0)
+      musicUrl.AddOption("albumid", albumID);
+    if (genreID > 0)
+      musicUrl.AddOption("genreid", genreID);
+    if (artistID > 0)
+      musicUrl.AddOption("artistid", artistID);
+
+    CVariant songs;
+    int total = 0;
+    if (!musicdatabase.GetSongObjects(musicUrl.ToString(), properties, sorting, songs, total))
+      return InternalError;
+
+    HandleObjectList("songs", songs, parameterObject, result, total);
+    return OK;
+  }
+
   CFileItemList items;
   if (!musicdatabase.GetSongsNav(musicUrl.ToString(), items, genreID, artistID, albumID, sorting))
     return InternalError;
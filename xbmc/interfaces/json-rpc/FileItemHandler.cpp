@@ -210,6 +210,21 @@ void CFileItemHandler::HandleFileItemList(const char *ID, bool allowFile, const
   }
 }
 
+void CFileItemHandler::HandleObjectList(const char *resultname, CVariant &objects, const CVariant &parameterObject, CVariant &result, int size)
+{
+  int start = (int)parameterObject["limits"]["start"].asInteger();
+  int end   = (int)parameterObject["limits"]["end"].asInteger();
+  end = (end <= 0 || end > size) ? size : end;
+  start = start > end ? end : start;
+
+  result["limits"]["start"] = start;
+  result["limits"]["end"]   = end;
+  result["limits"]["total"] = size;
+
+  if (objects.size() > 0)
+    result[resultname].swap(objects);
+}
+
 void CFileItemHandler::HandleFileItem(const char *ID, bool allowFile, const char *resultname, CFileItemPtr item, const CVariant &parameterObject, const CVariant &validFields, CVariant &result, bool append /* = true */)
 {
   CVariant object;
@@ -34,6 +34,11 @@ namespace JSONRPC
     static void HandleFileItemList(const char *ID, bool allowFile, const char *resultname, CFileItemList &items, const CVariant &parameterObject, CVariant &result, bool sortLimit = true);
     static void HandleFileItemList(const char *ID, bool allowFile, const char *resultname, CFileItemList &items, const CVariant &parameterObject, CVariant &result, int size, bool sortLimit = true);
     static void HandleFileItem(const char *ID, bool allowFile, const char *resultname, CFileItemPtr item, const CVariant &parameterObject, const CVariant &validFields, CVariant &result, bool append = true);
+    /*!
+     \brief Adds already serialized and limited objects (e.g. from CVideoDatabase::GetMovieObjects())
+     to the result the same way HandleFileItemList() does for a CFileItemList
+     */
+    static void HandleObjectList(const char *resultname, CVariant &objects, const CVariant &parameterObject, CVariant &result, int size);
 
     static bool FillFileItemList(const CVariant &parameterObject, CFileItemList &list);
 
@@ -23,7 +23,7 @@
 namespace JSONRPC
 {
   const char* const JSONRPC_SERVICE_ID          = "http://www.xbmc.org/jsonrpc/ServiceDescription.json";
-  const int         JSONRPC_SERVICE_VERSION     = 5;
+  const int         JSONRPC_SERVICE_VERSION     = 6;
   const char* const JSONRPC_SERVICE_DESCRIPTION = "JSON-RPC API of XBMC";
 
   const char* const JSONRPC_SERVICE_TYPES[] = {  
@@ -2661,6 +2661,15 @@ namespace JSONRPC
       "],"
       "\"returns\": null"
     "}",
+    "\"AudioLibrary.OnCleanFinished\": {"
+      "\"type\": \"notification\","
+      "\"description\": \"Cleaning the audio library has been finished.\","
+      "\"params\": ["
+        "{ \"name\": \"sender\", \"type\": \"string\", \"required\": true },"
+        "{ \"name\": \"data\", \"type\": \"null\", \"required\": true }"
+      "],"
+      "\"returns\": null"
+    "}",
     "\"VideoLibrary.OnUpdate\": {"
       "\"type\": \"notification\","
       "\"description\": \"A video item has been updated.\","
@@ -2699,6 +2708,15 @@ namespace JSONRPC
       "],"
       "\"returns\": null"
     "}",
+    "\"VideoLibrary.OnCleanFinished\": {"
+      "\"type\": \"notification\","
+      "\"description\": \"Cleaning the video library has been finished.\","
+      "\"params\": ["
+        "{ \"name\": \"sender\", \"type\": \"string\", \"required\": true },"
+        "{ \"name\": \"data\", \"type\": \"null\", \"required\": true }"
+      "],"
+      "\"returns\": null"
+    "}",
     "\"System.OnQuit\": {"
       "\"type\": \"notification\","
       "\"description\": \"XBMC will be closed.\","
@@ -24,6 +24,9 @@
 #include "Util.h"
 #include "utils/URIUtils.h"
 #include "video/VideoDatabase.h"
+#include "TextureCache.h"
+#include "ThumbLoader.h"
+#include "video/VideoInfoScanner.h"
 
 using namespace JSONRPC;
 
@@ -67,6 +70,30 @@ JSONRPC_STATUS CVideoLibrary::GetMovies(const CStdString &method, ITransportLaye
   if (setID < 0)
     setID = 0;
 
+  std::set<std::string> properties;
+  for (CVariant::const_iterator_array itr = parameterObject["properties"].begin_array(); itr != parameterObject["properties"].end_array(); itr++)
+    properties.insert(itr->asString());
+
+  // plain library columns can go straight from the database into the result
+  if (CVideoDatabase::CanGetMovieObjects(properties))
+  {
+    if (genreID > 0)
+      videoUrl.AddOption("genreid", genreID);
+    else if (year > 0)
+      videoUrl.AddOption("year", year);
+    else if (setID > 0)
+      videoUrl.AddOption("setid", setID);
+
+    CVariant movies;
+    int total = 0;
+    if (!videodatabase.GetMovieObjects(videoUrl.ToString(), properties, sorting, movies, total))
+      return InvalidParams;
+
+    FillMissingMovieArt(movies, properties.find("thumbnail") != properties.end(), properties.find("fanart") != properties.end(), videodatabase);
+    HandleObjectList("movies", movies, parameterObject, result, total);
+    return OK;
+  }
+
   CFileItemList items;
   if (!videodatabase.GetMoviesNav(videoUrl.ToString(), items, genreID, year, -1, -1, -1, -1, setID, -1, sorting))
     return InvalidParams;
@@ -750,6 +777,57 @@ JSONRPC_STATUS CVideoLibrary::GetAdditionalMovieDetails(const CVariant &paramete
   return OK;
 }
 
+void CVideoLibrary::FillMissingMovieArt(CVariant &movies, bool thumbnail, bool fanart, CVideoDatabase &videodatabase)
+{
+  if (!thumbnail && !fanart)
+    return;
+
+  // movies without artwork in the library get the local artwork HandleFileItem() would find
+  std::vector<int> idMovies;
+  for (CVariant::const_iterator_array itr = movies.begin_array(); itr != movies.end_array(); itr++)
+  {
+    if ((thumbnail && !itr->isMember("thumbnail")) || (fanart && !itr->isMember("fanart")))
+      idMovies.push_back((int)(*itr)["movieid"].asInteger());
+  }
+  if (idMovies.empty())
+    return;
+
+  // they are known to have no art rows, so skip the library lookup CVideoThumbLoader would
+  // do and only read what's needed to find the local art, for all of them at once
+  std::map<int, CVideoInfoTag> details;
+  if (!videodatabase.GetMoviesForLocalArt(idMovies, details))
+    return;
+
+  // movies mostly share a handful of source paths, so look each scraper up once
+  std::map<CStdString, std::pair<ADDON::ScraperPtr, VIDEO::SScanSettings> > scrapers;
+  VIDEO::CVideoInfoScanner scanner;
+  for (CVariant::iterator_array itr = movies.begin_array(); itr != movies.end_array(); itr++)
+  {
+    if ((!thumbnail || itr->isMember("thumbnail")) && (!fanart || itr->isMember("fanart")))
+      continue;
+
+    std::map<int, CVideoInfoTag>::const_iterator movie = details.find((int)(*itr)["movieid"].asInteger());
+    if (movie == details.end())
+      continue;
+
+    std::map<CStdString, std::pair<ADDON::ScraperPtr, VIDEO::SScanSettings> >::iterator scraper = scrapers.find(movie->second.m_strPath);
+    if (scraper == scrapers.end())
+    {
+      VIDEO::SScanSettings settings;
+      ADDON::ScraperPtr info = videodatabase.GetScraperForPath(movie->second.m_strPath, settings);
+      scraper = scrapers.insert(std::make_pair(movie->second.m_strPath, std::make_pair(info, settings))).first;
+    }
+
+    CFileItem item(movie->second);
+    if (scraper->second.first)
+      scanner.GetArtwork(&item, scraper->second.first->Content(), scraper->second.second.parent_name_root, true);
+    if (thumbnail)
+      (*itr)["thumbnail"] = item.HasThumbnail() ? CTextureCache::GetWrappedImageURL(item.GetThumbnailImage()) : "";
+    if (fanart)
+      (*itr)["fanart"] = item.HasProperty("fanart_image") ? CTextureCache::GetWrappedImageURL(item.GetProperty("fanart_image").asString()) : "";
+  }
+}
+
 JSONRPC_STATUS CVideoLibrary::GetAdditionalEpisodeDetails(const CVariant &parameterObject, CFileItemList &items, CVariant &result, CVideoDatabase &videodatabase)
 {
   if (!videodatabase.Open())
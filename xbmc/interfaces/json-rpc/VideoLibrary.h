@@ -71,6 +71,7 @@ namespace JSONRPC
 
   private:
     static JSONRPC_STATUS GetAdditionalMovieDetails(const CVariant &parameterObject, CFileItemList &items, CVariant &result, CVideoDatabase &videodatabase);
+    static void FillMissingMovieArt(CVariant &movies, bool thumbnail, bool fanart, CVideoDatabase &videodatabase);
     static JSONRPC_STATUS GetAdditionalEpisodeDetails(const CVariant &parameterObject, CFileItemList &items, CVariant &result, CVideoDatabase &videodatabase);
     static JSONRPC_STATUS GetAdditionalMusicVideoDetails(const CVariant &parameterObject, CFileItemList &items, CVariant &result, CVideoDatabase &videodatabase);
     static JSONRPC_STATUS RemoveVideo(const CVariant &parameterObject);
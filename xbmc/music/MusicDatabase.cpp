@@ -53,6 +53,7 @@
 #include "storage/MediaManager.h"
 #include "settings/Settings.h"
 #include "utils/StringUtils.h"
+#include "utils/Variant.h"
 #include "guilib/LocalizeStrings.h"
 #include "utils/log.h"
 #include "utils/TimeUtils.h"
@@ -2334,6 +2335,8 @@ int CMusicDatabase::Cleanup(CGUIDialogProgress *pDlgProgress)
   time = XbmcThreads::SystemClockMillis() - time;
   CLog::Log(LOGNOTICE, "%s: Cleaning musicdatabase done. Operation took %s", __FUNCTION__, StringUtils::SecondsToTimeString(time / 1000).c_str());
 
+  ANNOUNCEMENT::CAnnouncementManager::Announce(ANNOUNCEMENT::AudioLibrary, "xbmc", "OnCleanFinished");
+
   if (!Compress(false))
   {
     return ERROR_COMPRESSING;
@@ -3175,6 +3178,256 @@ bool CMusicDatabase::GetSongsByWhere(const CStdString &baseDir, const Filter &fi
   return false;
 }
 
+// number of songs read per query by GetSongObjects()
+#define SONG_OBJECTS_PAGE_SIZE 500
+
+typedef enum
+{
+  SongObjectString,
+  SongObjectInt,
+  SongObjectArray,
+  SongObjectList,     ///< like SongObjectArray but empty for an empty value (see CMusicInfoTag::SetGenre())
+  SongObjectTrack,
+  SongObjectDisc,
+  SongObjectRating,
+  SongObjectDateTime
+} SongObjectType;
+
+typedef struct
+{
+  const char*    property; ///< JSON-RPC property
+  const char*    column;   ///< songview column holding its value
+  SongObjectType type;     ///< how the value is converted
+} SSongObjectColumn;
+
+static const SSongObjectColumn SongObjectColumns[] =
+{
+  { "title",                    "strTitle",                    SongObjectString },
+  { "artist",                   "strArtists",                  SongObjectArray },
+  { "genre",                    "strGenres",                   SongObjectList },
+  { "album",                    "strAlbum",                    SongObjectString },
+  { "albumid",                  "idAlbum",                     SongObjectInt },
+  { "duration",                 "iDuration",                   SongObjectInt },
+  { "track",                    "iTrack",                      SongObjectTrack },
+  { "disc",                     "iTrack",                      SongObjectDisc },
+  { "year",                     "iYear",                       SongObjectInt },
+  { "musicbrainztrackid",       "strMusicBrainzTrackID",       SongObjectString },
+  { "musicbrainzartistid",      "strMusicBrainzArtistID",      SongObjectString },
+  { "musicbrainzalbumid",       "strMusicBrainzAlbumID",       SongObjectString },
+  { "musicbrainzalbumartistid", "strMusicBrainzAlbumArtistID", SongObjectString },
+  { "musicbrainztrmid",         "strMusicBrainzTRMID",         SongObjectString },
+  { "comment",                  "comment",                     SongObjectString },
+  { "rating",                   "rating",                      SongObjectRating },
+  { "playcount",                "iTimesPlayed",                SongObjectInt },
+  { "lastplayed",               "lastplayed",                  SongObjectDateTime }
+};
+
+#define NUM_SONG_OBJECT_COLUMNS (sizeof(SongObjectColumns) / sizeof(SongObjectColumns[0]))
+
+static const SSongObjectColumn* GetSongObjectColumn(const string &property)
+{
+  for (unsigned int i = 0; i < NUM_SONG_OBJECT_COLUMNS; i++)
+  {
+    if (property == SongObjectColumns[i].property)
+      return &SongObjectColumns[i];
+  }
+  return NULL;
+}
+
+bool CMusicDatabase::CanGetSongObjects(const set<string> &properties)
+{
+  for (set<string>::const_iterator it = properties.begin(); it != properties.end(); ++it)
+  {
+    if (*it != "file" && GetSongObjectColumn(*it) == NULL)
+      return false;
+  }
+  return true;
+}
+
+bool CMusicDatabase::GetSongObjects(const CStdString &baseDir, const set<string> &properties, const SortDescription &sortDescription, CVariant &songs, int &total)
+{
+  if (m_pDB.get() == NULL || m_pDS.get() == NULL)
+    return false;
+
+  try
+  {
+    unsigned int time = XbmcThreads::SystemClockMillis();
+    songs = CVariant(CVariant::VariantTypeArray);
+    total = 0;
+
+    Filter extFilter;
+    CMusicDbUrl musicUrl;
+    if (!musicUrl.FromString(baseDir) || !GetFilter(musicUrl, extFilter))
+      return false;
+
+    // if there are extra WHERE conditions we might need access
+    // to songview for these conditions
+    if (extFilter.where.find("albumview") != string::npos)
+    {
+      extFilter.AppendJoin("JOIN albumview ON albumview.idAlbum = songview.idAlbum");
+      extFilter.AppendGroup("songview.idSong");
+    }
+
+    CStdString strSQLExtra;
+    if (!BuildSQL(strSQLExtra, extFilter, strSQLExtra))
+      return false;
+
+    // sort and limit the matching songs using only the columns needed for sorting
+    FieldList sortFields;
+    if (!DatabaseUtils::GetSelectFields(SortUtils::GetFieldsForSorting(sortDescription.sortBy), MediaTypeSong, sortFields))
+      sortFields.clear();
+
+    CStdString strSQL = "SELECT songview.idSong";
+    for (FieldList::const_iterator field = sortFields.begin(); field != sortFields.end(); ++field)
+      strSQL += ", " + DatabaseUtils::GetField(*field, MediaTypeSong, DatabaseQueryPartSelect);
+    strSQL += " FROM songview " + strSQLExtra;
+
+    if (!m_pDS->query(strSQL.c_str()))
+      return false;
+
+    DatabaseResults results;
+    results.reserve(m_pDS->num_rows());
+    const dbiplus::query_data &data = m_pDS->get_result_set().records;
+    for (unsigned int row = 0; row < data.size(); row++)
+    {
+      DatabaseResult result;
+      result[FieldRow] = row;
+      result[FieldId] = data[row]->at(0).get_asInt();
+      unsigned int column = 1;
+      for (FieldList::const_iterator field = sortFields.begin(); field != sortFields.end(); ++field)
+        DatabaseUtils::GetFieldValue(data[row]->at(column++), result[*field]);
+      result[FieldMediaType] = MediaTypeSong;
+      if (result.find(FieldTrackNumber) != result.end() && result.find(FieldTitle) != result.end())
+      {
+        CStdString label;
+        label.Format("%d. %s", (int)result[FieldTrackNumber].asInteger(), result[FieldTitle].asString().c_str());
+        result[FieldLabel] = label;
+      }
+      results.push_back(result);
+    }
+    m_pDS->close();
+
+    total = (int)results.size();
+    SortUtils::Sort(sortDescription, results);
+    if (results.empty())
+      return true;
+
+    // work out the columns holding the requested properties
+    vector< pair<const SSongObjectColumn*, unsigned int> > columns;
+    CStdString strColumns = "idSong, strTitle";
+    unsigned int numColumns = 2;
+    int fileIndex = -1;
+    for (set<string>::const_iterator it = properties.begin(); it != properties.end(); ++it)
+    {
+      if (*it == "file")
+      {
+        strColumns += ", strPath, strFileName";
+        fileIndex = numColumns;
+        numColumns += 2;
+        continue;
+      }
+
+      const SSongObjectColumn *column = GetSongObjectColumn(*it);
+      if (column == NULL)
+        return false;
+
+      strColumns.AppendFormat(", %s", column->column);
+      columns.push_back(make_pair(column, numColumns++));
+    }
+
+    // read the properties a page at a time and convert them straight into objects
+    for (size_t start = 0; start < results.size(); start += SONG_OBJECTS_PAGE_SIZE)
+    {
+      size_t end = std::min(results.size(), start + SONG_OBJECTS_PAGE_SIZE);
+      CStdString ids;
+      for (size_t i = start; i < end; i++)
+        ids.AppendFormat("%s%d", i > start ? "," : "", (int)results[i].at(FieldId).asInteger());
+
+      map<int, CVariant> page;
+      strSQL = "SELECT " + strColumns + " FROM songview WHERE idSong IN (" + ids + ")";
+      if (!m_pDS->query(strSQL.c_str()))
+        return false;
+
+      while (!m_pDS->eof())
+      {
+        const dbiplus::sql_record* const record = m_pDS->get_sql_record();
+        int idSong = record->at(0).get_asInt();
+        CVariant &song = page[idSong];
+        song["songid"] = idSong;
+        song["label"] = record->at(1).get_asString();
+
+        for (vector< pair<const SSongObjectColumn*, unsigned int> >::const_iterator column = columns.begin(); column != columns.end(); ++column)
+        {
+          const dbiplus::field_value &value = record->at(column->second);
+          switch (column->first->type)
+          {
+          case SongObjectString:
+            song[column->first->property] = value.get_asString();
+            break;
+          case SongObjectInt:
+            song[column->first->property] = value.get_asInt();
+            break;
+          case SongObjectArray:
+            song[column->first->property] = StringUtils::Split(value.get_asString(), g_advancedSettings.m_musicItemSeparator);
+            break;
+          case SongObjectList:
+          {
+            CStdString values = value.get_asString();
+            song[column->first->property] = values.empty() ? vector<string>() : StringUtils::Split(values, g_advancedSettings.m_musicItemSeparator);
+            break;
+          }
+          case SongObjectTrack:
+            song[column->first->property] = value.get_asInt() & 0xffff;
+            break;
+          case SongObjectDisc:
+            song[column->first->property] = value.get_asInt() >> 16;
+            break;
+          case SongObjectRating:
+            song[column->first->property] = (int)(value.get_asChar() - '0');
+            break;
+          case SongObjectDateTime:
+          {
+            CDateTime dateTime;
+            dateTime.SetFromDBDateTime(value.get_asString());
+            song[column->first->property] = dateTime.IsValid() ? dateTime.GetAsDBDateTime() : StringUtils::EmptyString;
+            break;
+          }
+          }
+        }
+
+        if (fileIndex >= 0)
+        {
+          CStdString file;
+          URIUtils::AddFileToFolder(record->at(fileIndex).get_asString(), record->at(fileIndex + 1).get_asString(), file);
+          song["file"] = file;
+        }
+        m_pDS->next();
+      }
+      m_pDS->close();
+
+      for (size_t i = start; i < end; i++)
+      {
+        map<int, CVariant>::iterator song = page.find((int)results[i].at(FieldId).asInteger());
+        if (song == page.end())
+          continue;
+        songs.push_back(CVariant(CVariant::VariantTypeNull));
+        songs[songs.size() - 1].swap(song->second);
+      }
+    }
+
+    unsigned int elapsed = XbmcThreads::SystemClockMillis() - time;
+    CLog::Log(LOGDEBUG, "%s(%s) - %u of %d songs with %u properties in %u ms (%.0f rows/s)", __FUNCTION__, baseDir.c_str(),
+              (unsigned int)songs.size(), total, (unsigned int)properties.size(), elapsed, songs.size() * 1000.0 / std::max(elapsed, 1U));
+    return true;
+  }
+  catch (...)
+  {
+    m_pDS->close();
+    CLog::Log(LOGERROR, "%s(%s) failed", __FUNCTION__, baseDir.c_str());
+  }
+  return false;
+}
+
 bool CMusicDatabase::GetSongsByYear(const CStdString& baseDir, CFileItemList& items, int year)
 {
   CMusicDbUrl musicUrl;
@@ -31,6 +31,7 @@
 
 class CArtist;
 class CFileItem;
+class CVariant;
 
 namespace dbiplus
 {
@@ -159,6 +160,24 @@ public:
   bool GetSongsByYear(const CStdString& baseDir, CFileItemList& items, int year);
   bool GetSongsByWhere(const CStdString &baseDir, const Filter &filter, CFileItemList& items, const SortDescription &sortDescription = SortDescription());
   bool GetAlbumsByWhere(const CStdString &baseDir, const Filter &filter, CFileItemList &items, const SortDescription &sortDescription = SortDescription());
+
+  /*! \brief Retrieve sorted and limited songs straight into JSON-RPC objects
+   Sorts and limits on the sort columns only and then reads the requested properties of the
+   remaining songs page by page, without building CFileItems.
+   \param baseDir musicdb:// url of the songs node, including any filter options
+   \param properties JSON-RPC properties to retrieve (see CanGetSongObjects())
+   \param sortDescription sorting and limits to apply
+   \param songs array of song objects in sort order
+   \param total number of songs matching the filter before applying the limits
+   \return true on success, false otherwise
+   \sa CanGetSongObjects
+   */
+  bool GetSongObjects(const CStdString &baseDir, const std::set<std::string> &properties, const SortDescription &sortDescription, CVariant &songs, int &total);
+
+  /*! \brief Whether GetSongObjects() can provide the given properties
+   Artwork, album artists and lyrics aren't part of songview and aren't supported.
+   */
+  static bool CanGetSongObjects(const std::set<std::string> &properties);
   bool GetArtistsByWhere(const CStdString& strBaseDir, const Filter &filter, CFileItemList& items, const SortDescription &sortDescription = SortDescription());
   bool GetRandomSong(CFileItem* item, int& idSong, const Filter &filter);
   int GetKaraokeSongsCount();
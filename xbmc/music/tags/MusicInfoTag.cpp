@@ -22,6 +22,7 @@
 #include "MusicInfoTag.h"
 #include "music/Album.h"
 #include "utils/StringUtils.h"
+#include "utils/StringPool.h"
 #include "settings/AdvancedSettings.h"
 #include "utils/Variant.h"
 
@@ -275,6 +276,7 @@ void CMusicInfoTag::SetArtist(const CStdString& strArtist)
 void CMusicInfoTag::SetArtist(const std::vector<std::string>& artists)
 {
   m_artist = artists;
+  CStringPool::Intern(m_artist);
 }
 
 void CMusicInfoTag::SetAlbum(const CStdString& strAlbum)
@@ -298,6 +300,7 @@ void CMusicInfoTag::SetAlbumArtist(const CStdString& strAlbumArtist)
 void CMusicInfoTag::SetAlbumArtist(const std::vector<std::string>& albumArtists)
 {
   m_albumArtist = albumArtists;
+  CStringPool::Intern(m_albumArtist);
 }
 
 void CMusicInfoTag::SetGenre(const CStdString& strGenre)
@@ -311,6 +314,7 @@ void CMusicInfoTag::SetGenre(const CStdString& strGenre)
 void CMusicInfoTag::SetGenre(const std::vector<std::string>& genres)
 {
   m_genre = genres;
+  CStringPool::Intern(m_genre);
 }
 
 void CMusicInfoTag::SetYear(int year)
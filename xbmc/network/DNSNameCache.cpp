@@ -21,21 +21,39 @@
 
 #include "DNSNameCache.h"
 #include "threads/SingleLock.h"
+#include "threads/SystemClock.h"
 #include "utils/log.h"
 
+#include <sys/socket.h>
 #include <netinet/in.h>
 #include <arpa/inet.h>
 #include <netdb.h>
 
-CDNSNameCache g_DNSCache;
+// how long a successful lookup is trusted
+#define DNS_POSITIVE_TTL   300000
+// how long a failed lookup is remembered, so a dead host doesn't stall every access
+#define DNS_NEGATIVE_TTL    30000
+// the longest a caller of Lookup() waits for the resolver
+#define DNS_LOOKUP_TIMEOUT   5000
+#define DNS_RESOLVER_THREADS    2
 
+// defined ahead of g_DNSCache so it outlives the cache's destructor at exit
 CCriticalSection CDNSNameCache::m_critical;
 
+CDNSNameCache g_DNSCache;
+
 CDNSNameCache::CDNSNameCache(void)
-{}
+{
+  m_stopping = false;
+  m_hits = 0;
+  m_misses = 0;
+  m_negativeHits = 0;
+}
 
 CDNSNameCache::~CDNSNameCache(void)
-{}
+{
+  Deinitialize();
+}
 
 bool CDNSNameCache::Lookup(const CStdString& strHostName, CStdString& strIpAddress)
 {
@@ -48,76 +66,238 @@ bool CDNSNameCache::Lookup(const CStdString& strHostName, CStdString& strIpAddre
   }
 
   // check if there's a custom entry or if it's already cached
-  if(g_DNSCache.GetCached(strHostName, strIpAddress))
-    return true;
+  bool negative = false;
+  if (GetCached(strHostName, strIpAddress, negative))
+    return !negative;
 
-#ifndef _WIN32
-  // perform netbios lookup (win32 is handling this via gethostbyname)
-  char nmb_ip[100];
-  char line[200];
+  PendingPtr pending = g_DNSCache.QueueLookup(strHostName);
+  if (!pending)
+  {
+    // resolvers are shut down, so resolve on the calling thread
+    if (Resolve(strHostName, strIpAddress))
+      return true;
+    CLog::Log(LOGERROR, "Unable to lookup host: '%s'", strHostName.c_str());
+    return false;
+  }
 
-  CStdString cmd = "nmblookup " + strHostName;
-  FILE* fp = popen(cmd, "r");
-  if (fp)
+  if (!pending->m_done.WaitMSec(DNS_LOOKUP_TIMEOUT))
   {
-    while (fgets(line, sizeof line, fp))
+    CLog::Log(LOGWARNING, "Timed out looking up host: '%s'", strHostName.c_str());
+    return false;
+  }
+
+  CSingleLock lock(m_critical);
+  if (!pending->m_resolved)
+    return false;
+  strIpAddress = pending->m_strIpAddress;
+  return true;
+}
+
+void CDNSNameCache::Prefetch(const CStdString& strHostName)
+{
+  if (strHostName.IsEmpty() || inet_addr(strHostName.c_str()) != INADDR_NONE)
+    return;
+
+  CStdString strIpAddress;
+  bool negative = false;
+  if (!GetCached(strHostName, strIpAddress, negative))
+    g_DNSCache.QueueLookup(strHostName);
+}
+
+bool CDNSNameCache::GetCached(const CStdString& strHostName, CStdString& strIpAddress, bool &negative)
+{
+  CStdString key(strHostName);
+  key.ToLower();
+
+  CSingleLock lock(m_critical);
+
+  NameIndex::const_iterator it = g_DNSCache.m_names.find(key);
+  if (it != g_DNSCache.m_names.end())
+  {
+    const CDNSName &name = it->second;
+    if (name.m_permanent || (int)(name.m_expires - XbmcThreads::SystemClockMillis()) > 0)
     {
-      if (sscanf(line, "%99s *<00>\n", nmb_ip))
-      {
-        if (inet_addr(nmb_ip) != INADDR_NONE)
-          strIpAddress = nmb_ip;
-      }
+      negative = name.m_strIpAddress.IsEmpty();
+      if (negative)
+        g_DNSCache.m_negativeHits++;
+      else
+        g_DNSCache.m_hits++;
+      strIpAddress = name.m_strIpAddress;
+      return true;
     }
   }
-  pclose(fp);
 
-  if (!strIpAddress.IsEmpty())
+  // not cached, or stale
+  g_DNSCache.m_misses++;
+  return false;
+}
+
+void CDNSNameCache::Add(const CStdString &strHostName, const CStdString &strIpAddress)
+{
+  CStdString key(strHostName);
+  key.ToLower();
+
+  CSingleLock lock(m_critical);
+  CDNSName &name = g_DNSCache.m_names[key];
+  name.m_strIpAddress = strIpAddress;
+  name.m_permanent = true;
+}
+
+void CDNSNameCache::GetStats(unsigned int &hits, unsigned int &misses, unsigned int &negativeHits)
+{
+  CSingleLock lock(m_critical);
+  hits = g_DNSCache.m_hits;
+  misses = g_DNSCache.m_misses;
+  negativeHits = g_DNSCache.m_negativeHits;
+}
+
+void CDNSNameCache::Deinitialize()
+{
+  std::vector<CResolver*> resolvers;
   {
-    g_DNSCache.Add(strHostName, strIpAddress);
-    return true;
+    CSingleLock lock(m_critical);
+    g_DNSCache.m_stopping = true;
+    g_DNSCache.m_queue.clear();
+    resolvers.swap(g_DNSCache.m_resolvers);
   }
-#endif
 
-  // perform dns lookup
-  struct hostent *host = gethostbyname(strHostName.c_str());
-  if (host && host->h_addr_list[0])
+  for (unsigned int i = 0; i < resolvers.size(); i++)
+    resolvers[i]->StopThread(false);
+  for (unsigned int i = 0; i < resolvers.size(); i++)
   {
-    strIpAddress.Format("%d.%d.%d.%d", (unsigned char)host->h_addr_list[0][0], (unsigned char)host->h_addr_list[0][1], (unsigned char)host->h_addr_list[0][2], (unsigned char)host->h_addr_list[0][3]);
-    g_DNSCache.Add(strHostName, strIpAddress);
-    return true;
+    resolvers[i]->StopThread(true);
+    delete resolvers[i];
   }
 
-  CLog::Log(LOGERROR, "Unable to lookup host: '%s'", strHostName.c_str());
-  return false;
+  // wake anyone still waiting on an abandoned lookup
+  CSingleLock lock(m_critical);
+  for (PendingIndex::iterator it = g_DNSCache.m_pending.begin(); it != g_DNSCache.m_pending.end(); ++it)
+    it->second->m_done.Set();
+  g_DNSCache.m_pending.clear();
 }
 
-bool CDNSNameCache::GetCached(const CStdString& strHostName, CStdString& strIpAddress)
+CDNSNameCache::PendingPtr CDNSNameCache::QueueLookup(const CStdString& strHostName)
 {
+  CStdString key(strHostName);
+  key.ToLower();
+
   CSingleLock lock(m_critical);
+  if (m_stopping)
+    return PendingPtr();
+
+  // coalesce with a lookup already in flight for this host
+  PendingIndex::iterator it = m_pending.find(key);
+  if (it != m_pending.end())
+    return it->second;
+
+  PendingPtr pending(new CPendingLookup);
+  m_pending.insert(std::make_pair(key, pending));
+  m_queue.push_back(key);
 
-  // loop through all DNSname entries and see if strHostName is cached
-  for (int i = 0; i < (int)g_DNSCache.m_vecDNSNames.size(); ++i)
+  if (m_resolvers.empty())
   {
-    CDNSName& DNSname = g_DNSCache.m_vecDNSNames[i];
-    if ( DNSname.m_strHostName == strHostName )
+    for (unsigned int i = 0; i < DNS_RESOLVER_THREADS; i++)
     {
-      strIpAddress = DNSname.m_strIpAddress;
-      return true;
+      CResolver *resolver = new CResolver(this);
+      resolver->Create();
+      m_resolvers.push_back(resolver);
     }
   }
+  m_queueEvent.Set();
+  return pending;
+}
 
-  // not cached
-  return false;
+bool CDNSNameCache::GetNextRequest(CStdString& strHostName)
+{
+  CSingleLock lock(m_critical);
+  if (m_queue.empty())
+    return false;
+  strHostName = m_queue.front();
+  m_queue.pop_front();
+  // hand the wakeup on if there's more work for the other resolvers
+  if (!m_queue.empty())
+    m_queueEvent.Set();
+  return true;
 }
 
-void CDNSNameCache::Add(const CStdString &strHostName, const CStdString &strIpAddress)
+void CDNSNameCache::Complete(const CStdString& strHostName, bool resolved, const CStdString& strIpAddress)
 {
-  CDNSName dnsName;
+  CSingleLock lock(m_critical);
 
-  dnsName.m_strHostName = strHostName;
-  dnsName.m_strIpAddress  = strIpAddress;
+  CDNSName &name = m_names[strHostName];
+  if (!name.m_permanent)
+  {
+    name.m_strIpAddress = resolved ? strIpAddress : "";
+    name.m_expires = XbmcThreads::SystemClockMillis() + (resolved ? DNS_POSITIVE_TTL : DNS_NEGATIVE_TTL);
+  }
 
-  CSingleLock lock(m_critical);
-  g_DNSCache.m_vecDNSNames.push_back(dnsName);
+  PendingIndex::iterator it = m_pending.find(strHostName);
+  if (it != m_pending.end())
+  {
+    it->second->m_resolved = resolved;
+    it->second->m_strIpAddress = strIpAddress;
+    it->second->m_done.Set();
+    m_pending.erase(it);
+  }
+}
+
+void CDNSNameCache::CResolver::Process()
+{
+  while (!m_bStop)
+  {
+    CStdString strHostName;
+    if (!m_cache->GetNextRequest(strHostName))
+    {
+      AbortableWait(m_cache->m_queueEvent, 1000);
+      continue;
+    }
+
+    CStdString strIpAddress;
+    bool resolved = Resolve(strHostName, strIpAddress);
+    if (!resolved)
+      CLog::Log(LOGERROR, "Unable to lookup host: '%s'", strHostName.c_str());
+    m_cache->Complete(strHostName, resolved, strIpAddress);
+  }
 }
 
+bool CDNSNameCache::Resolve(const CStdString& strHostName, CStdString& strIpAddress)
+{
+#ifndef _WIN32
+  // perform netbios lookup (win32 is handling this via getaddrinfo)
+  char nmb_ip[100];
+  char line[200];
+
+  CStdString cmd = "nmblookup " + strHostName;
+  FILE* fp = popen(cmd, "r");
+  if (fp)
+  {
+    while (fgets(line, sizeof line, fp))
+    {
+      if (sscanf(line, "%99s *<00>\n", nmb_ip))
+      {
+        if (inet_addr(nmb_ip) != INADDR_NONE)
+          strIpAddress = nmb_ip;
+      }
+    }
+    pclose(fp);
+  }
+
+  if (!strIpAddress.IsEmpty())
+    return true;
+#endif
+
+  // perform dns lookup - getaddrinfo rather than gethostbyname as several resolvers run at once
+  struct addrinfo hints;
+  struct addrinfo *result = NULL;
+  memset(&hints, 0, sizeof(hints));
+  hints.ai_family = AF_INET;
+  hints.ai_socktype = SOCK_STREAM;
+
+  if (getaddrinfo(strHostName.c_str(), NULL, &hints, &result) != 0 || !result)
+    return false;
+
+  const unsigned char *addr = (const unsigned char *)&((struct sockaddr_in *)result->ai_addr)->sin_addr;
+  strIpAddress.Format("%d.%d.%d.%d", addr[0], addr[1], addr[2], addr[3]);
+  freeaddrinfo(result);
+  return true;
+}
@@ -22,27 +22,100 @@
  */
 
 #include "utils/StdString.h"
+#include "threads/CriticalSection.h"
+#include "threads/Event.h"
+#include "threads/Thread.h"
 
+#include <deque>
+#include <string>
 #include <vector>
-
-class CCriticalSection;
+#include <boost/shared_ptr.hpp>
+#include <boost/unordered_map.hpp>
 
 class CDNSNameCache
 {
 public:
-  class CDNSName
-  {
-  public:
-    CStdString m_strHostName;
-    CStdString m_strIpAddress;
-  };
   CDNSNameCache(void);
   virtual ~CDNSNameCache(void);
+
+  /*! \brief Resolve a hostname to an IPv4 address
+   Answers from the cache when possible. Otherwise the lookup is handed to the
+   resolver threads and the caller waits at most the lookup timeout, sharing
+   the result with any other caller waiting on the same host.
+   \param strHostName host to resolve
+   \param strIpAddress [out] dotted quad address
+   \return true if the host was resolved
+   */
   static bool Lookup(const CStdString& strHostName, CStdString& strIpAddress);
+
+  /*! \brief Add a static entry that never expires (advancedsettings <hosts>)
+   */
   static void Add(const CStdString& strHostName, const CStdString& strIpAddress);
 
+  /*! \brief Queue a background lookup for a host without waiting on the result
+   */
+  static void Prefetch(const CStdString& strHostName);
+
+  /*! \brief Retrieve the cache hit/miss counters
+   \param hits lookups answered from a positive entry
+   \param misses lookups that had to go to the resolver
+   \param negativeHits lookups answered from a cached failure
+   */
+  static void GetStats(unsigned int &hits, unsigned int &misses, unsigned int &negativeHits);
+
+  /*! \brief Stop the resolver threads, abandoning any queued lookups
+   */
+  static void Deinitialize();
+
 protected:
-  static bool GetCached(const CStdString& strHostName, CStdString& strIpAddress);
+  class CDNSName
+  {
+  public:
+    CDNSName() : m_expires(0), m_permanent(false) {};
+    CStdString   m_strIpAddress; ///< empty for a negative entry
+    unsigned int m_expires;      ///< SystemClockMillis() at which the entry goes stale
+    bool         m_permanent;    ///< static entries never expire
+  };
+
+  /*! \brief A lookup that is in flight, shared by every caller waiting on it
+   */
+  class CPendingLookup
+  {
+  public:
+    CPendingLookup() : m_done(true), m_resolved(false) {};
+    CEvent     m_done;
+    bool       m_resolved;
+    CStdString m_strIpAddress;
+  };
+  typedef boost::shared_ptr<CPendingLookup> PendingPtr;
+
+  class CResolver : public CThread
+  {
+  public:
+    CResolver(CDNSNameCache *cache) : CThread("CDNSResolver"), m_cache(cache) {};
+  protected:
+    virtual void Process();
+    CDNSNameCache *m_cache;
+  };
+
+  static bool GetCached(const CStdString& strHostName, CStdString& strIpAddress, bool &negative);
+  static bool Resolve(const CStdString& strHostName, CStdString& strIpAddress);
+  PendingPtr QueueLookup(const CStdString& strHostName);
+  bool GetNextRequest(CStdString& strHostName);
+  void Complete(const CStdString& strHostName, bool resolved, const CStdString& strIpAddress);
+
   static CCriticalSection m_critical;
-  std::vector<CDNSName> m_vecDNSNames;
+
+  typedef boost::unordered_map<std::string, CDNSName> NameIndex;
+  typedef boost::unordered_map<std::string, PendingPtr> PendingIndex;
+  NameIndex                m_names;
+  PendingIndex             m_pending;
+  std::deque<std::string>  m_queue;
+  CEvent                   m_queueEvent;
+  std::vector<CResolver*>  m_resolvers;
+  bool                     m_stopping;
+
+  unsigned int m_hits;
+  unsigned int m_misses;
+  unsigned int m_negativeHits;
 };
@@ -35,8 +35,10 @@
 #include "threads/SingleLock.h"
 #include "Zeroconf.h"
 #include "guilib/GUIAudioManager.h"
+#include "utils/TimeUtils.h"
 #include <map>
 #include <queue>
+#include <set>
 
 using namespace EVENTSERVER;
 using namespace EVENTPACKET;
@@ -44,6 +46,13 @@ using namespace EVENTCLIENT;
 using namespace SOCKETS;
 using namespace std;
 
+// max. number of datagrams fetched from the socket in one go
+#define ES_BATCH_SIZE   32
+// socket receive buffer, large enough to absorb bursts from high rate clients
+#define ES_RECV_BUFFER  (256 * 1024)
+// interval in seconds for the throughput/latency debug log
+#define ES_STATS_PERIOD 60
+
 /************************************************************************/
 /* CEventServer                                                         */
 /************************************************************************/
@@ -52,10 +61,22 @@ CEventServer::CEventServer() : CThread("CEventServer")
 {
   m_pSocket       = NULL;
   m_pPacketBuffer = NULL;
+  m_iBatchSize    = ES_BATCH_SIZE;
+  m_batchReceived = 0;
   m_bStop         = false;
   m_bRunning      = false;
   m_bRefreshSettings = false;
 
+  m_statStart        = 0;
+  m_statPackets      = 0;
+  m_statBatches      = 0;
+  m_statCoalesced    = 0;
+  m_statHandleTime   = 0;
+  m_statHandleMax    = 0;
+  m_statActions      = 0;
+  m_statDispatchTime = 0;
+  m_statDispatchMax  = 0;
+
   // default timeout in ms for receiving a single packet
   m_iListenTimeout = 1000;
 }
@@ -133,6 +154,11 @@ void CEventServer::Cleanup()
     m_clients.erase(iter);
     iter =  m_clients.begin();
   }
+  lock.Leave();
+
+  CSingleLock actionLock(m_actionSection);
+  while (!m_actionQueue.empty())
+    m_actionQueue.pop();
 }
 
 int CEventServer::GetNumberOfClients()
@@ -155,7 +181,6 @@ void CEventServer::Run()
 {
   CAddress any_addr;
   CSocketListener listener;
-  int packetSize = 0;
   std::map<std::string, std::string> txt;  
 
   CLog::Log(LOGNOTICE, "ES: Starting UDP Event server on %s:%d", any_addr.Address(), m_iPort);
@@ -169,7 +194,9 @@ void CEventServer::Run()
     CLog::Log(LOGERROR, "ES: Could not create socket, aborting!");
     return;
   }
-  m_pPacketBuffer = (unsigned char *)malloc(PACKET_SIZE);
+  m_pPacketBuffer = (unsigned char *)malloc(PACKET_SIZE * m_iBatchSize);
+  m_packetAddrs.resize(m_iBatchSize);
+  m_packetSizes.resize(m_iBatchSize);
 
   if (!m_pPacketBuffer)
   {
@@ -190,6 +217,11 @@ void CEventServer::Run()
     return;
   }
 
+  // bursts of mouse packets easily overflow the default receive buffer
+  int rcvbuf = ES_RECV_BUFFER;
+  if (setsockopt(m_pSocket->Socket(), SOL_SOCKET, SO_RCVBUF, (const char*)&rcvbuf, sizeof(rcvbuf)) != 0)
+    CLog::Log(LOGWARNING, "ES: Could not enlarge the socket receive buffer");
+
   // publish service
   CZeroconf::GetInstance()->PublishService("servers.eventserver",
                                "_xbmc-events._udp",
@@ -201,18 +233,22 @@ void CEventServer::Run()
   listener.AddSocket(m_pSocket);
 
   m_bRunning = true;
+  m_statStart = CurrentHostCounter();
 
   while (!m_bStop)
   {
+    int packets = 0;
     try
     {
-      // start listening until we timeout
+      // start listening until we timeout, then drain everything queued so far
       if (listener.Listen(m_iListenTimeout))
       {
-        CAddress addr;
-        if ((packetSize = m_pSocket->Read(addr, PACKET_SIZE, (void *)m_pPacketBuffer)) > -1)
+        packets = m_pSocket->ReadBatch(&m_packetAddrs[0], &m_packetSizes[0], m_iBatchSize,
+                                       PACKET_SIZE, (void *)m_pPacketBuffer);
+        if (packets > 0)
         {
-          ProcessPacket(addr, packetSize);
+          m_batchReceived = CurrentHostCounter();
+          ProcessPackets(packets);
         }
       }
     }
@@ -225,9 +261,21 @@ void CEventServer::Run()
     // process events and queue the necessary actions and button codes
     ProcessEvents();
 
+    int64_t now = CurrentHostCounter();
+    if (packets > 0)
+    {
+      int64_t handled = now - m_batchReceived;
+      m_statHandleTime += handled * packets;
+      if (handled > m_statHandleMax)
+        m_statHandleMax = handled;
+      g_application.WakeUp(CApplication::WAKE_INPUT);
+    }
+
     // refresh client list
     RefreshClients();
 
+    LogStats(now);
+
     // broadcast
     // BroadcastBeacon();
   }
@@ -237,28 +285,71 @@ void CEventServer::Run()
   Cleanup();
 }
 
-void CEventServer::ProcessPacket(CAddress& addr, int pSize)
+void CEventServer::ProcessPackets(int count)
+{
+  vector<CEventPacket*> packets(count, (CEventPacket*)NULL);
+  for (int i = 0 ; i < count ; i++)
+    packets[i] = ParsePacket(m_packetSizes[i], m_pPacketBuffer + i * PACKET_SIZE);
+
+  // absolute mouse packets overwrite the position of the previous ones,
+  // so only the last one of each client within a batch needs handling
+  set<unsigned long> moved;
+  for (int i = count - 1 ; i >= 0 ; i--)
+  {
+    CEventPacket* packet = packets[i];
+    if (!packet || packet->Type() != PT_MOUSE || packet->Size() > 1 ||
+        packet->PayloadSize() < 1 || !(((unsigned char*)packet->Payload())[0] & PTM_ABSOLUTE))
+      continue;
+
+    if (!moved.insert(ClientToken(m_packetAddrs[i], packet)).second)
+    {
+      delete packet;
+      packets[i] = NULL;
+      m_statCoalesced++;
+    }
+  }
+
+  CSingleLock lock(m_critSection);
+  for (int i = 0 ; i < count ; i++)
+  {
+    if (packets[i])
+      AddPacket(m_packetAddrs[i], packets[i]);
+  }
+
+  m_statPackets += count;
+  m_statBatches++;
+}
+
+CEventPacket* CEventServer::ParsePacket(int pSize, unsigned char* buffer)
 {
   // check packet validity
-  CEventPacket* packet = new CEventPacket(pSize, m_pPacketBuffer);
+  CEventPacket* packet = new CEventPacket(pSize, buffer);
   if(packet == NULL)
   {
     CLog::Log(LOGERROR, "ES: Out of memory, cannot accept packet");
-    return;
+    return NULL;
   }
 
-  unsigned int clientToken;
-
   if (!packet->IsValid())
   {
     CLog::Log(LOGDEBUG, "ES: Received invalid packet");
     delete packet;
-    return;
+    return NULL;
   }
+  return packet;
+}
 
-  clientToken = packet->ClientToken();
+unsigned long CEventServer::ClientToken(CAddress& addr, CEventPacket* packet)
+{
+  unsigned long clientToken = packet->ClientToken();
   if (!clientToken)
     clientToken = addr.ULong(); // use IP if packet doesn't have a token
+  return clientToken;
+}
+
+void CEventServer::AddPacket(CAddress& addr, CEventPacket* packet)
+{
+  unsigned long clientToken = ClientToken(addr, packet);
 
   CSingleLock lock(m_critSection);
 
@@ -283,9 +374,9 @@ void CEventServer::ProcessPacket(CAddress& addr, int pSize)
       return;
     }
 
-    m_clients[clientToken] = client;
+    iter = m_clients.insert(make_pair(clientToken, client)).first;
   }
-  m_clients[clientToken]->AddPacket(packet);
+  iter->second->AddPacket(packet);
 }
 
 void CEventServer::RefreshClients()
@@ -317,51 +408,101 @@ void CEventServer::RefreshClients()
 
 void CEventServer::ProcessEvents()
 {
-  CSingleLock lock(m_critSection);
-  map<unsigned long, CEventClient*>::iterator iter = m_clients.begin();
+  vector<CEventAction> actions;
+  {
+    CSingleLock lock(m_critSection);
+    map<unsigned long, CEventClient*>::iterator iter = m_clients.begin();
 
-  while (iter != m_clients.end())
+    while (iter != m_clients.end())
+    {
+      iter->second->ProcessEvents();
+
+      CEventAction action;
+      while (iter->second->GetNextAction(action))
+        actions.push_back(action);
+      iter++;
+    }
+  }
+
+  if (actions.empty())
+    return;
+
+  // hand the decoded actions over to the application thread
+  CSingleLock lock(m_actionSection);
+  for (unsigned int i = 0 ; i < actions.size() ; i++)
   {
-    iter->second->ProcessEvents();
-    iter++;
+    QueuedAction queued;
+    queued.action   = actions[i];
+    queued.received = m_batchReceived;
+    m_actionQueue.push(queued);
   }
 }
 
-bool CEventServer::ExecuteNextAction()
+void CEventServer::LogStats(int64_t now)
 {
-  CSingleLock lock(m_critSection);
+  int64_t freq = CurrentHostFrequency();
+  if (now - m_statStart < freq * ES_STATS_PERIOD)
+    return;
+
+  CSingleLock lock(m_actionSection);
+  if (m_statPackets)
+  {
+    double ms = 1000.0 / freq;
+    CLog::Log(LOGDEBUG, "ES: %.1f packets/s in %u batches, %u mouse packets coalesced, "
+              "handled after %.2f ms (max %.2f ms), %u actions dispatched after %.2f ms (max %.2f ms)",
+              (double)m_statPackets * freq / (now - m_statStart), m_statBatches, m_statCoalesced,
+              m_statHandleTime * ms / m_statPackets, m_statHandleMax * ms,
+              m_statActions, m_statActions ? m_statDispatchTime * ms / m_statActions : 0.0,
+              m_statDispatchMax * ms);
+  }
+
+  m_statStart        = now;
+  m_statPackets      = 0;
+  m_statBatches      = 0;
+  m_statCoalesced    = 0;
+  m_statHandleTime   = 0;
+  m_statHandleMax    = 0;
+  m_statActions      = 0;
+  m_statDispatchTime = 0;
+  m_statDispatchMax  = 0;
+}
 
+bool CEventServer::ExecuteNextAction()
+{
   CEventAction actionEvent;
-  map<unsigned long, CEventClient*>::iterator iter = m_clients.begin();
+  {
+    CSingleLock lock(m_actionSection);
+    if (m_actionQueue.empty())
+      return false;
+
+    actionEvent = m_actionQueue.front().action;
+    int64_t latency = CurrentHostCounter() - m_actionQueue.front().received;
+    m_actionQueue.pop();
+
+    m_statActions++;
+    m_statDispatchTime += latency;
+    if (latency > m_statDispatchMax)
+      m_statDispatchMax = latency;
+  }
 
-  while (iter != m_clients.end())
+  // the lock is released before processing the action
+  switch(actionEvent.actionType)
   {
-    if (iter->second->GetNextAction(actionEvent))
-    {
-      // Leave critical section before processing action
-      lock.Leave();
-      switch(actionEvent.actionType)
-      {
-      case AT_EXEC_BUILTIN:
-        CBuiltins::Execute(actionEvent.actionName);
-        break;
+  case AT_EXEC_BUILTIN:
+    CBuiltins::Execute(actionEvent.actionName);
+    break;
 
-      case AT_BUTTON:
-        {
-          int actionID;
-          CButtonTranslator::TranslateActionString(actionEvent.actionName.c_str(), actionID);
-          CAction action(actionID, 1.0f, 0.0f, actionEvent.actionName);
-          g_audioManager.PlayActionSound(action);
-          g_application.OnAction(action);
-        }
-        break;
-      }
-      return true;
+  case AT_BUTTON:
+    {
+      int actionID;
+      CButtonTranslator::TranslateActionString(actionEvent.actionName.c_str(), actionID);
+      CAction action(actionID, 1.0f, 0.0f, actionEvent.actionName);
+      g_audioManager.PlayActionSound(action);
+      g_application.OnAction(action);
     }
-    iter++;
+    break;
   }
-
-  return false;
+  return true;
 }
 
 unsigned short CEventServer::GetButtonCode(std::string& strMapName, bool& isAxis, float& fAmount)
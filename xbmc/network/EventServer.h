@@ -73,9 +73,20 @@ namespace EVENTSERVER
     CEventServer();
     void Cleanup();
     void Run();
-    void ProcessPacket(SOCKETS::CAddress& addr, int packetSize);
+    void ProcessPackets(int count);
+    EVENTPACKET::CEventPacket* ParsePacket(int packetSize, unsigned char* buffer);
+    unsigned long ClientToken(SOCKETS::CAddress& addr, EVENTPACKET::CEventPacket* packet);
+    void AddPacket(SOCKETS::CAddress& addr, EVENTPACKET::CEventPacket* packet);
     void ProcessEvents();
     void RefreshClients();
+    void LogStats(int64_t now);
+
+    // an action decoded by the server thread, waiting for the application thread
+    struct QueuedAction
+    {
+      EVENTCLIENT::CEventAction action;
+      int64_t                   received; // host counter when its batch arrived
+    };
 
     std::map<unsigned long, EVENTCLIENT::CEventClient*>  m_clients;
     static CEventServer* m_pInstance;
@@ -83,10 +94,30 @@ namespace EVENTSERVER
     int              m_iPort;
     int              m_iListenTimeout;
     int              m_iMaxClients;
-    unsigned char*   m_pPacketBuffer;
+    unsigned char*   m_pPacketBuffer;   // m_iBatchSize slots of PACKET_SIZE bytes
+    int              m_iBatchSize;
+    std::vector<SOCKETS::CAddress> m_packetAddrs;
+    std::vector<int> m_packetSizes;
+    int64_t          m_batchReceived;
     bool             m_bRunning;
     CCriticalSection m_critSection;
     bool             m_bRefreshSettings;
+
+    // actions are handed over under their own lock, so ExecuteNextAction()
+    // never waits for the server thread working through a batch
+    std::queue<QueuedAction> m_actionQueue;
+    CCriticalSection m_actionSection;
+
+    // throughput and latency, logged periodically at debug level
+    int64_t          m_statStart;
+    unsigned int     m_statPackets;
+    unsigned int     m_statBatches;
+    unsigned int     m_statCoalesced;
+    int64_t          m_statHandleTime;   // batch arrival to events processed, summed per packet
+    int64_t          m_statHandleMax;
+    unsigned int     m_statActions;
+    int64_t          m_statDispatchTime; // batch arrival to ExecuteNextAction(), summed per action
+    int64_t          m_statDispatchMax;
   };
 
 }
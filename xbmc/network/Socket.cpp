@@ -25,6 +25,7 @@
 #include "Socket.h"
 #include "utils/log.h"
 #include <vector>
+#include <errno.h>
 
 using namespace SOCKETS;
 //using namespace std; On VS2010, bind conflicts with std::bind
@@ -33,6 +34,9 @@ using namespace SOCKETS;
 #define close closesocket
 #endif
 
+// upper bound for the datagrams fetched by a single ReadBatch() call
+#define UDP_MAX_BATCH 64
+
 /**********************************************************************/
 /* CPosixUDPSocket                                                    */
 /**********************************************************************/
@@ -128,6 +132,69 @@ int CPosixUDPSocket::Read(CAddress& addr, const int buffersize, void *buffer)
                        (struct sockaddr*)&addr.saddr, &addr.size);
 }
 
+int CPosixUDPSocket::ReadBatch(CAddress* addrs, int* sizes, const int count,
+                               const int buffersize, void *buffer)
+{
+  int max = count < UDP_MAX_BATCH ? count : UDP_MAX_BATCH;
+  if (max <= 0)
+    return 0;
+
+#if defined(TARGET_LINUX) && defined(MSG_WAITFORONE)
+  if (m_bBatchRead)
+  {
+    struct mmsghdr msgs[UDP_MAX_BATCH];
+    struct iovec   iovs[UDP_MAX_BATCH];
+    memset(msgs, 0, sizeof(struct mmsghdr) * max);
+    for (int i = 0 ; i < max ; i++)
+    {
+      iovs[i].iov_base = (char*)buffer + i * buffersize;
+      iovs[i].iov_len  = (size_t)buffersize;
+      msgs[i].msg_hdr.msg_iov     = &iovs[i];
+      msgs[i].msg_hdr.msg_iovlen  = 1;
+      msgs[i].msg_hdr.msg_name    = &addrs[i].saddr;
+      msgs[i].msg_hdr.msg_namelen = sizeof(addrs[i].saddr);
+    }
+
+    // the socket was reported readable, so fetch whatever is queued without blocking
+    int read = recvmmsg(m_iSock, msgs, max, MSG_DONTWAIT, NULL);
+    if (read >= 0)
+    {
+      for (int i = 0 ; i < read ; i++)
+      {
+        addrs[i].size = msgs[i].msg_hdr.msg_namelen;
+        sizes[i] = (int)msgs[i].msg_len;
+      }
+      return read;
+    }
+    if (errno != ENOSYS)
+      return -1;
+
+    CLog::Log(LOGNOTICE, "UDP: recvmmsg not supported, reading datagrams one by one");
+    m_bBatchRead = false;
+  }
+#endif
+
+  // fallback: single reads for as long as datagrams are queued
+  int read = 0;
+  while (read < max && (read == 0 || Pending()))
+  {
+    int size = Read(addrs[read], buffersize, (char*)buffer + read * buffersize);
+    if (size < 0)
+      break;
+    sizes[read++] = size;
+  }
+  return read > 0 ? read : -1;
+}
+
+bool CPosixUDPSocket::Pending()
+{
+  fd_set fds;
+  FD_ZERO(&fds);
+  FD_SET(m_iSock, &fds);
+  struct timeval tv = { 0, 0 };
+  return select(m_iSock + 1, &fds, NULL, NULL, &tv) > 0;
+}
+
 int CPosixUDPSocket::SendTo(const CAddress& addr, const int buffersize,
                           const void *buffer)
 {
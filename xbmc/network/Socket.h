@@ -144,6 +144,11 @@ namespace SOCKETS
 
     // read datagrams, return no. of bytes read or -1 or error
     virtual int  Read(CAddress& addr, const int buffersize, void *buffer) = 0;
+
+    // read up to count queued datagrams, datagram i goes to
+    // buffer + i * buffersize, return no. of datagrams read or -1 on error
+    virtual int  ReadBatch(CAddress* addrs, int* sizes, const int count,
+                           const int buffersize, void *buffer) = 0;
     virtual bool Broadcast(const CAddress& addr, const int datasize,
                            const void* data) = 0;
   };
@@ -159,6 +164,7 @@ namespace SOCKETS
     CPosixUDPSocket()
       {
         m_iSock = INVALID_SOCKET;
+        m_bBatchRead = true;
       }
 
     bool Bind(CAddress& addr, int port, int range=0);
@@ -166,6 +172,8 @@ namespace SOCKETS
     bool Listen(int timeout);
     int  SendTo(const CAddress& addr, const int datasize, const void* data);
     int  Read(CAddress& addr, const int buffersize, void *buffer);
+    int  ReadBatch(CAddress* addrs, int* sizes, const int count,
+                   const int buffersize, void *buffer);
     bool Broadcast(const CAddress& addr, const int datasize, const void* data)
     {
       // TODO
@@ -175,8 +183,11 @@ namespace SOCKETS
     void Close();
 
   protected:
+    bool     Pending();
+
     SOCKET   m_iSock;
     CAddress m_addr;
+    bool     m_bBatchRead; // false once recvmmsg turned out to be unsupported
   };
 
   /**********************************************************************/
@@ -25,6 +25,9 @@
 #include <memory.h>
 #include <netinet/in.h>
 #include <arpa/inet.h>
+#ifndef _WIN32
+#include <fcntl.h>
+#endif
 
 #include "settings/AdvancedSettings.h"
 #include "interfaces/json-rpc/JSONRPC.h"
@@ -57,8 +60,31 @@ using namespace ANNOUNCEMENT;
 
 #define RECEIVEBUFFER 1024
 
+// announcements queued for a client that isn't reading before m_slowClientPolicy kicks in
+#define MAX_QUEUED_ANNOUNCEMENTS 64
+
 CTCPServer *CTCPServer::ServerInstance = NULL;
 
+// client sockets never block, so a client that stops reading can't hold up the others
+static void SetNonBlocking(SOCKET socket)
+{
+#ifdef _WIN32
+  unsigned long nonblocking = 1;
+  ioctlsocket(socket, FIONBIO, &nonblocking);
+#else
+  fcntl(socket, F_SETFL, fcntl(socket, F_GETFL) | O_NONBLOCK);
+#endif
+}
+
+static bool WouldBlock()
+{
+#ifdef _WIN32
+  return WSAGetLastError() == WSAEWOULDBLOCK;
+#else
+  return errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR;
+#endif
+}
+
 bool CTCPServer::StartServer(int port, bool nonlocal)
 {
   StopServer(true);
@@ -91,6 +117,8 @@ CTCPServer::CTCPServer(int port, bool nonlocal) : CThread("CTCPServer")
   m_port = port;
   m_nonlocal = nonlocal;
   m_sdpd = NULL;
+  // a client that missed notifications has stale state anyway, and resyncs when it reconnects
+  m_slowClientPolicy = ANNOUNCEMENT::Disconnect;
 }
 
 void CTCPServer::Process()
@@ -101,8 +129,10 @@ void CTCPServer::Process()
   {
     SOCKET          max_fd = 0;
     fd_set          rfds;
+    fd_set          wfds;
     struct timeval  to     = {1, 0};
     FD_ZERO(&rfds);
+    FD_ZERO(&wfds);
 
     for (std::vector<SOCKET>::iterator it = m_servers.begin(); it != m_servers.end(); it++)
     {
@@ -114,11 +144,13 @@ void CTCPServer::Process()
     for (unsigned int i = 0; i < m_connections.size(); i++)
     {
       FD_SET(m_connections[i]->m_socket, &rfds);
+      if (m_connections[i]->HasPendingOutput())
+        FD_SET(m_connections[i]->m_socket, &wfds);
       if ((intptr_t)m_connections[i]->m_socket > (intptr_t)max_fd)
         max_fd = m_connections[i]->m_socket;
     }
 
-    int res = select((intptr_t)max_fd+1, &rfds, NULL, NULL, &to);
+    int res = select((intptr_t)max_fd+1, &rfds, &wfds, NULL, &to);
     if (res < 0)
     {
       CLog::Log(LOGERROR, "JSONRPC Server: Select failed");
@@ -130,11 +162,19 @@ void CTCPServer::Process()
       for (int i = m_connections.size() - 1; i >= 0; i--)
       {
         int socket = m_connections[i]->m_socket;
+        if (FD_ISSET(socket, &wfds) && !m_connections[i]->Flush())
+        {
+          CLog::Log(LOGINFO, "JSONRPC Server: Disconnection detected");
+          RemoveConnection(i);
+          continue;
+        }
         if (FD_ISSET(socket, &rfds))
         {
           char buffer[RECEIVEBUFFER] = {};
           int  nread = 0;
           nread = recv(socket, (char*)&buffer, RECEIVEBUFFER, 0);
+          if (nread < 0 && WouldBlock())
+            continue;
           if (nread > 0)
           {
             std::string response;
@@ -148,6 +188,7 @@ void CTCPServer::Process()
               if (websocket != NULL)
               {
                 // Replace the CTCPClient with a CWebSocketClient
+                CSingleLock lock (m_connectionsSection);
                 CWebSocketClient *websocketClient = new CWebSocketClient(websocket, *(m_connections[i]));
                 delete m_connections[i];
                 m_connections.erase(m_connections.begin() + i);
@@ -162,9 +203,7 @@ void CTCPServer::Process()
           if (nread <= 0)
           {
             CLog::Log(LOGINFO, "JSONRPC Server: Disconnection detected");
-            m_connections[i]->Disconnect();
-            delete m_connections[i];
-            m_connections.erase(m_connections.begin() + i);
+            RemoveConnection(i);
           }
         }
       }
@@ -182,6 +221,8 @@ void CTCPServer::Process()
           else
           {
             CLog::Log(LOGINFO, "JSONRPC Server: New connection added");
+            SetNonBlocking(newconnection->m_socket);
+            CSingleLock lock (m_connectionsSection);
             m_connections.push_back(newconnection);
           }
         }
@@ -211,6 +252,7 @@ void CTCPServer::Announce(AnnouncementFlag flag, const char *sender, const char
 {
   std::string str = IJSONRPCAnnouncer::AnnouncementToJSONRPC(flag, sender, message, data, g_advancedSettings.m_jsonOutputCompact);
 
+  CSingleLock lock (m_connectionsSection);
   for (unsigned int i = 0; i < m_connections.size(); i++)
   {
     {
@@ -219,7 +261,7 @@ void CTCPServer::Announce(AnnouncementFlag flag, const char *sender, const char
         continue;
     }
 
-    m_connections[i]->Send(str.c_str(), str.size());
+    m_connections[i]->Announce(str, m_slowClientPolicy);
   }
 }
 
@@ -463,13 +505,16 @@ bool CTCPServer::InitializeTCP()
 
 void CTCPServer::Deinitialize()
 {
-  for (unsigned int i = 0; i < m_connections.size(); i++)
   {
-    m_connections[i]->Disconnect();
-    delete m_connections[i];
-  }
+    CSingleLock lock (m_connectionsSection);
+    for (unsigned int i = 0; i < m_connections.size(); i++)
+    {
+      m_connections[i]->Disconnect();
+      delete m_connections[i];
+    }
 
-  m_connections.clear();
+    m_connections.clear();
+  }
 
   for (unsigned int i = 0; i < m_servers.size(); i++)
     closesocket(m_servers[i]);
@@ -485,6 +530,14 @@ void CTCPServer::Deinitialize()
   CAnnouncementManager::RemoveAnnouncer(this);
 }
 
+void CTCPServer::RemoveConnection(unsigned int index)
+{
+  CSingleLock lock (m_connectionsSection);
+  m_connections[index]->Disconnect();
+  delete m_connections[index];
+  m_connections.erase(m_connections.begin() + index);
+}
+
 CTCPServer::CTCPClient::CTCPClient()
 {
   m_new = true;
@@ -494,6 +547,10 @@ CTCPServer::CTCPClient::CTCPClient()
   m_endBrackets = 0;
   m_beginChar = 0;
   m_endChar = 0;
+  m_outputSent = 0;
+  m_queuedAnnouncements = 0;
+  m_droppedAnnouncements = 0;
+  m_overflowed = false;
 
   m_addrlen = sizeof(m_cliaddr);
 }
@@ -527,12 +584,90 @@ bool CTCPServer::CTCPClient::SetAnnouncementFlags(int flags)
 
 void CTCPServer::CTCPClient::Send(const char *data, unsigned int size)
 {
-  unsigned int sent = 0;
-  do
+  CSingleLock lock (m_critSection);
+  Queue(Frame(data, size), false);
+  Flush();
+}
+
+void CTCPServer::CTCPClient::Announce(const std::string &data, AnnouncerPolicy policy)
+{
+  CSingleLock lock (m_critSection);
+  if (m_socket == INVALID_SOCKET || m_overflowed)
+    return;
+
+  if (m_queuedAnnouncements >= MAX_QUEUED_ANNOUNCEMENTS)
+  {
+    if (policy == ANNOUNCEMENT::Disconnect)
+    {
+      CLog::Log(LOGWARNING, "JSONRPC Server: Client stopped reading its announcements, disconnecting it");
+      m_overflowed = true;
+      m_output.clear();
+      m_outputSent = 0;
+      m_queuedAnnouncements = 0;
+      // the server thread sees the connection end and removes the client
+      shutdown(m_socket, SHUT_RDWR);
+      return;
+    }
+
+    // drop the oldest announcement that isn't partly written already
+    for (std::deque<COutput>::iterator it = m_output.begin(); it != m_output.end(); ++it)
+    {
+      if (it->m_announcement && (it != m_output.begin() || m_outputSent == 0))
+      {
+        m_output.erase(it);
+        m_queuedAnnouncements--;
+        if (m_droppedAnnouncements++ % 100 == 0)
+          CLog::Log(LOGWARNING, "JSONRPC Server: Client can't keep up, dropped %u announcements", m_droppedAnnouncements);
+        break;
+      }
+    }
+  }
+
+  Queue(Frame(data.c_str(), data.size()), true);
+  Flush();
+}
+
+void CTCPServer::CTCPClient::Queue(const std::string &data, bool announcement)
+{
+  if (data.empty())
+    return;
+
+  m_output.push_back(COutput(data, announcement));
+  if (announcement)
+    m_queuedAnnouncements++;
+}
+
+bool CTCPServer::CTCPClient::Flush()
+{
+  CSingleLock lock (m_critSection);
+  while (!m_output.empty())
   {
-    CSingleLock lock (m_critSection);
-    sent += send(m_socket, data, size - sent, 0);
-  } while (sent < size);
+    const COutput &output = m_output.front();
+    int sent = send(m_socket, output.m_data.c_str() + m_outputSent, output.m_data.size() - m_outputSent, 0);
+    if (sent < 0)
+      return WouldBlock();
+
+    m_outputSent += sent;
+    if (m_outputSent < output.m_data.size())
+      return true; // the socket is full, the rest goes once it's writable again
+
+    if (output.m_announcement)
+      m_queuedAnnouncements--;
+    m_output.pop_front();
+    m_outputSent = 0;
+  }
+  return true;
+}
+
+bool CTCPServer::CTCPClient::HasPendingOutput()
+{
+  CSingleLock lock (m_critSection);
+  return !m_output.empty();
+}
+
+std::string CTCPServer::CTCPClient::Frame(const char *data, unsigned int size)
+{
+  return std::string(data, size);
 }
 
 void CTCPServer::CTCPClient::PushBuffer(CTCPServer *host, const char *buffer, int length)
@@ -595,6 +730,11 @@ void CTCPServer::CTCPClient::Copy(const CTCPClient& client)
   m_beginChar         = client.m_beginChar;
   m_endChar           = client.m_endChar;
   m_buffer            = client.m_buffer;
+  m_output            = client.m_output;
+  m_outputSent        = client.m_outputSent;
+  m_queuedAnnouncements  = client.m_queuedAnnouncements;
+  m_droppedAnnouncements = client.m_droppedAnnouncements;
+  m_overflowed        = client.m_overflowed;
 }
 
 CTCPServer::CWebSocketClient::CWebSocketClient(CWebSocket *websocket)
@@ -630,15 +770,17 @@ CTCPServer::CWebSocketClient& CTCPServer::CWebSocketClient::operator=(const CWeb
   return *this;
 }
 
-void CTCPServer::CWebSocketClient::Send(const char *data, unsigned int size)
+std::string CTCPServer::CWebSocketClient::Frame(const char *data, unsigned int size)
 {
+  std::string framed;
   const CWebSocketMessage *msg = m_websocket->Send(WebSocketTextFrame, data, size);
   if (msg == NULL || !msg->IsComplete())
-    return;
+    return framed;
 
   std::vector<const CWebSocketFrame *> frames = msg->GetFrames();
   for (unsigned int index = 0; index < frames.size(); index++)
-    CTCPClient::Send(frames.at(index)->GetFrameData(), (unsigned int)frames.at(index)->GetFrameLength());
+    framed.append(frames.at(index)->GetFrameData(), (size_t)frames.at(index)->GetFrameLength());
+  return framed;
 }
 
 void CTCPServer::CWebSocketClient::PushBuffer(CTCPServer *host, const char *buffer, int length)
@@ -20,6 +20,8 @@
  *
  */
 
+#include <deque>
+#include <string>
 #include <vector>
 #include <sys/socket.h>
 
@@ -51,6 +53,7 @@ namespace JSONRPC
     bool InitializeBlue();
     bool InitializeTCP();
     void Deinitialize();
+    void RemoveConnection(unsigned int index);
 
     class CTCPClient : public IClient
     {
@@ -72,6 +75,18 @@ namespace JSONRPC
 
       virtual bool IsNew() const { return m_new; }
 
+      /*! \brief Queue an announcement without waiting for the client to read it
+       \param data the announcement
+       \param policy what to do once the client has too many announcements queued
+       */
+      void Announce(const std::string &data, ANNOUNCEMENT::AnnouncerPolicy policy);
+
+      /*! \brief Write as much of the queued output as the socket takes without blocking
+       \return false if the connection failed
+       */
+      bool Flush();
+      bool HasPendingOutput();
+
       SOCKET           m_socket;
       sockaddr_storage m_cliaddr;
       socklen_t        m_addrlen;
@@ -79,12 +94,30 @@ namespace JSONRPC
 
     protected:
       void Copy(const CTCPClient& client);
+
+      /*! \brief Turn data into what is written to the socket */
+      virtual std::string Frame(const char *data, unsigned int size);
     private:
+      void Queue(const std::string &data, bool announcement);
+
+      class COutput
+      {
+      public:
+        COutput(const std::string &data, bool announcement) : m_data(data), m_announcement(announcement) {};
+        std::string m_data;
+        bool        m_announcement;
+      };
+
       bool m_new;
       int m_announcementflags;
       int m_beginBrackets, m_endBrackets;
       char m_beginChar, m_endChar;
       std::string m_buffer;
+      std::deque<COutput> m_output;        ///< responses and announcements not yet written
+      size_t m_outputSent;                 ///< bytes of the front of m_output already written
+      unsigned int m_queuedAnnouncements;  ///< announcements in m_output
+      unsigned int m_droppedAnnouncements;
+      bool m_overflowed;                   ///< disconnected for falling behind
     };
 
     class CWebSocketClient : public CTCPClient
@@ -96,17 +129,21 @@ namespace JSONRPC
       CWebSocketClient& operator=(const CWebSocketClient& client);
       ~CWebSocketClient();
 
-      virtual void Send(const char *data, unsigned int size);
       virtual void PushBuffer(CTCPServer *host, const char *buffer, int length);
       virtual void Disconnect();
 
       virtual bool IsNew() const { return m_websocket == NULL; }
 
+    protected:
+      virtual std::string Frame(const char *data, unsigned int size);
+
     private:
       CWebSocket *m_websocket;
     };
 
     std::vector<CTCPClient*> m_connections;
+    CCriticalSection m_connectionsSection; ///< guards m_connections against Announce(), which runs on another thread
+    ANNOUNCEMENT::AnnouncerPolicy m_slowClientPolicy;
     std::vector<SOCKET> m_servers;
     int m_port;
     bool m_nonlocal;
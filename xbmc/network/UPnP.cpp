@@ -60,6 +60,11 @@
 #include "guilib/Key.h"
 #include "ThumbLoader.h"
 #include "Util.h"
+#include "threads/SingleLock.h"
+#include "interfaces/AnnouncementManager.h"
+
+#include <boost/shared_ptr.hpp>
+#include <boost/unordered_map.hpp>
 
 using namespace std;
 using namespace MUSIC_INFO;
@@ -70,6 +75,13 @@ NPT_SET_LOCAL_LOGGER("xbmc.upnp")
 #define UPNP_DEFAULT_MAX_RETURNED_ITEMS 200
 #define UPNP_DEFAULT_MIN_RETURNED_ITEMS 30
 
+// sorted container listings are kept while a renderer pages through them
+#define UPNP_CONTAINER_CACHE_TIME       30000
+#define UPNP_CONTAINER_CACHE_SIZE       16
+// DIDL-Lite fragments of individual objects
+#define UPNP_DIDL_CACHE_TIME            300000
+#define UPNP_DIDL_CACHE_SIZE            20000
+
 /*
 # Play speed
 #    1 normal
@@ -218,7 +230,8 @@ public:
 /*----------------------------------------------------------------------
 |   CUPnP::CUPnP
 +---------------------------------------------------------------------*/
-class CUPnPServer : public PLT_MediaConnect
+class CUPnPServer : public PLT_MediaConnect,
+                    public ANNOUNCEMENT::IAnnouncer
 {
 public:
     CUPnPServer(const char* friendly_name, const char* uuid = NULL, int port = 0) :
@@ -226,8 +239,19 @@ public:
         // hack: override path to make sure it's empty
         // urls will contain full paths to local files
         m_Path = "";
+        m_CacheGeneration = 0;
+        ANNOUNCEMENT::CAnnouncementManager::AddAnnouncer(this);
+    }
+    virtual ~CUPnPServer() {
+        ANNOUNCEMENT::CAnnouncementManager::RemoveAnnouncer(this);
     }
 
+    // IAnnouncer methods
+    virtual void Announce(ANNOUNCEMENT::AnnouncementFlag flag,
+                          const char*                    sender,
+                          const char*                    message,
+                          const CVariant&                data);
+
     // PLT_MediaServer methods
     virtual NPT_Result OnBrowseMetadata(PLT_ActionReference&          action,
                                         const char*                   object_id,
@@ -318,6 +342,29 @@ private:
                                             const char* protocol,
                                             const PLT_HttpRequestContext* context = NULL);
 
+    // browse caches, shared by all requests (Platinum serves them from several threads)
+    typedef boost::shared_ptr<CFileItemList> FileItemListPtr;
+    FileItemListPtr GetContainer(const NPT_String& parent_id);
+    NPT_Result      GetDidl(CFileItemPtr                  item,
+                            const char*                   filter,
+                            const PLT_HttpRequestContext& context,
+                            const char*                   parent_id,
+                            NPT_String&                   didl);
+
+    struct CCachedContainer {
+        FileItemListPtr items;
+        unsigned int    expires;
+    };
+    struct CCachedDidl {
+        NPT_String      didl;
+        unsigned int    expires;
+    };
+    void InvalidateCaches();
+
+    CCriticalSection                                        m_CacheSection;
+    unsigned int                                            m_CacheGeneration; // bumped on library changes
+    std::map<std::string, CCachedContainer>                 m_Containers;
+    boost::unordered_map<std::string, CCachedDidl>          m_Didl;
     NPT_Mutex                       m_FileMutex;
     NPT_Map<NPT_String, NPT_String> m_FileMap;
 
@@ -1071,15 +1118,52 @@ CUPnPServer::OnBrowseDirectChildren(PLT_ActionReference&          action,
                                     const NPT_List<NPT_String>&   sort_criteria,
                                     const PLT_HttpRequestContext& context)
 {
-    CFileItemList items;
     NPT_String    parent_id = TranslateWMPObjectId(object_id);
 
     CLog::Log(LOGINFO, "Received UPnP Browse DirectChildren request for object '%s'", (const char*)object_id);
 
-    items.SetPath(CStdString(parent_id));
-    if (!items.Load()) {
+    FileItemListPtr items = GetContainer(parent_id);
+
+    // Don't pass parent_id if action is Search not BrowseDirectChildren, as
+    // we want the engine to determine the best parent id, not necessarily the one
+    // passed
+    NPT_String action_name = action->GetActionDesc().GetName();
+    return BuildResponse(
+        action,
+        *items,
+        filter,
+        starting_index,
+        requested_count,
+        sort_criteria,
+        context,
+        (action_name.Compare("Search", true)==0)?NULL:parent_id.GetChars());
+}
+
+/*----------------------------------------------------------------------
+|   CUPnPServer::GetContainer
++---------------------------------------------------------------------*/
+CUPnPServer::FileItemListPtr
+CUPnPServer::GetContainer(const NPT_String& parent_id)
+{
+    std::string key((const char*)parent_id);
+    unsigned int now = XbmcThreads::SystemClockMillis();
+    unsigned int generation;
+
+    // renderers page through big containers a screenful at a time, so keep
+    // the sorted listing around instead of fetching it again for every page
+    {
+        CSingleLock lock(m_CacheSection);
+        std::map<std::string, CCachedContainer>::iterator it = m_Containers.find(key);
+        if (it != m_Containers.end() && (int)(it->second.expires - now) > 0)
+            return it->second.items;
+        generation = m_CacheGeneration;
+    }
+
+    FileItemListPtr items(new CFileItemList);
+    items->SetPath(CStdString(parent_id));
+    if (!items->Load()) {
         // cache anything that takes more than a second to retrieve
-      unsigned int time = XbmcThreads::SystemClockMillis();
+        unsigned int time = XbmcThreads::SystemClockMillis();
 
         if (parent_id.StartsWith("virtualpath://upnproot")) {
             CFileItemPtr item;
@@ -1088,39 +1172,127 @@ CUPnPServer::OnBrowseDirectChildren(PLT_ActionReference&          action,
             item.reset(new CFileItem("musicdb://", true));
             item->SetLabel("Music Library");
             item->SetLabelPreformated(true);
-            items.Add(item);
+            items->Add(item);
 
             // video library
             item.reset(new CFileItem("videodb://", true));
             item->SetLabel("Video Library");
             item->SetLabelPreformated(true);
-            items.Add(item);
+            items->Add(item);
 
         } else {
-            CDirectory::GetDirectory((const char*)parent_id, items);
+            CDirectory::GetDirectory((const char*)parent_id, *items);
         }
 
-        if (items.CacheToDiscAlways() || (items.CacheToDiscIfSlow() && (XbmcThreads::SystemClockMillis() - time) > 1000 )) {
-            items.Save();
+        if (items->CacheToDiscAlways() || (items->CacheToDiscIfSlow() && (XbmcThreads::SystemClockMillis() - time) > 1000 )) {
+            items->Save();
         }
     }
 
     // Always sort by label
-    items.Sort(SORT_METHOD_LABEL, SortOrderAscending);
+    items->Sort(SORT_METHOD_LABEL, SortOrderAscending);
+
+    CSingleLock lock(m_CacheSection);
+    // the library changed while listing, don't keep what may be stale already
+    if (generation != m_CacheGeneration)
+        return items;
+
+    now = XbmcThreads::SystemClockMillis();
+    for (std::map<std::string, CCachedContainer>::iterator it = m_Containers.begin(); it != m_Containers.end(); ) {
+        if ((int)(it->second.expires - now) <= 0)
+            m_Containers.erase(it++);
+        else
+            ++it;
+    }
+    if (m_Containers.size() >= UPNP_CONTAINER_CACHE_SIZE)
+        m_Containers.clear();
+
+    CCachedContainer &cached = m_Containers[key];
+    cached.items   = items;
+    cached.expires = now + UPNP_CONTAINER_CACHE_TIME;
+    return items;
+}
 
-    // Don't pass parent_id if action is Search not BrowseDirectChildren, as
-    // we want the engine to determine the best parent id, not necessarily the one
-    // passed
-    NPT_String action_name = action->GetActionDesc().GetName();
-    return BuildResponse(
-        action,
-        items,
-        filter,
-        starting_index,
-        requested_count,
-        sort_criteria,
-        context,
-        (action_name.Compare("Search", true)==0)?NULL:parent_id.GetChars());
+/*----------------------------------------------------------------------
+|   CUPnPServer::GetDidl
++---------------------------------------------------------------------*/
+NPT_Result
+CUPnPServer::GetDidl(CFileItemPtr                  item,
+                     const char*                   filter,
+                     const PLT_HttpRequestContext& context,
+                     const char*                   parent_id,
+                     NPT_String&                   didl)
+{
+    // the fragment depends on the interface the request came in on and on
+    // client quirks/mime mapping, so those are part of the key
+    const NPT_String* user_agent = context.GetRequest().GetHeaders().GetHeaderValue(NPT_HTTP_HEADER_USER_AGENT);
+    std::string key = item->GetPath();
+    key += '|'; key += parent_id ? parent_id : "";
+    key += '|'; key += filter ? filter : "";
+    key += '|'; key += (const char*)context.GetLocalAddress().GetIpAddress().ToString();
+    key += '|'; key += user_agent ? (const char*)*user_agent : "";
+
+    unsigned int now = XbmcThreads::SystemClockMillis();
+    unsigned int generation;
+    {
+        CSingleLock lock(m_CacheSection);
+        boost::unordered_map<std::string, CCachedDidl>::iterator it = m_Didl.find(key);
+        if (it != m_Didl.end() && (int)(it->second.expires - now) > 0) {
+            didl = it->second.didl;
+            return NPT_SUCCESS;
+        }
+        generation = m_CacheGeneration;
+    }
+
+    // Build() fills in tags and labels, so work on a copy as the listing
+    // may be shared with other requests
+    CFileItemPtr copy(new CFileItem(*item));
+    PLT_MediaObjectReference object(Build(copy, true, context, parent_id));
+    if (object.IsNull()) {
+        return NPT_FAILURE;
+    }
+
+    NPT_CHECK(PLT_Didl::ToDidl(*object.AsPointer(), filter, didl));
+
+    CSingleLock lock(m_CacheSection);
+    if (generation != m_CacheGeneration)
+        return NPT_SUCCESS;
+    if (m_Didl.size() >= UPNP_DIDL_CACHE_SIZE)
+        m_Didl.clear();
+    CCachedDidl &cached = m_Didl[key];
+    cached.didl    = didl;
+    cached.expires = now + UPNP_DIDL_CACHE_TIME;
+    return NPT_SUCCESS;
+}
+
+/*----------------------------------------------------------------------
+|   CUPnPServer::Announce
++---------------------------------------------------------------------*/
+void
+CUPnPServer::Announce(ANNOUNCEMENT::AnnouncementFlag flag,
+                      const char*                    sender,
+                      const char*                    message,
+                      const CVariant&                data)
+{
+    // scans, cleans and single item updates or removals all change what
+    // the library containers hold
+    if (strcmp(sender, "xbmc") == 0 &&
+        (flag == ANNOUNCEMENT::VideoLibrary || flag == ANNOUNCEMENT::AudioLibrary) &&
+        (strcmp(message, "OnScanFinished") == 0 || strcmp(message, "OnCleanFinished") == 0 ||
+         strcmp(message, "OnUpdate") == 0 || strcmp(message, "OnRemove") == 0))
+        InvalidateCaches();
+}
+
+/*----------------------------------------------------------------------
+|   CUPnPServer::InvalidateCaches
++---------------------------------------------------------------------*/
+void
+CUPnPServer::InvalidateCaches()
+{
+    CSingleLock lock(m_CacheSection);
+    m_CacheGeneration++;
+    m_Containers.clear();
+    m_Didl.clear();
 }
 
 /*----------------------------------------------------------------------
@@ -1150,16 +1322,12 @@ CUPnPServer::BuildResponse(PLT_ActionReference&          action,
 
     NPT_Cardinal count = 0;
     NPT_String didl = didl_header;
-    PLT_MediaObjectReference object;
     for (unsigned long i=starting_index; i<stop_index; ++i) {
-        object = Build(items[i], true, context, parent_id);
-        if (object.IsNull()) {
+        NPT_String tmp;
+        if (NPT_FAILED(GetDidl(items[i], filter, context, parent_id, tmp))) {
             continue;
         }
 
-        NPT_String tmp;
-        NPT_CHECK(PLT_Didl::ToDidl(*object.AsPointer(), filter, tmp));
-
         // Neptunes string growing is dead slow for small additions
         if (didl.GetCapacity() < tmp.GetLength() + didl.GetLength()) {
             didl.Reserve((tmp.GetLength() + didl.GetLength())*2);
@@ -22,6 +22,9 @@
 #include "WebServer.h"
 #ifdef HAS_WEB_SERVER
 #include "filesystem/File.h"
+#include "filesystem/SpecialProtocol.h"
+#include "settings/AdvancedSettings.h"
+#include "utils/CPUInfo.h"
 #include "utils/log.h"
 #include "utils/URIUtils.h"
 #include "utils/Variant.h"
@@ -30,11 +33,16 @@
 #include "XBDateTime.h"
 #include "URL.h"
 
+#ifdef TARGET_POSIX
+#include <fcntl.h>
+#endif
+
 #ifdef _WIN32
 #pragma comment(lib, "libmicrohttpd.dll.lib")
 #endif
 
 #define MAX_POST_BUFFER_SIZE 2048
+#define FILE_DOWNLOAD_BLOCK_SIZE (64 * 1024)
 
 #define PAGE_FILE_NOT_FOUND "<html><head><title>File not found</title></head><body>File not found</body></html>"
 #define NOT_SUPPORTED       "<html><head><title>Not Supported</title></head><body>The method you are trying to use is not supported by this server</body></html>"
@@ -43,6 +51,56 @@ using namespace XFILE;
 using namespace std;
 using namespace JSONRPC;
 
+enum RangeResult
+{
+  RangeIgnored = 0,
+  RangeSatisfiable,
+  RangeNotSatisfiable
+};
+
+// Parses a "Range: bytes=..." header. Only a single byte range is honoured,
+// anything else (multiple ranges, other units, garbage) is served as a full response.
+static RangeResult ParseRange(const string &header, int64_t length, int64_t &start, int64_t &end)
+{
+  if (header.compare(0, 6, "bytes=") != 0 || header.find(',') != string::npos)
+    return RangeIgnored;
+
+  string spec = header.substr(6);
+  size_t dash = spec.find('-');
+  if (dash == string::npos)
+    return RangeIgnored;
+
+  string first = spec.substr(0, dash);
+  string last = spec.substr(dash + 1);
+  if (first.find_first_not_of("0123456789 ") != string::npos ||
+      last.find_first_not_of("0123456789 ") != string::npos)
+    return RangeIgnored;
+
+  if (first.empty())
+  {
+    // suffix range: the last N bytes
+    if (last.empty())
+      return RangeIgnored;
+    int64_t suffix = strtoll(last.c_str(), NULL, 10);
+    if (suffix <= 0)
+      return RangeNotSatisfiable;
+    start = suffix < length ? length - suffix : 0;
+    end = length - 1;
+    return RangeSatisfiable;
+  }
+
+  start = strtoll(first.c_str(), NULL, 10);
+  end = last.empty() ? length - 1 : strtoll(last.c_str(), NULL, 10);
+  if (end < start)
+    return RangeIgnored;
+  if (start >= length)
+    return RangeNotSatisfiable;
+  if (end >= length)
+    end = length - 1;
+
+  return RangeSatisfiable;
+}
+
 vector<IHTTPRequestHandler *> CWebServer::m_requestHandlers;
 
 CWebServer::CWebServer()
@@ -275,6 +333,7 @@ int CWebServer::HandleRequest(IHTTPRequestHandler *handler, const HTTPRequest &r
   }
 
   struct MHD_Response *response = NULL;
+  int responseCode = handler->GetHTTPResonseCode();
   switch (handler->GetHTTPResponseType())
   {
     case HTTPNone:
@@ -286,7 +345,7 @@ int CWebServer::HandleRequest(IHTTPRequestHandler *handler, const HTTPRequest &r
       break;
 
     case HTTPFileDownload:
-      ret = CreateFileDownloadResponse(request.connection, handler->GetHTTPResponseFile(), request.method, response);
+      ret = CreateFileDownloadResponse(request.connection, handler->GetHTTPResponseFile(), request.method, response, responseCode);
       break;
 
     case HTTPMemoryDownloadNoFreeNoCopy:
@@ -324,7 +383,7 @@ int CWebServer::HandleRequest(IHTTPRequestHandler *handler, const HTTPRequest &r
   for (multimap<string, string>::const_iterator it = header.begin(); it != header.end(); it++)
     MHD_add_response_header(response, it->first.c_str(), it->second.c_str());
 
-  MHD_queue_response(request.connection, handler->GetHTTPResonseCode(), response);
+  MHD_queue_response(request.connection, responseCode, response);
   MHD_destroy_response(response);
   delete handler;
 
@@ -354,50 +413,179 @@ int CWebServer::CreateRedirect(struct MHD_Connection *connection, const string &
   return MHD_NO;
 }
 
-int CWebServer::CreateFileDownloadResponse(struct MHD_Connection *connection, const string &strURL, HTTPMethod methodType, struct MHD_Response *&response)
+int CWebServer::CreateFileDownloadResponse(struct MHD_Connection *connection, const string &strURL, HTTPMethod methodType, struct MHD_Response *&response, int &responseCode)
 {
   CFile *file = new CFile();
 
-  if (file->Open(strURL, READ_NO_CACHE))
+  if (!file->Open(strURL, READ_NO_CACHE))
+  {
+    delete file;
+    CLog::Log(LOGERROR, "WebServer: Failed to open %s", strURL.c_str());
+    responseCode = MHD_HTTP_NOT_FOUND;
+    return CreateErrorResponse(connection, MHD_HTTP_NOT_FOUND, methodType, response);
+  }
+
+  int64_t fileLength = file->GetLength();
+
+  // validators for conditional requests. Texture cache entries are named after
+  // the hash of their source, so size and mtime are enough to tell versions apart
+  CStdString etag, lastModified;
+  struct __stat64 st;
+  if (file->Stat(&st) == 0 && st.st_mtime > 0)
   {
-    if (methodType != HEAD)
+    etag.Format("\"%llx-%llx\"", (unsigned long long)st.st_mtime, (unsigned long long)fileLength);
+    lastModified = CDateTime((time_t)st.st_mtime).GetAsRFC1123DateTime();
+  }
+
+  if (!etag.empty())
+  {
+    string ifNoneMatch = GetRequestHeaderValue(connection, MHD_HEADER_KIND, "If-None-Match");
+    string ifModifiedSince = GetRequestHeaderValue(connection, MHD_HEADER_KIND, "If-Modified-Since");
+
+    bool notModified = false;
+    if (!ifNoneMatch.empty())
+      notModified = ifNoneMatch == "*" || ifNoneMatch.find(etag) != string::npos;
+    else if (!ifModifiedSince.empty())
+      notModified = ifModifiedSince == lastModified;
+
+    if (notModified)
     {
-      response = MHD_create_response_from_callback ( file->GetLength(),
-                                                     2048,
-                                                     &CWebServer::ContentReaderCallback, file,
-                                                     &CWebServer::ContentReaderFreeCallback);
+      file->Close();
+      delete file;
+
+      response = MHD_create_response_from_data (0, NULL, MHD_NO, MHD_NO);
       if (response == NULL)
         return MHD_NO;
+
+      MHD_add_response_header(response, "ETag", etag.c_str());
+      MHD_add_response_header(response, "Last-Modified", lastModified.c_str());
+      responseCode = MHD_HTTP_NOT_MODIFIED;
+      return MHD_YES;
     }
-    else
+  }
+
+  int64_t start = 0;
+  int64_t end = fileLength - 1;
+  bool partial = false;
+
+  string range = GetRequestHeaderValue(connection, MHD_HEADER_KIND, "Range");
+  if (!range.empty() && fileLength > 0)
+  {
+    // If-Range only lets the range through when the client still has the current version
+    string ifRange = GetRequestHeaderValue(connection, MHD_HEADER_KIND, "If-Range");
+    if (ifRange.empty() || (!etag.empty() && (ifRange == etag || ifRange == lastModified)))
+    {
+      RangeResult result = ParseRange(range, fileLength, start, end);
+      if (result == RangeNotSatisfiable)
+      {
+        file->Close();
+        delete file;
+
+        response = MHD_create_response_from_data (0, NULL, MHD_NO, MHD_NO);
+        if (response == NULL)
+          return MHD_NO;
+
+        CStdString contentRange;
+        contentRange.Format("bytes */%"PRId64, fileLength);
+        MHD_add_response_header(response, "Content-Range", contentRange.c_str());
+        responseCode = MHD_HTTP_REQUESTED_RANGE_NOT_SATISFIABLE;
+        return MHD_YES;
+      }
+      partial = result == RangeSatisfiable;
+      if (!partial)
+      {
+        start = 0;
+        end = fileLength - 1;
+      }
+    }
+  }
+
+  // files of unknown length are streamed until they run out, without a Content-Length
+  bool knownLength = fileLength > 0;
+  uint64_t contentLength = knownLength ? (uint64_t)(end - start + 1) : MHD_SIZE_UNKNOWN;
+
+  if (methodType != HEAD)
+  {
+#if defined(TARGET_POSIX) && (MHD_VERSION >= 0x00091200)
+    // local files are handed to MHD as a descriptor so the body goes
+    // straight from the page cache to the socket via sendfile()
+    int fd = -1;
+    CStdString localPath = CSpecialProtocol::TranslatePath(strURL);
+    if (knownLength && URIUtils::IsHD(localPath))
+      fd = open(localPath.c_str(), O_RDONLY);
+
+    if (fd >= 0)
     {
-      CStdString contentLength;
-      contentLength.Format("%I64d", file->GetLength());
       file->Close();
       delete file;
 
-      response = MHD_create_response_from_data (0, NULL, MHD_NO, MHD_NO);
+      response = MHD_create_response_from_fd_at_offset((size_t)contentLength, fd, (off_t)start);
       if (response == NULL)
+      {
+        close(fd);
         return MHD_NO;
-      MHD_add_response_header(response, "Content-Length", contentLength);
+      }
     }
+    else
+#endif
+    {
+      FileReaderContext *context = new FileReaderContext;
+      context->file = file;
+      context->offset = start;
 
-    CStdString ext = URIUtils::GetExtension(strURL);
-    ext = ext.ToLower();
-    const char *mime = CreateMimeTypeFromExtension(ext.c_str());
-    if (mime)
-      MHD_add_response_header(response, "Content-Type", mime);
-
-    CDateTime expiryTime = CDateTime::GetCurrentDateTime();
-    expiryTime += CDateTimeSpan(1, 0, 0, 0);
-    MHD_add_response_header(response, "Expires", expiryTime.GetAsRFC1123DateTime());
+      response = MHD_create_response_from_callback ( contentLength,
+                                                     FILE_DOWNLOAD_BLOCK_SIZE,
+                                                     &CWebServer::ContentReaderCallback, context,
+                                                     &CWebServer::ContentReaderFreeCallback);
+      if (response == NULL)
+      {
+        ContentReaderFreeCallback(context);
+        return MHD_NO;
+      }
+    }
   }
   else
   {
+    file->Close();
     delete file;
-    CLog::Log(LOGERROR, "WebServer: Failed to open %s", strURL.c_str());
-    return SendErrorResponse(connection, MHD_HTTP_NOT_FOUND, GET); /* GET Assumed Temporarily */
+
+    response = MHD_create_response_from_data (0, NULL, MHD_NO, MHD_NO);
+    if (response == NULL)
+      return MHD_NO;
+
+    if (knownLength)
+    {
+      CStdString strContentLength;
+      strContentLength.Format("%"PRIu64, contentLength);
+      MHD_add_response_header(response, "Content-Length", strContentLength);
+    }
   }
+
+  CStdString ext = URIUtils::GetExtension(strURL);
+  ext = ext.ToLower();
+  const char *mime = CreateMimeTypeFromExtension(ext.c_str());
+  if (mime)
+    MHD_add_response_header(response, "Content-Type", mime);
+
+  CDateTime expiryTime = CDateTime::GetCurrentDateTime();
+  expiryTime += CDateTimeSpan(1, 0, 0, 0);
+  MHD_add_response_header(response, "Expires", expiryTime.GetAsRFC1123DateTime());
+
+  MHD_add_response_header(response, "Accept-Ranges", "bytes");
+  if (!etag.empty())
+  {
+    MHD_add_response_header(response, "ETag", etag.c_str());
+    MHD_add_response_header(response, "Last-Modified", lastModified.c_str());
+  }
+
+  if (partial)
+  {
+    CStdString contentRange;
+    contentRange.Format("bytes %"PRId64"-%"PRId64"/%"PRId64, start, end, fileLength);
+    MHD_add_response_header(response, "Content-Range", contentRange.c_str());
+    responseCode = MHD_HTTP_PARTIAL_CONTENT;
+  }
+
   return MHD_YES;
 }
 
@@ -462,10 +650,11 @@ int CWebServer::ContentReaderCallback(void *cls, uint64_t pos, char *buf, int ma
 int CWebServer::ContentReaderCallback(void *cls, size_t pos, char *buf, int max)
 #endif
 {
-  CFile *file = (CFile *)cls;
-  if((unsigned int)pos != file->GetPosition())
-    file->Seek(pos);
-  unsigned res = file->Read(buf, max);
+  FileReaderContext *context = (FileReaderContext *)cls;
+  int64_t filePos = context->offset + (int64_t)pos;
+  if (filePos != context->file->GetPosition())
+    context->file->Seek(filePos);
+  unsigned res = context->file->Read(buf, max);
   if(res == 0)
     return -1;
   return res;
@@ -473,10 +662,11 @@ int CWebServer::ContentReaderCallback(void *cls, size_t pos, char *buf, int max)
 
 void CWebServer::ContentReaderFreeCallback(void *cls)
 {
-  CFile *file = (CFile *)cls;
-  file->Close();
+  FileReaderContext *context = (FileReaderContext *)cls;
+  context->file->Close();
 
-  delete file;
+  delete context->file;
+  delete context;
 }
 
 struct MHD_Daemon* CWebServer::StartMHD(unsigned int flags, int port)
@@ -485,6 +675,11 @@ struct MHD_Daemon* CWebServer::StartMHD(unsigned int flags, int port)
   // otherwise on libmicrohttpd 0.4.4-1 it spins a busy loop
 
   unsigned int timeout = 60 * 60 * 24;
+  // thumbnail heavy remotes fire off dozens of requests at once, so by default
+  // size the pool from the number of cpus instead of a fixed handful of threads
+  unsigned int threads = g_advancedSettings.m_webServerThreadPoolSize;
+  if (threads == 0)
+    threads = std::min(16, std::max(4, g_cpuInfo.getCPUCount() * 2));
   // MHD_USE_THREAD_PER_CONNECTION = one thread per connection
   // MHD_USE_SELECT_INTERNALLY = use main thread for each connection, can only handle one request at a time [unless you set the thread pool size]
 
@@ -495,7 +690,7 @@ struct MHD_Daemon* CWebServer::StartMHD(unsigned int flags, int port)
                           &CWebServer::AnswerToConnection,
                           this,
 #if (MHD_VERSION >= 0x00040002)
-                          MHD_OPTION_THREAD_POOL_SIZE, 4,
+                          MHD_OPTION_THREAD_POOL_SIZE, threads,
 #endif
                           MHD_OPTION_CONNECTION_LIMIT, 512,
                           MHD_OPTION_CONNECTION_TIMEOUT, timeout,
@@ -34,6 +34,11 @@
 #include "threads/CriticalSection.h"
 #include "httprequesthandler/IHTTPRequestHandler.h"
 
+namespace XFILE
+{
+  class CFile;
+}
+
 class CWebServer : public JSONRPC::ITransportLayer
 {
 public:
@@ -92,7 +97,7 @@ private:
   static int HandleRequest(IHTTPRequestHandler *handler, const HTTPRequest &request);
   static void ContentReaderFreeCallback (void *cls);
   static int CreateRedirect(struct MHD_Connection *connection, const std::string &strURL, struct MHD_Response *&response);
-  static int CreateFileDownloadResponse(struct MHD_Connection *connection, const std::string &strURL, HTTPMethod methodType, struct MHD_Response *&response);
+  static int CreateFileDownloadResponse(struct MHD_Connection *connection, const std::string &strURL, HTTPMethod methodType, struct MHD_Response *&response, int &responseCode);
   static int CreateErrorResponse(struct MHD_Connection *connection, int responseType, HTTPMethod method, struct MHD_Response *&response);
   static int CreateMemoryDownloadResponse(struct MHD_Connection *connection, void *data, size_t size, bool free, bool copy, struct MHD_Response *&response);
 
@@ -115,5 +120,11 @@ private:
     IHTTPRequestHandler *requestHandler;
     struct MHD_PostProcessor *postprocessor;
   } ConnectionHandler;
+
+  typedef struct FileReaderContext
+  {
+    XFILE::CFile *file;
+    int64_t offset;    ///< first byte of the (possibly partial) body within the file
+  } FileReaderContext;
 };
 #endif
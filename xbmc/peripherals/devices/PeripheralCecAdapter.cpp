@@ -101,9 +101,10 @@ CPeripheralCecAdapter::CPeripheralCecAdapter(const PeripheralType type, const Pe
 
 CPeripheralCecAdapter::~CPeripheralCecAdapter(void)
 {
+  // not under m_critSection, removal waits for a delivery to Announce() which takes it
+  CAnnouncementManager::RemoveAnnouncer(this);
   {
     CSingleLock lock(m_critSection);
-    CAnnouncementManager::RemoveAnnouncer(this);
     m_bStop = true;
   }
 
@@ -1607,10 +1608,10 @@ void CPeripheralCecAdapter::OnDeviceRemoved(void)
 
 void CPeripheralCecAdapter::ReopenConnection(void)
 {
+  CAnnouncementManager::RemoveAnnouncer(this);
   {
     CSingleLock lock(m_critSection);
     m_iExitCode = EXITCODE_RESTARTAPP;
-    CAnnouncementManager::RemoveAnnouncer(this);
     StopThread(false);
   }
 
@@ -33,6 +33,7 @@
 #include "GUIDialogPictureInfo.h"
 #include "GUIUserMessages.h"
 #include "guilib/GUIWindowManager.h"
+#include "settings/AdvancedSettings.h"
 #include "settings/Settings.h"
 #include "settings/GUISettings.h"
 #include "FileItem.h"
@@ -70,6 +71,7 @@ static float zoomamount[10] = { 1.0f, 1.2f, 1.5f, 2.0f, 2.8f, 4.0f, 6.0f, 9.0f,
 CBackgroundPicLoader::CBackgroundPicLoader() : CThread("CBackgroundPicLoader")
 {
   m_pCallback = NULL;
+  m_pPrefetcher = NULL;
   m_isLoading = false;
 }
 
@@ -78,9 +80,10 @@ CBackgroundPicLoader::~CBackgroundPicLoader()
   StopThread();
 }
 
-void CBackgroundPicLoader::Create(CGUIWindowSlideShow *pCallback)
+void CBackgroundPicLoader::Create(CGUIWindowSlideShow *pCallback, CSlideShowPrefetcher *pPrefetcher)
 {
   m_pCallback = pCallback;
+  m_pPrefetcher = pPrefetcher;
   m_isLoading = false;
   CThread::Create(false);
 }
@@ -96,10 +99,16 @@ void CBackgroundPicLoader::Process()
       if (m_pCallback)
       {
         unsigned int start = XbmcThreads::SystemClockMillis();
-        CBaseTexture* texture = new CTexture();
         unsigned int originalWidth = 0;
         unsigned int originalHeight = 0;
-        texture->LoadFromFile(m_strFileName, m_maxWidth, m_maxHeight, g_guiSettings.GetBool("pictures.useexifrotation"), &originalWidth, &originalHeight);
+        CBaseTexture* texture = NULL;
+        if (m_pPrefetcher)
+          texture = m_pPrefetcher->Take(m_strFileName, m_maxWidth, m_maxHeight, originalWidth, originalHeight);
+        if (!texture)
+        {
+          texture = new CTexture();
+          texture->LoadFromFile(m_strFileName, m_maxWidth, m_maxHeight, g_guiSettings.GetBool("pictures.useexifrotation"), &originalWidth, &originalHeight);
+        }
         totalTime += XbmcThreads::SystemClockMillis() - start;
         count++;
         // tell our parent
@@ -175,6 +184,7 @@ void CGUIWindowSlideShow::Reset()
   m_iNextSlide = 1;
   m_iCurrentPic = 0;
   m_iDirection = 1;
+  m_prefetcher.Clear();
   CSingleLock lock(m_slideSection);
   m_slides->Clear();
   m_Resolution = g_graphicsContext.GetVideoResolution();
@@ -194,6 +204,7 @@ void CGUIWindowSlideShow::FreeResources()
     delete m_pBackgroundLoader;
     m_pBackgroundLoader = NULL;
   }
+  m_prefetcher.Clear();
   // and close the images.
   m_Image[0].Close();
   m_Image[1].Close();
@@ -310,7 +321,7 @@ void CGUIWindowSlideShow::Process(unsigned int currentTime, CDirtyRegionList &re
     {
       throw 1;
     }
-    m_pBackgroundLoader->Create(this);
+    m_pBackgroundLoader->Create(this, &m_prefetcher);
   }
 
   bool bSlideShow = m_bSlideShow && !m_bPause && !m_bPlayingVideo;
@@ -367,6 +378,7 @@ void CGUIWindowSlideShow::Process(unsigned int currentTime, CDirtyRegionList &re
     GetCheckedSize((float)g_settings.m_ResInfo[m_Resolution].iWidth * zoomamount[m_iZoomFactor - 1],
                     (float)g_settings.m_ResInfo[m_Resolution].iHeight * zoomamount[m_iZoomFactor - 1],
                     maxWidth, maxHeight);
+    UpdatePrefetchWindow(m_iCurrentSlide, maxWidth, maxHeight);
     if (!m_slides->Get(m_iCurrentSlide)->IsVideo())
       m_pBackgroundLoader->LoadPic(m_iCurrentPic, m_iCurrentSlide, m_slides->Get(m_iCurrentSlide)->GetPath(), maxWidth, maxHeight);
   }
@@ -411,6 +423,7 @@ void CGUIWindowSlideShow::Process(unsigned int currentTime, CDirtyRegionList &re
       GetCheckedSize((float)g_settings.m_ResInfo[m_Resolution].iWidth * zoomamount[m_iZoomFactor - 1],
                      (float)g_settings.m_ResInfo[m_Resolution].iHeight * zoomamount[m_iZoomFactor - 1],
                      maxWidth, maxHeight);
+      UpdatePrefetchWindow(m_iNextSlide, maxWidth, maxHeight);
       if (!m_slides->Get(m_iNextSlide)->IsVideo())
         m_pBackgroundLoader->LoadPic(1 - m_iCurrentPic, m_iNextSlide, m_slides->Get(m_iNextSlide)->GetPath(), maxWidth, maxHeight);
     }
@@ -507,6 +520,30 @@ int CGUIWindowSlideShow::GetNextSlide()
     return (m_iCurrentSlide - 1 + m_slides->Size()) % m_slides->Size();
 }
 
+void CGUIWindowSlideShow::UpdatePrefetchWindow(int iSlide, int maxWidth, int maxHeight)
+{
+  // the slide about to be loaded comes first, then the ones after it in the direction we're
+  // heading and then the ones before it, nearest first
+  int size = m_slides->Size();
+  int step = (m_bSlideShow || m_iDirection >= 0) ? 1 : -1;
+  int ahead = std::min(g_advancedSettings.m_slideshowPrefetchAhead, size - 1);
+  int behind = std::min(g_advancedSettings.m_slideshowPrefetchBehind, size - 1 - ahead);
+
+  std::vector<CStdString> paths;
+  for (int i = 0; i <= ahead + behind; i++)
+  {
+    int offset = i <= ahead ? i * step : (ahead - i) * step;
+    int index = ((iSlide + offset) % size + size) % size;
+    // no point decoding the slide that's on screen again
+    if (index != iSlide && index == m_iCurrentSlide && m_Image[m_iCurrentPic].IsLoaded())
+      continue;
+    CFileItemPtr slide = m_slides->Get(index);
+    if (!slide->IsVideo())
+      paths.push_back(slide->GetPath());
+  }
+  m_prefetcher.SetWindow(paths, maxWidth, maxHeight);
+}
+
 EVENT_RESULT CGUIWindowSlideShow::OnMouseEvent(const CPoint &point, const CMouseEvent &event)
 {
   if (event.m_id == ACTION_GESTURE_NOTIFY)
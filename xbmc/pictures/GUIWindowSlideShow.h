@@ -27,6 +27,7 @@
 #include "threads/CriticalSection.h"
 #include "threads/Event.h"
 #include "SlideShowPicture.h"
+#include "SlideShowPrefetcher.h"
 #include "DllImageLib.h"
 #include "SortFileItem.h"
 
@@ -40,7 +41,7 @@ public:
   CBackgroundPicLoader();
   ~CBackgroundPicLoader();
 
-  void Create(CGUIWindowSlideShow *pCallback);
+  void Create(CGUIWindowSlideShow *pCallback, CSlideShowPrefetcher *pPrefetcher = NULL);
   void LoadPic(int iPic, int iSlideNumber, const CStdString &strFileName, const int maxWidth, const int maxHeight);
   bool IsLoading() { return m_isLoading;};
 
@@ -56,6 +57,7 @@ private:
   bool m_isLoading;
 
   CGUIWindowSlideShow *m_pCallback;
+  CSlideShowPrefetcher *m_pPrefetcher;
 };
 
 class CGUIWindowSlideShow : public CGUIWindow
@@ -107,6 +109,7 @@ private:
   void Move(float fX, float fY);
   void GetCheckedSize(float width, float height, int &maxWidth, int &maxHeight);
   int  GetNextSlide();
+  void UpdatePrefetchWindow(int iSlide, int maxWidth, int maxHeight);
 
   int m_iCurrentSlide;
   int m_iNextSlide;
@@ -128,6 +131,7 @@ private:
   int m_iCurrentPic;
   // background loader
   CBackgroundPicLoader* m_pBackgroundLoader;
+  CSlideShowPrefetcher m_prefetcher;
   bool m_bWaitForNextPic;
   bool m_bLoadNextPic;
   bool m_bReloadImage;
@@ -0,0 +1,225 @@
+/*
+ *      Copyright (C) 2005-2012 Team XBMC
+ *      http://www.xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, write to
+ *  the Free Software Foundation, 675 Mass Ave, Cambridge, MA 02139, USA.
+ *  http://www.gnu.org/copyleft/gpl.html
+ *
+ */
+
+
+#include <algorithm>
+
+#include "SlideShowPrefetcher.h"
+#include "guilib/Texture.h"
+#include "settings/AdvancedSettings.h"
+#include "settings/GUISettings.h"
+#include "threads/SingleLock.h"
+#include "utils/log.h"
+
+using namespace std;
+
+class CSlideShowPrefetcher::CDecodeJob : public CJob
+{
+public:
+  CDecodeJob(const CStdString &path, unsigned int maxWidth, unsigned int maxHeight)
+    : m_path(path), m_maxWidth(maxWidth), m_maxHeight(maxHeight),
+      m_originalWidth(0), m_originalHeight(0), m_texture(NULL)
+  {
+  }
+
+  virtual ~CDecodeJob()
+  {
+    delete m_texture;
+  }
+
+  virtual const char *GetType() const { return "slideshowdecode"; };
+
+  virtual bool DoWork()
+  {
+    // same as CBackgroundPicLoader, which hands the texture on even if it failed to load
+    m_texture = new CTexture();
+    m_texture->LoadFromFile(m_path, m_maxWidth, m_maxHeight, g_guiSettings.GetBool("pictures.useexifrotation"),
+                            &m_originalWidth, &m_originalHeight);
+    return true;
+  }
+
+  CStdString    m_path;
+  unsigned int  m_maxWidth;
+  unsigned int  m_maxHeight;
+  unsigned int  m_originalWidth;
+  unsigned int  m_originalHeight;
+  CBaseTexture *m_texture;
+};
+
+CSlideShowPrefetcher::CSlideShowPrefetcher()
+  : m_queue(NULL), m_size(0), m_sequence(0), m_hits(0), m_misses(0)
+{
+}
+
+CSlideShowPrefetcher::~CSlideShowPrefetcher()
+{
+  Clear();
+  delete m_queue;
+}
+
+void CSlideShowPrefetcher::SetWindow(const vector<CStdString> &paths, unsigned int maxWidth, unsigned int maxHeight)
+{
+  CSingleLock lock(m_section);
+  m_window = paths;
+
+  // drop what's queued for pictures that are no longer wanted, or at another size
+  for (map<CStdString, CDecodeJob*>::iterator it = m_pending.begin(); it != m_pending.end(); )
+  {
+    if (find(paths.begin(), paths.end(), it->first) == paths.end() ||
+        it->second->m_maxWidth != maxWidth || it->second->m_maxHeight != maxHeight)
+    {
+      m_queue->CancelJob(it->second);
+      m_pending.erase(it++);
+    }
+    else
+      ++it;
+  }
+
+  for (vector<CStdString>::const_iterator path = paths.begin(); path != paths.end(); ++path)
+  {
+    if (m_pending.find(*path) != m_pending.end())
+      continue;
+    map<CStdString, CPicture>::iterator picture = m_pictures.find(*path);
+    if (picture != m_pictures.end())
+    {
+      if (picture->second.m_maxWidth == maxWidth && picture->second.m_maxHeight == maxHeight)
+        continue;
+      m_size -= picture->second.m_size;
+      delete picture->second.m_texture;
+      m_pictures.erase(picture);
+    }
+
+    if (!m_queue)
+      m_queue = new COwnedJobQueue(this, false, g_advancedSettings.m_slideshowPrefetchJobs, CJob::PRIORITY_NORMAL);
+
+    CDecodeJob *job = new CDecodeJob(*path, maxWidth, maxHeight);
+    m_pending[*path] = job;
+    m_queue->AddJob(job);
+  }
+}
+
+CBaseTexture *CSlideShowPrefetcher::Take(const CStdString &path, unsigned int maxWidth, unsigned int maxHeight,
+                                         unsigned int &originalWidth, unsigned int &originalHeight)
+{
+  CSingleLock lock(m_section);
+  while (true)
+  {
+    map<CStdString, CPicture>::iterator it = m_pictures.find(path);
+    if (it != m_pictures.end())
+    {
+      CPicture picture = it->second;
+      m_pictures.erase(it);
+      m_size -= picture.m_size;
+      if (picture.m_maxWidth == maxWidth && picture.m_maxHeight == maxHeight)
+      {
+        m_hits++;
+        originalWidth = picture.m_originalWidth;
+        originalHeight = picture.m_originalHeight;
+        return picture.m_texture;
+      }
+      delete picture.m_texture;
+      m_misses++;
+      return NULL;
+    }
+
+    map<CStdString, CDecodeJob*>::iterator job = m_pending.find(path);
+    if (job == m_pending.end() || job->second->m_maxWidth != maxWidth || job->second->m_maxHeight != maxHeight)
+    {
+      m_misses++;
+      return NULL;
+    }
+
+    CSingleExit exit(m_section);
+    m_decodedEvent.WaitMSec(100);
+  }
+}
+
+void CSlideShowPrefetcher::Clear()
+{
+  CSingleLock lock(m_section);
+  // jobs that are already running may still complete, OnJobComplete() drops them as they're no longer pending
+  if (m_queue)
+    m_queue->CancelJobs();
+
+  for (map<CStdString, CPicture>::iterator it = m_pictures.begin(); it != m_pictures.end(); ++it)
+    delete it->second.m_texture;
+  m_pictures.clear();
+  m_pending.clear();
+  m_window.clear();
+  m_size = 0;
+
+  if (m_hits + m_misses > 0)
+    CLog::Log(LOGDEBUG, "%s - %u of %u pictures were decoded ahead of time", __FUNCTION__, m_hits, m_hits + m_misses);
+  m_hits = 0;
+  m_misses = 0;
+}
+
+void CSlideShowPrefetcher::OnJobComplete(unsigned int jobID, bool success, CJob *decodeJob)
+{
+  CDecodeJob *job = (CDecodeJob *)decodeJob;
+  CSingleLock lock(m_section);
+  map<CStdString, CDecodeJob*>::iterator it = m_pending.find(job->m_path);
+  if (it != m_pending.end() && it->second == job)
+  {
+    m_pending.erase(it);
+
+    CPicture picture;
+    picture.m_texture = job->m_texture;
+    picture.m_maxWidth = job->m_maxWidth;
+    picture.m_maxHeight = job->m_maxHeight;
+    picture.m_originalWidth = job->m_originalWidth;
+    picture.m_originalHeight = job->m_originalHeight;
+    picture.m_size = (size_t)job->m_texture->GetPitch() * job->m_texture->GetRows();
+    picture.m_decoded = m_sequence++;
+    job->m_texture = NULL;
+
+    m_pictures[job->m_path] = picture;
+    m_size += picture.m_size;
+    Evict();
+  }
+  m_decodedEvent.Set();
+}
+
+void CSlideShowPrefetcher::Evict()
+{
+  size_t budget = (size_t)g_advancedSettings.m_slideshowPrefetchMemory * 1024 * 1024;
+  while (m_size > budget && !m_pictures.empty())
+  {
+    // the window is ordered by how soon the pictures are shown, so drop the farthest one.
+    // Pictures that left the window rank behind all of it, the least recently decoded first.
+    map<CStdString, CPicture>::iterator farthest = m_pictures.end();
+    size_t farthestRank = 0;
+    for (map<CStdString, CPicture>::iterator it = m_pictures.begin(); it != m_pictures.end(); ++it)
+    {
+      size_t rank = find(m_window.begin(), m_window.end(), it->first) - m_window.begin();
+      if (farthest == m_pictures.end() || rank > farthestRank ||
+          (rank == farthestRank && it->second.m_decoded < farthest->second.m_decoded))
+      {
+        farthest = it;
+        farthestRank = rank;
+      }
+    }
+    CLog::Log(LOGDEBUG, "%s - dropping %s to stay within %u MB", __FUNCTION__, farthest->first.c_str(), g_advancedSettings.m_slideshowPrefetchMemory);
+    m_size -= farthest->second.m_size;
+    delete farthest->second.m_texture;
+    m_pictures.erase(farthest);
+  }
+}
@@ -0,0 +1,97 @@
+#pragma once
+/*
+ *      Copyright (C) 2005-2012 Team XBMC
+ *      http://www.xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, write to
+ *  the Free Software Foundation, 675 Mass Ave, Cambridge, MA 02139, USA.
+ *  http://www.gnu.org/copyleft/gpl.html
+ *
+ */
+
+
+#include <map>
+#include <vector>
+
+#include "threads/CriticalSection.h"
+#include "threads/Event.h"
+#include "utils/JobManager.h"
+#include "utils/StdString.h"
+
+class CBaseTexture;
+
+/*! \brief Decodes the pictures around the current slide of the slideshow ahead of time
+ Pictures are decoded on worker threads at the size they're shown at. Decoded pictures are kept
+ until they're taken, or evicted once they take up more than slideshow.prefetchmemory. Pictures
+ that left the window go first, then the least wanted ones of the window.
+ */
+class CSlideShowPrefetcher : public IJobCallback
+{
+public:
+  CSlideShowPrefetcher();
+  ~CSlideShowPrefetcher();
+
+  /*! \brief Set the pictures to decode, the most wanted first
+   Pictures that are neither decoded nor being decoded are queued, and queued pictures that are
+   no longer wanted are dropped from the queue.
+   \param paths the pictures
+   \param maxWidth width to decode the pictures at
+   \param maxHeight height to decode the pictures at
+   */
+  void SetWindow(const std::vector<CStdString> &paths, unsigned int maxWidth, unsigned int maxHeight);
+
+  /*! \brief Take a decoded picture, waiting for it if it's still being decoded
+   \param path the picture
+   \param maxWidth width the picture is wanted at
+   \param maxHeight height the picture is wanted at
+   \param originalWidth [out] width of the picture before scaling
+   \param originalHeight [out] height of the picture before scaling
+   \return the texture, owned by the caller, or NULL if the picture wasn't decoded at this size
+   */
+  CBaseTexture *Take(const CStdString &path, unsigned int maxWidth, unsigned int maxHeight,
+                     unsigned int &originalWidth, unsigned int &originalHeight);
+
+  /*! \brief Cancel any queued pictures and drop the decoded ones */
+  void Clear();
+
+  virtual void OnJobComplete(unsigned int jobID, bool success, CJob *job);
+
+private:
+  class CDecodeJob;
+
+  class CPicture
+  {
+  public:
+    CBaseTexture *m_texture;
+    unsigned int  m_maxWidth;
+    unsigned int  m_maxHeight;
+    unsigned int  m_originalWidth;
+    unsigned int  m_originalHeight;
+    size_t        m_size;    ///< bytes taken by the decoded texture
+    unsigned int  m_decoded; ///< sequence number, the lowest one is evicted first of those outside the window
+  };
+
+  void Evict();
+
+  CCriticalSection                    m_section;
+  CEvent                              m_decodedEvent;
+  COwnedJobQueue                     *m_queue;    ///< created on first use, lives as long as the prefetcher
+  std::map<CStdString, CDecodeJob*>   m_pending;  ///< pictures queued or being decoded
+  std::map<CStdString, CPicture>      m_pictures; ///< pictures decoded but not yet taken
+  std::vector<CStdString>             m_window;   ///< pictures wanted, the most wanted first
+  size_t                              m_size;     ///< bytes taken by m_pictures
+  unsigned int                        m_sequence;
+  unsigned int                        m_hits;
+  unsigned int                        m_misses;
+};
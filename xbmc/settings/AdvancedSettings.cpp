@@ -111,6 +111,8 @@ void CAdvancedSettings::Initialize()
   m_DXVAForceProcessorRenderer = true;
   m_DXVANoDeintProcForProgressive = false;
   m_videoFpsDetect = 1;
+  m_videoProbeCache = true;
+  m_videoExtractionJobs = 2;
   m_videoDefaultLatency = 0.0;
 
   m_musicUseTimeSeeking = true;
@@ -126,6 +128,10 @@ void CAdvancedSettings::Initialize()
   m_slideshowPanAmount = 2.5f;
   m_slideshowZoomAmount = 5.0f;
   m_slideshowBlackBarCompensation = 20.0f;
+  m_slideshowPrefetchAhead = 3;
+  m_slideshowPrefetchBehind = 1;
+  m_slideshowPrefetchJobs = 2;
+  m_slideshowPrefetchMemory = 128;
 
   m_lcdHeartbeat = false;
   m_lcdDimOnScreenSave = false;
@@ -189,6 +195,9 @@ void CAdvancedSettings::Initialize()
   m_sambaclienttimeout = 10;
   m_sambadoscodepage = "";
   m_sambastatfiles = true;
+  m_sambaContextsPerServer = 4;
+
+  m_nfsReadAhead = 4;
 
   m_bHTTPDirectoryStatFilesize = false;
 
@@ -218,6 +227,7 @@ void CAdvancedSettings::Initialize()
   m_bVideoLibraryImportWatchedState = false;
   m_bVideoLibraryImportResumePoint = false;
   m_bVideoScannerIgnoreErrors = false;
+  m_videoScannerListingsPerHost = 2;
   m_iVideoLibraryDateAdded = 1; // prefer mtime over ctime and current time
 
   m_iTuxBoxStreamtsPort = 31339;
@@ -289,12 +299,17 @@ void CAdvancedSettings::Initialize()
   m_jsonOutputCompact = true;
   m_jsonTcpPort = 9090;
 
+  m_webServerThreadPoolSize = 0;
+
   m_enableMultimediaKeys = false;
 
   m_canWindowed = true;
   m_guiVisualizeDirtyRegions = false;
   m_guiAlgorithmDirtyRegions = 0;
   m_guiDirtyRegionNoFlipTimeout = -1;
+  m_guiIdleWakeInterval = 40;
+  m_guiWindowXMLCache = 32;
+  m_guiAsyncTextureLoad = true;
   m_logEnableAirtunes = false;
   m_airTunesPort = 36666;
   m_airPlayPort = 36667;
@@ -568,6 +583,10 @@ void CAdvancedSettings::ParseSettingsFile(const CStdString &file)
     XMLUtils::GetBoolean(pElement,"dxvanodeintforprogressive", m_DXVANoDeintProcForProgressive);
     //0 = disable fps detect, 1 = only detect on timestamps with uniform spacing, 2 detect on all timestamps
     XMLUtils::GetInt(pElement, "fpsdetect", m_videoFpsDetect, 0, 2);
+    // remember demuxer probe results for local and network files
+    XMLUtils::GetBoolean(pElement, "probecache", m_videoProbeCache);
+    // the job manager runs no more than three low priority jobs at once
+    XMLUtils::GetInt(pElement, "extractionjobs", m_videoExtractionJobs, 1, 3);
 
     // Store global display latency settings
     TiXmlElement* pVideoLatency = pElement->FirstChildElement("latency");
@@ -640,6 +659,7 @@ void CAdvancedSettings::ParseSettingsFile(const CStdString &file)
   if (pElement)
   {
     XMLUtils::GetBoolean(pElement, "ignoreerrors", m_bVideoScannerIgnoreErrors);
+    XMLUtils::GetInt(pElement, "listingsperhost", m_videoScannerListingsPerHost, 1, 16);
   }
 
   // Backward-compatibility of ExternalPlayer config
@@ -654,6 +674,10 @@ void CAdvancedSettings::ParseSettingsFile(const CStdString &file)
     XMLUtils::GetFloat(pElement, "panamount", m_slideshowPanAmount, 0.0f, 20.0f);
     XMLUtils::GetFloat(pElement, "zoomamount", m_slideshowZoomAmount, 0.0f, 20.0f);
     XMLUtils::GetFloat(pElement, "blackbarcompensation", m_slideshowBlackBarCompensation, 0.0f, 50.0f);
+    XMLUtils::GetInt(pElement, "prefetchahead", m_slideshowPrefetchAhead, 0, 20);
+    XMLUtils::GetInt(pElement, "prefetchbehind", m_slideshowPrefetchBehind, 0, 20);
+    XMLUtils::GetInt(pElement, "prefetchjobs", m_slideshowPrefetchJobs, 1, 4);
+    XMLUtils::GetInt(pElement, "prefetchmemory", m_slideshowPrefetchMemory, 16, 1024);
   }
 
   pElement = pRootElement->FirstChildElement("lcd");
@@ -681,14 +705,26 @@ void CAdvancedSettings::ParseSettingsFile(const CStdString &file)
     XMLUtils::GetUInt(pElement, "tcpport", m_jsonTcpPort);
   }
 
+  pElement = pRootElement->FirstChildElement("webserver");
+  if (pElement)
+  {
+    // 0 sizes the pool from the number of cpus
+    XMLUtils::GetInt(pElement, "threadpoolsize", m_webServerThreadPoolSize, 0, 64);
+  }
+
   pElement = pRootElement->FirstChildElement("samba");
   if (pElement)
   {
     XMLUtils::GetString(pElement,  "doscodepage",   m_sambadoscodepage);
     XMLUtils::GetInt(pElement, "clienttimeout", m_sambaclienttimeout, 5, 100);
     XMLUtils::GetBoolean(pElement, "statfiles", m_sambastatfiles);
+    XMLUtils::GetInt(pElement, "contextsperserver", m_sambaContextsPerServer, 1, 16);
   }
 
+  pElement = pRootElement->FirstChildElement("nfs");
+  if (pElement)
+    XMLUtils::GetInt(pElement, "readahead", m_nfsReadAhead, 1, 32);
+
   pElement = pRootElement->FirstChildElement("httpdirectory");
   if (pElement)
     XMLUtils::GetBoolean(pElement, "statfilesize", m_bHTTPDirectoryStatFilesize);
@@ -983,6 +1019,9 @@ void CAdvancedSettings::ParseSettingsFile(const CStdString &file)
     XMLUtils::GetBoolean(pElement, "visualizedirtyregions", m_guiVisualizeDirtyRegions);
     XMLUtils::GetInt(pElement, "algorithmdirtyregions",     m_guiAlgorithmDirtyRegions);
     XMLUtils::GetInt(pElement, "nofliptimeout",             m_guiDirtyRegionNoFlipTimeout);
+    XMLUtils::GetInt(pElement, "idlewakeinterval",          m_guiIdleWakeInterval, 10, 1000);
+    XMLUtils::GetInt(pElement, "windowxmlcache",            m_guiWindowXMLCache, 0, 1000);
+    XMLUtils::GetBoolean(pElement, "asynctextureload",      m_guiAsyncTextureLoad);
   }
 
   // load in the GUISettings overrides:
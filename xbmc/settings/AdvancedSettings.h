@@ -164,6 +164,8 @@ class CAdvancedSettings
     bool m_DXVAForceProcessorRenderer;
     bool m_DXVANoDeintProcForProgressive;
     int  m_videoFpsDetect;
+    bool m_videoProbeCache;
+    int  m_videoExtractionJobs; ///< thumbs and stream details extracted at once by each video window
 
     CStdString m_videoDefaultPlayer;
     CStdString m_videoDefaultDVDPlayer;
@@ -172,6 +174,10 @@ class CAdvancedSettings
     float m_slideshowBlackBarCompensation;
     float m_slideshowZoomAmount;
     float m_slideshowPanAmount;
+    int m_slideshowPrefetchAhead;
+    int m_slideshowPrefetchBehind;
+    int m_slideshowPrefetchJobs;
+    int m_slideshowPrefetchMemory;
 
     bool m_lcdHeartbeat;
     bool m_lcdDimOnScreenSave;
@@ -224,6 +230,9 @@ class CAdvancedSettings
     int m_sambaclienttimeout;
     CStdString m_sambadoscodepage;
     bool m_sambastatfiles;
+    int m_sambaContextsPerServer; ///< libsmbclient contexts pooled per server and credentials for reading files
+
+    int m_nfsReadAhead; ///< READ requests kept in flight by an nfs stream
 
     bool m_bHTTPDirectoryStatFilesize;
 
@@ -255,6 +264,7 @@ class CAdvancedSettings
     bool m_bVideoLibraryImportResumePoint;
 
     bool m_bVideoScannerIgnoreErrors;
+    int m_videoScannerListingsPerHost;
     int m_iVideoLibraryDateAdded;
 
     std::vector<CStdString> m_vecTokens; // cleaning strings tied to language
@@ -330,12 +340,17 @@ class CAdvancedSettings
     bool m_guiVisualizeDirtyRegions;
     int  m_guiAlgorithmDirtyRegions;
     int  m_guiDirtyRegionNoFlipTimeout;
+    int  m_guiIdleWakeInterval;
+    int  m_guiWindowXMLCache;
+    bool m_guiAsyncTextureLoad;
 
     unsigned int m_cacheMemBufferSize;
 
     bool m_jsonOutputCompact;
     unsigned int m_jsonTcpPort;
 
+    int m_webServerThreadPoolSize;
+
     bool m_enableMultimediaKeys;
     std::vector<CStdString> m_settingsFiles;
     void ParseSettingsFile(const CStdString &file);
@@ -19,13 +19,15 @@
  *
  */
 
+#include <algorithm>
+
 #include "Archive.h"
 #include "filesystem/File.h"
 #include "Variant.h"
 
 using namespace XFILE;
 
-#define BUFFER_MAX 4096
+#define BUFFER_MAX 65536
 
 CArchive::CArchive(CFile* pFile, int mode)
 {
@@ -34,14 +36,31 @@ CArchive::CArchive(CFile* pFile, int mode)
 
   m_pBuffer = new BYTE[BUFFER_MAX];
   memset(m_pBuffer, 0, BUFFER_MAX);
+  m_ownsBuffer = true;
+
+  m_BufferPos = 0;
+  m_BufferSize = 0;
+  m_BufferStart = 0;
+}
+
+CArchive::CArchive(const uint8_t *data, unsigned int size)
+{
+  m_pFile = NULL;
+  m_iMode = load;
+
+  m_pBuffer = const_cast<uint8_t *>(data);
+  m_ownsBuffer = false;
 
   m_BufferPos = 0;
+  m_BufferSize = size;
+  m_BufferStart = 0;
 }
 
 CArchive::~CArchive()
 {
   FlushBuffer();
-  delete[] m_pBuffer;
+  if (m_ownsBuffer)
+    delete[] m_pBuffer;
   m_BufferPos = 0;
 }
 
@@ -60,6 +79,11 @@ bool CArchive::IsStoring()
   return (m_iMode == store);
 }
 
+int64_t CArchive::GetPosition() const
+{
+  return m_BufferStart + m_BufferPos;
+}
+
 CArchive& CArchive::operator<<(float f)
 {
   int size = sizeof(float);
@@ -285,87 +309,81 @@ CArchive& CArchive::operator<<(const std::vector<int>& iArray)
 
 CArchive& CArchive::operator>>(float& f)
 {
-  m_pFile->Read((void*)&f, sizeof(float));
+  ReadBytes(&f, sizeof(float));
 
   return *this;
 }
 
 CArchive& CArchive::operator>>(double& d)
 {
-  m_pFile->Read((void*)&d, sizeof(double));
+  ReadBytes(&d, sizeof(double));
 
   return *this;
 }
 
 CArchive& CArchive::operator>>(int& i)
 {
-  m_pFile->Read((void*)&i, sizeof(int));
+  ReadBytes(&i, sizeof(int));
 
   return *this;
 }
 
 CArchive& CArchive::operator>>(unsigned int& i)
 {
-  m_pFile->Read((void*)&i, sizeof(unsigned int));
+  ReadBytes(&i, sizeof(unsigned int));
 
   return *this;
 }
 
 CArchive& CArchive::operator>>(int64_t& i64)
 {
-  m_pFile->Read((void*)&i64, sizeof(int64_t));
+  ReadBytes(&i64, sizeof(int64_t));
 
   return *this;
 }
 
 CArchive& CArchive::operator>>(uint64_t& ui64)
 {
-  m_pFile->Read((void*)&ui64, sizeof(uint64_t));
+  ReadBytes(&ui64, sizeof(uint64_t));
 
   return *this;
 }
 
 CArchive& CArchive::operator>>(bool& b)
 {
-  m_pFile->Read((void*)&b, sizeof(bool));
+  ReadBytes(&b, sizeof(bool));
 
   return *this;
 }
 
 CArchive& CArchive::operator>>(char& c)
 {
-  m_pFile->Read((void*)&c, sizeof(char));
+  ReadBytes(&c, sizeof(char));
 
   return *this;
 }
 
 CArchive& CArchive::operator>>(CStdString& str)
 {
-  int iLength = 0;
-  *this >> iLength;
-
-  m_pFile->Read((void*)str.GetBufferSetLength(iLength), iLength);
+  int iLength = ReadLength();
+  ReadBytes(str.GetBufferSetLength(iLength), iLength);
   str.ReleaseBuffer();
 
-
   return *this;
 }
 
 CArchive& CArchive::operator>>(CStdStringW& str)
 {
-  int iLength = 0;
-  *this >> iLength;
-
-  m_pFile->Read((void*)str.GetBufferSetLength(iLength), iLength);
+  int iLength = ReadLength();
+  ReadBytes(str.GetBufferSetLength(iLength), iLength);
   str.ReleaseBuffer();
 
-
   return *this;
 }
 
 CArchive& CArchive::operator>>(SYSTEMTIME& time)
 {
-  m_pFile->Read((void*)&time, sizeof(SYSTEMTIME));
+  ReadBytes(&time, sizeof(SYSTEMTIME));
 
   return *this;
 }
@@ -422,8 +440,7 @@ CArchive& CArchive::operator>>(CVariant& variant)
   }
   case CVariant::VariantTypeArray:
   {
-    unsigned int size;
-    *this >> size;
+    unsigned int size = ReadLength();
     for (; size > 0; size--)
     {
       CVariant value;
@@ -434,8 +451,7 @@ CArchive& CArchive::operator>>(CVariant& variant)
   }
   case CVariant::VariantTypeObject:
   {
-    unsigned int size;
-    *this >> size;
+    unsigned int size = ReadLength();
     for (; size > 0; size--)
     {
       CStdString name;
@@ -457,8 +473,7 @@ CArchive& CArchive::operator>>(CVariant& variant)
 
 CArchive& CArchive::operator>>(std::vector<std::string>& strArray)
 {
-  int size;
-  *this >> size;
+  int size = ReadLength();
   strArray.clear();
   for (int index = 0; index < size; index++)
   {
@@ -472,8 +487,7 @@ CArchive& CArchive::operator>>(std::vector<std::string>& strArray)
 
 CArchive& CArchive::operator>>(std::vector<int>& iArray)
 {
-  int size;
-  *this >> size;
+  int size = ReadLength();
   iArray.clear();
   for (int index = 0; index < size; index++)
   {
@@ -487,9 +501,67 @@ CArchive& CArchive::operator>>(std::vector<int>& iArray)
 
 void CArchive::FlushBuffer()
 {
-  if (m_BufferPos > 0)
+  if (m_iMode == store && m_BufferPos > 0)
   {
     m_pFile->Write(m_pBuffer, m_BufferPos);
+    m_BufferStart += m_BufferPos;
     m_BufferPos = 0;
   }
 }
+
+void CArchive::ReadBytes(void *data, unsigned int size)
+{
+  uint8_t *dest = (uint8_t *)data;
+  while (size > 0)
+  {
+    if (m_BufferPos >= m_BufferSize)
+    {
+      if (!m_pFile)
+        break;
+
+      m_BufferStart += m_BufferSize;
+      m_BufferPos = 0;
+      m_BufferSize = 0;
+
+      // large fields skip the buffer
+      unsigned int read;
+      if (size >= BUFFER_MAX)
+      {
+        read = m_pFile->Read(dest, size);
+        if (read == 0 || read > size)
+          break;
+        m_BufferStart += read;
+        dest += read;
+        size -= read;
+        continue;
+      }
+
+      read = m_pFile->Read(m_pBuffer, BUFFER_MAX);
+      if (read == 0 || read > BUFFER_MAX)
+        break;
+      m_BufferSize = read;
+    }
+
+    unsigned int chunk = std::min(size, (unsigned int)(m_BufferSize - m_BufferPos));
+    memcpy(dest, &m_pBuffer[m_BufferPos], chunk);
+    m_BufferPos += chunk;
+    dest += chunk;
+    size -= chunk;
+  }
+
+  // truncated archive
+  if (size > 0)
+    memset(dest, 0, size);
+}
+
+int CArchive::ReadLength()
+{
+  int iLength = 0;
+  *this >> iLength;
+  if (iLength < 0)
+    iLength = 0;
+  // a corrupt length can't ask for more than there is in memory
+  if (!m_pFile && iLength > m_BufferSize - m_BufferPos)
+    iLength = m_BufferSize - m_BufferPos;
+  return iLength;
+}
@@ -43,6 +43,12 @@ class CArchive
 {
 public:
   CArchive(XFILE::CFile* pFile, int mode);
+  /*! \brief Load from a block of memory instead of a file
+   The memory is not copied, so must outlive the archive. Reads past its end give zeroed fields.
+   \param data the block to load from
+   \param size size of the block in bytes
+   */
+  CArchive(const uint8_t *data, unsigned int size);
   ~CArchive();
   // storing
   CArchive& operator<<(float f);
@@ -81,15 +87,23 @@ public:
   bool IsLoading();
   bool IsStoring();
 
+  /*! \brief Offset of the next field from the start of the archive */
+  int64_t GetPosition() const;
+
   void Close();
 
   enum Mode {load = 0, store};
 
 protected:
   void FlushBuffer();
+  void ReadBytes(void *data, unsigned int size);
+  int ReadLength();
   XFILE::CFile* m_pFile;
   int m_iMode;
   uint8_t *m_pBuffer;
+  bool m_ownsBuffer;
   int m_BufferPos;
+  int m_BufferSize;      ///< bytes of m_pBuffer that hold loaded data
+  int64_t m_BufferStart; ///< offset of m_pBuffer from the start of the archive
 };
 
@@ -0,0 +1,136 @@
+/*
+ *      Copyright (C) 2005-2012 Team XBMC
+ *      http://www.xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, write to
+ *  the Free Software Foundation, 675 Mass Ave, Cambridge, MA 02139, USA.
+ *  http://www.gnu.org/copyleft/gpl.html
+ *
+ */
+
+
+#include "Housekeeper.h"
+#include "threads/SingleLock.h"
+#include "threads/SystemClock.h"
+#include "utils/log.h"
+
+using namespace std;
+
+CHousekeeper g_housekeeper;
+
+CHousekeeper::CHousekeeper() : CThread("CHousekeeper")
+{
+}
+
+CHousekeeper::~CHousekeeper()
+{
+  StopThread();
+}
+
+void CHousekeeper::AddTask(const char *name, Task task, unsigned int interval, unsigned int deadline)
+{
+  CTaskInfo info;
+  info.m_name = name;
+  info.m_task = task;
+  info.m_interval = interval;
+  info.m_deadline = deadline;
+  info.m_runs = 0;
+  info.m_overruns = 0;
+  info.m_totalTime = 0;
+  info.m_maxTime = 0;
+
+  CSingleLock lock(m_section);
+  m_tasks.push_back(info);
+  m_schedule.insert(make_pair(XbmcThreads::SystemClockMillis() + interval, m_tasks.size() - 1));
+}
+
+void CHousekeeper::Start()
+{
+  StopThread();
+  Create();
+}
+
+void CHousekeeper::Stop()
+{
+  StopThread();
+  LogStats();
+
+  CSingleLock lock(m_section);
+  m_tasks.clear();
+  m_schedule.clear();
+}
+
+void CHousekeeper::Process()
+{
+  while (!m_bStop)
+  {
+    size_t index;
+    CTaskInfo task;
+    {
+      CSingleLock lock(m_section);
+      if (m_schedule.empty())
+      {
+        CSingleExit exit(m_section);
+        Sleep(1000);
+        continue;
+      }
+
+      // timestamps wrap, so compare the time elapsed since the task was due
+      multimap<unsigned int, size_t>::iterator next = m_schedule.begin();
+      int wait = (int)(next->first - XbmcThreads::SystemClockMillis());
+      if (wait > 0)
+      {
+        CSingleExit exit(m_section);
+        Sleep(wait);
+        continue;
+      }
+      index = next->second;
+      task = m_tasks[index];
+      m_schedule.erase(next);
+    }
+
+    unsigned int start = XbmcThreads::SystemClockMillis();
+    task.m_task();
+    unsigned int end = XbmcThreads::SystemClockMillis();
+    unsigned int duration = end - start;
+
+    if (duration > task.m_deadline)
+      CLog::Log(LOGWARNING, "%s - %s took %u ms, expected within %u ms", __FUNCTION__, task.m_name.c_str(), duration, task.m_deadline);
+
+    CSingleLock lock(m_section);
+    if (index < m_tasks.size())
+    {
+      CTaskInfo &info = m_tasks[index];
+      info.m_runs++;
+      info.m_totalTime += duration;
+      if (duration > info.m_maxTime)
+        info.m_maxTime = duration;
+      if (duration > info.m_deadline)
+        info.m_overruns++;
+      m_schedule.insert(make_pair(end + info.m_interval, index));
+    }
+  }
+}
+
+void CHousekeeper::LogStats()
+{
+  CSingleLock lock(m_section);
+  for (vector<CTaskInfo>::const_iterator it = m_tasks.begin(); it != m_tasks.end(); ++it)
+  {
+    if (it->m_runs == 0)
+      continue;
+    CLog::Log(LOGDEBUG, "%s - %s: %u runs, average %u ms, max %u ms, %u over %u ms", __FUNCTION__, it->m_name.c_str(),
+              it->m_runs, (unsigned int)(it->m_totalTime / it->m_runs), it->m_maxTime, it->m_overruns, it->m_deadline);
+  }
+}
@@ -0,0 +1,80 @@
+#pragma once
+/*
+ *      Copyright (C) 2005-2012 Team XBMC
+ *      http://www.xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, write to
+ *  the Free Software Foundation, 675 Mass Ave, Cambridge, MA 02139, USA.
+ *  http://www.gnu.org/copyleft/gpl.html
+ *
+ */
+
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include "threads/CriticalSection.h"
+#include "threads/Thread.h"
+
+/*! \brief Runs periodic housekeeping off the GUI thread
+ Each task runs at its own interval on a single background thread. A task that takes longer
+ than its deadline is logged, and the time taken by each task is logged when the housekeeper
+ stops. Tasks must be safe to run outside the GUI thread; the ones that aren't are left to
+ CApplication::ProcessSlow().
+ */
+class CHousekeeper : public CThread
+{
+public:
+  typedef void (*Task)();
+
+  CHousekeeper();
+  virtual ~CHousekeeper();
+
+  /*! \brief Add a task, to be first run one interval after it's added
+   \param name name of the task, for the log
+   \param task function to run
+   \param interval time between the end of one run and the start of the next, in ms
+   \param deadline time the task is expected to finish within, in ms
+   */
+  void AddTask(const char *name, Task task, unsigned int interval, unsigned int deadline);
+
+  void Start();
+  void Stop();
+
+protected:
+  virtual void Process();
+
+private:
+  class CTaskInfo
+  {
+  public:
+    std::string   m_name;
+    Task          m_task;
+    unsigned int  m_interval;
+    unsigned int  m_deadline;
+    unsigned int  m_runs;
+    unsigned int  m_overruns;
+    uint64_t      m_totalTime; ///< in ms
+    unsigned int  m_maxTime;   ///< in ms
+  };
+
+  void LogStats();
+
+  CCriticalSection                      m_section;
+  std::vector<CTaskInfo>                m_tasks;
+  std::multimap<unsigned int, size_t>   m_schedule; ///< index into m_tasks, keyed by the time it's due
+};
+
+extern CHousekeeper g_housekeeper;
@@ -159,6 +159,26 @@ void CJobQueue::CancelJobs()
   m_processing.clear();
 }
 
+COwnedJobQueue::COwnedJobQueue(IJobCallback *owner, bool lifo, unsigned int jobsAtOnce, CJob::PRIORITY priority)
+: CJobQueue(lifo, jobsAtOnce, priority), m_owner(owner)
+{
+}
+
+COwnedJobQueue::~COwnedJobQueue()
+{
+  CancelJobs();
+  CSingleLock lock(m_ownerSection);
+  m_owner = NULL;
+}
+
+void COwnedJobQueue::OnJobComplete(unsigned int jobID, bool success, CJob *job)
+{
+  CSingleLock lock(m_ownerSection);
+  if (m_owner)
+    m_owner->OnJobComplete(jobID, success, job);
+  CJobQueue::OnJobComplete(jobID, success, job);
+}
+
 CJobManager &CJobManager::GetInstance()
 {
   static CJobManager sJobManager;
@@ -150,6 +150,38 @@ private:
   bool m_lifo;
 };
 
+/*!
+ \ingroup jobs
+ \brief Job queue that hands the completed jobs on to the object owning it
+
+ CJobManager calls back outside of its lock, so a job that was already running when it got
+ cancelled may still complete into its queue after CancelJobs() has returned. The queue therefore
+ has to live as long as its owner: cancel the jobs when the results are no longer wanted and
+ have the owner drop results it didn't ask for, but only delete the queue with the owner. The
+ destructor cancels any jobs and waits for a callback that is in progress.
+
+ \sa CJobQueue
+ */
+class COwnedJobQueue : public CJobQueue
+{
+public:
+  /*!
+   \brief COwnedJobQueue constructor
+   \param owner callback for completed jobs, called before the job is deleted.
+   \param lifo whether the queue should be processed last in first out or first in first out.
+   \param jobsAtOnce number of jobs at once to process.
+   \param priority priority of this queue.
+   */
+  COwnedJobQueue(IJobCallback *owner, bool lifo = false, unsigned int jobsAtOnce = 1, CJob::PRIORITY priority = CJob::PRIORITY_LOW);
+  virtual ~COwnedJobQueue();
+
+  virtual void OnJobComplete(unsigned int jobID, bool success, CJob *job);
+
+private:
+  CCriticalSection m_ownerSection; ///< held while calling back m_owner
+  IJobCallback    *m_owner;
+};
+
 /*!
  \ingroup jobs
  \brief Job Manager class for scheduling asynchronous jobs.
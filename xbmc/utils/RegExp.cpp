@@ -27,9 +27,22 @@
 
 using namespace PCRE;
 
+static void FreeCode(pcre *re)
+{
+  pcre_free(re);
+}
+
+static void FreeStudy(pcre_extra *sd)
+{
+#ifdef PCRE_STUDY_JIT_COMPILE
+  pcre_free_study(sd);
+#else
+  pcre_free(sd);
+#endif
+}
+
 CRegExp::CRegExp(bool caseless)
 {
-  m_re          = NULL;
   m_iOptions    = PCRE_DOTALL;
   if(caseless)
     m_iOptions |= PCRE_CASELESS;
@@ -40,30 +53,28 @@ CRegExp::CRegExp(bool caseless)
 
 CRegExp::CRegExp(const CRegExp& re)
 {
-  m_re = NULL;
   m_iOptions = re.m_iOptions;
+  m_bMatched    = false;
+  m_iMatchCount = 0;
   *this = re;
 }
 
 const CRegExp& CRegExp::operator=(const CRegExp& re)
 {
-  size_t size;
+  if (this == &re)
+    return *this;
+
   Cleanup();
   m_pattern = re.m_pattern;
   if (re.m_re)
   {
-    if (pcre_fullinfo(re.m_re, NULL, PCRE_INFO_SIZE, &size) >= 0)
-    {
-      if ((m_re = (pcre*)malloc(size)))
-      {
-        memcpy(m_re, re.m_re, size);
-        memcpy(m_iOvector, re.m_iOvector, OVECCOUNT*sizeof(int));
-        m_iMatchCount = re.m_iMatchCount;
-        m_bMatched = re.m_bMatched;
-        m_subject = re.m_subject;
-        m_iOptions = re.m_iOptions;
-      }
-    }
+    m_re = re.m_re;
+    m_sd = re.m_sd;
+    memcpy(m_iOvector, re.m_iOvector, OVECCOUNT*sizeof(int));
+    m_iMatchCount = re.m_iMatchCount;
+    m_bMatched = re.m_bMatched;
+    m_subject = re.m_subject;
+    m_iOptions = re.m_iOptions;
   }
   return *this;
 }
@@ -73,7 +84,7 @@ CRegExp::~CRegExp()
   Cleanup();
 }
 
-CRegExp* CRegExp::RegComp(const char *re)
+CRegExp* CRegExp::RegComp(const char *re, bool study)
 {
   if (!re)
     return NULL;
@@ -85,14 +96,29 @@ CRegExp* CRegExp::RegComp(const char *re)
 
   Cleanup();
 
-  m_re = pcre_compile(re, m_iOptions, &errMsg, &errOffset, NULL);
-  if (!m_re)
+  pcre *code = pcre_compile(re, m_iOptions, &errMsg, &errOffset, NULL);
+  if (!code)
   {
     m_pattern.clear();
     CLog::Log(LOGERROR, "PCRE: %s. Compilation failed at offset %d in expression '%s'",
               errMsg, errOffset, re);
     return NULL;
   }
+  m_re.reset(code, FreeCode);
+
+  if (study)
+  {
+#ifdef PCRE_STUDY_JIT_COMPILE
+    pcre_extra *sd = pcre_study(code, PCRE_STUDY_JIT_COMPILE, &errMsg);
+#else
+    pcre_extra *sd = pcre_study(code, 0, &errMsg);
+#endif
+    // no study data just means there is nothing to speed up
+    if (sd)
+      m_sd.reset(sd, FreeStudy);
+    else if (errMsg)
+      CLog::Log(LOGWARNING, "PCRE: %s. Study failed for expression '%s'", errMsg, re);
+  }
 
   m_pattern = re;
 
@@ -117,7 +143,12 @@ int CRegExp::RegFind(const char* str, int startoffset)
   }
 
   m_subject = str;
-  int rc = pcre_exec(m_re, NULL, str, strlen(str), startoffset, 0, m_iOvector, OVECCOUNT);
+  int rc = pcre_exec(m_re.get(), m_sd.get(), str, strlen(str), startoffset, 0, m_iOvector, OVECCOUNT);
+#ifdef PCRE_ERROR_JITSTACKLIMIT
+  // the JIT runs on a small stack of its own, the interpreter can still cope
+  if (rc == PCRE_ERROR_JITSTACKLIMIT)
+    rc = pcre_exec(m_re.get(), NULL, str, strlen(str), startoffset, 0, m_iOvector, OVECCOUNT);
+#endif
 
   if (rc<1)
   {
@@ -144,7 +175,7 @@ int CRegExp::GetCaptureTotal()
 {
   int c = -1;
   if (m_re)
-    pcre_fullinfo(m_re, NULL, PCRE_INFO_CAPTURECOUNT, &c);
+    pcre_fullinfo(m_re.get(), NULL, PCRE_INFO_CAPTURECOUNT, &c);
   return c;
 }
 
@@ -239,7 +270,7 @@ std::string CRegExp::GetMatch(int iSub /* = 0 */)
 bool CRegExp::GetNamedSubPattern(const char* strName, std::string& strMatch)
 {
   strMatch.clear();
-  int iSub = pcre_get_stringnumber(m_re, strName);
+  int iSub = pcre_get_stringnumber(m_re.get(), strName);
   if (iSub < 0)
     return false;
   strMatch = GetMatch(iSub);
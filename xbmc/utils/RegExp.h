@@ -25,6 +25,7 @@
 
 #include <string>
 #include <vector>
+#include <boost/shared_ptr.hpp>
 
 namespace PCRE {
 #ifdef _WIN32
@@ -46,8 +47,16 @@ public:
   CRegExp(const CRegExp& re);
   ~CRegExp();
 
-  CRegExp* RegComp(const char *re);
-  CRegExp* RegComp(const std::string& re) { return RegComp(re.c_str()); }
+  /*! \brief Compile a pattern
+   Copies of a CRegExp share the compiled pattern, which is never modified, so a compiled
+   CRegExp can be copied into each thread that matches against it.
+   \param re the pattern
+   \param study whether to also study the pattern (and JIT compile it where PCRE supports it),
+   which is only worth it for patterns that are matched many times
+   \return this, or NULL if the pattern doesn't compile
+   */
+  CRegExp* RegComp(const char *re, bool study = false);
+  CRegExp* RegComp(const std::string& re, bool study = false) { return RegComp(re.c_str(), study); }
   int RegFind(const char *str, int startoffset = 0);
   int RegFind(const std::string& str, int startoffset = 0) { return RegFind(str.c_str(), startoffset); }
   char* GetReplaceString( const char* sReplaceExp );
@@ -69,10 +78,11 @@ public:
   const CRegExp& operator= (const CRegExp& re);
 
 private:
-  void Cleanup() { if (m_re) { PCRE::pcre_free(m_re); m_re = NULL; } }
+  void Cleanup() { m_re.reset(); m_sd.reset(); }
 
 private:
-  PCRE::pcre* m_re;
+  boost::shared_ptr<PCRE::pcre>       m_re;
+  boost::shared_ptr<PCRE::pcre_extra> m_sd; ///< study data, if the pattern was studied
   int         m_iOvector[OVECCOUNT];
   int         m_iMatchCount;
   int         m_iOptions;
@@ -29,7 +29,11 @@
 #include "Util.h"
 #include "log.h"
 #include "CharsetConverter.h"
+#include "filesystem/File.h"
+#include "threads/CriticalSection.h"
+#include "threads/SingleLock.h"
 
+#include <map>
 #include <sstream>
 #include <cstring>
 
@@ -37,6 +41,281 @@ using namespace std;
 using namespace ADDON;
 using namespace XFILE;
 
+static void ReplaceNewLines(CStdString& strDest)
+{
+  int iIndex = 0;
+  while ((size_t)(iIndex = strDest.find("\\n",iIndex)) != CStdString::npos)
+    strDest.replace(strDest.begin()+iIndex,strDest.begin()+iIndex+2,"\n");
+}
+
+static void GetBufferParams(bool* result, const char* attribute, bool defvalue)
+{
+  for (int iBuf=0;iBuf<MAX_SCRAPER_BUFFERS;++iBuf)
+    result[iBuf] = defvalue;;
+  if (attribute)
+  {
+    vector<CStdString> vecBufs;
+    CUtil::Tokenize(attribute,vecBufs,",");
+    for (size_t nToken=0; nToken < vecBufs.size(); nToken++)
+    {
+      int index = atoi(vecBufs[nToken].c_str())-1;
+      if (index < MAX_SCRAPER_BUFFERS)
+        result[index] = !defvalue;
+    }
+  }
+}
+
+static void InsertToken(CStdString& strOutput, int buf, const char* token)
+{
+  char temp[4];
+  sprintf(temp,"\\%i",buf);
+  int i2=0;
+  while ((i2 = strOutput.Find(temp,i2)) != -1)
+  {
+    strOutput.Insert(i2,token);
+    i2 += strlen(token);
+    strOutput.Insert(i2+strlen(temp),token);
+    i2 += strlen(temp);
+  }
+}
+
+/*! \brief A <RegExp> element of a scraper function (or a <clear> element within one)
+ Everything that doesn't depend on the buffers or the scraper settings is worked out once
+ when the scraper is compiled, including the pattern itself where it is fixed.
+ */
+class CScraperRegExp
+{
+public:
+  CScraperRegExp()
+  : m_dest(1), m_append(false), m_hasInput(false), m_hasConditional(false), m_inverse(false), m_hasExpression(false),
+    m_dynamicOutput(false), m_dynamicExpression(false), m_compiled(false), m_caseless(true),
+    m_repeat(false), m_clear(false), m_optional(-1), m_compare(-1)
+  {
+    memset(m_clean, 0, sizeof(m_clean));
+    memset(m_trim, 0, sizeof(m_trim));
+    memset(m_fixChars, 0, sizeof(m_fixChars));
+    memset(m_encode, 0, sizeof(m_encode));
+  }
+
+  void Compile(const TiXmlElement* element)
+  {
+    const TiXmlElement* pChildReg = element->FirstChildElement("RegExp");
+    if (!pChildReg)
+      pChildReg = element->FirstChildElement("clear");
+    CompileList(pChildReg, m_children);
+
+    const char* szDest = element->Attribute("dest");
+    if (szDest && strlen(szDest))
+    {
+      if (szDest[strlen(szDest)-1] == '+')
+        m_append = true;
+      m_dest = atoi(szDest);
+    }
+
+    const char* szInput = element->Attribute("input");
+    if (szInput)
+    {
+      m_hasInput = true;
+      m_input = szInput;
+    }
+
+    const char* szConditional = element->Attribute("conditional");
+    if (szConditional)
+    {
+      m_hasConditional = true;
+      if (szConditional[0] == '!')
+      {
+        m_inverse = true;
+        szConditional++;
+      }
+      m_conditional = szConditional;
+    }
+
+    const TiXmlElement* pExpression = element->FirstChildElement("expression");
+    if (!pExpression)
+      return;
+    m_hasExpression = true;
+
+    const char* sensitive = pExpression->Attribute("cs");
+    if (sensitive && stricmp(sensitive,"yes") == 0)
+      m_caseless = false; // match case sensitive
+
+    const char* szRepeat = pExpression->Attribute("repeat");
+    m_repeat = szRepeat && stricmp(szRepeat,"yes") == 0;
+    const char* szClear = pExpression->Attribute("clear");
+    m_clear = szClear && stricmp(szClear,"yes") == 0;
+
+    GetBufferParams(m_clean,pExpression->Attribute("noclean"),true);
+    GetBufferParams(m_trim,pExpression->Attribute("trim"),false);
+    GetBufferParams(m_fixChars,pExpression->Attribute("fixchars"),false);
+    GetBufferParams(m_encode,pExpression->Attribute("encode"),false);
+
+    pExpression->QueryIntAttribute("optional",&m_optional);
+    pExpression->QueryIntAttribute("compare",&m_compare);
+
+    if (pExpression->FirstChild())
+      m_expression = pExpression->FirstChild()->Value();
+    else
+      m_expression = "(.*)";
+    m_output = element->Attribute("output");
+
+    // anything without buffers, settings or localized strings in it can be done right away
+    m_dynamicExpression = m_expression.Find('$') >= 0;
+    if (!m_dynamicExpression)
+    {
+      ReplaceNewLines(m_expression);
+      CRegExp reg(m_caseless);
+      m_compiled = reg.RegComp(m_expression.c_str(), true) != NULL;
+      if (m_compiled)
+        m_regExp = reg;
+    }
+
+    m_dynamicOutput = m_output.Find('$') >= 0;
+    if (!m_dynamicOutput)
+    {
+      ReplaceNewLines(m_output);
+      InsertTokens(m_output);
+    }
+  }
+
+  void InsertTokens(CStdString& strOutput) const
+  {
+    for (int iBuf=0;iBuf<MAX_SCRAPER_BUFFERS;++iBuf)
+    {
+      if (m_clean[iBuf])
+        InsertToken(strOutput,iBuf+1,"!!!CLEAN!!!");
+      if (m_trim[iBuf])
+        InsertToken(strOutput,iBuf+1,"!!!TRIM!!!");
+      if (m_fixChars[iBuf])
+        InsertToken(strOutput,iBuf+1,"!!!FIXCHARS!!!");
+      if (m_encode[iBuf])
+        InsertToken(strOutput,iBuf+1,"!!!ENCODE!!!");
+    }
+  }
+
+  static void CompileList(const TiXmlElement* element, vector<CScraperRegExp>& regExps)
+  {
+    for (; element; element = element->NextSiblingElement("RegExp"))
+    {
+      regExps.push_back(CScraperRegExp());
+      regExps.back().Compile(element);
+    }
+  }
+
+  vector<CScraperRegExp> m_children; ///< run before this one
+
+  int        m_dest;
+  bool       m_append;
+  bool       m_hasInput;
+  CStdString m_input;
+  bool       m_hasConditional;
+  CStdString m_conditional;   ///< setting that must be "true" for this to run
+  bool       m_inverse;       ///< or must not be "true"
+
+  bool       m_hasExpression;
+  CStdString m_output;
+  bool       m_dynamicOutput;     ///< m_output still needs the buffers replaced and tokens inserted
+  CStdString m_expression;
+  bool       m_dynamicExpression; ///< m_expression still needs the buffers replaced and compiling
+  bool       m_compiled;
+  CRegExp    m_regExp;
+  bool       m_caseless;
+  bool       m_repeat;
+  bool       m_clear;
+  bool       m_clean[MAX_SCRAPER_BUFFERS];
+  bool       m_trim[MAX_SCRAPER_BUFFERS];
+  bool       m_fixChars[MAX_SCRAPER_BUFFERS];
+  bool       m_encode[MAX_SCRAPER_BUFFERS];
+  int        m_optional;
+  int        m_compare;
+};
+
+/*! \brief A scraper document compiled into its functions
+ Programs are never modified once compiled, and are shared by every parser that loads the
+ same scraper and libraries, on any thread.
+ */
+class CScraperProgram
+{
+public:
+  class CFunction
+  {
+  public:
+    int                    m_dest;
+    bool                   m_clearBuffers;
+    vector<CScraperRegExp> m_regExps;
+  };
+
+  CScraperProgram(const TiXmlElement* root)
+  {
+    for (const TiXmlElement* function = root->FirstChildElement(); function; function = function->NextSiblingElement())
+    {
+      // the first function of a name wins, as libraries are added after the scraper's own
+      if (m_functions.find(function->Value()) != m_functions.end())
+        continue;
+
+      CFunction &compiled = m_functions[function->Value()];
+      compiled.m_dest = 1; // default to param 1
+      function->QueryIntAttribute("dest",&compiled.m_dest);
+      const char* szClearBuffers = function->Attribute("clearbuffers");
+      compiled.m_clearBuffers = !szClearBuffers || stricmp(szClearBuffers,"no") != 0;
+      CScraperRegExp::CompileList(function->FirstChildElement("RegExp"), compiled.m_regExps);
+    }
+
+    m_optional.RegComp("(.*)(\\\\\\(.*\\\\2.*)\\\\\\)(.*)", true);
+    m_unicode.RegComp("\\\\u([0-f]{4})", true);
+    m_hex.RegComp("\\\\x([0-9]{2})([^\\\\]+;)", true);
+  }
+
+  const CFunction* GetFunction(const CStdString& name) const
+  {
+    map<string, CFunction>::const_iterator it = m_functions.find(name);
+    return it != m_functions.end() ? &it->second : NULL;
+  }
+
+  /*! \brief Get the compiled program for a scraper document
+   \param files the scraper and library files the document was loaded from
+   \param root root element of the document
+   \return the program, compiled by an earlier call if the files haven't changed since
+   */
+  static boost::shared_ptr<const CScraperProgram> Get(const vector<string>& files, const TiXmlElement* root)
+  {
+    // programs are kept per set of files, and replaced when any of them changes
+    string key, stamp;
+    for (vector<string>::const_iterator it = files.begin(); it != files.end(); ++it)
+    {
+      struct __stat64 buffer;
+      memset(&buffer, 0, sizeof(buffer));
+      CFile::Stat(*it, &buffer);
+      CStdString file;
+      file.Format("%"PRId64"|%"PRId64"|", (int64_t)buffer.st_mtime, (int64_t)buffer.st_size);
+      key += *it + "|";
+      stamp += file;
+    }
+
+    CSingleLock lock(m_programsSection);
+    pair<string, boost::shared_ptr<const CScraperProgram> > &program = m_programs[key];
+    if (!program.second || program.first != stamp)
+    {
+      program.first = stamp;
+      program.second.reset(new CScraperProgram(root));
+    }
+    return program.second;
+  }
+
+  CRegExp m_optional; ///< finds optional parts of an output
+  CRegExp m_unicode;  ///< finds \\u escapes of JSON strings
+  CRegExp m_hex;      ///< finds \\x escapes of JSON strings
+
+private:
+  map<string, CFunction> m_functions;
+
+  static CCriticalSection m_programsSection;
+  static map<string, pair<string, boost::shared_ptr<const CScraperProgram> > > m_programs; ///< (file stamps, program) by files
+};
+
+CCriticalSection CScraperProgram::m_programsSection;
+map<string, pair<string, boost::shared_ptr<const CScraperProgram> > > CScraperProgram::m_programs;
+
 CScraperParser::CScraperParser()
 {
   m_pRootElement = NULL;
@@ -60,6 +339,8 @@ CScraperParser &CScraperParser::operator=(const CScraperParser &parser)
     {
       m_scraper = parser.m_scraper;
       m_document = new CXBMCTinyXML(*parser.m_document);
+      m_files = parser.m_files;
+      m_program = parser.m_program;
       LoadFromXML();
     }
   }
@@ -78,6 +359,8 @@ void CScraperParser::Clear()
 
   m_document = NULL;
   m_strFile.Empty();
+  m_files.clear();
+  m_program.reset();
 }
 
 bool CScraperParser::Load(const CStdString& strXMLFile)
@@ -90,6 +373,7 @@ bool CScraperParser::Load(const CStdString& strXMLFile)
     return false;
 
   m_strFile = strXMLFile;
+  m_files.push_back(strXMLFile);
 
   if (m_document->LoadFile())
     return LoadFromXML();
@@ -176,80 +460,40 @@ void CScraperParser::ReplaceBuffers(CStdString& strDest)
     strDest.replace(strDest.begin()+iIndex,strDest.begin()+iEnd+1,strReplace);
     iIndex += strReplace.length();
   }
-  iIndex = 0;
-  while ((size_t)(iIndex = strDest.find("\\n",iIndex)) != CStdString::npos)
-    strDest.replace(strDest.begin()+iIndex,strDest.begin()+iIndex+2,"\n");
+  ReplaceNewLines(strDest);
 }
 
-void CScraperParser::ParseExpression(const CStdString& input, CStdString& dest, TiXmlElement* element, bool bAppend)
+void CScraperParser::ParseExpression(const CStdString& input, CStdString& dest, const CScraperRegExp& regExp, bool bAppend)
 {
-  CStdString strOutput = element->Attribute("output");
-
-  TiXmlElement* pExpression = element->FirstChildElement("expression");
-  if (pExpression)
+  if (regExp.m_hasExpression)
   {
-    bool bInsensitive=true;
-    const char* sensitive = pExpression->Attribute("cs");
-    if (sensitive)
-      if (stricmp(sensitive,"yes") == 0)
-        bInsensitive=false; // match case sensitive
-
-    CRegExp reg(bInsensitive);
-    CStdString strExpression;
-    if (pExpression->FirstChild())
-      strExpression = pExpression->FirstChild()->Value();
-    else
-      strExpression = "(.*)";
-    ReplaceBuffers(strExpression);
-    ReplaceBuffers(strOutput);
-
-    if (!reg.RegComp(strExpression.c_str()))
+    CRegExp reg(regExp.m_caseless);
+    if (regExp.m_dynamicExpression)
     {
-      return;
+      CStdString strExpression = regExp.m_expression;
+      ReplaceBuffers(strExpression);
+      if (!reg.RegComp(strExpression.c_str()))
+        return;
     }
+    else if (regExp.m_compiled)
+      reg = regExp.m_regExp;
+    else
+      return;
 
-    bool bRepeat = false;
-    const char* szRepeat = pExpression->Attribute("repeat");
-    if (szRepeat)
-      if (stricmp(szRepeat,"yes") == 0)
-        bRepeat = true;
-
-    const char* szClear = pExpression->Attribute("clear");
-    if (szClear)
-      if (stricmp(szClear,"yes") == 0)
-        dest=""; // clear no matter if regexp fails
-
-    bool bClean[MAX_SCRAPER_BUFFERS];
-    GetBufferParams(bClean,pExpression->Attribute("noclean"),true);
-
-    bool bTrim[MAX_SCRAPER_BUFFERS];
-    GetBufferParams(bTrim,pExpression->Attribute("trim"),false);
-
-    bool bFixChars[MAX_SCRAPER_BUFFERS];
-    GetBufferParams(bFixChars,pExpression->Attribute("fixchars"),false);
-
-    bool bEncode[MAX_SCRAPER_BUFFERS];
-    GetBufferParams(bEncode,pExpression->Attribute("encode"),false);
+    CStdString strOutput = regExp.m_output;
+    if (regExp.m_dynamicOutput)
+      ReplaceBuffers(strOutput);
 
-    int iOptional = -1;
-    pExpression->QueryIntAttribute("optional",&iOptional);
+    if (regExp.m_clear)
+      dest=""; // clear no matter if regexp fails
 
-    int iCompare = -1;
-    pExpression->QueryIntAttribute("compare",&iCompare);
+    int iOptional = regExp.m_optional;
+    int iCompare = regExp.m_compare;
     if (iCompare > -1)
       m_param[iCompare-1].ToLower();
     CStdString curInput = input;
-    for (int iBuf=0;iBuf<MAX_SCRAPER_BUFFERS;++iBuf)
-    {
-      if (bClean[iBuf])
-        InsertToken(strOutput,iBuf+1,"!!!CLEAN!!!");
-      if (bTrim[iBuf])
-        InsertToken(strOutput,iBuf+1,"!!!TRIM!!!");
-      if (bFixChars[iBuf])
-        InsertToken(strOutput,iBuf+1,"!!!FIXCHARS!!!");
-      if (bEncode[iBuf])
-        InsertToken(strOutput,iBuf+1,"!!!ENCODE!!!");
-    }
+    if (regExp.m_dynamicOutput)
+      regExp.InsertTokens(strOutput);
     int i = reg.RegFind(curInput.c_str());
     while (i > -1 && (i < (int)curInput.size() || curInput.size() == 0))
     {
@@ -265,8 +509,7 @@ void CScraperParser::ParseExpression(const CStdString& input, CStdString& dest,
         char temp[4];
         sprintf(temp,"\\%i",iOptional);
         char* szParam = reg.GetReplaceString(temp);
-        CRegExp reg2;
-        reg2.RegComp("(.*)(\\\\\\(.*\\\\2.*)\\\\\\)(.*)");
+        CRegExp reg2(m_program->m_optional);
         int i2=reg2.RegFind(strCurOutput.c_str());
         while (i2 > -1)
         {
@@ -310,7 +553,7 @@ void CScraperParser::ParseExpression(const CStdString& input, CStdString& dest,
 
         free(result);
       }
-      if (bRepeat && iLen > 0)
+      if (regExp.m_repeat && iLen > 0)
       {
         curInput.erase(0,i+iLen>(int)curInput.size()?curInput.size():i+iLen);
         i = reg.RegFind(curInput.c_str());
@@ -321,90 +564,60 @@ void CScraperParser::ParseExpression(const CStdString& input, CStdString& dest,
   }
 }
 
-void CScraperParser::ParseNext(TiXmlElement* element)
+void CScraperParser::ParseNext(const vector<CScraperRegExp>& regExps)
 {
-  TiXmlElement* pReg = element;
-  while (pReg)
+  for (vector<CScraperRegExp>::const_iterator pReg = regExps.begin(); pReg != regExps.end(); ++pReg)
   {
-    TiXmlElement* pChildReg = pReg->FirstChildElement("RegExp");
-    if (pChildReg)
-      ParseNext(pChildReg);
-    else
+    ParseNext(pReg->m_children);
+
+    int iDest = pReg->m_dest;
+    CStdString strInput;
+    if (pReg->m_hasInput)
     {
-      TiXmlElement* pChildReg = pReg->FirstChildElement("clear");
-      if (pChildReg)
-        ParseNext(pChildReg);
+      strInput = pReg->m_input;
+      ReplaceBuffers(strInput);
     }
+    else
+      strInput = m_param[0];
 
-    int iDest = 1;
-    bool bAppend = false;
-    const char* szDest = pReg->Attribute("dest");
-    if (szDest)
-      if (strlen(szDest))
-      {
-        if (szDest[strlen(szDest)-1] == '+')
-          bAppend = true;
-
-        iDest = atoi(szDest);
-      }
+    bool bExecute = true;
+    if (pReg->m_hasConditional)
+    {
+      CStdString strSetting;
+      if (m_scraper && m_scraper->HasSettings())
+         strSetting = m_scraper->GetSetting(pReg->m_conditional);
+      bExecute = pReg->m_inverse != strSetting.Equals("true");
+    }
 
-      const char *szInput = pReg->Attribute("input");
-      CStdString strInput;
-      if (szInput)
-      {
-        strInput = szInput;
-        ReplaceBuffers(strInput);
-      }
+    if (bExecute)
+    {
+      if (iDest-1 < MAX_SCRAPER_BUFFERS && iDest-1 > -1)
+        ParseExpression(strInput, m_param[iDest-1],*pReg,pReg->m_append);
       else
-        strInput = m_param[0];
-
-      const char* szConditional = pReg->Attribute("conditional");
-      bool bExecute = true;
-      if (szConditional)
-      {
-        bool bInverse=false;
-        if (szConditional[0] == '!')
-        {
-          bInverse = true;
-          szConditional++;
-        }
-        CStdString strSetting;
-        if (m_scraper && m_scraper->HasSettings())
-           strSetting = m_scraper->GetSetting(szConditional);
-        bExecute = bInverse != strSetting.Equals("true");
-      }
-
-      if (bExecute)
-      {
-        if (iDest-1 < MAX_SCRAPER_BUFFERS && iDest-1 > -1)
-          ParseExpression(strInput, m_param[iDest-1],pReg,bAppend);
-        else
-          CLog::Log(LOGERROR,"CScraperParser::ParseNext: destination buffer "
-                             "out of bounds, skipping expression");
-      }
-
-      pReg = pReg->NextSiblingElement("RegExp");
+        CLog::Log(LOGERROR,"CScraperParser::ParseNext: destination buffer "
+                           "out of bounds, skipping expression");
+    }
   }
 }
 
 const CStdString CScraperParser::Parse(const CStdString& strTag,
                                        CScraper* scraper)
 {
-  TiXmlElement* pChildElement = m_pRootElement->FirstChildElement(strTag.c_str());
-  if(pChildElement == NULL)
+  if (!m_program)
+    m_program = CScraperProgram::Get(m_files, m_pRootElement);
+
+  const CScraperProgram::CFunction* function = m_program->GetFunction(strTag);
+  if(function == NULL)
   {
     CLog::Log(LOGERROR,"%s: Could not find scraper function %s",__FUNCTION__,strTag.c_str());
     return "";
   }
-  int iResult = 1; // default to param 1
-  pChildElement->QueryIntAttribute("dest",&iResult);
-  TiXmlElement* pChildStart = pChildElement->FirstChildElement("RegExp");
+  int iResult = function->m_dest;
   m_scraper = scraper;
-  ParseNext(pChildStart);
+  ParseNext(function->m_regExps);
   CStdString tmp = m_param[iResult-1];
 
-  const char* szClearBuffers = pChildElement->Attribute("clearbuffers");
-  if (!szClearBuffers || stricmp(szClearBuffers,"no") != 0)
+  if (function->m_clearBuffers)
     ClearBuffers();
 
   return tmp;
@@ -491,8 +704,7 @@ void CScraperParser::RemoveWhiteSpace(CStdString &string)
 
 void CScraperParser::ConvertJSON(CStdString &string)
 {
-  CRegExp reg;
-  reg.RegComp("\\\\u([0-f]{4})");
+  CRegExp reg(m_program->m_unicode);
   while (reg.RegFind(string.c_str()) > -1)
   {
     int pos = reg.GetSubStart(1);
@@ -505,8 +717,7 @@ void CScraperParser::ConvertJSON(CStdString &string)
     free(szReplace);
   }
 
-  CRegExp reg2;
-  reg2.RegComp("\\\\x([0-9]{2})([^\\\\]+;)");
+  CRegExp reg2(m_program->m_hex);
   while (reg2.RegFind(string.c_str()) > -1)
   {
     int pos1 = reg2.GetSubStart(1);
@@ -530,39 +741,11 @@ void CScraperParser::ClearBuffers()
     m_param[i].clear();
 }
 
-void CScraperParser::GetBufferParams(bool* result, const char* attribute, bool defvalue)
-{
-  for (int iBuf=0;iBuf<MAX_SCRAPER_BUFFERS;++iBuf)
-    result[iBuf] = defvalue;;
-  if (attribute)
-  {
-    vector<CStdString> vecBufs;
-    CUtil::Tokenize(attribute,vecBufs,",");
-    for (size_t nToken=0; nToken < vecBufs.size(); nToken++)
-    {
-      int index = atoi(vecBufs[nToken].c_str())-1;
-      if (index < MAX_SCRAPER_BUFFERS)
-        result[index] = !defvalue;
-    }
-  }
-}
-
-void CScraperParser::InsertToken(CStdString& strOutput, int buf, const char* token)
-{
-  char temp[4];
-  sprintf(temp,"\\%i",buf);
-  int i2=0;
-  while ((i2 = strOutput.Find(temp,i2)) != -1)
-  {
-    strOutput.Insert(i2,token);
-    i2 += strlen(token);
-    strOutput.Insert(i2+strlen(temp),token);
-    i2 += strlen(temp);
-  }
-}
-
 void CScraperParser::AddDocument(const CXBMCTinyXML* doc)
 {
+  m_files.push_back(doc->Value());
+  m_program.reset();
+
   const TiXmlNode* node = doc->RootElement()->FirstChild();
   while (node)
   {
@@ -22,7 +22,9 @@
  *
  */
 
+#include <string>
 #include <vector>
+#include <boost/shared_ptr.hpp>
 #include "StdString.h"
 #include "addons/IAddon.h"
 
@@ -37,6 +39,8 @@ class TiXmlElement;
 class CXBMCTinyXML;
 
 class CScraperSettings;
+class CScraperProgram;
+class CScraperRegExp;
 
 class CScraperParser
 {
@@ -61,8 +65,8 @@ public:
 private:
   bool LoadFromXML();
   void ReplaceBuffers(CStdString& strDest);
-  void ParseExpression(const CStdString& input, CStdString& dest, TiXmlElement* element, bool bAppend);
-  void ParseNext(TiXmlElement* element);
+  void ParseExpression(const CStdString& input, CStdString& dest, const CScraperRegExp& regExp, bool bAppend);
+  void ParseNext(const std::vector<CScraperRegExp>& regExps);
   void Clean(CStdString& strDirty);
   /*! \brief Remove spaces, tabs, and newlines from a string
    \param string the string in question, which will be modified.
@@ -70,8 +74,6 @@ private:
   void RemoveWhiteSpace(CStdString &string);
   void ConvertJSON(CStdString &string);
   void ClearBuffers();
-  void GetBufferParams(bool* result, const char* attribute, bool defvalue);
-  void InsertToken(CStdString& strOutput, int buf, const char* token);
 
   CXBMCTinyXML* m_document;
   TiXmlElement* m_pRootElement;
@@ -80,6 +82,9 @@ private:
 
   CStdString m_strFile;
   ADDON::CScraper* m_scraper;
+
+  std::vector<std::string> m_files; ///< the scraper and any libraries added to the document
+  boost::shared_ptr<const CScraperProgram> m_program; ///< the document compiled, once it's needed
 };
 
 #endif
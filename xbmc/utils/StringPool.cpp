@@ -0,0 +1,60 @@
+/*
+ *      Copyright (C) 2005-2012 Team XBMC
+ *      http://www.xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, write to
+ *  the Free Software Foundation, 675 Mass Ave, Cambridge, MA 02139, USA.
+ *  http://www.gnu.org/copyleft/gpl.html
+ *
+ */
+
+#include "StringPool.h"
+#include "threads/CriticalSection.h"
+#include "threads/SingleLock.h"
+
+#include <set>
+
+using namespace std;
+
+#define MAX_POOLED_STRINGS 50000
+
+static CCriticalSection g_stringPoolSection;
+static set<string>      g_stringPool;
+
+string CStringPool::Intern(const string &value)
+{
+  if (value.empty())
+    return value;
+
+  CSingleLock lock(g_stringPoolSection);
+  set<string>::const_iterator it = g_stringPool.find(value);
+  if (it != g_stringPool.end())
+    return *it;
+
+  if (g_stringPool.size() >= MAX_POOLED_STRINGS)
+    g_stringPool.clear();
+  return *g_stringPool.insert(value).first;
+}
+
+void CStringPool::Intern(vector<string> &values)
+{
+  for (vector<string>::iterator it = values.begin(); it != values.end(); ++it)
+    *it = Intern(*it);
+}
+
+void CStringPool::Clear()
+{
+  CSingleLock lock(g_stringPoolSection);
+  g_stringPool.clear();
+}
@@ -0,0 +1,50 @@
+#pragma once
+/*
+ *      Copyright (C) 2005-2012 Team XBMC
+ *      http://www.xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, write to
+ *  the Free Software Foundation, 675 Mass Ave, Cambridge, MA 02139, USA.
+ *  http://www.gnu.org/copyleft/gpl.html
+ *
+ */
+
+#include <string>
+#include <vector>
+
+/*!
+ \brief Pool of strings that repeat across many items of a listing.
+
+ Library listings carry the same genres, studios and directory paths thousands of
+ times over. Assigning the pooled copy instead of the freshly read value lets all
+ items share a single buffer with the reference counted strings of our toolchains.
+ The pool is bounded - once it grows past its limit it is emptied, which only costs
+ sharing for values read afterwards.
+ */
+class CStringPool
+{
+public:
+  /*! \brief Get the pooled copy of a string
+   \param value the string to look up
+   \return a copy of the pooled string equal to value
+   */
+  static std::string Intern(const std::string &value);
+
+  /*! \brief Replace each string in a vector with its pooled copy
+   \param values the strings to intern, modified in place
+   */
+  static void Intern(std::vector<std::string> &values);
+
+  static void Clear();
+};
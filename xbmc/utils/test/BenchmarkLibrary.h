@@ -0,0 +1,82 @@
+#pragma once
+/*
+ *      Copyright (C) 2005-2012 Team XBMC
+ *      http://www.xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, write to
+ *  the Free Software Foundation, 675 Mass Ave, Cambridge, MA 02139, USA.
+ *  http://www.gnu.org/copyleft/gpl.html
+ *
+ */
+
+/*
+ * Synthetic movie library shared by the benchmarks, filled the way the video
+ * database fills a listing.
+ */
+
+#include <malloc.h>
+
+#include "FileItem.h"
+#include "video/VideoInfoTag.h"
+#include "utils/StringPool.h"
+#include "utils/StringUtils.h"
+#include "utils/Variant.h"
+
+namespace BENCHMARK
+{
+  static const char *genres[] = { "Action", "Adventure", "Animation", "Comedy", "Crime", "Documentary",
+                                  "Drama", "Family", "Fantasy", "History", "Horror", "Music", "Mystery",
+                                  "Romance", "Science Fiction", "Thriller", "War", "Western" };
+  static const unsigned int NUM_GENRES  = sizeof(genres) / sizeof(genres[0]);
+  static const unsigned int NUM_STUDIOS = 200;
+  static const unsigned int NUM_DIRS    = 500;
+
+  inline size_t HeapInUse()
+  {
+    struct mallinfo info = mallinfo();
+    return info.uordblks + info.hblkhd;
+  }
+
+  inline void BuildLibrary(CFileItemList &items, int count)
+  {
+    for (int i = 0; i < count; i++)
+    {
+      CVideoInfoTag tag;
+      CStdString value;
+
+      tag.m_iDbId = i + 1;
+      tag.m_strTitle.Format("Synthetic movie %d", i);
+      tag.m_strPlot = "A synthetic movie that only exists to take up memory in a benchmark.";
+      tag.m_iYear = 1950 + i % 60;
+      tag.m_fRating = (float)(i % 100) / 10.0f;
+
+      value.Format("%s / %s", genres[i % NUM_GENRES], genres[(i / NUM_GENRES) % NUM_GENRES]);
+      tag.m_genre = StringUtils::Split(value, " / ");
+      value.Format("Studio %d", i % NUM_STUDIOS);
+      tag.m_studio = StringUtils::Split(value, " / ");
+      // mirror CVideoDatabase::GetDetailsFromDB, which interns these
+      CStringPool::Intern(tag.m_genre);
+      CStringPool::Intern(tag.m_studio);
+      value.Format("smb://server/movies/%03d/", i % NUM_DIRS);
+      tag.m_strPath = CStringPool::Intern(value);
+      tag.m_strFileNameAndPath.Format("%smovie-%d.mkv", tag.m_strPath.c_str(), i);
+
+      CFileItemPtr item(new CFileItem(tag));
+      item->SetProperty("IsPlayable", "true");
+      item->SetProperty("fanart_image", "special://masterprofile/Thumbnails/Video/Fanart/0000.tbn");
+      item->SetProperty("original_listitem_url", item->GetPath());
+      items.Add(item);
+    }
+  }
+}
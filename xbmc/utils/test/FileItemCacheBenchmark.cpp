@@ -0,0 +1,127 @@
+/*
+ *      Copyright (C) 2005-2012 Team XBMC
+ *      http://www.xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, write to
+ *  the Free Software Foundation, 675 Mass Ave, Cambridge, MA 02139, USA.
+ *  http://www.gnu.org/copyleft/gpl.html
+ *
+ */
+
+/*
+ * Round trips a synthetic movie listing through special://temp (set to /tmp),
+ * both as a plain CArchive stream and in the disc cache format of
+ * CFileItemList::Save/Load, and reports the time taken, the size on disc and
+ * the heap used by the loaded listing.
+ *
+ * usage: benchFileItemCache [items]   (built with "make benchFileItemCache" from the top level)
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "FileItem.h"
+#include "utils/test/BenchmarkLibrary.h"
+#include "filesystem/File.h"
+#include "filesystem/SpecialProtocol.h"
+#include "utils/Archive.h"
+#include "utils/Crc32.h"
+#include "threads/SystemClock.h"
+
+using namespace BENCHMARK;
+
+static void ReportRoundTrip(const char *name, const CStdString &file, int count,
+                            unsigned int saveStart, unsigned int saved, unsigned int loaded, size_t heap)
+{
+  struct __stat64 buffer;
+  memset(&buffer, 0, sizeof(buffer));
+  XFILE::CFile::Stat(file, &buffer);
+  XFILE::CFile::Delete(file);
+
+  printf("  %-7s  save %6u ms, load %6u ms, %8.1f kB on disc, %8.1f kB loaded (%5.0f bytes/item)\n", name,
+         saved - saveStart, loaded - saved, buffer.st_size / 1024.0, heap / 1024.0, (double)heap / count);
+}
+
+static void RoundTripStream(CFileItemList &items, int count)
+{
+  CStdString path = "special://temp/benchFileItemCache.arc";
+
+  unsigned int start = XbmcThreads::SystemClockMillis();
+  XFILE::CFile file;
+  if (file.OpenForWrite(path, true))
+  {
+    CArchive ar(&file, CArchive::store);
+    ar << items;
+    ar.Close();
+    file.Close();
+  }
+  unsigned int saved = XbmcThreads::SystemClockMillis();
+
+  size_t heapStart = HeapInUse();
+  CFileItemList *loaded = new CFileItemList;
+  if (file.Open(path))
+  {
+    CArchive ar(&file, CArchive::load);
+    ar >> *loaded;
+    ar.Close();
+    file.Close();
+  }
+  unsigned int done = XbmcThreads::SystemClockMillis();
+  size_t heap = HeapInUse() - heapStart;
+  delete loaded;
+
+  ReportRoundTrip("archive", path, count, start, saved, done, heap);
+}
+
+static void RoundTripCache(CFileItemList &items, int count)
+{
+  // mirrors CFileItemList::GetDiscFileCache() for a plain folder
+  Crc32 crc;
+  crc.ComputeFromLowerCase("/benchFileItemCache");
+  CStdString path;
+  path.Format("special://temp/%08x.fi", (unsigned __int32)crc);
+  items.SetPath("/benchFileItemCache/");
+
+  unsigned int start = XbmcThreads::SystemClockMillis();
+  items.Save();
+  unsigned int saved = XbmcThreads::SystemClockMillis();
+
+  size_t heapStart = HeapInUse();
+  CFileItemList *loaded = new CFileItemList("/benchFileItemCache/");
+  if (!loaded->Load() || loaded->Size() != count)
+    printf("  cache failed to load\n");
+  unsigned int done = XbmcThreads::SystemClockMillis();
+  size_t heap = HeapInUse() - heapStart;
+  delete loaded;
+
+  ReportRoundTrip("cache", path, count, start, saved, done, heap);
+}
+
+int main(int argc, char *argv[])
+{
+  int count = argc > 1 ? atoi(argv[1]) : 50000;
+  if (count <= 0)
+    count = 50000;
+
+  CSpecialProtocol::SetTempPath("/tmp");
+  CFileItemList *items = new CFileItemList;
+  BuildLibrary(*items, count);
+
+  printf("%d items\n", count);
+  RoundTripStream(*items, count);
+  RoundTripCache(*items, count);
+  delete items;
+
+  return 0;
+}
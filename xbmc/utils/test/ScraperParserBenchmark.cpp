@@ -0,0 +1,108 @@
+/*
+ *      Copyright (C) 2005-2012 Team XBMC
+ *      http://www.xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, write to
+ *  the Free Software Foundation, 675 Mass Ave, Cambridge, MA 02139, USA.
+ *  http://www.gnu.org/copyleft/gpl.html
+ *
+ */
+
+/*
+ * Replays cached scraper pages (eg from special://temp/scrapers) through a
+ * scraper function, the way CScraper::InternalRun does, and reports the time
+ * taken by the first pass - which compiles the scraper - and by the passes
+ * after it.
+ *
+ * usage: benchScraperParser scraper.xml function passes page [page ...]
+ *        (built with "make benchScraperParser" from the top level)
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <vector>
+
+#include "utils/ScraperParser.h"
+#include "utils/StdString.h"
+#include "threads/SystemClock.h"
+
+static bool ReadPage(const char *path, CStdString &page)
+{
+  FILE *file = fopen(path, "rb");
+  if (!file)
+    return false;
+
+  char buffer[4096];
+  size_t read;
+  while ((read = fread(buffer, 1, sizeof(buffer), file)) > 0)
+    page.append(buffer, read);
+  fclose(file);
+  return true;
+}
+
+int main(int argc, char *argv[])
+{
+  if (argc < 5)
+  {
+    fprintf(stderr, "usage: %s scraper.xml function passes page [page ...]\n", argv[0]);
+    return 1;
+  }
+
+  int passes = atoi(argv[3]);
+  if (passes <= 0)
+    passes = 1;
+
+  std::vector<CStdString> pages;
+  for (int i = 4; i < argc; i++)
+  {
+    CStdString page;
+    if (!ReadPage(argv[i], page))
+    {
+      fprintf(stderr, "unable to read %s\n", argv[i]);
+      return 1;
+    }
+    pages.push_back(page);
+  }
+
+  CScraperParser parser;
+  if (!parser.Load(argv[1]))
+  {
+    fprintf(stderr, "unable to load %s\n", argv[1]);
+    return 1;
+  }
+
+  size_t output = 0;
+  unsigned int first = 0;
+  unsigned int start = XbmcThreads::SystemClockMillis();
+  for (int pass = 0; pass < passes; pass++)
+  {
+    for (unsigned int i = 0; i < pages.size(); i++)
+    {
+      parser.m_param[0] = pages[i];
+      output += parser.Parse(argv[2], NULL).size();
+    }
+    if (pass == 0)
+      first = XbmcThreads::SystemClockMillis() - start;
+  }
+  unsigned int total = XbmcThreads::SystemClockMillis() - start;
+
+  printf("%s on %u pages, %d passes, %u bytes of output\n", argv[2], (unsigned int)pages.size(), passes, (unsigned int)output);
+  printf("  first pass: %6u ms\n", first);
+  if (passes > 1)
+    printf("  later passes: %6.1f ms/pass, %6.2f ms/page\n", (double)(total - first) / (passes - 1),
+           (double)(total - first) / ((passes - 1) * pages.size()));
+
+  return 0;
+}
@@ -0,0 +1,202 @@
+/*
+ *      Copyright (C) 2005-2012 Team XBMC
+ *      http://www.xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, write to
+ *  the Free Software Foundation, 675 Mass Ave, Cambridge, MA 02139, USA.
+ *  http://www.gnu.org/copyleft/gpl.html
+ *
+ */
+
+#include "SeriesListingPrefetcher.h"
+#include "URL.h"
+#include "filesystem/Directory.h"
+#include "filesystem/File.h"
+#include "settings/AdvancedSettings.h"
+#include "settings/Settings.h"
+#include "threads/SingleLock.h"
+#include "utils/URIUtils.h"
+
+using namespace std;
+using namespace XFILE;
+
+namespace VIDEO
+{
+  class CSeriesListingJob : public CJob
+  {
+  public:
+    CSeriesListingJob(const CStdString &path, const FolderFingerprints &fingerprints)
+      : m_path(path), m_fingerprints(fingerprints), m_listing(NULL)
+    {
+    }
+
+    virtual ~CSeriesListingJob()
+    {
+      delete m_listing;
+    }
+
+    virtual const char *GetType() const { return "serieslisting"; };
+
+    virtual bool DoWork()
+    {
+      m_listing = new CSeriesListing;
+      CSeriesListingPrefetcher::Fetch(m_path, m_fingerprints, *m_listing);
+      return true;
+    }
+
+    CStdString         m_path;
+    FolderFingerprints m_fingerprints;
+    CSeriesListing    *m_listing;
+  };
+
+  static void GetRecursiveListing(const CStdString &path, CFileItemList &items, FolderFingerprints &fingerprints)
+  {
+    // folders inside archives change along with the archive itself
+    if (!URIUtils::IsInArchive(path))
+      fingerprints[path] = CSeriesListingPrefetcher::GetFingerprint(path);
+
+    CFileItemList folder;
+    CDirectory::GetDirectory(path, folder, g_settings.m_videoExtensions);
+    for (int i = 0; i < folder.Size(); i++)
+    {
+      if (folder[i]->m_bIsFolder)
+        GetRecursiveListing(folder[i]->GetPath(), items, fingerprints);
+      else
+        items.Add(folder[i]);
+    }
+  }
+
+  CSeriesListingPrefetcher::CHostQueue::CHostQueue(CSeriesListingPrefetcher *owner, unsigned int jobsAtOnce)
+    : CJobQueue(false, jobsAtOnce, CJob::PRIORITY_LOW), m_owner(owner)
+  {
+  }
+
+  void CSeriesListingPrefetcher::CHostQueue::OnJobComplete(unsigned int jobID, bool success, CJob *job)
+  {
+    CSeriesListingJob *listingJob = (CSeriesListingJob *)job;
+    m_owner->OnListing(listingJob->m_path, listingJob->m_listing);
+    listingJob->m_listing = NULL;
+    CJobQueue::OnJobComplete(jobID, success, job);
+  }
+
+  CSeriesListingPrefetcher::CSeriesListingPrefetcher()
+  {
+  }
+
+  CSeriesListingPrefetcher::~CSeriesListingPrefetcher()
+  {
+    Clear();
+  }
+
+  void CSeriesListingPrefetcher::Prefetch(const CStdString &path, const FolderFingerprints &fingerprints)
+  {
+    CSingleLock lock(m_section);
+    if (m_pending.find(path) != m_pending.end() || m_listings.find(path) != m_listings.end())
+      return;
+
+    string host = CURL(path).GetHostName();
+    map<string, CHostQueue*>::iterator queue = m_queues.find(host);
+    if (queue == m_queues.end())
+      queue = m_queues.insert(make_pair(host, new CHostQueue(this, g_advancedSettings.m_videoScannerListingsPerHost))).first;
+
+    m_pending.insert(path);
+    queue->second->AddJob(new CSeriesListingJob(path, fingerprints));
+  }
+
+  bool CSeriesListingPrefetcher::Get(const CStdString &path, CSeriesListing &listing)
+  {
+    CSingleLock lock(m_section);
+    while (true)
+    {
+      map<CStdString, CSeriesListing*>::iterator it = m_listings.find(path);
+      if (it != m_listings.end())
+      {
+        listing.m_unchanged = it->second->m_unchanged;
+        listing.m_items.Append(it->second->m_items);
+        listing.m_fingerprints.swap(it->second->m_fingerprints);
+        delete it->second;
+        m_listings.erase(it);
+        return true;
+      }
+      if (m_pending.find(path) == m_pending.end())
+        return false;
+
+      CSingleExit exit(m_section);
+      m_listingDone.WaitMSec(100);
+    }
+  }
+
+  void CSeriesListingPrefetcher::Clear()
+  {
+    map<string, CHostQueue*> queues;
+    {
+      CSingleLock lock(m_section);
+      queues.swap(m_queues);
+    }
+
+    // jobs already running when cancelled finish without calling back into OnListing()
+    for (map<string, CHostQueue*>::iterator it = queues.begin(); it != queues.end(); ++it)
+    {
+      it->second->CancelJobs();
+      delete it->second;
+    }
+
+    CSingleLock lock(m_section);
+    for (map<CStdString, CSeriesListing*>::iterator it = m_listings.begin(); it != m_listings.end(); ++it)
+      delete it->second;
+    m_listings.clear();
+    m_pending.clear();
+  }
+
+  void CSeriesListingPrefetcher::OnListing(const CStdString &path, CSeriesListing *listing)
+  {
+    CSingleLock lock(m_section);
+    if (m_pending.erase(path) && listing)
+      m_listings[path] = listing;
+    else
+      delete listing;
+    m_listingDone.Set();
+  }
+
+  void CSeriesListingPrefetcher::Fetch(const CStdString &path, const FolderFingerprints &fingerprints, CSeriesListing &listing)
+  {
+    listing.m_unchanged = !fingerprints.empty();
+    for (FolderFingerprints::const_iterator it = fingerprints.begin(); it != fingerprints.end() && listing.m_unchanged; ++it)
+      listing.m_unchanged = !it->second.empty() && GetFingerprint(it->first) == it->second;
+
+    if (listing.m_unchanged)
+      return;
+
+    GetRecursiveListing(path, listing.m_items, listing.m_fingerprints);
+  }
+
+  CStdString CSeriesListingPrefetcher::GetFingerprint(const CStdString &folder)
+  {
+    struct __stat64 buffer;
+    memset(&buffer, 0, sizeof(buffer));
+    if (CFile::Stat(folder, &buffer) == 0)
+    {
+      int64_t time = buffer.st_mtime;
+      if (!time)
+        time = buffer.st_ctime;
+      if (time)
+      {
+        CStdString fingerprint;
+        fingerprint.Format("%"PRId64"/%u", time, (unsigned int)buffer.st_nlink);
+        return fingerprint;
+      }
+    }
+    return "";
+  }
+}
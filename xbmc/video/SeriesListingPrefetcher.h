@@ -0,0 +1,110 @@
+#pragma once
+/*
+ *      Copyright (C) 2005-2012 Team XBMC
+ *      http://www.xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, write to
+ *  the Free Software Foundation, 675 Mass Ave, Cambridge, MA 02139, USA.
+ *  http://www.gnu.org/copyleft/gpl.html
+ *
+ */
+
+#include <map>
+#include <set>
+#include <string>
+
+#include "FileItem.h"
+#include "threads/CriticalSection.h"
+#include "threads/Event.h"
+#include "utils/JobManager.h"
+#include "utils/StdString.h"
+
+namespace VIDEO
+{
+  /*! \brief Stat fingerprints of the folders of a scanned path, keyed by folder */
+  typedef std::map<std::string, std::string> FolderFingerprints;
+
+  /*! \brief Recursive listing of a series folder, as used by CVideoInfoScanner::EnumerateSeriesFolder */
+  class CSeriesListing
+  {
+  public:
+    CSeriesListing() : m_unchanged(false) {};
+
+    bool               m_unchanged;    ///< the folders still match the stored fingerprints, so nothing was listed
+    CFileItemList      m_items;        ///< files in the series folder and all of its subfolders
+    FolderFingerprints m_fingerprints; ///< fingerprints of the series folder and all of its subfolders
+  };
+
+  /*! \brief Fetches the listings of series folders ahead of the scanner
+   Each series folder is first checked against the stat fingerprints of its folders from the
+   last scan, and only listed recursively if any of them changed. Listings run in the
+   background, with at most videoscanner.listingsperhost of them on the same host at once.
+   */
+  class CSeriesListingPrefetcher
+  {
+  public:
+    CSeriesListingPrefetcher();
+    ~CSeriesListingPrefetcher();
+
+    /*! \brief Queue fetching the listing of a series folder
+     Does nothing if the folder has already been queued.
+     \param path the series folder
+     \param fingerprints fingerprints stored for the folder by the last scan, may be empty
+     */
+    void Prefetch(const CStdString &path, const FolderFingerprints &fingerprints);
+
+    /*! \brief Take the listing of a series folder, waiting for it if it's still being fetched
+     \param path the series folder
+     \param listing [out] the listing
+     \return true if the folder was queued with Prefetch(), false otherwise
+     */
+    bool Get(const CStdString &path, CSeriesListing &listing);
+
+    /*! \brief Cancel any queued listings and drop the ones not taken */
+    void Clear();
+
+    /*! \brief Fetch the listing of a series folder on the calling thread
+     \param path the series folder
+     \param fingerprints fingerprints stored for the folder by the last scan, may be empty
+     \param listing [out] the listing
+     */
+    static void Fetch(const CStdString &path, const FolderFingerprints &fingerprints, CSeriesListing &listing);
+
+    /*! \brief Get the stat fingerprint of a folder
+     Made up of the modification (or creation) time and the link count of the folder, which
+     changes whenever one of its entries is added, removed or renamed.
+     \param folder the folder to stat
+     \return the fingerprint, or an empty string if the protocol doesn't provide a time
+     */
+    static CStdString GetFingerprint(const CStdString &folder);
+
+  private:
+    class CHostQueue : public CJobQueue
+    {
+    public:
+      CHostQueue(CSeriesListingPrefetcher *owner, unsigned int jobsAtOnce);
+      virtual void OnJobComplete(unsigned int jobID, bool success, CJob *job);
+    private:
+      CSeriesListingPrefetcher *m_owner;
+    };
+
+    void OnListing(const CStdString &path, CSeriesListing *listing);
+
+    CCriticalSection                       m_section;
+    CEvent                                 m_listingDone;
+    std::map<std::string, CHostQueue*>     m_queues;   ///< job queue per host
+    std::set<CStdString>                   m_pending;  ///< folders queued but not yet listed
+    std::map<CStdString, CSeriesListing*>  m_listings; ///< folders listed but not yet taken
+  };
+}
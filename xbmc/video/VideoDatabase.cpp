@@ -23,6 +23,8 @@
 #include "VideoDatabase.h"
 #include "video/windows/GUIWindowVideoBase.h"
 #include "utils/RegExp.h"
+#include "utils/StringPool.h"
+#include "utils/Variant.h"
 #include "addons/AddonManager.h"
 #include "GUIInfoManager.h"
 #include "Util.h"
@@ -319,6 +321,11 @@ bool CVideoDatabase::CreateTables()
     m_pDS->exec("CREATE TRIGGER delete_set AFTER DELETE ON sets FOR EACH ROW BEGIN DELETE FROM art WHERE media_id=old.idSet AND media_type='set'; END");
     m_pDS->exec("CREATE TRIGGER delete_person AFTER DELETE ON actors FOR EACH ROW BEGIN DELETE FROM art WHERE media_id=old.idActor AND media_type IN ('actor','artist','writer','director'); END");
 
+    CLog::Log(LOGINFO, "create pathfingerprint table");
+    m_pDS->exec("CREATE TABLE pathfingerprint (idPath integer, strFolder text, strFingerprint text)");
+    m_pDS->exec("CREATE INDEX ix_pathfingerprint ON pathfingerprint (idPath)");
+    m_pDS->exec("CREATE TRIGGER delete_path AFTER DELETE ON path FOR EACH ROW BEGIN DELETE FROM pathfingerprint WHERE idPath=old.idPath; END");
+
     CLog::Log(LOGINFO, "create tag table");
     m_pDS->exec("CREATE TABLE tag (idTag integer primary key, strTag text)");
     m_pDS->exec("CREATE UNIQUE INDEX ix_tag_1 ON tag (strTag(255))");
@@ -562,6 +569,23 @@ bool CVideoDatabase::GetPathsForTvShow(int idShow, set<int>& paths)
   return false;
 }
 
+int CVideoDatabase::GetFileCountForTvShow(int idShow)
+{
+  CStdString strSQL;
+  try
+  {
+    if (NULL == m_pDB.get()) return 0;
+    if (NULL == m_pDS.get()) return 0;
+    strSQL = PrepareSQL("SELECT COUNT(DISTINCT idFile) FROM episode WHERE idShow=%i", idShow);
+    return (int)strtol(GetSingleValue(strSQL, m_pDS).c_str(), NULL, 10);
+  }
+  catch (...)
+  {
+    CLog::Log(LOGERROR, "%s error during query: %s",__FUNCTION__, strSQL.c_str());
+  }
+  return 0;
+}
+
 int CVideoDatabase::RunQuery(const CStdString &sql)
 {
   unsigned int time = XbmcThreads::SystemClockMillis();
@@ -802,6 +826,66 @@ bool CVideoDatabase::SetPathHash(const CStdString &path, const CStdString &hash)
   return false;
 }
 
+bool CVideoDatabase::GetPathFingerprints(const CStdString &path, map<string, string> &fingerprints)
+{
+  try
+  {
+    if (NULL == m_pDB.get()) return false;
+    if (NULL == m_pDS.get()) return false;
+
+    int idPath = GetPathId(path);
+    if (idPath < 0)
+      return false;
+
+    CStdString strSQL = PrepareSQL("select strFolder, strFingerprint from pathfingerprint where idPath=%i", idPath);
+    m_pDS->query(strSQL.c_str());
+    while (!m_pDS->eof())
+    {
+      fingerprints.insert(make_pair(m_pDS->fv(0).get_asString(), m_pDS->fv(1).get_asString()));
+      m_pDS->next();
+    }
+    m_pDS->close();
+    return !fingerprints.empty();
+  }
+  catch (...)
+  {
+    CLog::Log(LOGERROR, "%s (%s) failed", __FUNCTION__, path.c_str());
+  }
+
+  return false;
+}
+
+bool CVideoDatabase::SetPathFingerprints(const CStdString &path, const map<string, string> &fingerprints)
+{
+  try
+  {
+    if (NULL == m_pDB.get()) return false;
+    if (NULL == m_pDS.get()) return false;
+
+    int idPath = GetPathId(path);
+    if (idPath < 0)
+      return false;
+
+    BeginTransaction();
+    CStdString strSQL = PrepareSQL("delete from pathfingerprint where idPath=%i", idPath);
+    m_pDS->exec(strSQL.c_str());
+    for (map<string, string>::const_iterator it = fingerprints.begin(); it != fingerprints.end(); ++it)
+    {
+      strSQL = PrepareSQL("insert into pathfingerprint (idPath, strFolder, strFingerprint) values (%i, '%s', '%s')", idPath, it->first.c_str(), it->second.c_str());
+      m_pDS->exec(strSQL.c_str());
+    }
+    CommitTransaction();
+    return true;
+  }
+  catch (...)
+  {
+    RollbackTransaction();
+    CLog::Log(LOGERROR, "%s (%s) failed", __FUNCTION__, path.c_str());
+  }
+
+  return false;
+}
+
 bool CVideoDatabase::LinkMovieToTvshow(int idMovie, int idShow, bool bRemove)
 {
    try
@@ -2948,8 +3032,13 @@ void CVideoDatabase::GetDetailsFromDB(const dbiplus::sql_record* const record, i
       *(float*)(((char*)&details)+offsets[i].offset) = record->at(i+idxOffset).get_asFloat();
       break;
     case VIDEODB_TYPE_STRINGARRAY:
-      *(std::vector<std::string>*)(((char*)&details)+offsets[i].offset) = StringUtils::Split(record->at(i+idxOffset).get_asString(), g_advancedSettings.m_videoItemSeparator);
+    {
+      // genres, studios, countries etc. repeat across the library, so share them
+      std::vector<std::string> &values = *(std::vector<std::string>*)(((char*)&details)+offsets[i].offset);
+      values = StringUtils::Split(record->at(i+idxOffset).get_asString(), g_advancedSettings.m_videoItemSeparator);
+      CStringPool::Intern(values);
       break;
+    }
     case VIDEODB_TYPE_DATE:
       ((CDateTime*)(((char*)&details)+offsets[i].offset))->SetFromDBDate(record->at(i+idxOffset).get_asString());
       break;
@@ -3126,7 +3215,7 @@ CVideoInfoTag CVideoDatabase::GetDetailsForMovie(const dbiplus::sql_record* cons
   details.m_iSetId = record->at(VIDEODB_DETAILS_MOVIE_SET_ID).get_asInt();
   details.m_strSet = record->at(VIDEODB_DETAILS_MOVIE_SET_NAME).get_asString();
   details.m_iFileId = record->at(VIDEODB_DETAILS_FILEID).get_asInt();
-  details.m_strPath = record->at(VIDEODB_DETAILS_MOVIE_PATH).get_asString();
+  details.m_strPath = CStringPool::Intern(record->at(VIDEODB_DETAILS_MOVIE_PATH).get_asString());
   CStdString strFileName = record->at(VIDEODB_DETAILS_MOVIE_FILE).get_asString();
   ConstructPath(details.m_strFileNameAndPath,details.m_strPath,strFileName);
   details.m_playCount = record->at(VIDEODB_DETAILS_MOVIE_PLAYCOUNT).get_asInt();
@@ -3188,7 +3277,7 @@ CVideoInfoTag CVideoDatabase::GetDetailsForTvShow(const dbiplus::sql_record* con
   GetDetailsFromDB(record, VIDEODB_ID_TV_MIN, VIDEODB_ID_TV_MAX, DbTvShowOffsets, details, 1);
   details.m_iDbId = idTvShow;
   details.m_type = "tvshow";
-  details.m_strPath = record->at(VIDEODB_DETAILS_TVSHOW_PATH).get_asString();
+  details.m_strPath = CStringPool::Intern(record->at(VIDEODB_DETAILS_TVSHOW_PATH).get_asString());
   details.m_dateAdded.SetFromDBDateTime(record->at(VIDEODB_DETAILS_TVSHOW_DATEADDED).get_asString());
   details.m_iEpisode = record->at(VIDEODB_DETAILS_TVSHOW_NUM_EPISODES).get_asInt();
   details.m_playCount = record->at(VIDEODB_DETAILS_TVSHOW_NUM_WATCHED).get_asInt();
@@ -3226,7 +3315,7 @@ CVideoInfoTag CVideoDatabase::GetDetailsForEpisode(const dbiplus::sql_record* co
   details.m_iDbId = idEpisode;
   details.m_type = "episode";
   details.m_iFileId = record->at(VIDEODB_DETAILS_FILEID).get_asInt();
-  details.m_strPath = record->at(VIDEODB_DETAILS_EPISODE_PATH).get_asString();
+  details.m_strPath = CStringPool::Intern(record->at(VIDEODB_DETAILS_EPISODE_PATH).get_asString());
   CStdString strFileName = record->at(VIDEODB_DETAILS_EPISODE_FILE).get_asString();
   ConstructPath(details.m_strFileNameAndPath,details.m_strPath,strFileName);
   details.m_playCount = record->at(VIDEODB_DETAILS_EPISODE_PLAYCOUNT).get_asInt();
@@ -3235,6 +3324,7 @@ CVideoInfoTag CVideoDatabase::GetDetailsForEpisode(const dbiplus::sql_record* co
   details.m_strMPAARating = record->at(VIDEODB_DETAILS_EPISODE_TVSHOW_MPAA).get_asString();
   details.m_strShowTitle = record->at(VIDEODB_DETAILS_EPISODE_TVSHOW_NAME).get_asString();
   details.m_studio = StringUtils::Split(record->at(VIDEODB_DETAILS_EPISODE_TVSHOW_STUDIO).get_asString(), g_advancedSettings.m_videoItemSeparator);
+  CStringPool::Intern(details.m_studio);
   details.m_premiered.SetFromDBDate(record->at(VIDEODB_DETAILS_EPISODE_TVSHOW_AIRED).get_asString());
   details.m_iIdShow = record->at(VIDEODB_DETAILS_EPISODE_TVSHOW_ID).get_asInt();
   details.m_strShowPath = record->at(VIDEODB_DETAILS_EPISODE_TVSHOW_PATH).get_asString();
@@ -3279,7 +3369,7 @@ CVideoInfoTag CVideoDatabase::GetDetailsForMusicVideo(const dbiplus::sql_record*
   details.m_type = "musicvideo";
   
   details.m_iFileId = record->at(VIDEODB_DETAILS_FILEID).get_asInt();
-  details.m_strPath = record->at(VIDEODB_DETAILS_MUSICVIDEO_PATH).get_asString();
+  details.m_strPath = CStringPool::Intern(record->at(VIDEODB_DETAILS_MUSICVIDEO_PATH).get_asString());
   CStdString strFileName = record->at(VIDEODB_DETAILS_MUSICVIDEO_FILE).get_asString();
   ConstructPath(details.m_strFileNameAndPath,details.m_strPath,strFileName);
   details.m_playCount = record->at(VIDEODB_DETAILS_MUSICVIDEO_PLAYCOUNT).get_asInt();
@@ -4011,6 +4101,12 @@ bool CVideoDatabase::UpdateOldVersion(int iVersion)
     }
     m_pDS->exec("DROP TABLE IF EXISTS setlinkmovie");
   }
+  if (iVersion < 69)
+  {
+    m_pDS->exec("CREATE TABLE pathfingerprint (idPath integer, strFolder text, strFingerprint text)");
+    m_pDS->exec("CREATE INDEX ix_pathfingerprint ON pathfingerprint (idPath)");
+    m_pDS->exec("CREATE TRIGGER delete_path AFTER DELETE ON path FOR EACH ROW BEGIN DELETE FROM pathfingerprint WHERE idPath=old.idPath; END");
+  }
   // always recreate the view after any table change
   CreateViews();
   return true;
@@ -5609,6 +5705,329 @@ bool CVideoDatabase::GetMoviesByWhere(const CStdString& strBaseDir, const Filter
   return false;
 }
 
+// number of movies read per query by GetMovieObjects()
+#define MOVIE_OBJECTS_PAGE_SIZE 500
+
+typedef struct
+{
+  const char* property; ///< JSON-RPC property
+  int         id;       ///< VIDEODB_ID_* column or -1 if column is set
+  const char* column;   ///< movieview column for properties that aren't in the movie table
+  int         type;     ///< VIDEODB_TYPE_* of the value
+} SMovieObjectColumn;
+
+static const SMovieObjectColumn MovieObjectColumns[] =
+{
+  { "title",         VIDEODB_ID_TITLE,         NULL,         VIDEODB_TYPE_STRING },
+  { "plot",          VIDEODB_ID_PLOT,          NULL,         VIDEODB_TYPE_STRING },
+  { "plotoutline",   VIDEODB_ID_PLOTOUTLINE,   NULL,         VIDEODB_TYPE_STRING },
+  { "tagline",       VIDEODB_ID_TAGLINE,       NULL,         VIDEODB_TYPE_STRING },
+  { "votes",         VIDEODB_ID_VOTES,         NULL,         VIDEODB_TYPE_STRING },
+  { "rating",        VIDEODB_ID_RATING,        NULL,         VIDEODB_TYPE_FLOAT },
+  { "writer",        VIDEODB_ID_CREDITS,       NULL,         VIDEODB_TYPE_STRINGARRAY },
+  { "year",          VIDEODB_ID_YEAR,          NULL,         VIDEODB_TYPE_INT },
+  { "imdbnumber",    VIDEODB_ID_IDENT,         NULL,         VIDEODB_TYPE_STRING },
+  { "sorttitle",     VIDEODB_ID_SORTTITLE,     NULL,         VIDEODB_TYPE_STRING },
+  { "runtime",       VIDEODB_ID_RUNTIME,       NULL,         VIDEODB_TYPE_STRING },
+  { "mpaa",          VIDEODB_ID_MPAA,          NULL,         VIDEODB_TYPE_STRING },
+  { "top250",        VIDEODB_ID_TOP250,        NULL,         VIDEODB_TYPE_INT },
+  { "genre",         VIDEODB_ID_GENRE,         NULL,         VIDEODB_TYPE_STRINGARRAY },
+  { "director",      VIDEODB_ID_DIRECTOR,      NULL,         VIDEODB_TYPE_STRINGARRAY },
+  { "originaltitle", VIDEODB_ID_ORIGINALTITLE, NULL,         VIDEODB_TYPE_STRING },
+  { "studio",        VIDEODB_ID_STUDIOS,       NULL,         VIDEODB_TYPE_STRINGARRAY },
+  { "trailer",       VIDEODB_ID_TRAILER,       NULL,         VIDEODB_TYPE_STRING },
+  { "country",       VIDEODB_ID_COUNTRY,       NULL,         VIDEODB_TYPE_STRINGARRAY },
+  { "set",           -1,                       "strSet",     VIDEODB_TYPE_STRING },
+  { "setid",         -1,                       "idSet",      VIDEODB_TYPE_INT },
+  { "playcount",     -1,                       "playCount",  VIDEODB_TYPE_INT },
+  { "lastplayed",    -1,                       "lastPlayed", VIDEODB_TYPE_DATETIME },
+  { "dateadded",     -1,                       "dateAdded",  VIDEODB_TYPE_DATETIME }
+};
+
+#define NUM_MOVIE_OBJECT_COLUMNS (sizeof(MovieObjectColumns) / sizeof(MovieObjectColumns[0]))
+
+static const SMovieObjectColumn* GetMovieObjectColumn(const string &property)
+{
+  for (unsigned int i = 0; i < NUM_MOVIE_OBJECT_COLUMNS; i++)
+  {
+    if (property == MovieObjectColumns[i].property)
+      return &MovieObjectColumns[i];
+  }
+  return NULL;
+}
+
+bool CVideoDatabase::CanGetMovieObjects(const set<string> &properties)
+{
+  // locked sources need the path of every movie checked
+  if (g_settings.GetMasterProfile().getLockMode() != LOCK_MODE_EVERYONE && !g_passwordManager.bMasterUser)
+    return false;
+
+  for (set<string>::const_iterator it = properties.begin(); it != properties.end(); ++it)
+  {
+    if (*it == "file" || *it == "resume" || *it == "thumbnail" || *it == "fanart")
+      continue;
+    if (GetMovieObjectColumn(*it) == NULL)
+      return false;
+  }
+  return true;
+}
+
+bool CVideoDatabase::GetMovieObjects(const CStdString& strBaseDir, const set<string> &properties, const SortDescription &sortDescription, CVariant &movies, int &total)
+{
+  try
+  {
+    if (NULL == m_pDB.get()) return false;
+    if (NULL == m_pDS.get() || NULL == m_pDS2.get()) return false;
+
+    unsigned int time = XbmcThreads::SystemClockMillis();
+    movies = CVariant(CVariant::VariantTypeArray);
+    total = 0;
+
+    CVideoDbUrl videoUrl;
+    Filter extFilter;
+    if (!videoUrl.FromString(strBaseDir) || !GetFilter(videoUrl, extFilter))
+      return false;
+
+    CStdString strSQLExtra;
+    if (!CDatabase::BuildSQL(strSQLExtra, extFilter, strSQLExtra))
+      return false;
+
+    // sort and limit the matching movies using only the columns needed for sorting
+    FieldList sortFields;
+    if (!DatabaseUtils::GetSelectFields(SortUtils::GetFieldsForSorting(sortDescription.sortBy), MediaTypeMovie, sortFields))
+      sortFields.clear();
+
+    CStdString strSQL = "SELECT movieview.idMovie";
+    for (FieldList::const_iterator field = sortFields.begin(); field != sortFields.end(); ++field)
+      strSQL += ", " + DatabaseUtils::GetField(*field, MediaTypeMovie, DatabaseQueryPartSelect);
+    strSQL += " FROM movieview " + strSQLExtra;
+
+    if (!m_pDS->query(strSQL.c_str()))
+      return false;
+
+    DatabaseResults results;
+    results.reserve(m_pDS->num_rows());
+    const query_data &data = m_pDS->get_result_set().records;
+    for (unsigned int row = 0; row < data.size(); row++)
+    {
+      DatabaseResult result;
+      result[FieldRow] = row;
+      result[FieldId] = data[row]->at(0).get_asInt();
+      unsigned int column = 1;
+      for (FieldList::const_iterator field = sortFields.begin(); field != sortFields.end(); ++field)
+        DatabaseUtils::GetFieldValue(data[row]->at(column++), result[*field]);
+      result[FieldMediaType] = MediaTypeMovie;
+      if (result.find(FieldTitle) != result.end())
+        result[FieldLabel] = result[FieldTitle].asString();
+      results.push_back(result);
+    }
+    m_pDS->close();
+
+    total = (int)results.size();
+    SortUtils::Sort(sortDescription, results);
+    if (results.empty())
+      return true;
+
+    // work out the columns holding the requested properties
+    vector< pair<const SMovieObjectColumn*, unsigned int> > columns;
+    CStdString strColumns; strColumns.Format("idMovie, c%02d", VIDEODB_ID_TITLE);
+    unsigned int numColumns = 2;
+    int fileIndex = -1, resumeIndex = -1;
+    bool thumbnail = false, fanart = false;
+    for (set<string>::const_iterator it = properties.begin(); it != properties.end(); ++it)
+    {
+      if (*it == "file")
+      {
+        strColumns += ", strPath, strFileName";
+        fileIndex = numColumns;
+        numColumns += 2;
+      }
+      else if (*it == "resume")
+      {
+        strColumns += ", resumeTimeInSeconds, totalTimeInSeconds";
+        resumeIndex = numColumns;
+        numColumns += 2;
+      }
+      else if (*it == "thumbnail")
+        thumbnail = true;
+      else if (*it == "fanart")
+        fanart = true;
+      else
+      {
+        const SMovieObjectColumn *column = GetMovieObjectColumn(*it);
+        if (column == NULL)
+          return false;
+
+        if (column->id >= 0)
+          strColumns.AppendFormat(", c%02d", column->id);
+        else
+          strColumns.AppendFormat(", %s", column->column);
+        columns.push_back(make_pair(column, numColumns++));
+      }
+    }
+
+    // read the properties a page at a time and convert them straight into objects
+    for (size_t start = 0; start < results.size(); start += MOVIE_OBJECTS_PAGE_SIZE)
+    {
+      size_t end = std::min(results.size(), start + MOVIE_OBJECTS_PAGE_SIZE);
+      CStdString ids;
+      for (size_t i = start; i < end; i++)
+        ids.AppendFormat("%s%d", i > start ? "," : "", (int)results[i].at(FieldId).asInteger());
+
+      map<int, CVariant> page;
+      strSQL = "SELECT " + strColumns + " FROM movieview WHERE idMovie IN (" + ids + ")";
+      if (!m_pDS->query(strSQL.c_str()))
+        return false;
+
+      while (!m_pDS->eof())
+      {
+        const sql_record* const record = m_pDS->get_sql_record();
+        int idMovie = record->at(0).get_asInt();
+        CVariant &movie = page[idMovie];
+        movie["movieid"] = idMovie;
+        movie["label"] = record->at(1).get_asString();
+
+        for (vector< pair<const SMovieObjectColumn*, unsigned int> >::const_iterator column = columns.begin(); column != columns.end(); ++column)
+        {
+          const field_value &value = record->at(column->second);
+          switch (column->first->type)
+          {
+          case VIDEODB_TYPE_STRING:
+            movie[column->first->property] = value.get_asString();
+            break;
+          case VIDEODB_TYPE_INT:
+            movie[column->first->property] = value.get_asInt();
+            break;
+          case VIDEODB_TYPE_FLOAT:
+            movie[column->first->property] = value.get_asFloat();
+            break;
+          case VIDEODB_TYPE_STRINGARRAY:
+            movie[column->first->property] = StringUtils::Split(value.get_asString(), g_advancedSettings.m_videoItemSeparator);
+            break;
+          case VIDEODB_TYPE_DATETIME:
+          {
+            CDateTime dateTime;
+            dateTime.SetFromDBDateTime(value.get_asString());
+            movie[column->first->property] = dateTime.IsValid() ? dateTime.GetAsDBDateTime() : StringUtils::EmptyString;
+            break;
+          }
+          }
+        }
+
+        if (fileIndex >= 0)
+        {
+          CStdString file;
+          ConstructPath(file, record->at(fileIndex).get_asString(), record->at(fileIndex + 1).get_asString());
+          movie["file"] = file;
+        }
+        if (resumeIndex >= 0)
+        {
+          CVariant resume = CVariant(CVariant::VariantTypeObject);
+          resume["position"] = (float)record->at(resumeIndex).get_asInt();
+          resume["total"] = (float)record->at(resumeIndex + 1).get_asInt();
+          movie["resume"] = resume;
+        }
+        m_pDS->next();
+      }
+      m_pDS->close();
+
+      // movies without any artwork in the library are left to the caller
+      if (thumbnail || fanart)
+      {
+        strSQL = "SELECT media_id, type, url FROM art WHERE media_type='movie' AND media_id IN (" + ids + ")";
+        m_pDS2->query(strSQL.c_str());
+        while (!m_pDS2->eof())
+        {
+          map<int, CVariant>::iterator movie = page.find(m_pDS2->fv(0).get_asInt());
+          if (movie != page.end())
+          {
+            // a movie with artwork gets empty values for the types it doesn't have
+            CVariant &object = movie->second;
+            if (thumbnail && !object.isMember("thumbnail"))
+              object["thumbnail"] = "";
+            if (fanart && !object.isMember("fanart"))
+              object["fanart"] = "";
+
+            string type = m_pDS2->fv(1).get_asString();
+            string url = m_pDS2->fv(2).get_asString();
+            if (!url.empty())
+            {
+              if (thumbnail && type == "thumb")
+                object["thumbnail"] = CTextureCache::GetWrappedImageURL(url);
+              else if (fanart && type == "fanart")
+                object["fanart"] = CTextureCache::GetWrappedImageURL(url);
+            }
+          }
+          m_pDS2->next();
+        }
+        m_pDS2->close();
+      }
+
+      for (size_t i = start; i < end; i++)
+      {
+        map<int, CVariant>::iterator movie = page.find((int)results[i].at(FieldId).asInteger());
+        if (movie == page.end())
+          continue;
+        movies.push_back(CVariant(CVariant::VariantTypeNull));
+        movies[movies.size() - 1].swap(movie->second);
+      }
+    }
+
+    unsigned int elapsed = XbmcThreads::SystemClockMillis() - time;
+    CLog::Log(LOGDEBUG, "%s(%s) - %u of %d movies with %u properties in %u ms (%.0f rows/s)", __FUNCTION__, strBaseDir.c_str(),
+              (unsigned int)movies.size(), total, (unsigned int)properties.size(), elapsed, movies.size() * 1000.0 / std::max(elapsed, 1U));
+    return true;
+  }
+  catch (...)
+  {
+    m_pDS->close();
+    m_pDS2->close();
+    CLog::Log(LOGERROR, "%s failed", __FUNCTION__);
+  }
+  return false;
+}
+
+bool CVideoDatabase::GetMoviesForLocalArt(const vector<int> &idMovies, map<int, CVideoInfoTag> &movies)
+{
+  try
+  {
+    if (NULL == m_pDB.get()) return false;
+    if (NULL == m_pDS.get()) return false;
+
+    for (size_t start = 0; start < idMovies.size(); start += MOVIE_OBJECTS_PAGE_SIZE)
+    {
+      size_t end = std::min(idMovies.size(), start + MOVIE_OBJECTS_PAGE_SIZE);
+      CStdString ids;
+      for (size_t i = start; i < end; i++)
+        ids.AppendFormat("%s%d", i > start ? "," : "", idMovies[i]);
+
+      CStdString strSQL = PrepareSQL("SELECT idMovie, strPath, strFileName, c%02d, c%02d FROM movieview WHERE idMovie IN (", VIDEODB_ID_THUMBURL, VIDEODB_ID_FANART) + ids + ")";
+      if (!m_pDS->query(strSQL.c_str()))
+        return false;
+
+      while (!m_pDS->eof())
+      {
+        CVideoInfoTag &details = movies[m_pDS->fv(0).get_asInt()];
+        details.m_iDbId = m_pDS->fv(0).get_asInt();
+        details.m_type = "movie";
+        details.m_strPath = m_pDS->fv(1).get_asString();
+        ConstructPath(details.m_strFileNameAndPath, details.m_strPath, m_pDS->fv(2).get_asString());
+        details.m_strPictureURL.m_xml = m_pDS->fv(3).get_asString();
+        details.m_fanart.m_xml = m_pDS->fv(4).get_asString();
+        m_pDS->next();
+      }
+      m_pDS->close();
+    }
+    return true;
+  }
+  catch (...)
+  {
+    m_pDS->close();
+    CLog::Log(LOGERROR, "%s failed", __FUNCTION__);
+  }
+  return false;
+}
+
 bool CVideoDatabase::GetTvShowsNav(const CStdString& strBaseDir, CFileItemList& items,
                                   int idGenre /* = -1 */, int idYear /* = -1 */, int idActor /* = -1 */, int idDirector /* = -1 */, int idStudio /* = -1 */,
                                   const SortDescription &sortDescription /* = SortDescription() */)
@@ -7766,6 +8185,8 @@ void CVideoDatabase::CleanDatabase(IVideoInfoScannerObserver* pObserver, const s
 
     for (unsigned int i = 0; i < musicVideoIDs.size(); i++)
       AnnounceRemove("musicvideo", musicVideoIDs[i]);
+
+    ANNOUNCEMENT::CAnnouncementManager::Announce(ANNOUNCEMENT::VideoLibrary, "xbmc", "OnCleanFinished");
   }
   catch (...)
   {
@@ -33,6 +33,7 @@ class CFileItem;
 class CFileItemList;
 class CVideoSettings;
 class CGUIDialogProgress;
+class CVariant;
 
 namespace dbiplus
 {
@@ -522,9 +523,32 @@ public:
   // scanning hashes and paths scanned
   bool SetPathHash(const CStdString &path, const CStdString &hash);
   bool GetPathHash(const CStdString &path, CStdString &hash);
+
+  /*! \brief Retrieve the stat fingerprints of the folders below a scanned path
+   \param path the scanned path
+   \param fingerprints [out] fingerprint of each folder, keyed by folder
+   \return true if fingerprints were stored for the path, false otherwise
+   \sa SetPathFingerprints
+   */
+  bool GetPathFingerprints(const CStdString &path, std::map<std::string, std::string> &fingerprints);
+
+  /*! \brief Replace the stat fingerprints of the folders below a scanned path
+   The path must already be in the database, e.g. from SetPathHash().
+   \param path the scanned path
+   \param fingerprints fingerprint of each folder, keyed by folder
+   \return true on success, false otherwise
+   \sa GetPathFingerprints
+   */
+  bool SetPathFingerprints(const CStdString &path, const std::map<std::string, std::string> &fingerprints);
   bool GetPaths(std::set<CStdString> &paths);
   bool GetPathsForTvShow(int idShow, std::set<int>& paths);
 
+  /*! \brief Retrieve the number of files holding episodes of a tv show
+   \param idShow the tv show
+   \return the number of files, 0 if the show has none or on error
+   */
+  int GetFileCountForTvShow(int idShow);
+
   /*! \brief retrieve subpaths of a given path.  Assumes a heirarchical folder structure
    \param basepath the root path to retrieve subpaths for
    \param subpaths the returned subpaths
@@ -645,7 +669,37 @@ public:
   bool GetTvShowsByWhere(const CStdString& strBaseDir, const Filter &filter, CFileItemList& items, const SortDescription &sortDescription = SortDescription());
   bool GetEpisodesByWhere(const CStdString& strBaseDir, const Filter &filter, CFileItemList& items, bool appendFullShowPath = true, const SortDescription &sortDescription = SortDescription());
   bool GetMusicVideosByWhere(const CStdString &baseDir, const Filter &filter, CFileItemList& items, bool checkLocks = true, const SortDescription &sortDescription = SortDescription());
-  
+
+  /*! \brief Retrieve sorted and limited movies straight into JSON-RPC objects
+   Sorts and limits on the sort columns only and then reads the requested properties of the
+   remaining movies page by page, without building CVideoInfoTags or a CFileItemList.
+   Movies without any artwork in the library don't get "thumbnail" and "fanart" members so
+   the caller can look for local artwork.
+   \param strBaseDir videodb:// url of the movies node, including any filter options
+   \param properties JSON-RPC properties to retrieve (see CanGetMovieObjects())
+   \param sortDescription sorting and limits to apply
+   \param movies array of movie objects in sort order
+   \param total number of movies matching the filter before applying the limits
+   \return true on success, false otherwise
+   \sa CanGetMovieObjects
+   */
+  bool GetMovieObjects(const CStdString& strBaseDir, const std::set<std::string> &properties, const SortDescription &sortDescription, CVariant &movies, int &total);
+
+  /*! \brief Whether GetMovieObjects() can provide the given properties
+   Properties that need extra tables (cast, tags, stream details etc.) aren't supported and
+   neither is filtering by locked sources.
+   */
+  static bool CanGetMovieObjects(const std::set<std::string> &properties);
+
+  /*! \brief Retrieve only what is needed to look for the local artwork of several movies
+   Fills the id, type, paths and scraped thumb and fanart urls of each movie, reading
+   them in pages rather than one movie at a time.
+   \param idMovies ids of the movies to retrieve
+   \param movies the partial details of each movie found, by movie id
+   \return true on success, false otherwise
+   */
+  bool GetMoviesForLocalArt(const std::vector<int> &idMovies, std::map<int, CVideoInfoTag> &movies);
+
   // retrieve sorted and limited items
   bool GetSortedVideos(MediaType mediaType, const CStdString& strBaseDir, const SortDescription &sortDescription, CFileItemList& items, const Filter &filter = Filter(), bool fetchSets = false);
 
@@ -803,7 +857,7 @@ private:
    */
   bool LookupByFolders(const CStdString &path, bool shows = false);
 
-  virtual int GetMinVersion() const { return 68; };
+  virtual int GetMinVersion() const { return 69; };
   virtual int GetExportVersion() const { return 1; };
   const char *GetBaseDBName() const { return "MyVideos"; };
 
@@ -53,6 +53,9 @@ using namespace std;
 using namespace XFILE;
 using namespace ADDON;
 
+// number of series folders listed ahead of the one being scanned
+#define SERIES_PREFETCH_COUNT 8
+
 namespace VIDEO
 {
 
@@ -365,6 +368,7 @@ namespace VIDEO
 
     bool FoundSomeInfo = false;
     vector<int> seenPaths;
+    int nextPrefetch = 0; // first item not yet handed to m_seriesListings
     for (int i = 0; i < (int)items.Size(); ++i)
     {
       m_nfoReader.Close();
@@ -394,6 +398,20 @@ namespace VIDEO
       // clear our scraper cache
       info2->ClearCache();
 
+      // list the next few series folders in the background while this one is processed
+      if (info2->Content() == CONTENT_TVSHOWS && fetchEpisodes)
+      {
+        for (int j = max(i, nextPrefetch); j < items.Size() && j < i + SERIES_PREFETCH_COUNT; j++)
+        {
+          nextPrefetch = j + 1;
+          if (!items[j]->m_bIsFolder)
+            continue;
+          FolderFingerprints fingerprints;
+          m_database.GetPathFingerprints(items[j]->GetPath(), fingerprints);
+          m_seriesListings.Prefetch(items[j]->GetPath(), fingerprints);
+        }
+      }
+
       INFO_RET ret = INFO_CANCELLED;
       if (info2->Content() == CONTENT_TVSHOWS)
         ret = RetrieveInfoForTvShow(pItem, bDirNames, info2, useLocal, pURL, fetchEpisodes, pDlgProgress);
@@ -422,6 +440,9 @@ namespace VIDEO
         seenPaths.push_back(m_database.GetPathId(pItem->GetPath()));
     }
 
+    m_seriesListings.Clear();
+    m_seriesFingerprints.clear();
+
     if (content == CONTENT_TVSHOWS && ! seenPaths.empty())
     {
       vector< pair<int,string> > libPaths;
@@ -455,7 +476,7 @@ namespace VIDEO
     {
       INFO_RET ret = RetrieveInfoForEpisodes(pItem, idTvShow, info2, useLocal, pDlgProgress);
       if (ret == INFO_ADDED)
-        m_database.SetPathHash(pItem->GetPath(), pItem->GetProperty("hash").asString());
+        SetSeriesHash(pItem);
       return ret;
     }
 
@@ -486,7 +507,7 @@ namespace VIDEO
       {
         INFO_RET ret = RetrieveInfoForEpisodes(pItem, lResult, info2, useLocal, pDlgProgress);
         if (ret == INFO_ADDED)
-          m_database.SetPathHash(pItem->GetPath(), pItem->GetProperty("hash").asString());
+          SetSeriesHash(pItem);
         return ret;
       }
       return INFO_ADDED;
@@ -511,7 +532,7 @@ namespace VIDEO
     {
       INFO_RET ret = RetrieveInfoForEpisodes(pItem, lResult, info2, useLocal, pDlgProgress);
       if (ret == INFO_ADDED)
-        m_database.SetPathHash(pItem->GetPath(), pItem->GetProperty("hash").asString());
+        SetSeriesHash(pItem);
     }
     return INFO_ADDED;
   }
@@ -626,18 +647,64 @@ namespace VIDEO
     return OnProcessSeriesFolder(files, scraper, useLocal, showID, showTitle, progress);
   }
 
+  void CVideoInfoScanner::SetSeriesHash(const CFileItemPtr &item)
+  {
+    m_database.SetPathHash(item->GetPath(), item->GetProperty("hash").asString());
+
+    map<CStdString, FolderFingerprints>::iterator fingerprints = m_seriesFingerprints.find(item->GetPath());
+    if (fingerprints != m_seriesFingerprints.end())
+    {
+      m_database.SetPathFingerprints(item->GetPath(), fingerprints->second);
+      m_seriesFingerprints.erase(fingerprints);
+    }
+  }
+
   void CVideoInfoScanner::EnumerateSeriesFolder(CFileItem* item, EPISODES& episodeList)
   {
     CFileItemList items;
 
     if (item->m_bIsFolder)
     {
-      CUtil::GetRecursiveListing(item->GetPath(), items, g_settings.m_videoExtensions, true);
       CStdString hash, dbHash;
+      bool haveHash = m_database.GetPathHash(item->GetPath(), dbHash) && !dbHash.IsEmpty();
+
+      CSeriesListing listing;
+      if (!m_seriesListings.Get(item->GetPath(), listing))
+      {
+        FolderFingerprints fingerprints;
+        m_database.GetPathFingerprints(item->GetPath(), fingerprints);
+        CSeriesListingPrefetcher::Fetch(item->GetPath(), fingerprints, listing);
+      }
+      if (listing.m_unchanged)
+      {
+        if (haveHash)
+        { // none of the folders changed since the last scan - no need to list them
+          CLog::Log(LOGDEBUG, "VideoInfoScanner: Skipping dir '%s' due to no change (fingerprint)", item->GetPath().c_str());
+          // nothing was listed, so count the files the library has for the show
+          int numFilesInFolder = m_database.GetFileCountForTvShow(m_database.GetTvShowId(item->GetPath()));
+          m_currentItem += numFilesInFolder;
+
+          // notify our observer of our progress
+          if (m_pObserver)
+          {
+            if (m_itemCount>0)
+            {
+              m_pObserver->OnSetProgress(m_currentItem, m_itemCount);
+              m_pObserver->OnSetCurrentProgress(numFilesInFolder, numFilesInFolder);
+            }
+            m_pObserver->OnDirectoryScanned(item->GetPath());
+          }
+          return;
+        }
+        CSeriesListingPrefetcher::Fetch(item->GetPath(), FolderFingerprints(), listing);
+      }
+      items.Append(listing.m_items);
       int numFilesInFolder = GetPathHash(items, hash);
 
-      if (m_database.GetPathHash(item->GetPath(), dbHash) && dbHash == hash)
+      if (haveHash && dbHash == hash)
       {
+        // content is unchanged, so refresh the fingerprints for the next scan
+        m_database.SetPathFingerprints(item->GetPath(), listing.m_fingerprints);
         m_currentItem += numFilesInFolder;
 
         // notify our observer of our progress
@@ -655,6 +722,7 @@ namespace VIDEO
       m_pathsToClean.insert(m_database.GetPathId(item->GetPath()));
       m_database.GetPathsForTvShow(m_database.GetTvShowId(item->GetPath()), m_pathsToClean);
       item->SetProperty("hash", hash);
+      m_seriesFingerprints[item->GetPath()].swap(listing.m_fingerprints);
     }
     else
     {
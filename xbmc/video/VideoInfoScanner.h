@@ -23,6 +23,7 @@
 #include "VideoDatabase.h"
 #include "addons/Scraper.h"
 #include "NfoFile.h"
+#include "SeriesListingPrefetcher.h"
 #include "XBDateTime.h"
 
 class CRegExp;
@@ -228,6 +229,13 @@ namespace VIDEO
     INFO_RET OnProcessSeriesFolder(EPISODES& files, const ADDON::ScraperPtr &scraper, bool useLocal, int idShow, const CStdString& strShowTitle, CGUIDialogProgress* pDlgProgress = NULL);
 
     void EnumerateSeriesFolder(CFileItem* item, EPISODES& episodeList);
+
+    /*! \brief Store the hash of a series folder set by EnumerateSeriesFolder() once its episodes are added
+     Also stores the fingerprints of its folders so an unchanged series folder needn't be listed next time.
+     \param item the series folder
+     */
+    void SetSeriesHash(const CFileItemPtr &item);
+
     bool EnumerateEpisodeItem(const CFileItemPtr item, EPISODES& episodeList);
     bool ProcessItemByVideoInfoTag(const CFileItemPtr item, EPISODES &episodeList);
 
@@ -252,6 +260,8 @@ namespace VIDEO
     std::set<CStdString> m_pathsToCount;
     std::set<int> m_pathsToClean;
     CNfoFile m_nfoReader;
+    CSeriesListingPrefetcher m_seriesListings;
+    std::map<CStdString, FolderFingerprints> m_seriesFingerprints; ///< fingerprints of series folders waiting for SetSeriesHash()
   };
 }
 
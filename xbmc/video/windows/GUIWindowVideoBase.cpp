@@ -112,6 +112,7 @@ bool CGUIWindowVideoBase::OnMessage(CGUIMessage& message)
   case GUI_MSG_WINDOW_DEINIT:
     if (m_thumbLoader.IsLoading())
       m_thumbLoader.StopThread();
+    m_thumbLoader.CancelJobs();
     m_database.Close();
     break;
 
@@ -1705,6 +1706,10 @@ bool CGUIWindowVideoBase::Update(const CStdString &strDirectory)
   if (m_thumbLoader.IsLoading())
     m_thumbLoader.StopThread();
 
+  // extractions for the folder we're leaving are of no use anymore
+  if (!m_vecItems->GetPath().Equals(strDirectory))
+    m_thumbLoader.CancelJobs();
+
   if (!CGUIMediaWindow::Update(strDirectory))
     return false;
 